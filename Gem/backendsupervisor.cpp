@@ -0,0 +1,315 @@
+#include "backendsupervisor.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+
+const int StartupTimeoutMs = 60000;
+const int StopGraceMs = 3000;
+const int MaxBackoffMs = 30000;
+const qint64 StableUptimeMs = 60000; // a child up this long gets its backoff reset
+const int MaxOptionalRestarts = 5;    // crashes in a row before an optional child is given up
+const int MaxPendingOutput = 4096;
+
+} // namespace
+
+BackendSupervisor::BackendSupervisor(QObject *parent)
+    : QObject(parent), environment(QProcessEnvironment::systemEnvironment())
+{
+    network = new QNetworkAccessManager(this);
+
+    startupTimer = new QTimer(this);
+    startupTimer->setSingleShot(true);
+    connect(startupTimer, &QTimer::timeout, this, [=]() {
+        for (Child *child : children) {
+            if (child->required && !child->ready) {
+                emit failed(QString("%1 did not become ready in time").arg(child->name));
+                stop();
+                return;
+            }
+        }
+    });
+
+    const QString root = QCoreApplication::applicationDirPath();
+
+    // gem-cache speaks the Redis protocol and prints redis-server's marker
+    Child *cache = addChild("cache", QDir(root).filePath("gem-cache"), {});
+    cache->readyMarker = "Ready to accept connections";
+    cache->required = false; // cache-ocr.js falls back to LLM-only mode
+
+    Child *screenpipe = addChild("screenpipe", "screenpipe", {});
+    screenpipe->probeHealth = true;
+
+    // Without the gateway the backend talks to the provider directly
+    const QString gatewayPort = qEnvironmentVariable("GEM_GATEWAY_PORT", "8787");
+    Child *gateway = addChild("gateway", QDir(root).filePath("gem-gateway"), {"--port", gatewayPort});
+    gateway->readyMarker = "GEM_READY";
+    gateway->required = false;
+    gateway->exports.insert("GEM_GATEWAY_URL", QString("http://127.0.0.1:%1").arg(gatewayPort));
+
+    Child *poller = addChild("poller", "node", {QDir(root).filePath("backend/ocr/screenpipe-poller.js")});
+    poller->readyMarker = "GEM_READY";
+    poller->dependsOn = {"screenpipe", "gateway"};
+}
+
+BackendSupervisor::~BackendSupervisor() {
+    stopping = true;
+    for (Child *child : children) {
+        child->restartTimer->stop();
+        if (child->process->state() == QProcess::NotRunning) continue;
+
+        child->process->disconnect(this);
+        child->process->closeWriteChannel();
+        child->process->terminate();
+        if (!child->process->waitForFinished(StopGraceMs / 2)) child->process->kill();
+        child->process->waitForFinished(500);
+    }
+    qDeleteAll(children);
+}
+
+BackendSupervisor::Child *BackendSupervisor::addChild(const QString &name, const QString &program,
+                                                      const QStringList &arguments) {
+    Child *child = new Child;
+    child->name = name;
+    child->program = program;
+    child->arguments = arguments;
+
+    child->process = new QProcess(this);
+    child->process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(child->process, &QProcess::readyReadStandardOutput, this, [=]() { onOutput(child); });
+    connect(child->process, &QProcess::finished, this,
+            [=](int exitCode, QProcess::ExitStatus status) { onFinished(child, exitCode, status); });
+    connect(child->process, &QProcess::errorOccurred, this,
+            [=](QProcess::ProcessError error) { onError(child, error); });
+
+    child->restartTimer = new QTimer(this);
+    child->restartTimer->setSingleShot(true);
+    connect(child->restartTimer, &QTimer::timeout, this, [=]() { launch(child); });
+
+    children.append(child);
+    return child;
+}
+
+BackendSupervisor::Child *BackendSupervisor::find(const QString &name) const {
+    for (Child *child : children)
+        if (child->name == name) return child;
+    return nullptr;
+}
+
+void BackendSupervisor::start() {
+    if (running) return;
+    running = true;
+    stopping = false;
+    announcedReady = false;
+
+    for (Child *child : children) {
+        child->ready = false;
+        child->unavailable = false;
+        child->restarts = 0;
+    }
+
+    startupTimer->start(StartupTimeoutMs);
+    launchDependents();
+}
+
+void BackendSupervisor::launchDependents() {
+    for (Child *child : children) {
+        if (child->unavailable || child->process->state() != QProcess::NotRunning
+            || child->restartTimer->isActive())
+            continue;
+
+        bool satisfied = true;
+        for (const QString &dependency : child->dependsOn) {
+            Child *other = find(dependency);
+            if (other && !other->ready && !other->unavailable) satisfied = false;
+        }
+        if (satisfied) launch(child);
+    }
+}
+
+void BackendSupervisor::launch(Child *child) {
+    if (stopping || child->process->state() != QProcess::NotRunning) return;
+
+    QProcessEnvironment env = environment;
+    env.insert("GEM_SUPERVISED", "1"); // children exit when their stdin closes
+    for (const Child *other : children) {
+        if (!other->ready) continue;
+        for (auto it = other->exports.constBegin(); it != other->exports.constEnd(); ++it)
+            env.insert(it.key(), it.value());
+    }
+
+    child->ready = false;
+    child->probing = false;
+    child->pendingOutput.clear();
+    child->process->setProcessEnvironment(env);
+    child->process->setWorkingDirectory(QCoreApplication::applicationDirPath());
+    child->process->start(child->program, child->arguments);
+    child->uptime.start();
+
+    qDebug() << "Supervisor: launching" << child->name;
+    emit childStatus(child->name, "starting");
+}
+
+void BackendSupervisor::onOutput(Child *child) {
+    const QByteArray output = child->process->readAllStandardOutput();
+    if (child->ready) return;
+
+    if (child->probeHealth) {
+        probeHealth(child);
+        return;
+    }
+
+    // Look for the marker on a complete line
+    child->pendingOutput.append(output);
+    int newline;
+    while ((newline = child->pendingOutput.indexOf('\n')) >= 0) {
+        const QByteArray line = child->pendingOutput.left(newline).trimmed();
+        child->pendingOutput.remove(0, newline + 1);
+        if (line.contains(child->readyMarker)) {
+            markReady(child);
+            return;
+        }
+    }
+    if (child->pendingOutput.size() > MaxPendingOutput)
+        child->pendingOutput = child->pendingOutput.right(MaxPendingOutput);
+}
+
+void BackendSupervisor::probeHealth(Child *child) {
+    if (child->probing || child->ready) return;
+    child->probing = true;
+
+    const QString port = qEnvironmentVariable("SCREENPIPE_PORT", "3030");
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/health").arg(port)));
+    QNetworkReply *reply = network->get(request);
+
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        child->probing = false;
+        if (child->ready || child->process->state() != QProcess::Running) return;
+
+        if (reply->error() == QNetworkReply::NoError) {
+            markReady(child);
+            return;
+        }
+
+        // Not listening yet; try again shortly in case it has gone quiet
+        if (child->uptime.elapsed() < StartupTimeoutMs)
+            QTimer::singleShot(250, this, [=]() { probeHealth(child); });
+    });
+}
+
+void BackendSupervisor::markReady(Child *child) {
+    child->ready = true;
+    qDebug() << "Supervisor:" << child->name << "ready after" << child->uptime.elapsed() << "ms";
+    emit childStatus(child->name, "ready");
+
+    launchDependents();
+
+    if (announcedReady) return;
+    for (Child *other : children)
+        if (other->required && !other->ready) return;
+
+    announcedReady = true;
+    startupTimer->stop();
+    emit ready();
+}
+
+void BackendSupervisor::onFinished(Child *child, int exitCode, QProcess::ExitStatus status) {
+    const bool wasReady = child->ready;
+    child->ready = false;
+    child->probing = false;
+
+    if (stopping) {
+        emit childStatus(child->name, "stopped");
+        checkAllStopped();
+        return;
+    }
+
+    qWarning() << "Supervisor:" << child->name << "exited" << exitCode << status;
+
+    if (child->uptime.isValid() && child->uptime.elapsed() > StableUptimeMs) child->restarts = 0;
+
+    // An optional child that exits before it is ready (its port is taken,
+    // its database locked) or keeps crashing won't come right by waiting;
+    // what depends on it goes on without it
+    if (!child->required && (!wasReady || child->restarts >= MaxOptionalRestarts)) {
+        markUnavailable(child);
+        return;
+    }
+
+    const int delay = qMin(MaxBackoffMs, 1000 << qMin(child->restarts, 5));
+    ++child->restarts;
+
+    emit childStatus(child->name, QString("restarting in %1 s").arg(delay / 1000));
+    child->restartTimer->start(delay);
+}
+
+void BackendSupervisor::onError(Child *child, QProcess::ProcessError error) {
+    if (error != QProcess::FailedToStart) return;
+
+    qWarning() << "Supervisor: failed to start" << child->name << child->process->errorString();
+
+    if (!child->required) {
+        markUnavailable(child);
+        return;
+    }
+
+    if (!stopping) {
+        emit failed(QString("%1 could not be started: %2").arg(child->name, child->process->errorString()));
+        stop();
+    }
+}
+
+void BackendSupervisor::markUnavailable(Child *child) {
+    child->unavailable = true;
+    child->restartTimer->stop();
+    emit childStatus(child->name, "unavailable");
+
+    // Dependents running with its exports (a gateway URL) would keep using
+    // a dead port; they are restarted, and relaunched without them
+    if (!child->exports.isEmpty()) {
+        for (Child *other : children) {
+            if (!other->dependsOn.contains(child->name) || other->process->state() == QProcess::NotRunning)
+                continue;
+            qDebug() << "Supervisor: restarting" << other->name << "without" << child->name;
+            other->process->closeWriteChannel();
+            other->process->terminate();
+        }
+    }
+
+    launchDependents();
+}
+
+void BackendSupervisor::stop() {
+    if (!running) return;
+    stopping = true;
+    startupTimer->stop();
+
+    // Dependents first
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
+        Child *child = *it;
+        child->restartTimer->stop();
+        if (child->process->state() == QProcess::NotRunning) continue;
+
+        child->process->closeWriteChannel();
+        child->process->terminate();
+        QTimer::singleShot(StopGraceMs, child->process, [process = child->process]() {
+            if (process->state() != QProcess::NotRunning) process->kill();
+        });
+    }
+
+    checkAllStopped();
+}
+
+void BackendSupervisor::checkAllStopped() {
+    if (!stopping || !running) return;
+    for (Child *child : children)
+        if (child->process->state() != QProcess::NotRunning) return;
+
+    running = false;
+    emit stopped();
+}
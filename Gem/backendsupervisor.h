@@ -0,0 +1,79 @@
+#ifndef BACKENDSUPERVISOR_H
+#define BACKENDSUPERVISOR_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+
+// Owns the backend processes (cache, Screenpipe, LLM gateway, poller) as QProcess
+// children. A child is ready when it prints its marker line on stdout; for
+// Screenpipe, whose output we don't control, each burst of output triggers a
+// /health probe instead. Crashed children are restarted with exponential
+// backoff; an optional one that exits before it is ready, or crashes too
+// often, is given up and its dependents go on without it. Everything is
+// shut down when the supervisor stops or dies.
+class BackendSupervisor : public QObject {
+    Q_OBJECT
+public:
+    explicit BackendSupervisor(QObject *parent = nullptr);
+    ~BackendSupervisor();
+
+    void setEnvironment(const QProcessEnvironment &env) { environment = env; }
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+
+signals:
+    void ready();
+    void failed(const QString &reason);
+    void stopped();
+    void childStatus(const QString &name, const QString &status);
+
+private:
+    struct Child {
+        QString name;
+        QString program;
+        QStringList arguments;
+        QStringList dependsOn;
+        QHash<QString, QString> exports; // environment for children launched once this one is ready
+        QByteArray readyMarker;
+        bool probeHealth = false;
+        bool required = true;
+
+        QProcess *process = nullptr;
+        QTimer *restartTimer = nullptr;
+        QElapsedTimer uptime;
+        QByteArray pendingOutput;
+        bool ready = false;
+        bool probing = false;
+        bool unavailable = false;
+        int restarts = 0;
+    };
+
+    QList<Child*> children;
+    QProcessEnvironment environment;
+    QNetworkAccessManager *network;
+    QTimer *startupTimer;
+    bool running = false;
+    bool stopping = false;
+    bool announcedReady = false;
+
+    Child *addChild(const QString &name, const QString &program, const QStringList &arguments);
+    Child *find(const QString &name) const;
+    void launch(Child *child);
+    void launchDependents();
+    void onOutput(Child *child);
+    void onFinished(Child *child, int exitCode, QProcess::ExitStatus status);
+    void onError(Child *child, QProcess::ProcessError error);
+    void probeHealth(Child *child);
+    void markReady(Child *child);
+    void markUnavailable(Child *child);
+    void checkAllStopped();
+};
+
+#endif // BACKENDSUPERVISOR_H
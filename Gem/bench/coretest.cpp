@@ -0,0 +1,344 @@
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "kvstore.h"
+#include "promptbuilder.h"
+#include "simhash.h"
+#include "textdelta.h"
+#include "textkernels.h"
+
+// Checks for the Qt-free structures in Gem/core that the benchmarks lean
+// on. No test framework: each failed check prints where it failed and the
+// process exits non-zero. Build with -fsanitize=address,undefined to catch
+// what the checks don't.
+//
+//   gem_core_test
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                             \
+        }                                                                           \
+    } while (0)
+
+uint64_t flipBits(uint64_t fingerprint, int count, std::mt19937_64 &random) {
+    uint64_t flipped = fingerprint;
+    while (hammingDistance(flipped, fingerprint) < count) flipped ^= uint64_t(1) << (random() % 64);
+    return flipped;
+}
+
+// Every fingerprint within maxDistance must be found, wherever its changed
+// bits fall, and nothing further away
+void nearDuplicateIndex() {
+    std::mt19937_64 random(7);
+    for (int distance = 0; distance <= 15; ++distance) {
+        NearDuplicateIndex index(distance, 256);
+        CHECK(index.maxDistance() == distance);
+
+        std::vector<uint64_t> stored;
+        for (int i = 0; i < 200; ++i) {
+            stored.push_back(random());
+            index.insert("app|window", stored.back(), std::to_string(i));
+        }
+
+        for (size_t i = 0; i < stored.size(); ++i) {
+            for (int flips = 0; flips <= distance; ++flips) {
+                const NearDuplicateIndex::Match match = index.lookup("app|window", flipBits(stored[i], flips, random));
+                CHECK(match && match.distance <= flips);
+            }
+            CHECK(!index.lookup("other|window", stored[i]));
+        }
+
+        // Changes packed into the top and the bottom bits, where the last
+        // and first bands are
+        for (uint64_t fingerprint : {stored.front(), stored.back()}) {
+            const uint64_t low = distance == 0 ? 0 : (uint64_t(1) << distance) - 1;
+            CHECK(index.lookup("app|window", fingerprint ^ low));
+            CHECK(index.lookup("app|window", fingerprint ^ (low << (64 - distance) % 64)));
+        }
+
+        NearDuplicateIndex single(distance, 4);
+        const uint64_t fingerprint = random();
+        single.insert("scope", fingerprint, "payload");
+        if (distance < 15) CHECK(!single.lookup("scope", flipBits(fingerprint, distance + 1, random)));
+        const NearDuplicateIndex::Match exact = single.lookup("scope", fingerprint);
+        CHECK(exact && *exact.payload == "payload" && exact.distance == 0);
+    }
+}
+
+// Every SIMD kernel must normalise exactly as the scalar path does: mostly
+// ASCII text (the vector fast path) with UTF-8 sequences, stray bytes and
+// separators landing on every block boundary
+void textKernels() {
+    const char *pieces[] = {"Inbox", " ", "(3)", " - ", "\xc3\x89t\xc3\xa9", "\xe2\x80\x94", "\xe3\x80\x82",
+                            "\xd0\x9f\xd0\xa0", "\xf0\x9f\x93\xa7", "\x80", "\xc3", "mail.google.com", "\t\n", "ABCxyz09"};
+    std::mt19937_64 random(20);
+    const TextKernel best = textKernel();
+    for (int round = 0; round < 2000; ++round) {
+        std::string text;
+        const size_t length = random() % 200;
+        while (text.size() < length) text += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+
+        setTextKernel(TextKernel::Scalar);
+        const std::string expected = normalizeText(text);
+        for (TextKernel kernel : {TextKernel::Sse42, TextKernel::Avx2}) {
+            setTextKernel(kernel);
+            if (textKernel() != kernel) continue; // not on this CPU
+            CHECK(normalizeText(text) == expected);
+        }
+    }
+    setTextKernel(best);
+    CHECK(normalizeText("  Compose EMAIL\xe2\x80\x94Inbox!! ") == "compose email inbox");
+}
+
+// A peeked frame leaves the baseline alone until committed, so changes too
+// small to clean one at a time are still reported against the last kept one
+void textDeltaPeek() {
+    TextDeltaTracker tracker;
+    const std::string screen = "Inbox\nfirst message\nsecond message";
+    CHECK(tracker.update("mail", screen).baseline);
+
+    const TextDeltaTracker::Delta small = tracker.peek("mail", screen + "\nre");
+    CHECK(!small.baseline && small.changedLines == 1);
+    const TextDeltaTracker::Delta more = tracker.peek("mail", screen + "\nreply");
+    CHECK(more.changedLines == 1 && tracker.size() == 1);
+    CHECK(!tracker.commit("other") && tracker.commit("mail"));
+    CHECK(!tracker.commit("mail"));
+    CHECK(tracker.update("mail", screen + "\nreply").spans.empty());
+
+    // Nothing kept for a new scope until its first frame is committed
+    CHECK(tracker.peek("calendar", "Monday").baseline);
+    CHECK(tracker.peek("calendar", "Monday").baseline);
+    tracker.forget("calendar");
+    CHECK(!tracker.commit("calendar") && tracker.size() == 1);
+}
+
+// Source token counts come from the cache on a repeat build, leaving only the
+// budgeted events to count, and match what a fresh builder counts once an
+// event has changed
+void promptSourceTokens() {
+    size_t counted = 0;
+    const PromptBuilder builder([&](std::string_view text) {
+        counted += text.size();
+        return estimateTokens(text);
+    });
+    std::vector<PromptBuilder::Thread> threads(2);
+    threads[0].topic = "inbox";
+    threads[1].topic = "calendar";
+    for (int i = 0; i < 200; ++i) {
+        PromptBuilder::Event event;
+        event.timeMs = 1000 + i;
+        event.app = "mail";
+        event.text = "message " + std::to_string(i) + std::string(size_t(i % 7) * 20, 'x');
+        threads[size_t(i % 2)].events.push_back(event);
+    }
+    PromptBuilder::Options options;
+    options.maxTokens = 300;
+    const size_t source = builder.build(threads, {}, options).sourceTokens;
+    const size_t first = counted;
+    CHECK(builder.build(threads, {}, options).sourceTokens == source);
+    CHECK(counted - first < first / 4);
+
+    threads[1].events[5].text += " and a reply";
+    threads[1].events[6].delta = true;
+    CHECK(builder.build(threads, {}, options).sourceTokens == PromptBuilder().build(threads, {}, options).sourceTokens);
+}
+
+// KvStore against a std::map, driven by random operations on a simulated
+// clock. The budget and entry limit are small enough that sets evict and the
+// arena compacts every few dozen writes. Evictions are the one thing the map
+// doesn't predict: a key may go missing only if something was evicted since
+// it was last known to be there. Every few hundred operations the whole key
+// space is checked, the file is copied as a crash image and recovered, and
+// the store is closed and reopened.
+void kvStoreModel() {
+    struct Entry {
+        std::string value;
+        int64_t expiresAt = KvStore::NoExpiry;
+        uint64_t evictionsSeen = 0; // evictions when last known present
+    };
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::filesystem::path path = directory / "gem_core_test_kvstore.db";
+    const std::filesystem::path crashPath = directory / "gem_core_test_kvstore_crash.db";
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    KvStore::Options options;
+    options.budgetBytes = 4096;
+    options.maxEntries = 64;
+
+    KvStore store;
+    if (!store.open(path, options)) {
+        std::fprintf(stderr, "gem_core_test: %s\n", store.lastError().c_str());
+        ++failures;
+        return;
+    }
+
+    std::mt19937_64 random(16);
+    std::map<std::string, Entry> model;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i) keys.push_back("k" + std::to_string(i));
+    int64_t now = 1000000;
+
+    const auto live = [&now](const Entry &entry) {
+        return entry.expiresAt == KvStore::NoExpiry || entry.expiresAt > now;
+    };
+    const auto evictions = [&store]() { return store.stats().evictions; };
+    // The store no longer has key: fine if the model agrees or it was evicted
+    const auto lost = [&](const std::string &key) {
+        const auto it = model.find(key);
+        if (it == model.end()) return;
+        CHECK(!live(it->second) || evictions() > it->second.evictionsSeen);
+        model.erase(it);
+    };
+    const auto randomValue = [&random]() {
+        std::string value(random() % 200, '\0');
+        for (char &c : value) c = char(random());
+        return value;
+    };
+    const auto randomExpiry = [&random, &now]() {
+        return random() % 3 ? KvStore::NoExpiry : now + int64_t(1 + random() % 500);
+    };
+
+    // Checks every key, after which the model matches the store exactly
+    const auto verify = [&](KvStore &target, bool exact) {
+        size_t present = 0, expiring = 0;
+        uint64_t bytes = 0;
+        for (const std::string &key : keys) {
+            const int64_t expiresAt = target.expiresAt(key, now);
+            const auto it = model.find(key);
+            if (expiresAt == -2) {
+                if (exact) CHECK(it == model.end() || !live(it->second));
+                else lost(key);
+                continue;
+            }
+            std::string value;
+            CHECK(target.get(key, now, &value));
+            CHECK(it != model.end() && live(it->second));
+            if (it == model.end()) continue;
+            CHECK(value == it->second.value && expiresAt == it->second.expiresAt);
+            it->second.evictionsSeen = evictions();
+            ++present;
+            expiring += expiresAt != KvStore::NoExpiry;
+            bytes += key.size() + value.size();
+        }
+        CHECK(target.size() == present);
+        CHECK(target.expiringCount() == expiring);
+        CHECK(target.liveBytes() == bytes && bytes <= options.budgetBytes);
+    };
+
+    for (int step = 1; step <= 20000; ++step) {
+        now += int64_t(random() % 20);
+        const std::string &key = keys[random() % keys.size()];
+        const int operation = int(random() % 100);
+
+        if (operation < 40) {
+            Entry entry;
+            entry.value = randomValue();
+            entry.expiresAt = randomExpiry();
+            CHECK(store.set(key, entry.value, entry.expiresAt, now));
+            entry.evictionsSeen = evictions();
+            model[key] = entry;
+        } else if (operation < 65) {
+            std::string value;
+            if (store.get(key, now, &value)) {
+                const auto it = model.find(key);
+                CHECK(it != model.end() && live(it->second) && it->second.value == value);
+            } else {
+                lost(key);
+            }
+        } else if (operation < 73) {
+            if (!store.remove(key)) lost(key);
+            model.erase(key);
+        } else if (operation < 85) {
+            // Extend, drop the TTL, or expire right away
+            const int choice = int(random() % 3);
+            const int64_t expiresAt = choice == 0 ? KvStore::NoExpiry
+                : choice == 1 ? now + int64_t(1 + random() % 500) : now - int64_t(random() % 10);
+            if (store.setExpiry(key, expiresAt, now)) {
+                const auto it = model.find(key);
+                CHECK(it != model.end() && live(it->second));
+                if (expiresAt != KvStore::NoExpiry && expiresAt <= now) model.erase(key);
+                else if (it != model.end()) it->second.expiresAt = expiresAt;
+            } else {
+                lost(key);
+            }
+        } else if (operation < 97) {
+            store.expireSome(now, 16);
+        } else if (operation < 99) {
+            const std::string prefix = "k" + std::to_string(random() % 10);
+            size_t known = 0;
+            for (auto it = model.begin(); it != model.end();) {
+                if (it->first.compare(0, prefix.size(), prefix) == 0) {
+                    ++known;
+                    it = model.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            CHECK(store.removePrefix(prefix) <= known);
+        } else if (random() % 20 == 0) {
+            store.clear();
+            model.clear();
+        }
+
+        CHECK(store.size() <= options.maxEntries && store.liveBytes() <= options.budgetBytes);
+
+        if (step % 500 == 0) {
+            verify(store, false);
+
+            // A copy of the open file is what a crash leaves behind
+            std::filesystem::copy_file(path, crashPath, std::filesystem::copy_options::overwrite_existing, ec);
+            if (!ec) {
+                KvStore crashed;
+                CHECK(crashed.open(crashPath, options) && crashed.recovered());
+                verify(crashed, true);
+                crashed.close();
+                std::filesystem::remove(crashPath, ec);
+            }
+
+            store.close();
+            CHECK(store.open(path, options) && !store.recovered());
+            verify(store, true);
+        }
+    }
+
+    // Once everything is past its TTL the sweep alone empties the store of it
+    now += 1000;
+    for (uint32_t i = 0; i < options.maxEntries && store.expiringCount() > 0; ++i) store.expireSome(now, 1);
+    CHECK(store.expiringCount() == 0);
+
+    const KvStore::Stats stats = store.stats();
+    CHECK(stats.evictions > 0 && stats.compactions > 0 && stats.expirations > 0);
+
+    store.close();
+    std::filesystem::remove(path, ec);
+}
+
+} // namespace
+
+int main() {
+    nearDuplicateIndex();
+    textKernels();
+    textDeltaPeek();
+    promptSourceTokens();
+    kvStoreModel();
+
+    if (failures) {
+        std::fprintf(stderr, "gem_core_test: %d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("gem_core_test: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,392 @@
+#include <QtTest>
+#include <QApplication>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "mainwindow.h"
+#include "notificationmanager.h"
+#include "suggestionpopup.h"
+#include "logtail.h"
+#include "logindex.h"
+
+// Benchmarks for the front end's hot paths. Each one drives the real
+// classes; private members are reached as a friend rather than through
+// test-only API.
+//
+//   gem_bench [--json FILE] [QtTest options]
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise, and
+// writes every QBENCHMARK result to FILE (default gem_bench.json) so runs
+// can be diffed between releases. GEM_BENCH_MAX_LOG_MB skips the larger
+// synthetic logs (they default to 10 MB, 100 MB and 1 GB).
+class GemBench : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void popupConstruct();
+    void popupPresent();
+    void checkForSuggestion();
+    void saveBlacklist();
+    void notificationBurst();
+    void notificationRelayout();
+    void popupCountdowns_data();
+    void popupCountdowns();
+    void logTailResume_data();
+    void logTailResume();
+    void logIndexBuild_data();
+    void logIndexBuild();
+
+private:
+    QTemporaryDir logDir;
+    QHash<int, int> logLines; // megabytes -> lines
+    QHash<QString, double> countdownCosts;
+    MainWindow *window = nullptr;
+
+    QString suggestionText(int i) const;
+    QString logFile(int megabytes);
+    void addLogRows();
+};
+
+namespace {
+
+const int LogIndexTimeoutMs = 10 * 60 * 1000;
+const int CountdownPopups = 5;
+const int CountdownMs = 5000;
+
+// What a set of cards costs while they count down: paints and layout
+// passes of any of their widgets, and timer events app-wide
+class CostCounter : public QObject {
+public:
+    QList<QObject*> roots;
+    int paints = 0;
+    int layouts = 0;
+    int timers = 0;
+
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        switch (event->type()) {
+        case QEvent::Paint: if (belongs(watched)) ++paints; break;
+        case QEvent::LayoutRequest: if (belongs(watched)) ++layouts; break;
+        case QEvent::Timer: ++timers; break;
+        default: break;
+        }
+        return false;
+    }
+
+private:
+    bool belongs(QObject *object) const {
+        for (; object; object = object->parent())
+            if (roots.contains(object)) return true;
+        return false;
+    }
+};
+
+} // namespace
+
+void GemBench::initTestCase() {
+    // Don't take over a running app's socket
+    qputenv("GEM_IPC_NAME", QByteArray("gem-bench-") + QByteArray::number(QCoreApplication::applicationPid()));
+    window = new MainWindow();
+    QVERIFY(logDir.isValid());
+}
+
+void GemBench::cleanupTestCase() {
+    delete window;
+    window = nullptr;
+}
+
+QString GemBench::suggestionText(int i) const {
+    return QString("Suggested Action: send_email\n\nReason: Thread %1 mentions a reply that is due today").arg(i);
+}
+
+void GemBench::popupConstruct() {
+    QBENCHMARK {
+        SuggestionPopup popup;
+    }
+}
+
+void GemBench::popupPresent() {
+    SuggestionPopup popup;
+    const QString text = suggestionText(0);
+
+    QBENCHMARK {
+        popup.present(text, 15000, QPoint(100, 100));
+        QMetaObject::invokeMethod(&popup, "onReject");
+    }
+}
+
+void GemBench::checkForSuggestion() {
+    // Includes writing the file, as the backend does without a socket
+    const QByteArray json = R"({"action":"send_email","reason":"A reply is due today","id":"bench"})";
+    const QString path = window->getConfigPath("latest_suggestion.json");
+
+    QBENCHMARK {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(json);
+        file.close();
+
+        window->checkForSuggestion();
+        window->notifications->pending.clear();
+    }
+    QVERIFY(!QFile::exists(path));
+}
+
+void GemBench::saveBlacklist() {
+    window->appBlacklistList->clear();
+    window->windowBlacklistList->clear();
+    for (int i = 0; i < 1000; ++i) window->appBlacklistList->addItem(QString("Application %1").arg(i));
+
+    // The debounced write is forced so its cost is counted too
+    QBENCHMARK {
+        window->saveBlacklistToSettings();
+        window->settings->flush();
+    }
+
+    window->appBlacklistList->clear();
+    window->saveBlacklistToSettings();
+    window->settings->flush();
+}
+
+void GemBench::notificationBurst() {
+    // 20 suggestions at once: queued, folded into one digest card, dismissed.
+    // The bucket never runs dry, so every round gets its card.
+    QWidget host;
+    NotificationManager::Limits limits;
+    limits.burst = std::numeric_limits<int>::max();
+    NotificationManager manager(&host, limits);
+    QStringList texts, ids;
+    for (int i = 0; i < 20; ++i) {
+        texts << suggestionText(i);
+        ids << QString("bench-%1").arg(i);
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < 20; ++i) manager.notify(texts[i], ids[i], "send_email");
+        QMetaObject::invokeMethod(&manager, "pump");
+        for (SuggestionPopup *card : manager.cards()) QMetaObject::invokeMethod(card, "onReject");
+    }
+    QVERIFY(manager.queued() == 0);
+}
+
+void GemBench::notificationRelayout() {
+    // Every card on screen, restacked
+    QWidget host;
+    NotificationManager manager(&host);
+    for (int i = 0; i < NotificationManager::DefaultMaxVisible; ++i) {
+        manager.notify(suggestionText(i), QString("bench-%1").arg(i), "send_email");
+        QMetaObject::invokeMethod(&manager, "pump");
+    }
+    QVERIFY(manager.cards().size() == NotificationManager::DefaultMaxVisible);
+
+    QBENCHMARK {
+        QMetaObject::invokeMethod(&manager, "relayout");
+    }
+}
+
+void GemBench::popupCountdowns_data() {
+    QTest::addColumn<QString>("measure");
+    for (const char *measure : {"repaints", "layout passes", "timer events", "cpu ms"})
+        QTest::newRow(measure) << QString(measure);
+}
+
+void GemBench::popupCountdowns() {
+    // Five cards counting down together, from present() until the last one
+    // times out. Only SuggestionPopup's public API is used, so the same case
+    // builds against older popups for a before/after comparison. "cpu ms" is
+    // process CPU time, not wall time; the scenario runs once for all rows.
+    QFETCH(QString, measure);
+
+    if (countdownCosts.isEmpty()) {
+        std::vector<std::unique_ptr<SuggestionPopup>> popups;
+        CostCounter counter;
+        for (int i = 0; i < CountdownPopups; ++i) {
+            popups.emplace_back(new SuggestionPopup);
+            counter.roots.append(popups.back().get());
+        }
+        auto presenting = [&]() {
+            return std::any_of(popups.begin(), popups.end(), [](const auto &popup) { return popup->isPresenting(); });
+        };
+
+        qApp->installEventFilter(&counter);
+        const std::clock_t cpu = std::clock();
+        for (int i = 0; i < CountdownPopups; ++i)
+            popups[i]->present(suggestionText(i), CountdownMs, QPoint(100, 100 + i * 160));
+        const bool finished = QTest::qWaitFor([&]() { return !presenting(); }, CountdownMs * 2);
+        const double cpuMs = double(std::clock() - cpu) * 1000.0 / CLOCKS_PER_SEC;
+        qApp->removeEventFilter(&counter);
+        QVERIFY(finished);
+
+        countdownCosts["repaints"] = counter.paints;
+        countdownCosts["layout passes"] = counter.layouts;
+        countdownCosts["timer events"] = counter.timers;
+        countdownCosts["cpu ms"] = cpuMs;
+    }
+
+    QTest::setBenchmarkResult(countdownCosts.value(measure),
+                              measure == "cpu ms" ? QTest::WalltimeMilliseconds : QTest::Events);
+}
+
+QString GemBench::logFile(int megabytes) {
+    const QString path = logDir.filePath(QString("debug-%1.log").arg(megabytes));
+    if (logLines.contains(megabytes)) return path;
+
+    // Records in logger.js's format, with varied stages, levels and text
+    static const char *const stages[] = {"ocr-cache", "threads", "suggest-and-act", "ipc", "ingest"};
+    static const char *const levels[] = {"debug", "info", "info", "info", "warn", "error"};
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return QString();
+
+    const qint64 target = qint64(megabytes) * 1024 * 1024;
+    const qint64 start = QDateTime::currentMSecsSinceEpoch() - 24 * 60 * 60 * 1000;
+    QByteArray chunk;
+    qint64 written = 0;
+    int lines = 0;
+    while (written < target) {
+        const QDateTime ts = QDateTime::fromMSecsSinceEpoch(start + lines * 10).toUTC();
+        chunk += R"({"ts":")" + ts.toString(Qt::ISODateWithMs).toUtf8()
+               + R"(","level":")" + levels[lines % 6]
+               + R"(","stage":")" + stages[lines % 5]
+               + R"(","msg":"Cached OCR","data":{"topic":"Quarterly report draft )" + QByteArray::number(lines)
+               + R"(","cleaned_text":"Revenue grew in the third quarter across all regions"}})" + "\n";
+        ++lines;
+        if (chunk.size() >= 1024 * 1024) {
+            written += file.write(chunk);
+            chunk.clear();
+        }
+    }
+    file.write(chunk);
+    logLines.insert(megabytes, lines);
+    return path;
+}
+
+void GemBench::addLogRows() {
+    QTest::addColumn<int>("megabytes");
+
+    const int limit = qEnvironmentVariableIntValue("GEM_BENCH_MAX_LOG_MB");
+    for (int megabytes : {10, 100, 1024}) {
+        if (limit > 0 && megabytes > limit) continue;
+        QTest::newRow(megabytes >= 1024 ? "1 GB" : qPrintable(QString("%1 MB").arg(megabytes))) << megabytes;
+    }
+}
+
+void GemBench::logTailResume_data() {
+    addLogRows();
+}
+
+// What the Live tab pays when the debug window is shown: the newest lines
+void GemBench::logTailResume() {
+    QFETCH(int, megabytes);
+    const QString path = logFile(megabytes);
+    QVERIFY(!path.isEmpty());
+
+    int lines = 0;
+    QBENCHMARK {
+        LogTail tail(path, 5000);
+        tail.resume();
+        lines = int(tail.lines().size());
+    }
+    QCOMPARE(lines, 5000);
+}
+
+void GemBench::logIndexBuild_data() {
+    addLogRows();
+}
+
+// What the Explorer tab pays to index the whole file on its worker thread
+void GemBench::logIndexBuild() {
+    QFETCH(int, megabytes);
+    const QString path = logFile(megabytes);
+    QVERIFY(!path.isEmpty());
+    const int expected = logLines.value(megabytes);
+
+    QBENCHMARK_ONCE {
+        LogIndex index(path);
+        index.refresh();
+
+        QElapsedTimer timer;
+        timer.start();
+        while (index.count() < expected) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+            if (timer.elapsed() > LogIndexTimeoutMs) QFAIL("indexing timed out");
+        }
+    }
+}
+
+namespace {
+
+// QtTest has no JSON reporter; its XML one is converted instead
+bool writeJson(const QString &xmlPath, const QString &jsonPath) {
+    QFile xml(xmlPath);
+    if (!xml.open(QIODevice::ReadOnly)) return false;
+
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader reader(&xml);
+    while (!reader.atEnd()) {
+        if (!reader.readNextStartElement()) continue;
+        if (reader.name() == QLatin1String("TestFunction")) {
+            function = reader.attributes().value("name").toString();
+        } else if (reader.name() == QLatin1String("BenchmarkResult")) {
+            const QXmlStreamAttributes attributes = reader.attributes();
+            QJsonObject result;
+            result["name"] = function;
+            result["tag"] = attributes.value("tag").toString();
+            result["metric"] = attributes.value("metric").toString();
+            result["value"] = attributes.value("value").toDouble();
+            result["iterations"] = attributes.value("iterations").toInt();
+            results.append(result);
+        }
+    }
+
+    QJsonObject root;
+    root["qt"] = QString::fromLatin1(qVersion());
+    root["platform"] = QGuiApplication::platformName();
+    root["results"] = results;
+
+    QFile json(jsonPath);
+    if (!json.open(QIODevice::WriteOnly)) return false;
+    json.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString jsonPath = "gem_bench.json";
+    const int jsonArg = args.indexOf("--json");
+    if (jsonArg > 0 && jsonArg + 1 < args.size()) {
+        jsonPath = args.at(jsonArg + 1);
+        args.remove(jsonArg, 2);
+    }
+
+    QTemporaryDir scratch;
+    const QString xmlPath = scratch.filePath("results.xml");
+    args << "-o" << xmlPath + ",xml" << "-o" << "-,txt";
+
+    GemBench bench;
+    const int status = QTest::qExec(&bench, args);
+
+    if (!writeJson(xmlPath, jsonPath)) {
+        qWarning() << "gem_bench: could not write" << jsonPath;
+        return status ? status : 1;
+    }
+    qInfo() << "gem_bench: results written to" << jsonPath;
+    return status;
+}
+
+#include "gembench.moc"
@@ -0,0 +1,104 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QTimer>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "kvstore.h"
+#include "respserver.h"
+
+// gem-cache: the OCR cache, in place of a Redis server.
+//
+// Entries live in one memory-mapped file (see KvStore), so the cache is warm
+// from the first frame after a restart. Clients connect over the Redis
+// protocol on a loopback port. While any key has a TTL, expired keys are
+// also swept in the background, and dirty pages are handed to the OS every few seconds. Under the
+// supervisor (GEM_SUPERVISED) the process exits when stdin closes.
+
+namespace {
+
+const int ExpireIntervalMs = 100;
+const size_t ExpireChecks = 256; // slots looked at per sweep
+const int FlushIntervalMs = 5000;
+
+void writeLine(const QString &line) {
+    const QByteArray bytes = line.toUtf8() + '\n';
+    std::fwrite(bytes.constData(), 1, size_t(bytes.size()), stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gem-cache");
+
+    const QString defaultFile = QDir(QCoreApplication::applicationDirPath()).filePath("config/gem-cache.db");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Loopback port to serve the Redis protocol on.", "port",
+                                  qEnvironmentVariable("GEM_CACHE_PORT", "6379"));
+    QCommandLineOption fileOption("file", "Cache file.", "path", defaultFile);
+    QCommandLineOption budgetOption("budget", "Key and value bytes kept before evicting, in MB.", "mb", "32");
+    QCommandLineOption entriesOption("entries", "Maximum number of keys.", "count", "65536");
+    parser.addOptions({portOption, fileOption, budgetOption, entriesOption});
+    parser.process(app);
+
+    KvStore::Options options;
+    options.budgetBytes = quint64(qMax(1, parser.value(budgetOption).toInt())) << 20;
+    options.maxEntries = qMax(1u, parser.value(entriesOption).toUInt());
+
+    KvStore store;
+    const QString file = parser.value(fileOption);
+    if (!store.open(file.toStdString(), options)) {
+        std::fprintf(stderr, "gem-cache: %s\n", store.lastError().c_str());
+        return 1;
+    }
+    if (store.recovered()) std::fprintf(stderr, "gem-cache: %s\n", store.lastError().c_str());
+
+    RespServer server(&store);
+    const quint16 port = quint16(parser.value(portOption).toUInt());
+    if (!server.listen(port)) {
+        std::fprintf(stderr, "gem-cache: cannot listen on 127.0.0.1:%u: %s\n", unsigned(port),
+                     qPrintable(server.errorString()));
+        return 1;
+    }
+
+    // The sweep only runs while there is something that can expire
+    QTimer expireTimer;
+    QObject::connect(&expireTimer, &QTimer::timeout, &app, [&store, &expireTimer]() {
+        store.expireSome(QDateTime::currentMSecsSinceEpoch(), ExpireChecks);
+        if (store.expiringCount() == 0) expireTimer.stop();
+    });
+    const auto armExpiry = [&store, &expireTimer]() {
+        if (store.expiringCount() > 0 && !expireTimer.isActive()) expireTimer.start(ExpireIntervalMs);
+    };
+    QObject::connect(&server, &RespServer::executed, &app, armExpiry);
+    armExpiry();
+
+    QTimer flushTimer;
+    QObject::connect(&flushTimer, &QTimer::timeout, &app, [&store]() { store.flush(); });
+    flushTimer.start(FlushIntervalMs);
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&store]() { store.close(); });
+
+    if (qEnvironmentVariableIsSet("GEM_SUPERVISED")) {
+        // Blocking stdin reads stay off the event loop
+        std::thread([&app]() {
+            std::string line;
+            while (std::getline(std::cin, line)) {}
+            QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+        }).detach();
+    }
+
+    // The supervisor and start-assistant.js wait for redis-server's marker
+    writeLine(QString("gem-cache: %1 keys in %2, serving 127.0.0.1:%3")
+                  .arg(store.size()).arg(file).arg(port));
+    writeLine("Ready to accept connections");
+
+    return app.exec();
+}
@@ -0,0 +1,396 @@
+#include "respserver.h"
+#include <QDateTime>
+#include <QDebug>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int MaxInlineSize = 64 * 1024;
+
+std::string_view view(const QByteArray &bytes) {
+    return std::string_view(bytes.constData(), size_t(bytes.size()));
+}
+
+QByteArray simple(const QByteArray &text) {
+    return '+' + text + "\r\n";
+}
+
+QByteArray error(const QByteArray &text) {
+    return "-ERR " + text + "\r\n";
+}
+
+QByteArray integer(qint64 value) {
+    return ':' + QByteArray::number(value) + "\r\n";
+}
+
+QByteArray bulk(const QByteArray &bytes) {
+    return '$' + QByteArray::number(bytes.size()) + "\r\n" + bytes + "\r\n";
+}
+
+QByteArray bulk(const std::string &bytes) {
+    return bulk(QByteArray::fromStdString(bytes));
+}
+
+const QByteArray NullBulk = "$-1\r\n";
+
+QByteArray array(const QList<QByteArray> &items) {
+    QByteArray out = '*' + QByteArray::number(items.size()) + "\r\n";
+    for (const QByteArray &item : items) out += item;
+    return out;
+}
+
+QByteArray wrongArity(const QByteArray &name) {
+    return error("wrong number of arguments for '" + name.toLower() + "' command");
+}
+
+bool toInteger(const QByteArray &text, qint64 *value) {
+    bool ok = false;
+    *value = text.toLongLong(&ok);
+    return ok;
+}
+
+const QByteArray NotInteger = error("value is not an integer or out of range");
+
+// TTLs are clamped to about 140,000 years before converting to ms, so no
+// client value can overflow the expiry arithmetic
+const qint64 MaxTtlMs = qint64(1) << 52;
+
+qint64 expiryAfter(qint64 now, qint64 ttl, qint64 unitMs) {
+    const qint64 limit = MaxTtlMs / unitMs;
+    return now + qBound(-limit, ttl, limit) * unitMs;
+}
+
+} // namespace
+
+RespServer::RespServer(KvStore *store, QObject *parent)
+    : QObject(parent), store(store)
+{
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &RespServer::onNewConnection);
+}
+
+bool RespServer::listen(quint16 port) {
+    return server->listen(QHostAddress::LocalHost, port);
+}
+
+void RespServer::onNewConnection() {
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &RespServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void RespServer::onReadyRead() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || !buffers.contains(socket)) return;
+
+    QByteArray &buffer = buffers[socket];
+    buffer.append(socket->readAll());
+
+    // Answer everything pipelined in this read with a single write
+    QByteArray replies;
+    bool close = false;
+    while (!close && !buffer.isEmpty()) {
+        Arguments arguments;
+        QByteArray protocolError;
+        const int parsed = parseCommand(buffer, &arguments, &protocolError);
+        if (parsed == 0) break;
+        if (parsed < 0) {
+            replies += error("Protocol error: " + protocolError);
+            close = true;
+            break;
+        }
+        if (!arguments.isEmpty()) replies += execute(arguments, &close);
+    }
+
+    if (!replies.isEmpty()) {
+        socket->write(replies);
+        emit executed();
+    }
+    if (close) socket->disconnectFromHost();
+}
+
+int RespServer::parseCommand(QByteArray &buffer, Arguments *arguments, QByteArray *error) {
+    if (!buffer.startsWith('*')) {
+        // Inline command: one line of space-separated words
+        const int newline = buffer.indexOf('\n');
+        if (newline < 0) {
+            if (buffer.size() <= MaxInlineSize) return 0;
+            *error = "too big inline request";
+            return -1;
+        }
+        const QByteArray line = buffer.left(newline).simplified();
+        buffer.remove(0, newline + 1);
+        if (!line.isEmpty()) *arguments = line.split(' ');
+        return 1;
+    }
+
+    int lineEnd = buffer.indexOf("\r\n");
+    if (lineEnd < 0) {
+        if (buffer.size() <= 32) return 0;
+        *error = "invalid multibulk length";
+        return -1;
+    }
+
+    bool ok = false;
+    const qint64 count = buffer.mid(1, lineEnd - 1).toLongLong(&ok);
+    if (!ok || count > MaxArguments) {
+        *error = "invalid multibulk length";
+        return -1;
+    }
+
+    qint64 position = lineEnd + 2;
+    Arguments parsed;
+    parsed.reserve(int(qMax<qint64>(0, count)));
+    for (qint64 i = 0; i < count; ++i) {
+        if (position >= buffer.size()) return 0;
+        if (buffer[position] != '$') {
+            *error = "expected '$', got '" + QByteArray(1, buffer[position]) + "'";
+            return -1;
+        }
+        lineEnd = buffer.indexOf("\r\n", position);
+        if (lineEnd < 0) {
+            if (buffer.size() - position <= 32) return 0;
+            *error = "invalid bulk length";
+            return -1;
+        }
+
+        const qint64 length = buffer.mid(position + 1, lineEnd - position - 1).toLongLong(&ok);
+        if (!ok || length < 0 || length > MaxBulkSize) {
+            *error = "invalid bulk length";
+            return -1;
+        }
+        if (buffer.size() < lineEnd + 2 + length + 2) return 0;
+        parsed.append(buffer.mid(lineEnd + 2, length));
+        position = lineEnd + 2 + length + 2;
+    }
+
+    buffer.remove(0, position);
+    *arguments = parsed;
+    return 1;
+}
+
+QByteArray RespServer::execute(const Arguments &arguments, bool *close) {
+    ++commands;
+    const QByteArray name = arguments[0].toUpper();
+    const int argc = arguments.size();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    if (name == "GET") {
+        if (argc != 2) return wrongArity(name);
+        std::string value;
+        return store->get(view(arguments[1]), now, &value) ? bulk(value) : NullBulk;
+    }
+    if (name == "SET") {
+        return set(arguments, now);
+    }
+    if (name == "SETEX" || name == "PSETEX") {
+        if (argc != 4) return wrongArity(name);
+        qint64 ttl = 0;
+        if (!toInteger(arguments[2], &ttl)) return NotInteger;
+        if (ttl <= 0) return error("invalid expire time in '" + name.toLower() + "' command");
+        const qint64 expiresAt = expiryAfter(now, ttl, name == "SETEX" ? 1000 : 1);
+        if (!store->set(view(arguments[1]), view(arguments[3]), expiresAt, now))
+            return error("value exceeds the cache budget");
+        return simple("OK");
+    }
+    if (name == "DEL" || name == "UNLINK") {
+        if (argc < 2) return wrongArity(name);
+        qint64 removed = 0;
+        for (int i = 1; i < argc; ++i) removed += store->remove(view(arguments[i])) ? 1 : 0;
+        return integer(removed);
+    }
+    if (name == "DELPREFIX") {
+        if (argc != 2) return wrongArity(name);
+        return integer(qint64(store->removePrefix(view(arguments[1]))));
+    }
+    if (name == "MGET") {
+        if (argc < 2) return wrongArity(name);
+        QList<QByteArray> values;
+        for (int i = 1; i < argc; ++i) {
+            std::string value;
+            values.append(store->get(view(arguments[i]), now, &value) ? bulk(value) : NullBulk);
+        }
+        return array(values);
+    }
+    if (name == "EXISTS") {
+        if (argc < 2) return wrongArity(name);
+        qint64 found = 0;
+        for (int i = 1; i < argc; ++i) found += store->contains(view(arguments[i]), now) ? 1 : 0;
+        return integer(found);
+    }
+    if (name == "EXPIRE" || name == "PEXPIRE") {
+        if (argc != 3) return wrongArity(name);
+        qint64 ttl = 0;
+        if (!toInteger(arguments[2], &ttl)) return NotInteger;
+        const qint64 expiresAt = expiryAfter(now, ttl, name == "EXPIRE" ? 1000 : 1);
+        // A non-positive TTL deletes the key, as in Redis
+        return integer(store->setExpiry(view(arguments[1]), qMax<qint64>(expiresAt, now), now) ? 1 : 0);
+    }
+    if (name == "TTL" || name == "PTTL") {
+        if (argc != 2) return wrongArity(name);
+        const qint64 expiresAt = store->expiresAt(view(arguments[1]), now);
+        if (expiresAt == -2) return integer(-2);
+        if (expiresAt == KvStore::NoExpiry) return integer(-1);
+        const qint64 remaining = expiresAt - now;
+        return integer(name == "TTL" ? (remaining + 500) / 1000 : remaining);
+    }
+    if (name == "PERSIST") {
+        if (argc != 2) return wrongArity(name);
+        const qint64 expiresAt = store->expiresAt(view(arguments[1]), now);
+        if (expiresAt == -2 || expiresAt == KvStore::NoExpiry) return integer(0);
+        store->setExpiry(view(arguments[1]), KvStore::NoExpiry, now);
+        return integer(1);
+    }
+    if (name == "SCAN") {
+        return scan(arguments, now);
+    }
+    if (name == "KEYS") {
+        if (argc != 2) return wrongArity(name);
+        std::vector<std::string> keys;
+        store->scan(0, store->maxEntries(), view(arguments[1]), now, &keys);
+        QList<QByteArray> items;
+        for (const std::string &key : keys) items.append(bulk(key));
+        return array(items);
+    }
+    if (name == "DBSIZE") {
+        return integer(qint64(store->size()));
+    }
+    if (name == "FLUSHDB" || name == "FLUSHALL") {
+        store->clear();
+        return simple("OK");
+    }
+    if (name == "PING") {
+        if (argc > 2) return wrongArity(name);
+        return argc == 2 ? bulk(arguments[1]) : simple("PONG");
+    }
+    if (name == "ECHO") {
+        if (argc != 2) return wrongArity(name);
+        return bulk(arguments[1]);
+    }
+    if (name == "SELECT") {
+        if (argc != 2) return wrongArity(name);
+        return arguments[1] == "0" ? simple("OK") : error("DB index is out of range");
+    }
+    if (name == "INFO") {
+        return bulk(info());
+    }
+    if (name == "CLIENT") {
+        return simple("OK"); // SETNAME / SETINFO from client libraries
+    }
+    if (name == "COMMAND") {
+        return array({});
+    }
+    if (name == "QUIT") {
+        *close = true;
+        return simple("OK");
+    }
+
+    QByteArray preview = arguments[0].left(64);
+    return error("unknown command '" + preview + "'");
+}
+
+QByteArray RespServer::set(const Arguments &arguments, qint64 now) {
+    if (arguments.size() < 3) return wrongArity("SET");
+
+    qint64 expiresAt = KvStore::NoExpiry;
+    bool keepTtl = false;
+    bool onlyNew = false;
+    bool onlyExisting = false;
+    for (int i = 3; i < arguments.size(); ++i) {
+        const QByteArray option = arguments[i].toUpper();
+        if (option == "NX") {
+            onlyNew = true;
+        } else if (option == "XX") {
+            onlyExisting = true;
+        } else if (option == "KEEPTTL") {
+            keepTtl = true;
+        } else if (option == "EX" || option == "PX" || option == "EXAT" || option == "PXAT") {
+            qint64 value = 0;
+            if (i + 1 >= arguments.size()) return error("syntax error");
+            if (!toInteger(arguments[++i], &value)) return NotInteger;
+            if (value <= 0) return error("invalid expire time in 'set' command");
+            if (option == "EX") expiresAt = expiryAfter(now, value, 1000);
+            else if (option == "PX") expiresAt = expiryAfter(now, value, 1);
+            else if (option == "EXAT") expiresAt = expiryAfter(0, value, 1000);
+            else expiresAt = value;
+        } else {
+            return error("syntax error");
+        }
+    }
+    if (onlyNew && onlyExisting) return error("syntax error");
+
+    const std::string_view key = view(arguments[1]);
+    if (onlyNew || onlyExisting || keepTtl) {
+        const qint64 current = store->expiresAt(key, now);
+        const bool exists = current != -2;
+        if ((onlyNew && exists) || (onlyExisting && !exists)) return NullBulk;
+        if (keepTtl && exists) expiresAt = current;
+    }
+
+    if (!store->set(key, view(arguments[2]), expiresAt, now))
+        return error("value exceeds the cache budget");
+    return simple("OK");
+}
+
+QByteArray RespServer::scan(const Arguments &arguments, qint64 now) {
+    if (arguments.size() < 2) return wrongArity("SCAN");
+
+    qint64 cursor = 0;
+    if (!toInteger(arguments[1], &cursor) || cursor < 0) return error("invalid cursor");
+
+    QByteArray pattern;
+    qint64 count = 10;
+    for (int i = 2; i < arguments.size(); ++i) {
+        const QByteArray option = arguments[i].toUpper();
+        if (i + 1 >= arguments.size()) return error("syntax error");
+        if (option == "MATCH") {
+            pattern = arguments[++i];
+        } else if (option == "COUNT") {
+            if (!toInteger(arguments[++i], &count)) return NotInteger;
+            if (count < 1) return error("syntax error");
+        } else if (option == "TYPE") {
+            // Everything here is a string
+            if (arguments[++i].toLower() != "string") return array({bulk(QByteArray("0")), array({})});
+        } else {
+            return error("syntax error");
+        }
+    }
+
+    std::vector<std::string> keys;
+    const uint64_t next = store->scan(uint64_t(cursor), size_t(count), view(pattern), now, &keys);
+    QList<QByteArray> items;
+    items.reserve(int(keys.size()));
+    for (const std::string &key : keys) items.append(bulk(key));
+    return array({bulk(QByteArray::number(qulonglong(next))), array(items)});
+}
+
+QByteArray RespServer::info() const {
+    const KvStore::Stats stats = store->stats();
+    QByteArray text;
+    text += "# Server\r\n";
+    text += "redis_version:7.0.0\r\n";
+    text += "gem_cache:1\r\n";
+    text += "\r\n# Clients\r\n";
+    text += "connected_clients:" + QByteArray::number(buffers.size()) + "\r\n";
+    text += "\r\n# Memory\r\n";
+    text += "used_memory:" + QByteArray::number(qulonglong(store->liveBytes())) + "\r\n";
+    text += "maxmemory:" + QByteArray::number(qulonglong(store->budgetBytes())) + "\r\n";
+    text += "maxmemory_policy:allkeys-lru\r\n";
+    text += "\r\n# Stats\r\n";
+    text += "total_commands_processed:" + QByteArray::number(commands) + "\r\n";
+    text += "keyspace_hits:" + QByteArray::number(qulonglong(stats.hits)) + "\r\n";
+    text += "keyspace_misses:" + QByteArray::number(qulonglong(stats.misses)) + "\r\n";
+    text += "evicted_keys:" + QByteArray::number(qulonglong(stats.evictions)) + "\r\n";
+    text += "expired_keys:" + QByteArray::number(qulonglong(stats.expirations)) + "\r\n";
+    text += "gem_compactions:" + QByteArray::number(qulonglong(stats.compactions)) + "\r\n";
+    text += "\r\n# Keyspace\r\n";
+    text += "db0:keys=" + QByteArray::number(qulonglong(store->size())) + "\r\n";
+    return text;
+}
@@ -0,0 +1,58 @@
+#ifndef RESPSERVER_H
+#define RESPSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include "kvstore.h"
+
+// Serves a KvStore over the Redis protocol (RESP2), so redis clients, and
+// cache-ocr.js in particular, talk to gem-cache unchanged. Commands:
+// PING ECHO QUIT SELECT CLIENT COMMAND INFO DBSIZE GET MGET SET (EX PX EXAT
+// PXAT KEEPTTL NX XX) SETEX PSETEX DEL UNLINK EXISTS EXPIRE PEXPIRE TTL PTTL
+// PERSIST SCAN (MATCH COUNT TYPE) KEYS FLUSHDB FLUSHALL, plus DELPREFIX
+// prefix, which drops every key starting with prefix in one round trip.
+// Inline commands (telnet-style lines) work too.
+class RespServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int MaxArguments = 1024 * 1024;
+    static constexpr qint64 MaxBulkSize = 512 * 1024 * 1024;
+
+    explicit RespServer(KvStore *store, QObject *parent = nullptr);
+
+    bool listen(quint16 port);
+    QString errorString() const { return server->errorString(); }
+
+    quint64 commandCount() const { return commands; }
+    int connectionCount() const { return buffers.size(); }
+
+signals:
+    // After each batch of commands from one read
+    void executed();
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    using Arguments = QList<QByteArray>;
+
+    KvStore *store;
+    QTcpServer *server;
+    QHash<QTcpSocket*, QByteArray> buffers;
+    quint64 commands = 0;
+
+    // 1 parsed, 0 needs more data, -1 protocol error
+    static int parseCommand(QByteArray &buffer, Arguments *arguments, QByteArray *error);
+    QByteArray execute(const Arguments &arguments, bool *close);
+
+    QByteArray set(const Arguments &arguments, qint64 now);
+    QByteArray scan(const Arguments &arguments, qint64 now);
+    QByteArray info() const;
+};
+
+#endif // RESPSERVER_H
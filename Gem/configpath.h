@@ -0,0 +1,17 @@
+#ifndef CONFIGPATH_H
+#define CONFIGPATH_H
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QString>
+
+// config/ next to the executable, unless GEM_CONFIG_DIR points elsewhere;
+// the same rule as backend/utility/config-path.js, so gem-replay can give
+// the app and the backend one scratch directory
+inline QString gemConfigPath(const QString &filename) {
+    const QString dir = qEnvironmentVariable("GEM_CONFIG_DIR");
+    if (!dir.isEmpty()) return QDir(dir).filePath(filename);
+    return QDir(QCoreApplication::applicationDirPath()).filePath("config/" + filename);
+}
+
+#endif // CONFIGPATH_H
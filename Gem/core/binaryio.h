@@ -0,0 +1,93 @@
+#ifndef BINARYIO_H
+#define BINARYIO_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// Little-endian encoding helpers for the on-disk formats in gemcore
+
+inline void putU32(std::string &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+inline void putU64(std::string &out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+inline void putString(std::string &out, const std::string &s) {
+    putU32(out, uint32_t(s.size()));
+    out.append(s);
+}
+
+inline uint32_t getU32(const char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= uint32_t(uint8_t(p[i])) << (8 * i);
+    return v;
+}
+
+inline uint64_t getU64(const char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= uint64_t(uint8_t(p[i])) << (8 * i);
+    return v;
+}
+
+// Bounds-checked reader over a byte buffer; fails sticky on overrun
+class ByteReader {
+public:
+    ByteReader(const char *data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return good; }
+    size_t position() const { return pos; }
+
+    uint8_t u8() { return need(1) ? uint8_t(data[pos++]) : 0; }
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        const uint32_t v = getU32(data + pos);
+        pos += 4;
+        return v;
+    }
+    uint64_t u64() {
+        if (!need(8)) return 0;
+        const uint64_t v = getU64(data + pos);
+        pos += 8;
+        return v;
+    }
+    std::string string() {
+        const uint32_t length = u32();
+        if (!need(length)) return std::string();
+        std::string s(data + pos, length);
+        pos += length;
+        return s;
+    }
+
+private:
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+    bool good = true;
+
+    bool need(size_t n) {
+        if (!good || size - pos < n) good = false;
+        return good;
+    }
+};
+
+// Contents of path from offset to the end; false if it cannot be opened
+inline bool readFileFrom(const std::filesystem::path &path, uint64_t offset, std::string &out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    const std::streamoff size = in.tellg();
+    out.clear();
+    if (size <= std::streamoff(offset)) return true;
+
+    out.resize(size_t(size - std::streamoff(offset)));
+    in.seekg(std::streamoff(offset));
+    in.read(out.data(), std::streamsize(out.size()));
+    out.resize(size_t(in.gcount()));
+    return true;
+}
+
+#endif // BINARYIO_H
@@ -0,0 +1,129 @@
+#include "blacklistmatcher.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_set>
+
+namespace {
+
+inline uint8_t fold(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? uint8_t(c + 32) : c;
+}
+
+} // namespace
+
+BlacklistMatcher::BlacklistMatcher(const std::vector<std::string> &patterns) {
+    compile(patterns);
+}
+
+void BlacklistMatcher::compile(const std::vector<std::string> &patterns) {
+    patternList.clear();
+    std::unordered_set<std::string> seen;
+    for (const std::string &pattern : patterns) {
+        std::string folded(pattern);
+        for (char &c : folded) c = char(fold(uint8_t(c)));
+        if (!folded.empty() && seen.insert(folded).second) patternList.push_back(folded);
+    }
+
+    // Compress the alphabet to the bytes patterns actually use
+    std::fill(std::begin(byteClass), std::end(byteClass), uint8_t(0));
+    classCount = 1;
+    for (const std::string &pattern : patternList) {
+        for (char c : pattern) {
+            uint8_t &cls = byteClass[uint8_t(c)];
+            if (cls == 0) cls = uint8_t(classCount++);
+        }
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) byteClass[c] = byteClass[c + 32];
+
+    // Trie
+    transitions.assign(size_t(classCount), -1);
+    ownMatch.assign(1, -1);
+    for (size_t i = 0; i < patternList.size(); ++i) {
+        int32_t state = 0;
+        for (char c : patternList[i]) {
+            const size_t slot = size_t(state) * classCount + byteClass[uint8_t(c)];
+            if (transitions[slot] < 0) {
+                transitions[slot] = int32_t(ownMatch.size());
+                ownMatch.push_back(-1);
+                transitions.resize(transitions.size() + size_t(classCount), -1);
+            }
+            state = transitions[slot];
+        }
+        if (ownMatch[size_t(state)] < 0) ownMatch[size_t(state)] = int32_t(i);
+    }
+
+    // Failure links, breadth first, folded straight into the transition table
+    const size_t states = ownMatch.size();
+    std::vector<int32_t> failure(states, 0);
+    firstMatch.assign(states, -1);
+    outputLink.assign(states, -1);
+    firstMatch[0] = ownMatch[0];
+
+    std::queue<int32_t> pending;
+    for (int cls = 0; cls < classCount; ++cls) {
+        int32_t &next = transitions[size_t(cls)];
+        if (next < 0) {
+            next = 0;
+        } else {
+            failure[size_t(next)] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        const int32_t state = pending.front();
+        pending.pop();
+
+        const int32_t fail = failure[size_t(state)];
+        outputLink[size_t(state)] = ownMatch[size_t(fail)] >= 0 ? fail : outputLink[size_t(fail)];
+
+        const int32_t inherited = firstMatch[size_t(fail)];
+        const int32_t own = ownMatch[size_t(state)];
+        firstMatch[size_t(state)] = own < 0 ? inherited : (inherited < 0 ? own : std::min(own, inherited));
+
+        for (int cls = 0; cls < classCount; ++cls) {
+            const size_t slot = size_t(state) * classCount + size_t(cls);
+            const int32_t viaFailure = transitions[size_t(fail) * classCount + size_t(cls)];
+            if (transitions[slot] < 0) {
+                transitions[slot] = viaFailure;
+            } else {
+                failure[size_t(transitions[slot])] = viaFailure;
+                pending.push(transitions[slot]);
+            }
+        }
+    }
+}
+
+int BlacklistMatcher::findFirst(std::string_view text) const {
+    if (patternList.empty()) return -1;
+
+    const int32_t *table = transitions.data();
+    int32_t state = 0;
+    for (char c : text) {
+        state = table[size_t(state) * classCount + byteClass[uint8_t(c)]];
+        const int32_t match = firstMatch[size_t(state)];
+        if (match >= 0) return match;
+    }
+    return -1;
+}
+
+std::vector<int> BlacklistMatcher::findAll(std::string_view text) const {
+    std::vector<int> result;
+    if (patternList.empty()) return result;
+
+    std::vector<bool> found(patternList.size(), false);
+    int32_t state = 0;
+    for (char c : text) {
+        state = transitions[size_t(state) * classCount + byteClass[uint8_t(c)]];
+        if (firstMatch[size_t(state)] < 0) continue;
+
+        for (int32_t s = ownMatch[size_t(state)] >= 0 ? state : outputLink[size_t(state)]; s > 0;
+             s = outputLink[size_t(s)]) {
+            found[size_t(ownMatch[size_t(s)])] = true;
+        }
+    }
+
+    for (size_t i = 0; i < found.size(); ++i)
+        if (found[i]) result.push_back(int(i));
+    return result;
+}
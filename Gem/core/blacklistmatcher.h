@@ -0,0 +1,43 @@
+#ifndef BLACKLISTMATCHER_H
+#define BLACKLISTMATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Multi-pattern substring matcher for the app/window blacklists. The patterns
+// are compiled once into an Aho-Corasick automaton with every failure
+// transition resolved ahead of time, so matching is one table lookup per byte
+// of input regardless of how many patterns there are. Matching folds ASCII
+// case; other bytes (UTF-8 sequences) must match exactly.
+class BlacklistMatcher {
+public:
+    BlacklistMatcher() = default;
+    explicit BlacklistMatcher(const std::vector<std::string> &patterns);
+
+    // Empty and duplicate patterns are ignored
+    void compile(const std::vector<std::string> &patterns);
+
+    // Index into patterns() of a pattern contained in text, or -1. When
+    // several match, the one ending earliest wins, then the lowest index.
+    int findFirst(std::string_view text) const;
+    bool matches(std::string_view text) const { return findFirst(text) >= 0; }
+
+    // Every distinct pattern contained in text, in pattern order
+    std::vector<int> findAll(std::string_view text) const;
+
+    const std::vector<std::string> &patterns() const { return patternList; }
+    size_t stateCount() const { return firstMatch.size(); }
+
+private:
+    std::vector<std::string> patternList;
+    uint8_t byteClass[256] = {};
+    int classCount = 1;                 // class 0 is every byte no pattern uses
+    std::vector<int32_t> transitions;   // state * classCount + class -> state
+    std::vector<int32_t> firstMatch;    // lowest pattern index ending at or below a state, or -1
+    std::vector<int32_t> ownMatch;      // pattern ending exactly at a state, or -1
+    std::vector<int32_t> outputLink;    // next state on the suffix chain with ownMatch, or -1
+};
+
+#endif // BLACKLISTMATCHER_H
@@ -0,0 +1,348 @@
+#include "bpetokenizer.h"
+#include "binaryio.h"
+#include <algorithm>
+
+namespace {
+
+enum CharClass : uint8_t { Letter, Number, Space, Newline, Other };
+
+struct Range {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Non-ASCII code points that are \p{N}; all other code points outside the
+// tables below count as letters
+const Range NumberRanges[] = {
+    {0xB2, 0xB3}, {0xB9, 0xB9}, {0xBC, 0xBE}, {0x660, 0x669}, {0x6F0, 0x6F9}, {0x7C0, 0x7C9},
+    {0x966, 0x96F}, {0x9E6, 0x9EF}, {0xA66, 0xA6F}, {0xAE6, 0xAEF}, {0xB66, 0xB6F}, {0xBE6, 0xBF2},
+    {0xC66, 0xC6F}, {0xCE6, 0xCEF}, {0xD66, 0xD78}, {0xE50, 0xE59}, {0xED0, 0xED9}, {0xF20, 0xF33},
+    {0x1040, 0x1049}, {0x17E0, 0x17E9}, {0x1810, 0x1819}, {0x2070, 0x2070}, {0x2074, 0x2079},
+    {0x2080, 0x2089}, {0x2150, 0x2182}, {0x2185, 0x2189}, {0x2460, 0x249B}, {0x24EA, 0x24FF},
+    {0x2776, 0x2793}, {0x3007, 0x3007}, {0x3021, 0x3029}, {0x3038, 0x303A}, {0xFF10, 0xFF19},
+    {0x1D7CE, 0x1D7FF}, {0x1F100, 0x1F10C},
+};
+
+// Neither letters nor numbers nor spaces: controls, combining marks,
+// punctuation and symbols
+const Range OtherRanges[] = {
+    {0x80, 0x9F}, {0xA1, 0xA9}, {0xAB, 0xB1}, {0xB4, 0xB4}, {0xB6, 0xB8}, {0xBB, 0xBB}, {0xBF, 0xBF},
+    {0xD7, 0xD7}, {0xF7, 0xF7}, {0x2C2, 0x2C5}, {0x2D2, 0x2DF}, {0x2E5, 0x2EB}, {0x2ED, 0x2ED},
+    {0x2EF, 0x36F}, {0x375, 0x375}, {0x37E, 0x37E}, {0x384, 0x385}, {0x387, 0x387}, {0x3F6, 0x3F6},
+    {0x482, 0x489}, {0x55A, 0x55F}, {0x589, 0x58A}, {0x58D, 0x58F}, {0x591, 0x5C7}, {0x5F3, 0x5F4},
+    {0x600, 0x61F}, {0x64B, 0x65F}, {0x66A, 0x66D}, {0x670, 0x670}, {0x6D4, 0x6D4}, {0x6D6, 0x6ED},
+    {0x6FD, 0x6FE}, {0x900, 0x903}, {0x93A, 0x93C}, {0x93E, 0x94F}, {0x951, 0x957}, {0x962, 0x965},
+    {0x970, 0x970}, {0xE31, 0xE31}, {0xE34, 0xE3A}, {0xE3F, 0xE3F}, {0xE47, 0xE4F}, {0xE5A, 0xE5B},
+    {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x2010, 0x2027}, {0x2030, 0x205E}, {0x2060, 0x206F},
+    {0x207A, 0x207E}, {0x208A, 0x208E}, {0x20A0, 0x20FF}, {0x2100, 0x2101}, {0x2103, 0x2106},
+    {0x2108, 0x2109}, {0x2114, 0x2114}, {0x2116, 0x2118}, {0x211E, 0x2123}, {0x2125, 0x2125},
+    {0x2127, 0x2127}, {0x2129, 0x2129}, {0x212E, 0x212E}, {0x213A, 0x213B}, {0x2140, 0x2144},
+    {0x214A, 0x214D}, {0x214F, 0x214F}, {0x2190, 0x245F}, {0x249C, 0x24E9}, {0x2500, 0x2775},
+    {0x2794, 0x2BFF}, {0x2E00, 0x2FFF}, {0x3001, 0x3004}, {0x3008, 0x3020}, {0x302A, 0x3030},
+    {0x3036, 0x3037}, {0x303D, 0x303F}, {0x3099, 0x309C}, {0x30A0, 0x30A0}, {0x30FB, 0x30FB},
+    {0x3200, 0x33FF}, {0xA490, 0xA4C6}, {0xD800, 0xF8FF}, {0xFD3E, 0xFD3F}, {0xFE00, 0xFE6F},
+    {0xFEFF, 0xFEFF}, {0xFF01, 0xFF0F}, {0xFF1A, 0xFF20}, {0xFF3B, 0xFF40}, {0xFF5B, 0xFF65},
+    {0xFFE0, 0xFFFF}, {0x1D000, 0x1D24F}, {0x1F000, 0x1FBFF}, {0xE0000, 0xE01EF}, {0xF0000, 0x10FFFF},
+};
+
+template <size_t N>
+bool inRanges(const Range (&ranges)[N], uint32_t cp) {
+    const Range *end = ranges + N;
+    const Range *it = std::upper_bound(ranges, end, cp, [](uint32_t value, const Range &range) {
+        return value < range.first;
+    });
+    return it != ranges && cp <= (it - 1)->last;
+}
+
+CharClass classify(uint32_t cp) {
+    if (cp < 0x80) {
+        if ((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z')) return Letter;
+        if (cp >= '0' && cp <= '9') return Number;
+        if (cp == '\r' || cp == '\n') return Newline;
+        if (cp == ' ' || cp == '\t' || cp == '\v' || cp == '\f') return Space;
+        return Other;
+    }
+    if (cp == 0x85 || cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) || cp == 0x2028 ||
+        cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000)
+        return Space;
+    if (inRanges(NumberRanges, cp)) return Number;
+    if (inRanges(OtherRanges, cp)) return Other;
+    return Letter;
+}
+
+inline bool isContinuation(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+struct Char {
+    CharClass cls;
+    size_t length;
+};
+
+// The character at i; a malformed sequence is one Other byte
+Char charAt(std::string_view text, size_t i) {
+    const uint8_t c = uint8_t(text[i]);
+    if (c < 0x80) return {classify(c), 1};
+
+    size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 0;
+    if (length == 0 || i + length > text.size()) return {Other, 1};
+    uint32_t cp = c & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k) {
+        const uint8_t next = uint8_t(text[i + k]);
+        if (!isContinuation(next)) return {Other, 1};
+        cp = (cp << 6) | (next & 0x3F);
+    }
+    return {classify(cp), length};
+}
+
+size_t skipClass(std::string_view text, size_t i, CharClass cls) {
+    while (i < text.size()) {
+        const Char c = charAt(text, i);
+        if (c.cls != cls) break;
+        i += c.length;
+    }
+    return i;
+}
+
+size_t skipNewlines(std::string_view text, size_t i) {
+    while (i < text.size() && (text[i] == '\r' || text[i] == '\n')) ++i;
+    return i;
+}
+
+inline char lower(char c) { return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c; }
+
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+bool decodeBase64(std::string_view in, std::string &out) {
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : in) {
+        if (c == '=') break;
+        const int value = base64Value(c);
+        if (value < 0) return false;
+        buffer = (buffer << 6) | uint32_t(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(char((buffer >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool BpeTokenizer::load(const std::filesystem::path &path) {
+    ranks.clear();
+    bytes.clear();
+    cache.clear();
+    error.clear();
+
+    std::string data;
+    if (!readFileFrom(path, 0, data)) {
+        error = "cannot read " + path.string();
+        return false;
+    }
+
+    // Tokens go into one buffer first so the map's views stay put
+    struct Entry {
+        size_t offset;
+        size_t length;
+        uint32_t rank;
+    };
+    std::vector<Entry> entries;
+    size_t lineNumber = 0;
+    for (size_t pos = 0; pos < data.size();) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) end = data.size();
+        std::string_view line(data.data() + pos, end - pos);
+        pos = end + 1;
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        const size_t space = line.find(' ');
+        std::string_view digits = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+        uint64_t rank = 0;
+        bool valid = !digits.empty() && digits.size() <= 10;
+        for (char c : digits) {
+            if (c < '0' || c > '9') valid = false;
+            else rank = rank * 10 + uint64_t(c - '0');
+        }
+        const size_t offset = bytes.size();
+        if (!valid || rank >= NoRank || !decodeBase64(line.substr(0, space), bytes) || bytes.size() == offset) {
+            error = path.string() + ":" + std::to_string(lineNumber) + ": not a token and rank";
+            bytes.clear();
+            return false;
+        }
+        entries.push_back({offset, bytes.size() - offset, uint32_t(rank)});
+    }
+
+    ranks.reserve(entries.size());
+    for (const Entry &entry : entries) ranks.emplace(std::string_view(bytes.data() + entry.offset, entry.length), entry.rank);
+    if (ranks.empty()) error = path.string() + ": no tokens";
+    return loaded();
+}
+
+size_t BpeTokenizer::nextPiece(std::string_view text, size_t i) {
+    const size_t n = text.size();
+    if (i >= n) return n;
+    const Char c = charAt(text, i);
+
+    // 's 't 're 've 'm 'll 'd, any case
+    if (text[i] == '\'' && i + 1 < n) {
+        const char a = lower(text[i + 1]);
+        if (a == 's' || a == 't' || a == 'm' || a == 'd') return i + 2;
+        if (i + 2 < n) {
+            const char b = lower(text[i + 2]);
+            if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) return i + 3;
+        }
+    }
+
+    // Letters, after at most one character that is none of letter, digit or newline
+    if (c.cls == Letter) return skipClass(text, i, Letter);
+    if (c.cls == Space || c.cls == Other) {
+        const size_t j = i + c.length;
+        if (j < n && charAt(text, j).cls == Letter) return skipClass(text, j, Letter);
+    }
+
+    // Up to three digits
+    if (c.cls == Number) {
+        size_t j = i;
+        for (int k = 0; k < 3 && j < n; ++k) {
+            const Char d = charAt(text, j);
+            if (d.cls != Number) break;
+            j += d.length;
+        }
+        return j;
+    }
+
+    // Punctuation and symbols, after at most one space, with the newlines behind them
+    if (text[i] == ' ' && i + 1 < n && charAt(text, i + 1).cls == Other)
+        return skipNewlines(text, skipClass(text, i + 1, Other));
+    if (c.cls == Other) return skipNewlines(text, skipClass(text, i, Other));
+
+    // Whitespace: up to the last newline in the run; else the run but the
+    // character before a word, which goes with the word
+    size_t j = i, lastNewline = n, last = i;
+    while (j < n) {
+        const Char s = charAt(text, j);
+        if (s.cls != Space && s.cls != Newline) break;
+        if (text[j] == '\r' || text[j] == '\n') lastNewline = j;
+        last = j;
+        j += s.length;
+    }
+    if (lastNewline != n) return lastNewline + 1;
+    if (j == n || last == i) return j;
+    return last;
+}
+
+uint32_t BpeTokenizer::rankOf(std::string_view token) const {
+    auto it = ranks.find(token);
+    return it == ranks.end() ? NoRank : it->second;
+}
+
+void BpeTokenizer::merge(std::string_view piece, std::vector<size_t> &bounds) const {
+    // As tiktoken: parts[i] is a boundary and the rank of merging the two
+    // tokens that start there; the lowest rank is merged until none is left
+    struct Part {
+        size_t start;
+        uint32_t rank;
+    };
+    std::vector<Part> parts;
+    parts.reserve(piece.size() + 1);
+    for (size_t i = 0; i <= piece.size(); ++i) {
+        parts.push_back({i, i + 2 <= piece.size() ? rankOf(piece.substr(i, 2)) : NoRank});
+    }
+
+    auto pairRank = [&](size_t i) {
+        return i + 3 < parts.size() ? rankOf(piece.substr(parts[i].start, parts[i + 3].start - parts[i].start))
+                                    : NoRank;
+    };
+
+    while (parts.size() > 2) {
+        size_t best = 0;
+        uint32_t bestRank = NoRank;
+        for (size_t i = 0; i + 1 < parts.size(); ++i) {
+            if (parts[i].rank < bestRank) {
+                bestRank = parts[i].rank;
+                best = i;
+            }
+        }
+        if (bestRank == NoRank) break;
+
+        parts[best].rank = pairRank(best);
+        if (best > 0) parts[best - 1].rank = pairRank(best - 1);
+        parts.erase(parts.begin() + std::ptrdiff_t(best + 1));
+    }
+
+    bounds.clear();
+    for (const Part &part : parts) bounds.push_back(part.start);
+}
+
+size_t BpeTokenizer::countPiece(std::string_view piece) const {
+    if (ranks.count(piece)) return 1;
+
+    auto cached = cache.find(std::string(piece));
+    if (cached != cache.end()) return cached->second;
+
+    std::vector<size_t> bounds;
+    merge(piece, bounds);
+    const uint32_t tokens = uint32_t(bounds.size() - 1);
+    if (cache.size() >= CacheLimit) cache.clear();
+    cache.emplace(std::string(piece), tokens);
+    return tokens;
+}
+
+size_t BpeTokenizer::count(std::string_view text) const {
+    size_t tokens = 0;
+    for (size_t i = 0; i < text.size();) {
+        const size_t end = nextPiece(text, i);
+        tokens += countPiece(text.substr(i, end - i));
+        i = end;
+    }
+    return tokens;
+}
+
+std::vector<uint32_t> BpeTokenizer::encode(std::string_view text) const {
+    std::vector<uint32_t> tokens;
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i < text.size();) {
+        const size_t end = nextPiece(text, i);
+        const std::string_view piece = text.substr(i, end - i);
+        const uint32_t whole = rankOf(piece);
+        if (whole != NoRank) {
+            tokens.push_back(whole);
+        } else {
+            merge(piece, bounds);
+            for (size_t k = 0; k + 1 < bounds.size(); ++k)
+                tokens.push_back(rankOf(piece.substr(bounds[k], bounds[k + 1] - bounds[k])));
+        }
+        i = end;
+    }
+    return tokens;
+}
+
+size_t BpeTokenizer::prefixBytes(std::string_view text, size_t maxTokens) const {
+    size_t tokens = 0;
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i < text.size();) {
+        const size_t end = nextPiece(text, i);
+        const std::string_view piece = text.substr(i, end - i);
+        const size_t pieceTokens = countPiece(piece);
+        if (tokens + pieceTokens > maxTokens) {
+            merge(piece, bounds);
+            size_t cut = i + bounds[maxTokens - tokens];
+            while (cut > 0 && cut < text.size() && isContinuation(uint8_t(text[cut]))) --cut;
+            return cut;
+        }
+        tokens += pieceTokens;
+        i = end;
+    }
+    return text.size();
+}
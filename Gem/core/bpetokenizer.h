@@ -0,0 +1,63 @@
+#ifndef BPETOKENIZER_H
+#define BPETOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Byte-level BPE token counts for the chat models, from the model's own
+// merge ranks in tiktoken's format: one "base64(token bytes) rank" pair per
+// line, lowest rank merged first (Llama 3's tokenizer.model is such a file).
+//
+// Text is first split the way the model's pre-tokenizer does (the cl100k /
+// Llama 3 pattern: contractions, letter runs with one leading non-letter,
+// digit groups of up to three, punctuation runs, newline and space runs),
+// then each piece is merged pair by pair. Letters, digits and spaces are
+// told apart with Unicode range tables covering Latin, Greek, Cyrillic, CJK
+// and the common punctuation and symbol blocks; text in other scripts can
+// split differently from the model's, by a token here and there.
+//
+// Counts of recent pieces are cached, which is what makes repeated OCR
+// text cheap to count; the cache makes a tokenizer unsafe to share between
+// threads.
+class BpeTokenizer {
+public:
+    BpeTokenizer() = default;
+    BpeTokenizer(const BpeTokenizer &) = delete;
+    BpeTokenizer &operator=(const BpeTokenizer &) = delete;
+
+    bool load(const std::filesystem::path &path);
+    bool loaded() const { return !ranks.empty(); }
+    const std::string &lastError() const { return error; }
+    size_t vocabularySize() const { return ranks.size(); }
+
+    size_t count(std::string_view text) const;
+    std::vector<uint32_t> encode(std::string_view text) const;
+
+    // Bytes of the longest prefix of text that is at most maxTokens tokens
+    // and ends between two tokens; never inside a UTF-8 character
+    size_t prefixBytes(std::string_view text, size_t maxTokens) const;
+
+    // End of the pre-tokenizer piece that starts at begin
+    static size_t nextPiece(std::string_view text, size_t begin);
+
+private:
+    static constexpr uint32_t NoRank = UINT32_MAX;
+    static constexpr size_t CacheLimit = 1 << 16;
+
+    std::string bytes;                                   // every token, back to back
+    std::unordered_map<std::string_view, uint32_t> ranks; // views into bytes
+    mutable std::unordered_map<std::string, uint32_t> cache; // piece -> tokens
+    std::string error;
+
+    uint32_t rankOf(std::string_view token) const;
+    // Token boundaries in piece: offsets 0 = b0 < b1 < ... < bn = size
+    void merge(std::string_view piece, std::vector<size_t> &bounds) const;
+    size_t countPiece(std::string_view piece) const;
+};
+
+#endif // BPETOKENIZER_H
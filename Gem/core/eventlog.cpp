@@ -0,0 +1,298 @@
+#include "eventlog.h"
+#include "binaryio.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char Magic[8] = {'G', 'E', 'M', 'L', 'O', 'G', '1', '\n'};
+const uint64_t HeaderBytes = sizeof(Magic);
+const uint32_t MaxBodyBytes = 64u << 20;
+
+std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        table[i] = c;
+    }
+    return table;
+}
+
+} // namespace
+
+uint32_t crc32(const void *data, size_t length, uint32_t seed) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    const uint8_t *bytes = static_cast<const uint8_t*>(data);
+    uint32_t c = seed ^ 0xffffffffu;
+    for (size_t i = 0; i < length; ++i) c = table[(c ^ bytes[i]) & 0xff] ^ (c >> 8);
+    return c ^ 0xffffffffu;
+}
+
+EventLog::~EventLog() {
+    close();
+}
+
+fs::path EventLog::segmentPath(uint64_t firstSequence) const {
+    char name[48];
+    std::snprintf(name, sizeof(name), "segment-%020llu.log", static_cast<unsigned long long>(firstSequence));
+    return dir / name;
+}
+
+std::vector<EventLog::Segment> EventLog::listSegments() const {
+    std::vector<Segment> found;
+    std::error_code ec;
+    for (const fs::directory_entry &entry : fs::directory_iterator(dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() != 32 || name.compare(0, 8, "segment-") != 0 || name.compare(28, 4, ".log") != 0)
+            continue;
+
+        Segment segment;
+        segment.firstSequence = std::strtoull(name.c_str() + 8, nullptr, 10);
+        segment.path = entry.path();
+        if (segment.firstSequence > 0) found.push_back(segment);
+    }
+    std::sort(found.begin(), found.end(),
+              [](const Segment &a, const Segment &b) { return a.firstSequence < b.firstSequence; });
+    return found;
+}
+
+bool EventLog::open(const fs::path &directory, bool readOnlyMode, const Visitor &visit, uint64_t afterSequence) {
+    close();
+    dir = directory;
+    readOnly = readOnlyMode;
+    error.clear();
+    discarded = 0;
+    nextSequence = afterSequence + 1;
+
+    std::error_code ec;
+    if (!readOnly) fs::create_directories(dir, ec);
+    if (!fs::is_directory(dir, ec)) {
+        if (readOnly) return true; // nothing written yet
+        error = "cannot create " + dir.string();
+        return false;
+    }
+
+    segments = listSegments();
+    for (Segment &segment : segments) {
+        nextSequence = std::max(nextSequence, segment.firstSequence);
+        if (!scanSegment(segment, afterSequence, 0, visit)) return false;
+    }
+    if (!readOnly)
+        segments.erase(std::remove_if(segments.begin(), segments.end(),
+                                      [](const Segment &segment) { return segment.bytes == 0; }),
+                       segments.end());
+    readOffset = segments.empty() ? 0 : segments.back().bytes;
+
+    return readOnly || openForAppend();
+}
+
+bool EventLog::scanSegment(Segment &segment, uint64_t afterSequence, uint64_t offset, const Visitor &visit) {
+    std::string data;
+    if (!readFileFrom(segment.path, offset, data)) {
+        error = "cannot read " + segment.path.string();
+        return false;
+    }
+
+    size_t pos = 0;
+    if (offset == 0) {
+        if (data.size() < HeaderBytes || std::memcmp(data.data(), Magic, HeaderBytes) != 0) {
+            // Created but never written (or not ours): treat as empty
+            segment.bytes = 0;
+            if (!readOnly) {
+                std::error_code ec;
+                fs::remove(segment.path, ec);
+            }
+            return true;
+        }
+        pos = HeaderBytes;
+    }
+
+    uint64_t sequence = offset == 0 ? segment.firstSequence : nextSequence;
+    Record record;
+
+    while (pos + 8 <= data.size()) {
+        const uint32_t length = getU32(data.data() + pos);
+        const uint32_t checksum = getU32(data.data() + pos + 4);
+        if (length < 13 || length > MaxBodyBytes || pos + 8 + length > data.size()) break;
+
+        const char *body = data.data() + pos + 8;
+        const uint32_t keyLength = getU32(body + 9);
+        if (crc32(body, length) != checksum || 13 + uint64_t(keyLength) > length) break;
+
+        if (sequence > afterSequence && visit) {
+            record.type = uint8_t(body[0]);
+            record.timestampMs = int64_t(getU64(body + 1));
+            record.key.assign(body + 13, keyLength);
+            record.payload.assign(body + 13 + keyLength, length - 13 - keyLength);
+            visit(sequence, record);
+        }
+        ++sequence;
+        pos += 8 + length;
+    }
+
+    const uint64_t good = offset + pos;
+    const bool trailing = pos < data.size();
+    segment.bytes = good;
+    nextSequence = std::max(nextSequence, sequence);
+
+    // Readers stop here and pick the rest up once the writer finishes it
+    if (trailing && !readOnly) {
+        // Torn or corrupt tail from a crash mid-append: cut it off. In an
+        // older segment this loses the rest of that segment only; sequence
+        // numbers resume from the next segment's name.
+        std::error_code ec;
+        fs::resize_file(segment.path, good, ec);
+        if (ec) {
+            error = "cannot truncate " + segment.path.string() + ": " + ec.message();
+            return false;
+        }
+        discarded += data.size() - pos;
+    }
+    return true;
+}
+
+bool EventLog::openForAppend() {
+    out.close();
+    out.clear();
+
+    if (segments.empty() || segments.back().bytes >= segmentLimit) {
+        Segment segment;
+        segment.firstSequence = nextSequence;
+        segment.path = segmentPath(nextSequence);
+        out.open(segment.path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "cannot create " + segment.path.string();
+            return false;
+        }
+        out.write(Magic, HeaderBytes);
+        out.flush();
+        segment.bytes = HeaderBytes;
+        segments.push_back(segment);
+    } else {
+        out.open(segments.back().path, std::ios::binary | std::ios::app);
+        if (!out) {
+            error = "cannot open " + segments.back().path.string();
+            return false;
+        }
+    }
+    return bool(out);
+}
+
+uint64_t EventLog::append(const Record &record) {
+    if (readOnly || !out.is_open()) return 0;
+    if (segments.back().bytes >= segmentLimit && !openForAppend()) return 0;
+
+    std::string body;
+    body.reserve(13 + record.key.size() + record.payload.size());
+    body.push_back(char(record.type));
+    putU64(body, uint64_t(record.timestampMs));
+    putU32(body, uint32_t(record.key.size()));
+    body.append(record.key);
+    body.append(record.payload);
+
+    std::string frame;
+    frame.reserve(8 + body.size());
+    putU32(frame, uint32_t(body.size()));
+    putU32(frame, crc32(body.data(), body.size()));
+    frame.append(body);
+
+    out.write(frame.data(), std::streamsize(frame.size()));
+    out.flush();
+    if (!out) {
+        error = "write failed on " + segments.back().path.string();
+        // Reopen so a partial frame is truncated before the next append
+        std::error_code ec;
+        out.close();
+        out.clear();
+        fs::resize_file(segments.back().path, segments.back().bytes, ec);
+        openForAppend();
+        return 0;
+    }
+
+    segments.back().bytes += frame.size();
+    return nextSequence++;
+}
+
+void EventLog::roll() {
+    if (readOnly || segments.empty() || segments.back().bytes <= HeaderBytes) return;
+    out.close();
+    out.clear();
+
+    Segment segment;
+    segment.firstSequence = nextSequence;
+    segment.path = segmentPath(nextSequence);
+    out.open(segment.path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot create " + segment.path.string();
+        return;
+    }
+    out.write(Magic, HeaderBytes);
+    out.flush();
+    segment.bytes = HeaderBytes;
+    segments.push_back(segment);
+}
+
+void EventLog::dropThrough(uint64_t sequence) {
+    if (readOnly) return;
+
+    // Never the active segment; roll() first to retire it
+    std::vector<Segment> kept;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const bool active = i + 1 == segments.size();
+        const uint64_t last = active ? nextSequence - 1 : segments[i + 1].firstSequence - 1;
+        std::error_code ec;
+        if (!active && last <= sequence && fs::remove(segments[i].path, ec)) continue;
+        kept.push_back(segments[i]); // still needed, or held open by a reader
+    }
+    segments.swap(kept);
+}
+
+void EventLog::clear() {
+    if (readOnly) return;
+    out.close();
+    out.clear();
+    for (const Segment &segment : segments) {
+        std::error_code ec;
+        fs::remove(segment.path, ec);
+    }
+    segments.clear();
+    openForAppend();
+}
+
+bool EventLog::readNew(const Visitor &visit) {
+    if (!readOnly) return true;
+
+    std::vector<Segment> current = listSegments();
+    const uint64_t reading = segments.empty() ? 0 : segments.back().firstSequence;
+
+    std::vector<Segment> kept;
+    for (Segment &segment : current) {
+        if (segment.firstSequence < reading) continue;
+
+        if (reading > 0 && segment.firstSequence == reading) {
+            if (!scanSegment(segment, 0, readOffset, visit)) return false;
+        } else if (!scanSegment(segment, nextSequence - 1, 0, visit)) {
+            return false;
+        }
+        readOffset = segment.bytes;
+        kept.push_back(segment);
+    }
+    if (!kept.empty()) segments.swap(kept);
+    return true;
+}
+
+uint64_t EventLog::totalBytes() const {
+    uint64_t total = 0;
+    for (const Segment &segment : segments) total += segment.bytes;
+    return total;
+}
+
+void EventLog::close() {
+    if (out.is_open()) out.close();
+    out.clear();
+}
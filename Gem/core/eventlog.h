@@ -0,0 +1,84 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Segmented append-only log of small binary records. Each segment file is
+// named after the sequence number of its first record; every record carries
+// a length and CRC32, so a torn write at the tail is detected on open and
+// cut off (in write mode) instead of poisoning what came before it.
+//
+//   segment := "GEMLOG1\n" record*
+//   record  := u32 bodyLength, u32 crc32(body), body
+//   body    := u8 type, i64 timestampMs, u32 keyLength, key, payload
+//
+// Integers are little-endian. One writer per directory; any number of
+// read-only openers may follow it with readNew().
+class EventLog {
+public:
+    struct Record {
+        uint8_t type = 0;
+        int64_t timestampMs = 0;
+        std::string key;
+        std::string payload;
+    };
+
+    using Visitor = std::function<void(uint64_t sequence, const Record &record)>;
+
+    ~EventLog();
+
+    // Scans every segment, truncating a damaged tail when writable
+    bool open(const std::filesystem::path &directory, bool readOnly, const Visitor &visit,
+              uint64_t afterSequence = 0);
+    void close();
+
+    uint64_t append(const Record &record);     // sequence number, or 0 on failure
+    void roll();                                // next append starts a new segment
+    void setSegmentBytes(uint64_t bytes) { segmentLimit = bytes; }
+
+    // Delete segments whose records all have sequence <= sequence
+    void dropThrough(uint64_t sequence);
+    // Delete every segment; sequence numbers keep counting
+    void clear();
+
+    // Readers: visit records appended since the last open/readNew
+    bool readNew(const Visitor &visit);
+
+    uint64_t lastSequence() const { return nextSequence - 1; }
+    uint64_t totalBytes() const;
+    size_t segmentCount() const { return segments.size(); }
+    uint64_t discardedBytes() const { return discarded; } // cut off by recovery on open
+    const std::string &lastError() const { return error; }
+
+private:
+    struct Segment {
+        uint64_t firstSequence = 0;
+        uint64_t bytes = 0;
+        std::filesystem::path path;
+    };
+
+    std::filesystem::path dir;
+    bool readOnly = true;
+    std::vector<Segment> segments;
+    std::ofstream out;
+    uint64_t nextSequence = 1;
+    uint64_t segmentLimit = 4 << 20;
+    uint64_t readOffset = 0;   // readers: position in the last segment read
+    uint64_t discarded = 0;
+    std::string error;
+
+    bool scanSegment(Segment &segment, uint64_t afterSequence, uint64_t offset, const Visitor &visit);
+    bool openForAppend();
+    std::vector<Segment> listSegments() const;
+    std::filesystem::path segmentPath(uint64_t firstSequence) const;
+};
+
+uint32_t crc32(const void *data, size_t length, uint32_t seed = 0);
+
+#endif // EVENTLOG_H
@@ -0,0 +1,72 @@
+#include "hdrhistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int highestBit(uint64_t value) {
+    int bit = -1;
+    while (value) {
+        value >>= 1;
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+HdrHistogram::HdrHistogram(int precision, int maxBits)
+    : subBits(std::clamp(precision, 1, 16) + 1), maxBits(std::clamp(maxBits, subBits, 63))
+{
+    // Group 0 holds [0, 2^subBits) one value per bucket; every group after
+    // that adds half as many buckets, each twice as wide as the last group's
+    const size_t half = size_t(1) << (subBits - 1);
+    counts.assign(size_t(this->maxBits - subBits + 2) * half, 0);
+}
+
+size_t HdrHistogram::indexOf(uint64_t value) const {
+    const size_t half = size_t(1) << (subBits - 1);
+    const int shift = std::max(0, highestBit(value) - subBits + 1);
+    const uint64_t sub = value >> shift; // in [half, 2 * half) once shift > 0
+    return size_t(shift) * half + size_t(sub);
+}
+
+uint64_t HdrHistogram::highestEquivalent(size_t index) const {
+    const size_t half = size_t(1) << (subBits - 1);
+    if (index < 2 * half) return index;
+    const size_t shift = index / half - 1;
+    const uint64_t sub = index - shift * half;
+    return ((sub + 1) << shift) - 1;
+}
+
+void HdrHistogram::record(uint64_t value) {
+    value = std::min(value, (uint64_t(1) << maxBits) - 1);
+    ++counts[indexOf(value)];
+    ++total;
+    sum += value;
+    lowest = std::min(lowest, value);
+    highest = std::max(highest, value);
+}
+
+void HdrHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    sum = 0;
+    lowest = UINT64_MAX;
+    highest = 0;
+}
+
+uint64_t HdrHistogram::valueAtPercentile(double percentile) const {
+    if (total == 0) return 0;
+
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(percentile / 100.0 * double(total))));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(highestEquivalent(i), highest);
+    }
+    return highest;
+}
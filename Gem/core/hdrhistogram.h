@@ -0,0 +1,43 @@
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Log-linear latency histogram in the HdrHistogram layout. Values are
+// grouped by their highest set bit and each group is split into 2^precision
+// linear sub-buckets, so any recorded value is reported to within about
+// 2^-precision of itself whatever its magnitude. Memory is fixed at
+// construction and record() is a couple of shifts and an increment.
+class HdrHistogram {
+public:
+    // Values above 2^maxBits - 1 are clamped (40 bits of µs is ~12 days)
+    explicit HdrHistogram(int precision = 7, int maxBits = 40);
+
+    void record(uint64_t value);
+    void reset();
+
+    // Highest value equivalent to the one at the given percentile (0..100),
+    // never above the largest recorded value
+    uint64_t valueAtPercentile(double percentile) const;
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? lowest : 0; }
+    uint64_t max() const { return highest; }
+    double mean() const { return total ? double(sum) / double(total) : 0.0; }
+
+private:
+    int subBits;
+    int maxBits;
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t lowest = UINT64_MAX;
+    uint64_t highest = 0;
+
+    size_t indexOf(uint64_t value) const;
+    uint64_t highestEquivalent(size_t index) const;
+};
+
+#endif // HDRHISTOGRAM_H
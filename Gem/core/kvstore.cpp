@@ -0,0 +1,656 @@
+#include "kvstore.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct KvStore::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t clean;
+    uint64_t budgetBytes;
+    uint64_t arenaBytes;
+    uint32_t maxEntries;
+    uint32_t bucketCount;
+    uint32_t entries;
+    uint32_t freeHead;      // free slots, linked through chainNext
+    uint32_t lruHead;       // most recently used
+    uint32_t lruTail;
+    uint64_t arenaTail;
+    uint64_t liveBytes;
+    uint64_t clock;         // LRU stamp counter
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t expirations;
+    uint64_t compactions;
+};
+
+struct KvStore::Slot {
+    uint64_t hash;
+    int64_t expiresAtMs;
+    uint64_t offset;        // key then value, in the arena
+    uint64_t stamp;         // clock at last use; orders the rebuilt LRU list
+    uint32_t keyLength;
+    uint32_t valueLength;
+    uint32_t chainNext;
+    uint32_t lruPrev;
+    uint32_t lruNext;
+    uint32_t check;         // checksum of key and value, verified on recovery
+    uint32_t used;
+    uint32_t reserved;
+};
+
+namespace {
+
+const char Magic[8] = {'G', 'E', 'M', 'K', 'V', '0', '1', '\n'};
+const uint32_t Version = 1;
+
+uint64_t align64(uint64_t n) {
+    return (n + 63) & ~uint64_t(63);
+}
+
+uint64_t hashKey(std::string_view key) {
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint32_t checksum(const char *data, uint64_t length) {
+    uint32_t h = 2166136261u; // FNV-1a, 32-bit
+    for (uint64_t i = 0; i < length; ++i) {
+        h ^= uint8_t(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+struct Geometry {
+    uint32_t bucketCount = 1;
+    uint64_t arenaBytes = 0;
+    uint64_t bucketsOffset = 0;
+    uint64_t slotsOffset = 0;
+    uint64_t arenaOffset = 0;
+    uint64_t totalBytes = 0;
+};
+
+template <typename HeaderT, typename SlotT>
+Geometry geometryFor(const KvStore::Options &options) {
+    Geometry g;
+    while (g.bucketCount < options.maxEntries) g.bucketCount <<= 1;
+    // Half the budget again as slack, so compaction runs at most once per
+    // half-budget of writes
+    g.arenaBytes = align64(options.budgetBytes + options.budgetBytes / 2);
+    g.bucketsOffset = align64(sizeof(HeaderT));
+    g.slotsOffset = g.bucketsOffset + align64(uint64_t(g.bucketCount) * sizeof(uint32_t));
+    g.arenaOffset = g.slotsOffset + align64((uint64_t(options.maxEntries) + 1) * sizeof(SlotT));
+    g.totalBytes = g.arenaOffset + g.arenaBytes;
+    return g;
+}
+
+} // namespace
+
+KvStore::~KvStore() {
+    close();
+}
+
+bool KvStore::open(const std::filesystem::path &path, const Options &options) {
+    static_assert(sizeof(Slot) == 64, "slot layout is part of the file format");
+
+    close();
+    error.clear();
+    recoveredOnOpen = false;
+
+    if (options.budgetBytes == 0 || options.maxEntries == 0) {
+        error = "budget and entry limit must be non-zero";
+        return false;
+    }
+
+    const Geometry g = geometryFor<Header, Slot>(options);
+    bool created = false;
+    if (!mapFile(path, g.totalBytes, &created)) return false;
+
+    header = reinterpret_cast<Header*>(base);
+    buckets = reinterpret_cast<uint32_t*>(base + g.bucketsOffset);
+    slots = reinterpret_cast<Slot*>(base + g.slotsOffset);
+    arena = base + g.arenaOffset;
+
+    const bool compatible = !created && std::memcmp(header->magic, Magic, sizeof(Magic)) == 0
+        && header->version == Version && header->budgetBytes == options.budgetBytes
+        && header->maxEntries == options.maxEntries && header->bucketCount == g.bucketCount
+        && header->arenaBytes == g.arenaBytes;
+
+    if (!compatible) {
+        format(options);
+    } else if (!header->clean) {
+        rebuild();
+        recoveredOnOpen = true;
+        error = "cache was not closed cleanly; index rebuilt";
+    } else {
+        expiring = 0;
+        for (uint32_t i = 1; i <= header->maxEntries; ++i)
+            if (slots[i].used && slots[i].expiresAtMs != NoExpiry) ++expiring;
+    }
+
+    header->clean = 0;
+    expireCursor = 1;
+    return true;
+}
+
+void KvStore::close() {
+    if (!base) return;
+    header->clean = 1;
+#ifdef _WIN32
+    FlushViewOfFile(base, 0);
+    FlushFileBuffers(static_cast<HANDLE>(fileHandle));
+#else
+    msync(base, mappedBytes, MS_SYNC);
+#endif
+    unmapFile();
+}
+
+bool KvStore::mapFile(const std::filesystem::path &path, uint64_t bytes, bool *created) {
+    std::error_code ec;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), ec);
+
+#ifdef _WIN32
+    // No sharing: a second opener fails instead of corrupting the map
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "cannot open " + path.string() + " (in use by another process?)";
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    *created = uint64_t(size.QuadPart) != bytes;
+    if (*created) {
+        // Truncate first so the whole file reads back as zeros
+        LARGE_INTEGER position{};
+        SetFilePointerEx(file, position, nullptr, FILE_BEGIN);
+        SetEndOfFile(file);
+        position.QuadPart = LONGLONG(bytes);
+        if (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+            error = "cannot size " + path.string();
+            CloseHandle(file);
+            return false;
+        }
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE,
+                                        DWORD(bytes >> 32), DWORD(bytes & 0xffffffff), nullptr);
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, SIZE_T(bytes)) : nullptr;
+    if (!view) {
+        error = "cannot map " + path.string();
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = static_cast<char*>(view);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        error = "cannot open " + path.string() + ": " + std::strerror(errno);
+        return false;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        error = path.string() + " is in use by another process";
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    struct stat info;
+    fstat(fd, &info);
+    *created = uint64_t(info.st_size) != bytes;
+    if (*created && (ftruncate(fd, 0) != 0 || ftruncate(fd, off_t(bytes)) != 0)) {
+        error = "cannot size " + path.string() + ": " + std::strerror(errno);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void *view = mmap(nullptr, size_t(bytes), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        error = "cannot map " + path.string() + ": " + std::strerror(errno);
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    base = static_cast<char*>(view);
+#endif
+    mappedBytes = bytes;
+    return true;
+}
+
+void KvStore::unmapFile() {
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(base, size_t(mappedBytes));
+    ::close(fd); // releases the lock
+    fd = -1;
+#endif
+    base = nullptr;
+    expiring = 0;
+    header = nullptr;
+    buckets = nullptr;
+    slots = nullptr;
+    arena = nullptr;
+    mappedBytes = 0;
+}
+
+void KvStore::format(const Options &options) {
+    const Geometry g = geometryFor<Header, Slot>(options);
+
+    std::memset(base, 0, size_t(g.arenaOffset)); // the arena's contents don't matter
+    std::memcpy(header->magic, Magic, sizeof(Magic));
+    header->version = Version;
+    header->budgetBytes = options.budgetBytes;
+    header->arenaBytes = g.arenaBytes;
+    header->maxEntries = options.maxEntries;
+    header->bucketCount = g.bucketCount;
+    expiring = 0;
+
+    // Free list in index order, so slots fill from the front
+    for (uint32_t i = options.maxEntries; i >= 1; --i) {
+        slots[i].chainNext = header->freeHead;
+        header->freeHead = i;
+    }
+}
+
+void KvStore::rebuild() {
+    const uint32_t maxEntries = header->maxEntries;
+    std::memset(buckets, 0, size_t(header->bucketCount) * sizeof(uint32_t));
+
+    // Keep slots whose bytes are intact and don't overlap an earlier entry
+    std::vector<uint32_t> live;
+    for (uint32_t i = 1; i <= maxEntries; ++i) {
+        Slot &slot = slots[i];
+        if (!slot.used) continue;
+        const uint64_t length = uint64_t(slot.keyLength) + slot.valueLength;
+        const bool intact = slot.offset <= header->arenaBytes && length <= header->arenaBytes - slot.offset
+            && hashKey(keyOf(slot)) == slot.hash && checksum(arena + slot.offset, length) == slot.check;
+        if (intact) live.push_back(i);
+        else slot.used = 0;
+    }
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+        return slots[a].offset < slots[b].offset;
+    });
+    uint64_t end = 0;
+    for (uint32_t &index : live) {
+        Slot &slot = slots[index];
+        if (slot.offset < end) {
+            slot.used = 0;
+            index = 0;
+            continue;
+        }
+        end = slot.offset + slot.keyLength + slot.valueLength;
+    }
+    live.erase(std::remove(live.begin(), live.end(), 0u), live.end());
+
+    // Relink oldest first, so the newest ends up at the head of the LRU list
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+        return slots[a].stamp < slots[b].stamp;
+    });
+    header->entries = 0;
+    header->liveBytes = 0;
+    header->lruHead = header->lruTail = 0;
+    header->clock = 0;
+    expiring = 0;
+    for (uint32_t index : live) {
+        Slot &slot = slots[index];
+        // A torn overwrite can leave the old entry behind; the newer one wins
+        const uint32_t older = find(keyOf(slot), slot.hash);
+        if (older) release(older);
+
+        uint32_t &bucket = buckets[slot.hash & (header->bucketCount - 1)];
+        slot.chainNext = bucket;
+        bucket = index;
+        pushFront(index);
+        header->entries++;
+        header->liveBytes += uint64_t(slot.keyLength) + slot.valueLength;
+        header->clock = std::max(header->clock, slot.stamp);
+        if (slot.expiresAtMs != NoExpiry) ++expiring;
+    }
+    header->arenaTail = end;
+
+    header->freeHead = 0;
+    for (uint32_t i = maxEntries; i >= 1; --i) {
+        if (slots[i].used) continue;
+        slots[i].chainNext = header->freeHead;
+        header->freeHead = i;
+    }
+}
+
+std::string_view KvStore::keyOf(const Slot &slot) const {
+    return std::string_view(arena + slot.offset, slot.keyLength);
+}
+
+bool KvStore::expired(const Slot &slot, int64_t nowMs) const {
+    return slot.expiresAtMs != NoExpiry && slot.expiresAtMs <= nowMs;
+}
+
+uint32_t KvStore::find(std::string_view key, uint64_t hash) const {
+    for (uint32_t i = buckets[hash & (header->bucketCount - 1)]; i != 0; i = slots[i].chainNext) {
+        const Slot &slot = slots[i];
+        if (slot.hash == hash && slot.keyLength == key.size() && keyOf(slot) == key) return i;
+    }
+    return 0;
+}
+
+void KvStore::unlink(uint32_t index) {
+    uint32_t *link = &buckets[slots[index].hash & (header->bucketCount - 1)];
+    while (*link != 0 && *link != index) link = &slots[*link].chainNext;
+    if (*link == index) *link = slots[index].chainNext;
+}
+
+void KvStore::release(uint32_t index) {
+    Slot &slot = slots[index];
+    unlink(index);
+    detachLru(index);
+    header->entries--;
+    header->liveBytes -= uint64_t(slot.keyLength) + slot.valueLength;
+    if (slot.expiresAtMs != NoExpiry) --expiring;
+    slot.used = 0;
+    slot.chainNext = header->freeHead;
+    header->freeHead = index;
+}
+
+void KvStore::pushFront(uint32_t index) {
+    Slot &slot = slots[index];
+    slot.lruPrev = 0;
+    slot.lruNext = header->lruHead;
+    if (header->lruHead) slots[header->lruHead].lruPrev = index;
+    header->lruHead = index;
+    if (!header->lruTail) header->lruTail = index;
+}
+
+void KvStore::detachLru(uint32_t index) {
+    Slot &slot = slots[index];
+    if (slot.lruPrev) slots[slot.lruPrev].lruNext = slot.lruNext;
+    else header->lruHead = slot.lruNext;
+    if (slot.lruNext) slots[slot.lruNext].lruPrev = slot.lruPrev;
+    else header->lruTail = slot.lruPrev;
+    slot.lruPrev = slot.lruNext = 0;
+}
+
+void KvStore::touch(uint32_t index) {
+    slots[index].stamp = ++header->clock;
+    if (header->lruHead == index) return;
+    detachLru(index);
+    pushFront(index);
+}
+
+void KvStore::evictOldest() {
+    release(header->lruTail);
+    header->evictions++;
+}
+
+void KvStore::compact() {
+    std::vector<uint32_t> live;
+    live.reserve(header->entries);
+    for (uint32_t i = header->lruHead; i != 0; i = slots[i].lruNext) live.push_back(i);
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+        return slots[a].offset < slots[b].offset;
+    });
+
+    // Sliding down in offset order only ever overwrites bytes already moved
+    uint64_t tail = 0;
+    for (uint32_t index : live) {
+        Slot &slot = slots[index];
+        const uint64_t length = uint64_t(slot.keyLength) + slot.valueLength;
+        if (slot.offset != tail) std::memmove(arena + tail, arena + slot.offset, size_t(length));
+        slot.offset = tail;
+        tail += length;
+    }
+    header->arenaTail = tail;
+    header->compactions++;
+}
+
+bool KvStore::get(std::string_view key, int64_t nowMs, std::string *value) {
+    if (!base) return false;
+    const uint32_t index = find(key, hashKey(key));
+    if (index && expired(slots[index], nowMs)) {
+        release(index);
+        header->expirations++;
+    } else if (index) {
+        const Slot &slot = slots[index];
+        value->assign(arena + slot.offset + slot.keyLength, slot.valueLength);
+        touch(index);
+        header->hits++;
+        return true;
+    }
+    header->misses++;
+    return false;
+}
+
+bool KvStore::contains(std::string_view key, int64_t nowMs) {
+    return expiresAt(key, nowMs) != -2;
+}
+
+bool KvStore::set(std::string_view key, std::string_view value, int64_t expiresAtMs, int64_t nowMs) {
+    if (!base) return false;
+    const uint64_t length = uint64_t(key.size()) + value.size();
+    if (length > header->budgetBytes || key.size() > UINT32_MAX || value.size() > UINT32_MAX) return false;
+    if (expiresAtMs != NoExpiry && expiresAtMs <= nowMs) {
+        remove(key);
+        return true;
+    }
+
+    const uint64_t hash = hashKey(key);
+    if (const uint32_t existing = find(key, hash)) release(existing);
+
+    while (header->entries > 0 && (header->liveBytes + length > header->budgetBytes || header->freeHead == 0))
+        evictOldest();
+    if (header->arenaTail + length > header->arenaBytes) compact();
+
+    const uint32_t index = header->freeHead;
+    Slot &slot = slots[index];
+    header->freeHead = slot.chainNext;
+
+    char *bytes = arena + header->arenaTail;
+    std::memcpy(bytes, key.data(), key.size());
+    std::memcpy(bytes + key.size(), value.data(), value.size());
+
+    slot.hash = hash;
+    slot.expiresAtMs = expiresAtMs;
+    slot.offset = header->arenaTail;
+    slot.keyLength = uint32_t(key.size());
+    slot.valueLength = uint32_t(value.size());
+    slot.check = checksum(bytes, length);
+    slot.used = 1;
+
+    uint32_t &bucket = buckets[hash & (header->bucketCount - 1)];
+    slot.chainNext = bucket;
+    bucket = index;
+    slot.stamp = ++header->clock;
+    pushFront(index);
+
+    header->arenaTail += length;
+    header->liveBytes += length;
+    header->entries++;
+    if (expiresAtMs != NoExpiry) ++expiring;
+    return true;
+}
+
+bool KvStore::remove(std::string_view key) {
+    if (!base) return false;
+    const uint32_t index = find(key, hashKey(key));
+    if (!index) return false;
+    release(index);
+    return true;
+}
+
+size_t KvStore::removePrefix(std::string_view prefix) {
+    if (!base) return 0;
+    size_t removed = 0;
+    for (uint32_t i = 1; i <= header->maxEntries; ++i) {
+        if (!slots[i].used || keyOf(slots[i]).substr(0, prefix.size()) != prefix) continue;
+        release(i);
+        ++removed;
+    }
+    return removed;
+}
+
+void KvStore::clear() {
+    if (!base) return;
+    Options options;
+    options.budgetBytes = header->budgetBytes;
+    options.maxEntries = header->maxEntries;
+    const Stats kept = stats();
+    format(options);
+    header->hits = kept.hits;
+    header->misses = kept.misses;
+    header->evictions = kept.evictions;
+    header->expirations = kept.expirations;
+    header->compactions = kept.compactions;
+}
+
+int64_t KvStore::expiresAt(std::string_view key, int64_t nowMs) {
+    if (!base) return -2;
+    const uint32_t index = find(key, hashKey(key));
+    if (!index) return -2;
+    if (expired(slots[index], nowMs)) {
+        release(index);
+        header->expirations++;
+        return -2;
+    }
+    return slots[index].expiresAtMs;
+}
+
+bool KvStore::setExpiry(std::string_view key, int64_t expiresAtMs, int64_t nowMs) {
+    if (expiresAt(key, nowMs) == -2) return false;
+    const uint32_t index = find(key, hashKey(key));
+    if (expiresAtMs != NoExpiry && expiresAtMs <= nowMs) {
+        release(index);
+        return true;
+    }
+    if ((slots[index].expiresAtMs != NoExpiry) != (expiresAtMs != NoExpiry)) {
+        if (expiresAtMs != NoExpiry) ++expiring;
+        else --expiring;
+    }
+    slots[index].expiresAtMs = expiresAtMs;
+    return true;
+}
+
+uint64_t KvStore::scan(uint64_t cursor, size_t count, std::string_view pattern, int64_t nowMs,
+                       std::vector<std::string> *keys) {
+    if (!base) return 0;
+    uint64_t i = std::max<uint64_t>(cursor, 1);
+    for (size_t visited = 0; i <= header->maxEntries && visited < std::max<size_t>(count, 1); ++i, ++visited) {
+        const Slot &slot = slots[i];
+        if (!slot.used || expired(slot, nowMs)) continue;
+        const std::string_view key = keyOf(slot);
+        if (pattern.empty() || globMatch(pattern, key)) keys->emplace_back(key);
+    }
+    return i > header->maxEntries ? 0 : i;
+}
+
+size_t KvStore::expireSome(int64_t nowMs, size_t maxChecks) {
+    if (!base) return 0;
+    size_t removed = 0;
+    for (size_t n = 0; n < maxChecks && header->entries > 0; ++n) {
+        if (expireCursor == 0 || expireCursor > header->maxEntries) expireCursor = 1;
+        const uint32_t index = expireCursor++;
+        if (!slots[index].used || !expired(slots[index], nowMs)) continue;
+        release(index);
+        header->expirations++;
+        ++removed;
+    }
+    return removed;
+}
+
+void KvStore::flush() {
+    if (!base) return;
+#ifdef _WIN32
+    FlushViewOfFile(base, 0);
+#else
+    msync(base, mappedBytes, MS_ASYNC);
+#endif
+}
+
+size_t KvStore::size() const {
+    return header ? header->entries : 0;
+}
+
+uint64_t KvStore::liveBytes() const {
+    return header ? header->liveBytes : 0;
+}
+
+uint64_t KvStore::budgetBytes() const {
+    return header ? header->budgetBytes : 0;
+}
+
+uint32_t KvStore::maxEntries() const {
+    return header ? header->maxEntries : 0;
+}
+
+KvStore::Stats KvStore::stats() const {
+    Stats s;
+    if (!header) return s;
+    s.hits = header->hits;
+    s.misses = header->misses;
+    s.evictions = header->evictions;
+    s.expirations = header->expirations;
+    s.compactions = header->compactions;
+    return s;
+}
+
+bool KvStore::globMatch(std::string_view pattern, std::string_view text) {
+    size_t p = 0, t = 0;
+    size_t starP = std::string_view::npos, starT = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starT = t;
+            continue;
+        }
+        if (p < pattern.size()) {
+            char expected = pattern[p];
+            size_t width = 1;
+            if (expected == '\\' && p + 1 < pattern.size()) {
+                expected = pattern[p + 1];
+                width = 2;
+            } else if (expected == '?') {
+                p += 1;
+                ++t;
+                continue;
+            }
+            if (expected == text[t]) {
+                p += width;
+                ++t;
+                continue;
+            }
+        }
+        // Mismatch: let the last * swallow one more character
+        if (starP == std::string_view::npos) return false;
+        p = starP + 1;
+        t = ++starT;
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
@@ -0,0 +1,128 @@
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// String key/value cache kept entirely in one memory-mapped file, so a
+// restart reopens it warm instead of reloading anything.
+//
+//   file := header, bucket[bucketCount], slot[maxEntries + 1], arena
+//
+// Buckets head chains of slots (slot 0 means none). Each slot points at its
+// key and value bytes in the arena and sits on an LRU list. Writes append to
+// the arena; the space freed by overwrites and removals is reclaimed by
+// compacting the arena when its tail reaches the end. Live key + value bytes
+// never exceed budgetBytes: older entries are evicted first.
+//
+// The header's clean flag is cleared while the file is open. Opening a file
+// that was not closed cleanly rebuilds the buckets and the LRU list from the
+// slots, dropping any slot whose key or value fails its checksum. The file
+// uses native byte order; it is a cache, not an interchange format. One
+// process at a time may open a file.
+class KvStore {
+public:
+    struct Options {
+        uint64_t budgetBytes = 64 << 20;
+        uint32_t maxEntries = 65536;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        uint64_t compactions = 0;
+    };
+
+    static constexpr int64_t NoExpiry = 0;
+
+    ~KvStore();
+
+    // Reuses an existing file with the same geometry, otherwise starts empty
+    bool open(const std::filesystem::path &path, const Options &options);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // nowMs and expiry times are wall-clock ms since the epoch, so TTLs
+    // survive restarts
+    bool get(std::string_view key, int64_t nowMs, std::string *value);
+    bool contains(std::string_view key, int64_t nowMs);
+    // False only when the entry can never fit in the budget
+    bool set(std::string_view key, std::string_view value, int64_t expiresAtMs, int64_t nowMs);
+    bool remove(std::string_view key);
+    size_t removePrefix(std::string_view prefix);
+    void clear();
+
+    // -2 when missing or expired, NoExpiry when the key never expires
+    int64_t expiresAt(std::string_view key, int64_t nowMs);
+    bool setExpiry(std::string_view key, int64_t expiresAtMs, int64_t nowMs);
+
+    // Redis-style cursor iteration over slots: visits about count slots from
+    // cursor, appends live keys matching the glob pattern and returns the
+    // next cursor, 0 when done. Keys present for the whole scan are reported
+    // at least once.
+    uint64_t scan(uint64_t cursor, size_t count, std::string_view pattern, int64_t nowMs,
+                  std::vector<std::string> *keys);
+
+    // Active expiry: checks up to maxChecks slots from a rotating position
+    size_t expireSome(int64_t nowMs, size_t maxChecks);
+
+    // Schedules dirty pages for writing; the OS does the rest
+    void flush();
+
+    size_t size() const;
+    size_t expiringCount() const { return expiring; } // keys with a TTL; nothing for expireSome() when 0
+    uint64_t liveBytes() const;
+    uint64_t budgetBytes() const;
+    uint32_t maxEntries() const;
+    Stats stats() const;
+    bool recovered() const { return recoveredOnOpen; } // last open repaired an unclean file
+    const std::string &lastError() const { return error; }
+
+    // Redis glob subset: * ? and backslash escapes
+    static bool globMatch(std::string_view pattern, std::string_view text);
+
+private:
+    struct Header;
+    struct Slot;
+
+    char *base = nullptr;
+    uint64_t mappedBytes = 0;
+    Header *header = nullptr;
+    uint32_t *buckets = nullptr;
+    Slot *slots = nullptr;
+    char *arena = nullptr;
+    uint32_t expireCursor = 1;
+    size_t expiring = 0;     // not in the file: recounted on open
+    bool recoveredOnOpen = false;
+    std::string error;
+
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    bool mapFile(const std::filesystem::path &path, uint64_t bytes, bool *created);
+    void unmapFile();
+    void format(const Options &options);
+    void rebuild();
+
+    uint32_t find(std::string_view key, uint64_t hash) const;
+    std::string_view keyOf(const Slot &slot) const;
+    bool expired(const Slot &slot, int64_t nowMs) const;
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void touch(uint32_t index);
+    void pushFront(uint32_t index);
+    void detachLru(uint32_t index);
+    void evictOldest();
+    void compact();
+};
+
+#endif // KVSTORE_H
@@ -0,0 +1,341 @@
+#include "promptbuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_set>
+#include "simhash.h"
+#include "textkernels.h"
+
+namespace {
+
+const size_t FullRelevanceMatches = 3;
+const size_t MinFingerprintBytes = 40; // shorter texts give unstable fingerprints
+const size_t MaxFingerprints = 64;     // per thread, newest
+const char Ellipsis[] = "\xE2\x80\xA6";
+const char ThreadEnd[] = "]}";
+
+inline bool isContinuation(char c) { return (uint8_t(c) & 0xC0) == 0x80; }
+
+void appendJsonString(std::string &out, std::string_view text) {
+    static const char Hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : text) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (uint8_t(c) < 0x20) {
+                out += "\\u00";
+                out.push_back(Hex[uint8_t(c) >> 4]);
+                out.push_back(Hex[uint8_t(c) & 0xF]);
+            } else {
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+void appendField(std::string &out, const char *name, std::string_view value) {
+    if (value.empty()) return;
+    if (out.back() != '{') out.push_back(',');
+    out.push_back('"');
+    out += name;
+    out += "\":";
+    appendJsonString(out, value);
+}
+
+std::string renderEvent(const PromptBuilder::Event &event, std::string_view text) {
+    std::string out = "{";
+    appendField(out, "timestamp", event.timestamp);
+    appendField(out, "app_name", event.app);
+    appendField(out, "window_name", event.window);
+    appendField(out, "browser_url", event.url);
+    appendField(out, "text", text);
+    if (event.delta) out += out.size() > 1 ? ",\"delta\":true" : "\"delta\":true";
+    out.push_back('}');
+    return out;
+}
+
+// FNV-1a over each field and a separator, then the splitmix64 finaliser
+class FieldHash {
+public:
+    explicit FieldHash(char kind) { add(std::string_view(&kind, 1)); }
+
+    FieldHash &add(std::string_view field) {
+        for (char c : field) mix(uint8_t(c));
+        mix(0x1F);
+        return *this;
+    }
+
+    uint64_t value() const {
+        uint64_t h = state;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+private:
+    uint64_t state = 0xcbf29ce484222325ULL;
+
+    void mix(uint8_t c) {
+        state ^= c;
+        state *= 0x100000001b3ULL;
+    }
+};
+
+uint64_t eventKey(const PromptBuilder::Event &event) {
+    return FieldHash('e').add(event.timestamp).add(event.app).add(event.window).add(event.url)
+        .add(event.text).add(event.delta ? "1" : "0").value();
+}
+
+// Up to the opening of the events array
+std::string renderThreadStart(const std::string &topic) {
+    std::string out = "{\"topic\":";
+    appendJsonString(out, topic);
+    out += ",\"events\":[";
+    return out;
+}
+
+struct Candidate {
+    size_t thread;
+    size_t event;
+    size_t sourceTokens;   // whole and uncut
+    size_t overheadTokens; // with the text cut to nothing
+    double score;
+    std::string text;
+    bool truncated;
+};
+
+} // namespace
+
+PromptBuilder::PromptBuilder(TextChunker::TokenCounter counter)
+    : counter(counter ? std::move(counter) : TextChunker::TokenCounter(estimateTokens)) {}
+
+std::string PromptBuilder::truncate(std::string_view text, size_t maxTokens) const {
+    if (counter(text) <= maxTokens) return std::string(text);
+    const size_t ellipsisTokens = counter(Ellipsis);
+    const size_t limit = maxTokens > ellipsisTokens ? maxTokens - ellipsisTokens : 0;
+
+    // Longest prefix within limit; prefix counts only ever grow by a token
+    // or so at a time, so a binary search lands within a character of it
+    size_t fits = 0, over = text.size();
+    while (fits + 1 < over) {
+        const size_t mid = fits + (over - fits) / 2;
+        if (counter(text.substr(0, mid)) <= limit) fits = mid;
+        else over = mid;
+    }
+    size_t cut = fits;
+    while (cut > 0 && cut < text.size() && isContinuation(text[cut])) --cut;
+
+    // Between words, if that gives up no more than a fifth
+    const size_t space = cut > 0 ? text.find_last_of(" \t\n", cut - 1) : std::string_view::npos;
+    if (space != std::string_view::npos && space >= cut - cut / 5) cut = space;
+    while (cut > 0 && (text[cut - 1] == ' ' || text[cut - 1] == '\t' || text[cut - 1] == '\n')) --cut;
+
+    return std::string(text.substr(0, cut)) + Ellipsis;
+}
+
+PromptBuilder::Result PromptBuilder::build(const std::vector<Thread> &threads,
+                                           const std::vector<std::string> &keywords,
+                                           const Options &options) const {
+    Result result;
+
+    std::vector<std::string> needles;
+    for (const std::string &keyword : keywords) {
+        std::string needle = normalizeText(keyword);
+        if (!needle.empty()) needles.push_back(std::move(needle));
+    }
+
+    // Every event with text, newest first; the source as it would have been
+    // sent whole
+    struct Ref {
+        size_t thread;
+        size_t event;
+        Facts facts;
+    };
+    std::vector<Ref> order;
+    int64_t newest = 0;
+    // Worked out only the first time a topic or event is seen
+    const auto factsOf = [&](uint64_t key, const auto &work) -> Facts {
+        const auto cached = facts.find(key);
+        if (cached != facts.end()) return cached->second;
+        if (facts.size() >= CacheLimit) facts.clear();
+        return facts.emplace(key, work()).first->second;
+    };
+    std::string normalized;
+    result.sourceTokens = counter("[]");
+    for (size_t t = 0; t < threads.size(); ++t) {
+        const std::string &topic = threads[t].topic;
+        result.sourceTokens += factsOf(FieldHash('t').add(topic).value(), [&] {
+            Facts topicFacts;
+            topicFacts.sourceTokens = uint32_t(counter(renderThreadStart(topic) + ThreadEnd));
+            return topicFacts;
+        }).sourceTokens + 1;
+        for (size_t e = 0; e < threads[t].events.size(); ++e) {
+            const Event &event = threads[t].events[e];
+            if (event.text.empty()) continue;
+            const Facts eventFacts = factsOf(eventKey(event), [&] {
+                Facts out;
+                out.sourceTokens = uint32_t(counter(renderEvent(event, event.text)));
+                out.overheadTokens = uint32_t(counter(renderEvent(event, Ellipsis)));
+                normalizeText(event.text, normalized);
+                if (normalized.size() >= MinFingerprintBytes) out.print = simhash(normalized);
+                return out;
+            });
+            order.push_back({t, e, eventFacts});
+            newest = std::max(newest, event.timeMs);
+            result.sourceTokens += eventFacts.sourceTokens + 1;
+        }
+    }
+    result.events = order.size();
+    std::reverse(order.begin(), order.end()); // later in a thread is newer on a tie
+    std::stable_sort(order.begin(), order.end(), [&](const Ref &a, const Ref &b) {
+        return threads[a.thread].events[a.event].timeMs > threads[b.thread].events[b.event].timeMs;
+    });
+
+    // Drop repeats, keeping the newest, and score what is left
+    std::unordered_set<size_t> seen;
+    std::vector<std::vector<uint64_t>> prints(threads.size());
+    std::vector<Candidate> candidates;
+    std::string haystack;
+    for (const Ref &ref : order) {
+        const Thread &thread = threads[ref.thread];
+        const Event &event = thread.events[ref.event];
+        normalizeText(event.text, normalized);
+        if (normalized.empty() || !seen.insert(std::hash<std::string>{}(normalized)).second) {
+            ++result.duplicates;
+            continue;
+        }
+        if (normalized.size() >= MinFingerprintBytes) {
+            const uint64_t print = ref.facts.print;
+            std::vector<uint64_t> &recent = prints[ref.thread];
+            const bool repeat = std::any_of(recent.begin(), recent.end(), [&](uint64_t other) {
+                return hammingDistance(print, other) <= options.duplicateDistance;
+            });
+            if (repeat) {
+                ++result.duplicates;
+                continue;
+            }
+            recent.push_back(print);
+            if (recent.size() > MaxFingerprints) recent.erase(recent.begin());
+        }
+
+        haystack.clear();
+        appendNormalizedText(thread.topic, haystack);
+        appendNormalizedText(event.window, haystack);
+        haystack.push_back(TextSeparator);
+        haystack += normalized;
+        size_t matches = 0;
+        for (const std::string &needle : needles) {
+            if (haystack.find(needle) != std::string::npos) ++matches;
+        }
+
+        const double relevance = std::min(1.0, double(matches) / double(FullRelevanceMatches));
+        const double recency = event.timeMs > 0
+            ? std::exp2(-double(newest - event.timeMs) / double(std::max<int64_t>(options.halfLifeMs, 1)))
+            : 0.0;
+
+        candidates.push_back({ref.thread, ref.event, ref.facts.sourceTokens, ref.facts.overheadTokens,
+                              recency * (1.0 + options.relevanceWeight * relevance), {}, false});
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        return a.score > b.score;
+    });
+
+    // Best first while they fit, capped only once taken so the cost stays
+    // with what is kept; a comma is a token before every element but the
+    // first, counted for all of them to stay on the safe side
+    std::vector<bool> opened(threads.size(), false);
+    std::vector<size_t> chosen;
+    size_t used = counter("[]");
+    for (size_t i = 0; i < candidates.size() && used + options.minEventTokens < options.maxTokens; ++i) {
+        Candidate &candidate = candidates[i];
+        const Event &event = threads[candidate.thread].events[candidate.event];
+        const size_t opening = opened[candidate.thread]
+            ? 0 : counter(renderThreadStart(threads[candidate.thread].topic) + ThreadEnd) + 1;
+        // Once the budget is nearly spent most events can't be cut to fit;
+        // ruled out on their fields alone, before any truncating
+        if (used + opening + candidate.sourceTokens + 1 > options.maxTokens &&
+            used + opening + candidate.overheadTokens + 1 + options.minEventTokens > options.maxTokens) continue;
+        candidate.text = truncate(event.text, options.maxEventTokens);
+        candidate.truncated = candidate.text.size() != event.text.size();
+
+        size_t tokens = counter(renderEvent(event, candidate.text)) + 1;
+        if (used + opening + tokens > options.maxTokens) {
+            const size_t overhead = candidate.overheadTokens + 1;
+            const size_t left = options.maxTokens > used + opening ? options.maxTokens - used - opening : 0;
+            if (left < overhead + options.minEventTokens) continue;
+            candidate.text = truncate(candidate.text, left - overhead);
+            candidate.truncated = true;
+            tokens = counter(renderEvent(event, candidate.text)) + 1;
+            if (used + opening + tokens > options.maxTokens) continue;
+        }
+        used += opening + tokens;
+        opened[candidate.thread] = true;
+        chosen.push_back(i);
+    }
+
+    // Threads newest first, events in time order
+    auto render = [&]() {
+        std::vector<size_t> byThread = chosen;
+        std::stable_sort(byThread.begin(), byThread.end(), [&](size_t a, size_t b) {
+            const Candidate &x = candidates[a], &y = candidates[b];
+            if (x.thread != y.thread) return x.thread < y.thread;
+            const int64_t tx = threads[x.thread].events[x.event].timeMs, ty = threads[y.thread].events[y.event].timeMs;
+            return tx != ty ? tx < ty : x.event < y.event;
+        });
+
+        struct Group {
+            size_t thread;
+            int64_t latest;
+            std::string json;
+        };
+        std::vector<Group> groups;
+        for (size_t index : byThread) {
+            const Candidate &candidate = candidates[index];
+            const Event &event = threads[candidate.thread].events[candidate.event];
+            if (groups.empty() || groups.back().thread != candidate.thread) {
+                groups.push_back({candidate.thread, 0, renderThreadStart(threads[candidate.thread].topic)});
+            } else {
+                groups.back().json.push_back(',');
+            }
+            groups.back().latest = std::max(groups.back().latest, event.timeMs);
+            groups.back().json += renderEvent(event, candidate.text);
+        }
+        std::stable_sort(groups.begin(), groups.end(), [](const Group &a, const Group &b) {
+            return a.latest > b.latest;
+        });
+
+        std::string json = "[";
+        for (const Group &group : groups) {
+            if (json.size() > 1) json.push_back(',');
+            json += group.json;
+            json += ThreadEnd;
+        }
+        json.push_back(']');
+        return json;
+    };
+
+    // Counts of the parts don't quite add up to the count of the whole;
+    // drop the lowest ranked events until it fits
+    result.json = render();
+    result.tokens = counter(result.json);
+    while (result.tokens > options.maxTokens && !chosen.empty()) {
+        chosen.pop_back();
+        result.json = render();
+        result.tokens = counter(result.json);
+    }
+
+    result.kept = chosen.size();
+    for (size_t index : chosen) {
+        if (candidates[index].truncated) ++result.truncated;
+    }
+    return result;
+}
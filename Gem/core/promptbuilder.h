@@ -0,0 +1,88 @@
+#ifndef PROMPTBUILDER_H
+#define PROMPTBUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "textchunker.h"
+
+// Fits topic threads into a prompt's token budget, as compact JSON.
+//
+// Events are deduplicated first, keeping the newest: the same normalised
+// text anywhere, and near-repeats (SimHash within duplicateDistance bits)
+// within a thread. The rest are ranked by recency, a weight that halves
+// every halfLifeMs behind the newest event, times relevance, 1 +
+// relevanceWeight once an event mentions three of the keywords. Event texts
+// are capped at maxEventTokens, and events are taken best first while they
+// fit; one that doesn't is cut to what is left of the budget if that is at
+// least minEventTokens. Threads come out newest first with their events in
+// time order, and nothing but the events' own fields.
+//
+// What build() works out from an event alone (token counts, fingerprint) is
+// cached by a hash of its fields, as is each topic's count, since a
+// session's threads come back with every request; build() is therefore not
+// safe to call from two threads at once.
+class PromptBuilder {
+public:
+    struct Options {
+        size_t maxTokens = 3000;
+        size_t maxEventTokens = 400;
+        size_t minEventTokens = 48;
+        int64_t halfLifeMs = 2 * 60 * 1000;
+        double relevanceWeight = 2.0;
+        int duplicateDistance = 3;
+    };
+
+    struct Event {
+        std::string timestamp;
+        int64_t timeMs = 0; // 0 when unknown: ranked as the oldest
+        std::string app;
+        std::string window;
+        std::string url;
+        std::string text;
+        bool delta = false;
+    };
+
+    struct Thread {
+        std::string topic;
+        std::vector<Event> events;
+    };
+
+    struct Result {
+        std::string json;
+        size_t tokens = 0;       // of json
+        size_t sourceTokens = 0; // of every thread and event as given, compact
+        size_t events = 0;       // with any text
+        size_t kept = 0;
+        size_t duplicates = 0;
+        size_t truncated = 0;
+    };
+
+    explicit PromptBuilder(TextChunker::TokenCounter counter = estimateTokens);
+
+    Result build(const std::vector<Thread> &threads, const std::vector<std::string> &keywords,
+                 const Options &options) const;
+
+    size_t countTokens(std::string_view text) const { return counter(text); }
+
+    // Longest prefix of text within maxTokens, ending between words where
+    // that loses little, with an ellipsis when anything was cut
+    std::string truncate(std::string_view text, size_t maxTokens) const;
+
+private:
+    static constexpr size_t CacheLimit = 1 << 16;
+
+    struct Facts {
+        uint32_t sourceTokens = 0;   // rendered whole, compact
+        uint32_t overheadTokens = 0; // rendered with the text cut to nothing
+        uint64_t print = 0;          // of the normalised text; 0 when too short
+    };
+
+    TextChunker::TokenCounter counter;
+    mutable std::unordered_map<uint64_t, Facts> facts; // fields hash -> facts
+};
+
+#endif // PROMPTBUILDER_H
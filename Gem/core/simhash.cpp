@@ -0,0 +1,148 @@
+#include "simhash.h"
+#include <algorithm>
+
+namespace {
+
+inline uint64_t mix(uint64_t x) {
+    // splitmix64 finaliser
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t hashBytes(std::string_view bytes) {
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (char c : bytes) {
+        h ^= uint8_t(c);
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+inline bool isWordByte(uint8_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+inline void vote(int32_t *votes, uint64_t hash) {
+    for (int bit = 0; bit < 64; ++bit)
+        votes[bit] += (hash >> bit) & 1 ? 1 : -1;
+}
+
+} // namespace
+
+uint64_t simhash(std::string_view text) {
+    int32_t votes[64] = {};
+    std::string word;
+    uint64_t previous = 0;
+    bool havePrevious = false;
+
+    auto flush = [&]() {
+        if (word.empty()) return;
+        const uint64_t hash = mix(hashBytes(word));
+        vote(votes, hash);
+        if (havePrevious) vote(votes, mix(previous * 31 + hash));
+        previous = hash;
+        havePrevious = true;
+        word.clear();
+    };
+
+    for (char ch : text) {
+        const uint8_t c = uint8_t(ch);
+        if (isWordByte(c)) {
+            word.push_back(char(c >= 'A' && c <= 'Z' ? c + 32 : c));
+        } else {
+            flush();
+        }
+    }
+    flush();
+
+    uint64_t fingerprint = 0;
+    for (int bit = 0; bit < 64; ++bit)
+        if (votes[bit] > 0) fingerprint |= uint64_t(1) << bit;
+    return fingerprint;
+}
+
+NearDuplicateIndex::NearDuplicateIndex(int maxDistance, size_t capacity)
+    : distanceLimit(std::clamp(maxDistance, 0, 15)),
+      bandCount(distanceLimit + 1),
+      bandWidth(64 / bandCount),
+      widerBands(64 % bandCount),
+      entries(std::max<size_t>(capacity, 1)) {}
+
+uint64_t NearDuplicateIndex::bandKey(uint64_t scope, uint64_t fingerprint, int band) const {
+    // The first widerBands bands take a bit more each, so every band has
+    // bits and together they cover all 64
+    const int shift = band * bandWidth + std::min(band, widerBands);
+    const int width = bandWidth + (band < widerBands ? 1 : 0);
+    const uint64_t mask = width >= 64 ? ~uint64_t(0) : ((uint64_t(1) << width) - 1);
+    const uint64_t bits = (fingerprint >> shift) & mask;
+    return mix(scope ^ mix(bits * 64 + uint64_t(band)));
+}
+
+NearDuplicateIndex::Match NearDuplicateIndex::lookup(std::string_view scope, uint64_t fingerprint) {
+    const uint64_t scopeHash = hashBytes(scope);
+    Match best;
+
+    for (int band = 0; band < bandCount; ++band) {
+        auto it = buckets.find(bandKey(scopeHash, fingerprint, band));
+        if (it == buckets.end()) continue;
+
+        for (uint32_t slot : it->second) {
+            const Entry &entry = entries[slot];
+            if (entry.scope != scopeHash) continue;
+            const int distance = hammingDistance(entry.fingerprint, fingerprint);
+            if (distance <= distanceLimit && (!best || distance < best.distance)) {
+                best.payload = &entry.payload;
+                best.distance = distance;
+                if (distance == 0) break;
+            }
+        }
+        if (best && best.distance == 0) break;
+    }
+
+    if (best) ++counters.hits;
+    else ++counters.misses;
+    return best;
+}
+
+void NearDuplicateIndex::unlink(uint32_t slot) {
+    const Entry &entry = entries[slot];
+    for (int band = 0; band < bandCount; ++band) {
+        auto it = buckets.find(bandKey(entry.scope, entry.fingerprint, band));
+        if (it == buckets.end()) continue;
+        std::vector<uint32_t> &slots = it->second;
+        slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+        if (slots.empty()) buckets.erase(it);
+    }
+}
+
+void NearDuplicateIndex::insert(std::string_view scope, uint64_t fingerprint, std::string payload) {
+    const uint32_t slot = uint32_t(next);
+    if (count == entries.size()) {
+        unlink(slot);
+        ++counters.evictions;
+    } else {
+        ++count;
+    }
+
+    Entry &entry = entries[slot];
+    entry.scope = hashBytes(scope);
+    entry.fingerprint = fingerprint;
+    entry.payload = std::move(payload);
+
+    for (int band = 0; band < bandCount; ++band)
+        buckets[bandKey(entry.scope, fingerprint, band)].push_back(slot);
+
+    next = (next + 1) % entries.size();
+    ++counters.inserts;
+}
+
+void NearDuplicateIndex::clear() {
+    buckets.clear();
+    for (Entry &entry : entries) entry = Entry();
+    next = 0;
+    count = 0;
+}
@@ -0,0 +1,79 @@
+#ifndef SIMHASH_H
+#define SIMHASH_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 64-bit SimHash of OCR text. Words (ASCII-folded runs of letters, digits
+// and non-ASCII bytes) and adjacent word pairs each vote on every bit, so a
+// few changed tokens — a clock, a cursor, one scrolled line — move the
+// fingerprint by only a few bits.
+uint64_t simhash(std::string_view text);
+
+inline int hammingDistance(uint64_t a, uint64_t b) {
+    uint64_t x = a ^ b;
+    int count = 0;
+    while (x) {
+        x &= x - 1;
+        ++count;
+    }
+    return count;
+}
+
+// Recent fingerprints per scope (app + window), each carrying a payload.
+// Lookup is banded LSH: the 64 bits are cut into maxDistance + 1 bands, so
+// any fingerprint within maxDistance of a stored one shares at least one
+// band with it exactly and only those bucket entries are compared. The
+// oldest entry is evicted once capacity is reached.
+class NearDuplicateIndex {
+public:
+    struct Match {
+        const std::string *payload = nullptr;
+        int distance = -1;
+        explicit operator bool() const { return payload != nullptr; }
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t inserts = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit NearDuplicateIndex(int maxDistance = 6, size_t capacity = 4096);
+
+    // Closest stored fingerprint in scope within maxDistance; counts a hit
+    // or a miss. The payload pointer is valid until the next insert.
+    Match lookup(std::string_view scope, uint64_t fingerprint);
+    void insert(std::string_view scope, uint64_t fingerprint, std::string payload);
+    void clear();
+
+    int maxDistance() const { return distanceLimit; }
+    size_t size() const { return count; }
+    const Stats &stats() const { return counters; }
+
+private:
+    struct Entry {
+        uint64_t scope = 0;
+        uint64_t fingerprint = 0;
+        std::string payload;
+    };
+
+    int distanceLimit;
+    int bandCount;
+    int bandWidth;  // bits in the narrower bands
+    int widerBands; // bands with one bit more
+    std::vector<Entry> entries;  // ring buffer
+    size_t next = 0;
+    size_t count = 0;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+    Stats counters;
+
+    uint64_t bandKey(uint64_t scope, uint64_t fingerprint, int band) const;
+    void unlink(uint32_t slot);
+};
+
+#endif // SIMHASH_H
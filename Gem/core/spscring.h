@@ -0,0 +1,63 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bounded single-producer / single-consumer queue. push() and pop() are
+// wait-free: one slot copy and one release store each, no locks and no
+// allocation after construction. When the consumer falls behind, push()
+// drops the new item and counts it instead of blocking the producer.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer side
+    bool push(const T &item) {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) > mask) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[tail & mask] = item;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T &item) {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire)) return false;
+        item = slots[head & mask];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate unless called from the consumer with the producer idle
+    size_t size() const {
+        return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask + 1; }
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    // Each index is written by one side only; keep them on separate lines
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+    std::atomic<uint64_t> droppedCount{0};
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,196 @@
+#include "textchunker.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+inline bool isAlpha(uint8_t c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+inline bool isDigit(uint8_t c) { return c >= '0' && c <= '9'; }
+inline bool isSpace(uint8_t c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+inline bool isContinuation(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+inline uint64_t hashBytes(std::string_view bytes) {
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (char c : bytes) {
+        h ^= uint8_t(c);
+        h *= 0x100000001b3ULL;
+    }
+    // splitmix64 finaliser, so the top bits are usable on their own
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+// End of the whitespace run starting at i
+inline size_t skipSpace(std::string_view text, size_t i) {
+    while (i < text.size() && isSpace(uint8_t(text[i]))) ++i;
+    return i;
+}
+
+// Back off to the start of the character containing byte i
+inline size_t characterStart(std::string_view text, size_t i) {
+    while (i > 0 && i < text.size() && isContinuation(uint8_t(text[i]))) --i;
+    return i;
+}
+
+} // namespace
+
+size_t estimateTokens(std::string_view text) {
+    size_t tokens = 0;
+    size_t i = 0;
+    const size_t n = text.size();
+    while (i < n) {
+        const uint8_t c = uint8_t(text[i]);
+        size_t j = i + 1;
+        if (isAlpha(c)) {
+            while (j < n && isAlpha(uint8_t(text[j]))) ++j;
+            tokens += 1 + (j - i - 1) / 6;
+        } else if (isDigit(c)) {
+            while (j < n && isDigit(uint8_t(text[j]))) ++j;
+            tokens += (j - i + 2) / 3; // digits go in groups of up to three
+        } else if (isSpace(c)) {
+            // A single space rides along with the next word
+            bool newline = c == '\n';
+            while (j < n && isSpace(uint8_t(text[j]))) newline |= text[j++] == '\n';
+            if (j - i > 1 || newline) ++tokens;
+        } else if (c >= 0x80) {
+            while (j < n && isContinuation(uint8_t(text[j]))) ++j;
+            ++tokens;
+        } else {
+            ++tokens;
+        }
+        i = j;
+    }
+    return tokens;
+}
+
+TextChunker::TextChunker(const Options &options, TokenCounter counter)
+    : options(options), counter(counter ? std::move(counter) : TokenCounter(estimateTokens))
+{
+    this->options.maxTokens = std::max<size_t>(this->options.maxTokens, 1);
+    if (this->options.overlapTokens >= this->options.maxTokens)
+        this->options.overlapTokens = this->options.maxTokens / 4;
+}
+
+std::vector<TextChunker::Chunk> TextChunker::split(std::string_view text) const {
+    std::vector<Chunk> chunks;
+    if (text.empty()) return chunks;
+
+    const size_t bodyBudget = options.maxTokens - options.overlapTokens;
+    const size_t minBody = bodyBudget / 2;
+    const std::vector<Unit> all = units(text, bodyBudget);
+
+    size_t total = 0;
+    for (const Unit &unit : all) total += unit.tokens;
+    if (total <= options.maxTokens) {
+        chunks.push_back(Chunk{0, 0, text.size(), total});
+        return chunks;
+    }
+
+    size_t i = 0;
+    size_t previousBody = 0;
+    while (i < all.size()) {
+        const size_t bodyStart = i;
+        size_t body = 0;
+        while (i < all.size()) {
+            if (body > 0 && body + all[i].tokens > bodyBudget) break;
+            body += all[i].tokens;
+            ++i;
+            if (body >= minBody && all[i - 1].cut) break;
+        }
+
+        // Trailing units of the previous chunk's body, as many as fit
+        size_t first = bodyStart;
+        size_t overlap = 0;
+        while (first > previousBody && overlap + all[first - 1].tokens <= options.overlapTokens) {
+            --first;
+            overlap += all[first].tokens;
+        }
+
+        chunks.push_back(Chunk{all[first].begin, all[bodyStart].begin, all[i - 1].end, body + overlap});
+        previousBody = bodyStart;
+    }
+    return chunks;
+}
+
+// Sentences end at . ! ? followed by whitespace, lines at a newline; the
+// whitespace after the end belongs to the unit
+std::vector<TextChunker::Unit> TextChunker::units(std::string_view text, size_t bodyBudget) const {
+    std::vector<Unit> out;
+    // Cut probability per token such that a chunk ends, on average, midway
+    // between half and all of the budget
+    const double cutRate = 2.0 / double(std::max<size_t>(bodyBudget - bodyBudget / 2, 1));
+
+    auto emit = [&](size_t begin, size_t end) {
+        const std::string_view piece = text.substr(begin, end - begin);
+        const size_t tokens = counter(piece);
+        if (tokens > bodyBudget) {
+            splitOversized(text, begin, end, bodyBudget, out);
+            return;
+        }
+        const double threshold = std::min(1.0, double(tokens) * cutRate) * 4294967296.0;
+        out.push_back(Unit{begin, end, tokens, double(hashBytes(piece) >> 32) < threshold});
+    };
+
+    size_t start = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        const char c = text[i];
+        const bool terminator = c == '.' || c == '!' || c == '?';
+        if (c == '\n' || (terminator && (i + 1 == text.size() || isSpace(uint8_t(text[i + 1]))))) {
+            i = skipSpace(text, i + 1);
+            emit(start, i);
+            start = i;
+        } else {
+            ++i;
+        }
+    }
+    if (start < text.size()) emit(start, text.size());
+    return out;
+}
+
+// A unit too big for a chunk on its own: split between words, and a word
+// too big on its own between characters
+void TextChunker::splitOversized(std::string_view text, size_t begin, size_t end, size_t bodyBudget,
+                                 std::vector<Unit> &out) const {
+    size_t pieceBegin = begin;
+    size_t pieceTokens = 0;
+    size_t i = begin;
+    while (i < end) {
+        size_t wordEnd = i;
+        while (wordEnd < end && !isSpace(uint8_t(text[wordEnd]))) ++wordEnd;
+        wordEnd = std::min(skipSpace(text, wordEnd), end);
+
+        size_t wordTokens = counter(text.substr(i, wordEnd - i));
+        if (pieceTokens > 0 && pieceTokens + wordTokens > bodyBudget) {
+            out.push_back(Unit{pieceBegin, i, pieceTokens, false});
+            pieceBegin = i;
+            pieceTokens = 0;
+        }
+
+        while (wordTokens > bodyBudget) {
+            // Shrink towards a prefix that fits, keeping whole characters
+            size_t length = wordEnd - i;
+            size_t tokens = wordTokens;
+            while (tokens > bodyBudget && length > 1) {
+                const size_t shrunk = std::max<size_t>(length * bodyBudget / tokens, 1);
+                length = std::max<size_t>(characterStart(text, i + std::min(shrunk, length - 1)) - i, 1);
+                tokens = counter(text.substr(i, length));
+            }
+            length = std::max<size_t>(characterStart(text, i + length) - i, 1);
+            if (characterStart(text, i + length) == i) // a lone multi-byte character
+                while (i + length < wordEnd && isContinuation(uint8_t(text[i + length]))) ++length;
+            out.push_back(Unit{i, i + length, counter(text.substr(i, length)), false});
+            i += length;
+            pieceBegin = i;
+            wordTokens = counter(text.substr(i, wordEnd - i));
+        }
+
+        pieceTokens += wordTokens;
+        i = wordEnd;
+    }
+    if (i > pieceBegin) out.push_back(Unit{pieceBegin, i, pieceTokens, false});
+}
@@ -0,0 +1,66 @@
+#ifndef TEXTCHUNKER_H
+#define TEXTCHUNKER_H
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Rough token count for the chat models' BPE vocabularies: about one token
+// per short word, more for long words and digit runs, one per punctuation
+// mark or non-ASCII character. Errs on the high side.
+size_t estimateTokens(std::string_view text);
+
+// Splits a long document into chunks that each fit a token budget, for
+// summarising piecewise.
+//
+// The text is cut into units — sentences, or lines where there is no
+// punctuation — and consecutive units are packed into chunks. Where a chunk
+// ends is decided by the content: past half the budget, a chunk ends after
+// the first unit whose hash falls under a threshold proportional to its
+// size (and always before it would overflow). An edit therefore only moves
+// the boundaries around it, and chunks further on come out byte-identical,
+// which is what lets per-chunk results be cached.
+//
+// Each chunk after the first starts with up to overlapTokens of the
+// previous chunk's trailing units, so no sentence loses its context.
+// Offsets are in bytes of the UTF-8 input; cuts never split a character.
+class TextChunker {
+public:
+    struct Options {
+        size_t maxTokens = 2048;    // per chunk, overlap included
+        size_t overlapTokens = 128;
+    };
+
+    struct Chunk {
+        size_t begin = 0;       // overlap starts here
+        size_t bodyBegin = 0;   // new text starts here
+        size_t end = 0;
+        size_t tokens = 0;
+    };
+
+    using TokenCounter = std::function<size_t(std::string_view)>;
+
+    explicit TextChunker(const Options &options, TokenCounter counter = estimateTokens);
+
+    std::vector<Chunk> split(std::string_view text) const;
+
+    size_t countTokens(std::string_view text) const { return counter(text); }
+
+private:
+    struct Unit {
+        size_t begin;
+        size_t end;
+        size_t tokens;
+        bool cut; // content-defined boundary after this unit
+    };
+
+    Options options;
+    TokenCounter counter;
+
+    std::vector<Unit> units(std::string_view text, size_t bodyBudget) const;
+    void splitOversized(std::string_view text, size_t begin, size_t end, size_t bodyBudget,
+                        std::vector<Unit> &out) const;
+};
+
+#endif // TEXTCHUNKER_H
@@ -0,0 +1,290 @@
+#include "textdelta.h"
+#include <algorithm>
+
+namespace {
+
+inline uint64_t mix(uint64_t x) {
+    // splitmix64 finaliser
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline bool isSpace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isPunctuation(uint8_t c) {
+    return (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+}
+
+// Myers over a[0, n) and b[0, m), what is left once the common ends are
+// trimmed; matches are offset by base. trace[d] keeps the furthest x on
+// diagonals -d..d before round d, which is all the walk back needs.
+bool myers(const uint64_t *a, int n, const uint64_t *b, int m, size_t maxEdits, uint32_t base,
+           std::vector<std::pair<uint32_t, uint32_t>> &matches) {
+    if (n == 0 || m == 0) return size_t(n) + size_t(m) <= maxEdits;
+
+    const int limit = int(std::min(size_t(n) + size_t(m), maxEdits));
+    const int offset = limit + 1;
+    std::vector<int> v(size_t(2 * limit + 3), 0);
+    std::vector<std::vector<int>> trace;
+
+    int edits = -1;
+    for (int d = 0; d <= limit && edits < 0; ++d) {
+        trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                ? v[offset + k + 1]
+                : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && a[x] == b[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                edits = d;
+                break;
+            }
+        }
+    }
+    if (edits < 0) return false;
+
+    const size_t first = matches.size();
+    int x = n, y = m;
+    for (int d = edits; d > 0; --d) {
+        const std::vector<int> &previous = trace[size_t(d)];
+        auto furthest = [&](int k) { return previous[size_t(k + d)]; };
+        const int k = x - y;
+        const int fromK = (k == -d || (k != d && furthest(k - 1) < furthest(k + 1))) ? k + 1 : k - 1;
+        const int fromX = furthest(fromK);
+        const int fromY = fromX - fromK;
+        while (x > fromX && y > fromY) {
+            --x;
+            --y;
+            matches.emplace_back(base + uint32_t(x), base + uint32_t(y));
+        }
+        x = fromX;
+        y = fromY;
+    }
+    while (x > 0 && y > 0) {
+        --x;
+        --y;
+        matches.emplace_back(base + uint32_t(x), base + uint32_t(y));
+    }
+    std::reverse(matches.begin() + std::ptrdiff_t(first), matches.end());
+    return true;
+}
+
+} // namespace
+
+bool diffSequences(const uint64_t *a, size_t n, const uint64_t *b, size_t m, size_t maxEdits,
+                   std::vector<std::pair<uint32_t, uint32_t>> &matches) {
+    matches.clear();
+
+    size_t prefix = 0;
+    while (prefix < n && prefix < m && a[prefix] == b[prefix]) ++prefix;
+    size_t suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix && a[n - 1 - suffix] == b[m - 1 - suffix]) ++suffix;
+
+    for (size_t i = 0; i < prefix; ++i) matches.emplace_back(uint32_t(i), uint32_t(i));
+    if (!myers(a + prefix, int(n - prefix - suffix), b + prefix, int(m - prefix - suffix), maxEdits,
+               uint32_t(prefix), matches)) {
+        matches.clear();
+        return false;
+    }
+    for (size_t i = 0; i < suffix; ++i)
+        matches.emplace_back(uint32_t(n - suffix + i), uint32_t(m - suffix + i));
+    return true;
+}
+
+TextDeltaTracker::TextDeltaTracker(size_t capacity, size_t maxEdits)
+    : capacity(std::max<size_t>(capacity, 1)), maxEdits(std::max<size_t>(maxEdits, 1)) {}
+
+void TextDeltaTracker::scan(std::string_view text, Frame &frame) {
+    frame.lines.clear();
+    frame.words.clear();
+
+    uint32_t number = 0;
+    size_t pos = 0;
+    for (;;) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+
+        Line line;
+        line.offset = uint32_t(pos);
+        line.length = uint32_t(end - pos);
+        line.number = number;
+        line.firstWord = uint32_t(frame.words.size());
+
+        uint64_t hash = 0;
+        size_t i = pos;
+        while (i < end) {
+            while (i < end && isSpace(uint8_t(text[i]))) ++i;
+            if (i >= end) break;
+            uint64_t word = 0xcbf29ce484222325ULL; // FNV-1a
+            bool any = false;
+            for (; i < end && !isSpace(uint8_t(text[i])); ++i) {
+                const uint8_t c = uint8_t(text[i]);
+                if (isPunctuation(c)) continue;
+                word ^= c;
+                word *= 0x100000001b3ULL;
+                any = true;
+            }
+            if (!any) continue;
+            word = mix(word);
+            frame.words.push_back(word);
+            hash = hash * 0x9e3779b97f4a7c15ULL + word;
+        }
+
+        line.words = uint32_t(frame.words.size()) - line.firstWord;
+        if (line.words > 0) {
+            line.hash = mix(hash ^ line.words);
+            frame.lines.push_back(line);
+        }
+
+        ++number;
+        if (end >= text.size()) break;
+        pos = end + 1;
+    }
+}
+
+void TextDeltaTracker::evictOldest() {
+    auto oldest = frames.begin();
+    for (auto it = frames.begin(); it != frames.end(); ++it) {
+        if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+    }
+    if (oldest == frames.end()) return;
+    frames.erase(oldest);
+    ++counters.evictions;
+}
+
+TextDeltaTracker::Delta TextDeltaTracker::update(std::string_view scope, std::string_view text) {
+    const Delta delta = peek(scope, text);
+    commit(scope);
+    return delta;
+}
+
+TextDeltaTracker::Delta TextDeltaTracker::peek(std::string_view scope, std::string_view text) {
+    Delta delta;
+    Frame &next = pending;
+    pendingScope.assign(scope);
+    hasPending = true;
+    scan(text, next);
+    next.lastUse = ++clock;
+    delta.totalLines = next.lines.size();
+    delta.totalBytes = text.size();
+    ++counters.frames;
+    counters.bytesIn += text.size();
+
+    auto found = frames.find(std::string(scope));
+    std::vector<bool> changed(next.lines.size(), found == frames.end());
+    delta.baseline = found == frames.end();
+
+    if (!delta.baseline) {
+        const Frame &previous = found->second;
+        std::vector<uint64_t> before(previous.lines.size()), after(next.lines.size());
+        for (size_t i = 0; i < before.size(); ++i) before[i] = previous.lines[i].hash;
+        for (size_t i = 0; i < after.size(); ++i) after[i] = next.lines[i].hash;
+
+        std::vector<std::pair<uint32_t, uint32_t>> lineMatches, wordMatches;
+        if (!diffSequences(before.data(), before.size(), after.data(), after.size(), maxEdits, lineMatches)) {
+            delta.baseline = true;
+            std::fill(changed.begin(), changed.end(), true);
+        } else {
+            // Between matched lines: old lines [i, endI) became new lines
+            // [j, endJ). New lines whose words all survive from the old run
+            // were only rewrapped.
+            size_t i = 0, j = 0;
+            for (size_t match = 0; match <= lineMatches.size(); ++match) {
+                const size_t endI = match < lineMatches.size() ? lineMatches[match].first : previous.lines.size();
+                const size_t endJ = match < lineMatches.size() ? lineMatches[match].second : next.lines.size();
+
+                if (endJ > j) {
+                    bool all = endI == i;
+                    if (!all) {
+                        const size_t oldFirst = previous.lines[i].firstWord;
+                        const size_t oldEnd = previous.lines[endI - 1].firstWord + previous.lines[endI - 1].words;
+                        const size_t newFirst = next.lines[j].firstWord;
+                        const size_t newEnd = next.lines[endJ - 1].firstWord + next.lines[endJ - 1].words;
+
+                        all = !diffSequences(previous.words.data() + oldFirst, oldEnd - oldFirst,
+                                             next.words.data() + newFirst, newEnd - newFirst, maxEdits, wordMatches);
+                        if (!all) {
+                            std::vector<bool> kept(newEnd - newFirst, false);
+                            for (const auto &pair : wordMatches) kept[pair.second] = true;
+                            for (size_t line = j; line < endJ; ++line) {
+                                const Line &words = next.lines[line];
+                                for (size_t w = words.firstWord; w < size_t(words.firstWord) + words.words; ++w) {
+                                    if (!kept[w - newFirst]) {
+                                        changed[line] = true;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    if (all) std::fill(changed.begin() + std::ptrdiff_t(j), changed.begin() + std::ptrdiff_t(endJ), true);
+                }
+
+                i = endI + 1;
+                j = endJ + 1;
+            }
+        }
+    }
+
+    for (size_t line = 0; line < next.lines.size();) {
+        if (!changed[line]) {
+            ++line;
+            continue;
+        }
+        size_t last = line;
+        while (last + 1 < next.lines.size() && changed[last + 1]) ++last;
+
+        Span span;
+        span.offset = next.lines[line].offset;
+        span.length = size_t(next.lines[last].offset) + next.lines[last].length - span.offset;
+        span.line = next.lines[line].number;
+        span.lines = last - line + 1;
+        delta.spans.push_back(span);
+        delta.changedLines += span.lines;
+        delta.changedBytes += span.length;
+        line = last + 1;
+    }
+
+    if (delta.baseline) ++counters.baselines;
+    if (delta.spans.empty()) ++counters.unchanged;
+    counters.bytesOut += delta.changedBytes;
+
+    // Peeking is use too: a scope whose frames keep being looked at stays
+    if (found != frames.end()) found->second.lastUse = next.lastUse;
+    return delta;
+}
+
+bool TextDeltaTracker::commit(std::string_view scope) {
+    if (!hasPending || pendingScope != scope) return false;
+    hasPending = false;
+
+    auto found = frames.find(pendingScope);
+    if (found != frames.end()) {
+        found->second = std::move(pending);
+    } else {
+        if (frames.size() >= capacity) evictOldest();
+        frames.emplace(pendingScope, std::move(pending));
+    }
+    return true;
+}
+
+void TextDeltaTracker::forget(std::string_view scope) {
+    frames.erase(std::string(scope));
+    if (pendingScope == scope) hasPending = false;
+}
+
+void TextDeltaTracker::clear() {
+    frames.clear();
+    hasPending = false;
+}
@@ -0,0 +1,107 @@
+#ifndef TEXTDELTA_H
+#define TEXTDELTA_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// What changed between successive OCR frames of one scope (app + window).
+// Scrolling or typing leaves most of a frame as it was, so each frame is
+// diffed against the scope's previous one and only the lines with new
+// content are reported.
+//
+// Lines and words are hashed in one pass over the text: a word's hash is
+// FNV-1a over its bytes bar ASCII punctuation, a line's a polynomial over
+// its words. Runs of spaces, blank lines and the punctuation OCR is least
+// sure of (a cursor glued to a word, a rule of dashes) never count as
+// changes. Lines are diffed with
+// Myers' O(ND) algorithm; where a run of lines was replaced, the words of
+// the old and new run are diffed again, so lines that OCR only wrapped
+// differently are not reported either. Diffs needing more than maxEdits
+// edits report the whole frame instead.
+class TextDeltaTracker {
+public:
+    // A run of changed lines: bytes [offset, offset + length) of the new
+    // text, starting and ending on a line
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+        size_t line = 0;  // first line, counting blank lines
+        size_t lines = 0; // lines with words in the span
+    };
+
+    struct Delta {
+        bool baseline = false; // nothing to diff against: every line counts as changed
+        std::vector<Span> spans;
+        size_t changedLines = 0;
+        size_t totalLines = 0;  // with words
+        size_t changedBytes = 0;
+        size_t totalBytes = 0;
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t baselines = 0;
+        uint64_t unchanged = 0; // frames with no span
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;  // in spans
+        uint64_t evictions = 0;
+    };
+
+    explicit TextDeltaTracker(size_t capacity = 256, size_t maxEdits = 1000);
+
+    // Diffs text against the last frame of scope and keeps it as the new
+    // last frame. Once capacity scopes are held, the least recently used
+    // one is dropped.
+    Delta update(std::string_view scope, std::string_view text);
+    // Diffs without keeping: the frame is held until commit(scope), so one
+    // judged to add nothing leaves the last kept frame as the baseline and
+    // small changes add up against it. Only the latest peek is held.
+    Delta peek(std::string_view scope, std::string_view text);
+    // Keeps the frame of the last peek at scope; false if there is none
+    bool commit(std::string_view scope);
+    // The next frame of scope is a baseline again
+    void forget(std::string_view scope);
+    void clear();
+
+    size_t size() const { return frames.size(); }
+    const Stats &stats() const { return counters; }
+
+private:
+    struct Line {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+        uint32_t number = 0;     // counting blank lines
+        uint32_t firstWord = 0;
+        uint32_t words = 0;
+        uint64_t hash = 0;
+    };
+
+    struct Frame {
+        std::vector<Line> lines;
+        std::vector<uint64_t> words;
+        uint64_t lastUse = 0;
+    };
+
+    size_t capacity;
+    size_t maxEdits;
+    std::unordered_map<std::string, Frame> frames;
+    std::string pendingScope;
+    Frame pending;
+    bool hasPending = false;
+    uint64_t clock = 0;
+    Stats counters;
+
+    static void scan(std::string_view text, Frame &frame);
+    void evictOldest();
+};
+
+// Pairs (i, j) with a[i] == b[j] of a longest common subsequence, in order,
+// by Myers' algorithm; false if more than maxEdits insertions and deletions
+// are needed
+bool diffSequences(const uint64_t *a, size_t n, const uint64_t *b, size_t m, size_t maxEdits,
+                   std::vector<std::pair<uint32_t, uint32_t>> &matches);
+
+#endif // TEXTDELTA_H
@@ -0,0 +1,298 @@
+#include "textkernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GEM_TEXT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GEM_TARGET(isa)
+#else
+#define GEM_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+// Code points other than ASCII that separate words
+inline bool isSeparator(uint32_t cp) {
+    return cp < 0x80 ? !((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9'))
+                     : cp <= 0xBF || cp == 0xD7 || cp == 0xF7
+                           || (cp >= 0x2000 && cp <= 0x206F) || (cp >= 0x3000 && cp <= 0x303F) || cp == 0xFEFF;
+}
+
+// Capitals in the two-byte ranges; the result stays two bytes long
+inline uint32_t foldCase(uint32_t cp) {
+    if (cp >= 0xC0 && cp <= 0xDE) return cp + 0x20;
+    if (cp == 0x178) return 0xFF;
+    if (((cp >= 0x100 && cp <= 0x12F) || (cp >= 0x132 && cp <= 0x137) || (cp >= 0x14A && cp <= 0x177))
+        && cp % 2 == 0)
+        return cp + 1;
+    if (((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) && cp % 2 == 1) return cp + 1;
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2) return cp + 0x20;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    return cp;
+}
+
+// Normalises the code points starting in [i, until), so a sequence that
+// straddles until is finished. Returns where it stopped.
+size_t normalizeScalar(const uint8_t *in, size_t n, size_t i, size_t until, char *out, size_t &o, bool &prevSep) {
+    while (i < until) {
+        const uint8_t c = in[i];
+        if (c < 0x80) {
+            if (isSeparator(c)) {
+                if (!prevSep) out[o++] = ' ';
+                prevSep = true;
+            } else {
+                out[o++] = char(c >= 'A' && c <= 'Z' ? c + 32 : c);
+                prevSep = false;
+            }
+            ++i;
+            continue;
+        }
+
+        size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+        if (i + length > n) length = 1;
+        uint32_t cp = length == 1 ? 0x80 /* stray byte: a separator */
+                    : length == 2 ? c & 0x1F : length == 3 ? c & 0x0F : c & 0x07;
+        for (size_t k = 1; k < length; ++k) {
+            if ((in[i + k] & 0xC0) != 0x80) {
+                length = 1;
+                cp = 0x80;
+                break;
+            }
+            cp = (cp << 6) | (in[i + k] & 0x3F);
+        }
+
+        if (isSeparator(cp)) {
+            if (!prevSep) out[o++] = ' ';
+            prevSep = true;
+        } else if (length == 2) {
+            const uint32_t folded = foldCase(cp);
+            out[o++] = char(0xC0 | (folded >> 6));
+            out[o++] = char(0x80 | (folded & 0x3F));
+            prevSep = false;
+        } else {
+            std::memcpy(out + o, in + i, length);
+            o += length;
+            prevSep = false;
+        }
+        i += length;
+    }
+    return i;
+}
+
+#ifdef GEM_TEXT_X86
+
+// pshufb indices that pack the kept bytes of an 8-byte group to the front
+struct PackTable {
+    alignas(16) uint8_t shuffle[256][8];
+    uint8_t count[256];
+
+    PackTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int n = 0;
+            for (int bit = 0; bit < 8; ++bit)
+                if (mask & (1 << bit)) shuffle[mask][n++] = uint8_t(bit);
+            for (int rest = n; rest < 8; ++rest) shuffle[mask][rest] = 0x80;
+            count[mask] = uint8_t(n);
+        }
+    }
+};
+
+const PackTable &packTable() {
+    static const PackTable table;
+    return table;
+}
+
+GEM_TARGET("sse4.2")
+inline size_t pack16(__m128i bytes, uint32_t keep, char *out, const PackTable &table) {
+    const uint32_t low = keep & 0xFF;
+    const uint32_t high = (keep >> 8) & 0xFF;
+    const __m128i lowIndex = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.shuffle[low]));
+    const __m128i highIndex = _mm_add_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.shuffle[high])),
+                                           _mm_set1_epi8(8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(bytes, lowIndex));
+    // Unused slots hold 0x80 (0x88 once offset), which pshufb turns into zero
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + table.count[low]), _mm_shuffle_epi8(bytes, highIndex));
+    return table.count[low] + table.count[high];
+}
+
+// Separators become spaces and capitals lower case; returns the word mask
+GEM_TARGET("sse4.2")
+inline __m128i mapAscii16(__m128i v, uint32_t *wordMask) {
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i word = _mm_or_si128(_mm_or_si128(upper, lower), digit);
+    const __m128i folded = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    *wordMask = uint32_t(_mm_movemask_epi8(word));
+    return _mm_blendv_epi8(_mm_set1_epi8(' '), folded, word);
+}
+
+GEM_TARGET("sse4.2")
+size_t normalizeSse42(const uint8_t *in, size_t n, char *out) {
+    const PackTable &table = packTable();
+    size_t i = 0, o = 0;
+    bool prevSep = true; // drops leading separators
+    while (i + 16 <= n) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if (_mm_movemask_epi8(v) != 0) {
+            i = normalizeScalar(in, n, i, i + 16, out, o, prevSep);
+            continue;
+        }
+        uint32_t word;
+        const __m128i mapped = mapAscii16(v, &word);
+        const uint32_t sep = ~word & 0xFFFF;
+        const uint32_t keep = ~(sep & ((sep << 1) | (prevSep ? 1u : 0u))) & 0xFFFF;
+        prevSep = (sep >> 15) & 1;
+        if (keep == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), mapped);
+            o += 16;
+        } else {
+            o += pack16(mapped, keep, out + o, table);
+        }
+        i += 16;
+    }
+    normalizeScalar(in, n, i, n, out, o, prevSep);
+    return o;
+}
+
+GEM_TARGET("avx2")
+size_t normalizeAvx2(const uint8_t *in, size_t n, char *out) {
+    const PackTable &table = packTable();
+    size_t i = 0, o = 0;
+    bool prevSep = true;
+    while (i + 32 <= n) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        if (_mm256_movemask_epi8(v) != 0) {
+            i = normalizeScalar(in, n, i, i + 32, out, o, prevSep);
+            continue;
+        }
+        const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+        const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+        const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        const __m256i word = _mm256_or_si256(_mm256_or_si256(upper, lower), digit);
+        const __m256i folded = _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        const __m256i mapped = _mm256_blendv_epi8(_mm256_set1_epi8(' '), folded, word);
+
+        const uint32_t sep = ~uint32_t(_mm256_movemask_epi8(word));
+        const uint32_t keep = ~(sep & ((sep << 1) | (prevSep ? 1u : 0u)));
+        prevSep = sep >> 31;
+        if (keep == 0xFFFFFFFFu) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), mapped);
+            o += 32;
+        } else {
+            o += pack16(_mm256_castsi256_si128(mapped), keep & 0xFFFF, out + o, table);
+            o += pack16(_mm256_extracti128_si256(mapped, 1), keep >> 16, out + o, table);
+        }
+        i += 32;
+    }
+    normalizeScalar(in, n, i, n, out, o, prevSep);
+    return o;
+}
+
+TextKernel detectKernel() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    const int leaves = info[0];
+    __cpuid(info, 1);
+    const bool sse42 = (info[2] >> 20) & 1;
+    const bool osAvx = ((info[2] >> 27) & 1) && (_xgetbv(0) & 6) == 6;
+    bool avx2 = false;
+    if (leaves >= 7 && osAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] >> 5) & 1;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse42 = __builtin_cpu_supports("sse4.2");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    return avx2 ? TextKernel::Avx2 : sse42 ? TextKernel::Sse42 : TextKernel::Scalar;
+}
+
+#else
+
+TextKernel detectKernel() { return TextKernel::Scalar; }
+
+#endif // GEM_TEXT_X86
+
+const TextKernel supportedKernel = detectKernel();
+std::atomic<TextKernel> activeKernel{supportedKernel};
+
+} // namespace
+
+TextKernel textKernel() {
+    return activeKernel.load(std::memory_order_relaxed);
+}
+
+const char *textKernelName(TextKernel kernel) {
+    switch (kernel) {
+    case TextKernel::Avx2: return "avx2";
+    case TextKernel::Sse42: return "sse4.2";
+    default: return "scalar";
+    }
+}
+
+void setTextKernel(TextKernel kernel) {
+    activeKernel.store(std::min(kernel, supportedKernel), std::memory_order_relaxed);
+}
+
+namespace {
+
+size_t normalizeInto(std::string_view text, char *out) {
+    const uint8_t *in = reinterpret_cast<const uint8_t*>(text.data());
+    const size_t n = text.size();
+    size_t o = 0;
+    switch (textKernel()) {
+#ifdef GEM_TEXT_X86
+    case TextKernel::Avx2:
+        o = normalizeAvx2(in, n, out);
+        break;
+    case TextKernel::Sse42:
+        o = normalizeSse42(in, n, out);
+        break;
+#endif
+    default: {
+        bool prevSep = true;
+        normalizeScalar(in, n, 0, n, out, o, prevSep);
+    }
+    }
+    if (o > 0 && out[o - 1] == ' ') --o;
+    return o;
+}
+
+} // namespace
+
+void normalizeText(std::string_view text, std::string &out) {
+    // Room for a whole vector store past the last kept byte
+    out.resize(text.size() + 32);
+    out.resize(normalizeInto(text, out.data()));
+}
+
+void appendNormalizedText(std::string_view text, std::string &out) {
+    size_t start = out.size();
+    if (start > 0) {
+        out.push_back(TextSeparator);
+        ++start;
+    }
+    // Amortised growth: out is usually a long-lived buffer appended to often
+    if (out.capacity() < start + text.size() + 32) out.reserve(std::max(out.capacity() * 2, start + text.size() + 32));
+    out.resize(start + text.size() + 32);
+    out.resize(start + normalizeInto(text, out.data() + start));
+}
+
+std::string normalizeText(std::string_view text) {
+    std::string out;
+    normalizeText(text, out);
+    return out;
+}
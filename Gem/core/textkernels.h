@@ -0,0 +1,32 @@
+#ifndef TEXTKERNELS_H
+#define TEXTKERNELS_H
+
+#include <string>
+#include <string_view>
+
+// Text normalisation for thread queries and prompt compaction, with SIMD
+// kernels for the common all-ASCII case (AVX2 or SSE4.2, picked at run
+// time) and a scalar path for everything else.
+//
+// Normalised text is lower case with every run of separators — ASCII
+// punctuation, controls and spaces, Latin-1 symbols, general and CJK
+// punctuation — collapsed to one space and trimmed. Other non-ASCII
+// characters are kept as word characters; case is folded for Latin-1,
+// Latin Extended-A, Greek and Cyrillic capitals.
+enum class TextKernel { Scalar, Sse42, Avx2 };
+
+// The best kernel this CPU supports, unless lowered with setTextKernel
+TextKernel textKernel();
+const char *textKernelName(TextKernel kernel);
+// Clamped to what the CPU supports; for benchmarks
+void setTextKernel(TextKernel kernel);
+
+std::string normalizeText(std::string_view text);
+void normalizeText(std::string_view text, std::string &out);
+// Appends the normalised text to out, after a separator when out is not
+// empty: one searchable string for many texts, where no keyword can match
+// across two of them
+void appendNormalizedText(std::string_view text, std::string &out);
+constexpr char TextSeparator = '\x01';
+
+#endif // TEXTKERNELS_H
@@ -0,0 +1,268 @@
+#include "threadstore.h"
+#include "binaryio.h"
+#include <algorithm>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char SnapshotMagic[8] = {'G', 'E', 'M', 'S', 'N', 'A', 'P', '1'};
+
+uint64_t threadBytes(const StoredThread &thread) {
+    uint64_t bytes = 64 + thread.key.size() + thread.topic.size();
+    for (const std::string &event : thread.events) bytes += 4 + event.size();
+    return bytes;
+}
+
+} // namespace
+
+bool ThreadStore::open(const fs::path &directory, bool readOnlyMode) {
+    close();
+    dir = directory;
+    readOnly = readOnlyMode;
+    error.clear();
+    state.clear();
+    appliedSequence = 0;
+    snapshotSequence = 0;
+    logBytesAtSnapshot = 0;
+
+    if (!loadSnapshot()) {
+        // Renamed into place atomically, so this is disk damage rather than
+        // a crash; fall back to whatever the log still holds.
+        state.clear();
+        snapshotSequence = 0;
+        appliedSequence = 0;
+        error = "snapshot.bin is damaged; rebuilt from the log";
+    }
+
+    eventLog.setSegmentBytes(options.segmentBytes);
+    const bool opened = eventLog.open(
+        dir, readOnly, [this](uint64_t sequence, const EventLog::Record &record) { apply(sequence, record); },
+        snapshotSequence);
+    if (!opened) {
+        error = eventLog.lastError();
+        return false;
+    }
+    appliedSequence = std::max(appliedSequence, eventLog.lastSequence());
+    return true;
+}
+
+void ThreadStore::close() {
+    eventLog.close();
+}
+
+void ThreadStore::apply(uint64_t sequence, const EventLog::Record &record) {
+    appliedSequence = sequence;
+
+    switch (record.type) {
+    case CreateRecord: {
+        auto it = state.find(record.key);
+        if (it != state.end()) break;
+        StoredThread &thread = state[record.key];
+        thread.key = record.key;
+        thread.topic = record.payload;
+        thread.created = record.timestampMs;
+        thread.lastUpdated = record.timestampMs;
+        break;
+    }
+    case EventRecord: {
+        StoredThread &thread = state[record.key];
+        if (thread.key.empty()) {
+            thread.key = record.key;
+            thread.created = record.timestampMs;
+        }
+        if (!record.payload.empty()) thread.events.push_back(record.payload);
+        thread.lastUpdated = record.timestampMs;
+        thread.finalized = false;
+        break;
+    }
+    case FinalizeRecord: {
+        auto it = state.find(record.key);
+        if (it != state.end()) it->second.finalized = true;
+        break;
+    }
+    case RemoveRecord:
+        state.erase(record.key);
+        break;
+    case ClearRecord:
+        state.clear();
+        break;
+    default:
+        break; // written by a newer version; skip
+    }
+}
+
+bool ThreadStore::record(RecordType type, const std::string &key, int64_t timestampMs,
+                         const std::string &payload) {
+    if (readOnly) {
+        error = "thread store is read-only";
+        return false;
+    }
+
+    EventLog::Record entry;
+    entry.type = type;
+    entry.timestampMs = timestampMs;
+    entry.key = key;
+    entry.payload = payload;
+
+    const uint64_t sequence = eventLog.append(entry);
+    if (sequence == 0) {
+        error = eventLog.lastError();
+        return false;
+    }
+    apply(sequence, entry);
+
+    if (eventLog.totalBytes() - std::min(eventLog.totalBytes(), logBytesAtSnapshot) > options.compactBytes)
+        compact(timestampMs);
+    return true;
+}
+
+bool ThreadStore::append(const std::string &key, const std::string &topic, int64_t timestampMs,
+                         const std::string &event) {
+    if (!state.count(key) && !record(CreateRecord, key, timestampMs, topic)) return false;
+    return record(EventRecord, key, timestampMs, event);
+}
+
+bool ThreadStore::finalize(const std::string &key, int64_t timestampMs) {
+    auto it = state.find(key);
+    if (it == state.end() || it->second.finalized) return true;
+    return record(FinalizeRecord, key, timestampMs, std::string());
+}
+
+bool ThreadStore::remove(const std::string &key, int64_t timestampMs) {
+    if (!state.count(key)) return true;
+    return record(RemoveRecord, key, timestampMs, std::string());
+}
+
+bool ThreadStore::clear(int64_t timestampMs) {
+    return record(ClearRecord, std::string(), timestampMs, std::string()) && compact(timestampMs);
+}
+
+void ThreadStore::applyRetention(int64_t nowMs) {
+    if (options.maxAgeMs > 0) {
+        for (auto it = state.begin(); it != state.end();) {
+            if (nowMs - it->second.lastUpdated > options.maxAgeMs) it = state.erase(it);
+            else ++it;
+        }
+    }
+
+    uint64_t total = 0;
+    for (const auto &entry : state) total += threadBytes(entry.second);
+    if (options.maxBytes == 0 || total <= options.maxBytes) return;
+
+    std::vector<const StoredThread*> byAge;
+    byAge.reserve(state.size());
+    for (const auto &entry : state) byAge.push_back(&entry.second);
+    std::sort(byAge.begin(), byAge.end(),
+              [](const StoredThread *a, const StoredThread *b) { return a->lastUpdated < b->lastUpdated; });
+
+    std::vector<std::string> evict;
+    for (const StoredThread *thread : byAge) {
+        if (total <= options.maxBytes) break;
+        total -= threadBytes(*thread);
+        evict.push_back(thread->key);
+    }
+    for (const std::string &key : evict) state.erase(key);
+}
+
+bool ThreadStore::compact(int64_t nowMs) {
+    if (readOnly) return false;
+
+    applyRetention(nowMs);
+
+    // Everything up to appliedSequence goes into the snapshot; new records
+    // land in a fresh segment so the old ones can be deleted whole.
+    eventLog.roll();
+    if (!writeSnapshot()) return false;
+    eventLog.dropThrough(snapshotSequence);
+    logBytesAtSnapshot = eventLog.totalBytes();
+    return true;
+}
+
+bool ThreadStore::writeSnapshot() {
+    std::string data(SnapshotMagic, sizeof(SnapshotMagic));
+    putU64(data, appliedSequence);
+    putU32(data, uint32_t(state.size()));
+    for (const auto &entry : state) {
+        const StoredThread &thread = entry.second;
+        putString(data, thread.key);
+        putString(data, thread.topic);
+        putU64(data, uint64_t(thread.created));
+        putU64(data, uint64_t(thread.lastUpdated));
+        data.push_back(thread.finalized ? 1 : 0);
+        putU32(data, uint32_t(thread.events.size()));
+        for (const std::string &event : thread.events) putString(data, event);
+    }
+    putU32(data, crc32(data.data(), data.size()));
+
+    const fs::path temporary = dir / "snapshot.tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), std::streamsize(data.size()));
+        out.flush();
+        if (!out) {
+            error = "cannot write " + temporary.string();
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temporary, snapshotPath(), ec);
+    if (ec) {
+        error = "cannot replace snapshot: " + ec.message();
+        return false;
+    }
+    snapshotSequence = appliedSequence;
+    return true;
+}
+
+bool ThreadStore::loadSnapshot() {
+    std::error_code ec;
+    if (!fs::exists(snapshotPath(), ec)) return true;
+
+    std::string data;
+    if (!readFileFrom(snapshotPath(), 0, data)) return false;
+    if (data.size() < sizeof(SnapshotMagic) + 16 || std::memcmp(data.data(), SnapshotMagic, sizeof(SnapshotMagic)) != 0)
+        return false;
+    if (crc32(data.data(), data.size() - 4) != getU32(data.data() + data.size() - 4)) return false;
+
+    ByteReader in(data.data() + sizeof(SnapshotMagic), data.size() - sizeof(SnapshotMagic) - 4);
+    const uint64_t sequence = in.u64();
+    const uint32_t count = in.u32();
+    for (uint32_t i = 0; i < count && in.ok(); ++i) {
+        StoredThread thread;
+        thread.key = in.string();
+        thread.topic = in.string();
+        thread.created = int64_t(in.u64());
+        thread.lastUpdated = int64_t(in.u64());
+        thread.finalized = in.u8() != 0;
+        const uint32_t events = in.u32();
+        for (uint32_t e = 0; e < events && in.ok(); ++e) thread.events.push_back(in.string());
+        if (in.ok()) state[thread.key] = std::move(thread);
+    }
+    if (!in.ok()) return false;
+
+    snapshotSequence = sequence;
+    appliedSequence = sequence;
+    return true;
+}
+
+uint64_t ThreadStore::snapshotSequenceOnDisk() const {
+    std::ifstream in(snapshotPath(), std::ios::binary);
+    char header[sizeof(SnapshotMagic) + 8];
+    if (!in.read(header, sizeof(header))) return 0;
+    return getU64(header + sizeof(SnapshotMagic));
+}
+
+bool ThreadStore::refresh() {
+    if (!readOnly) return false;
+
+    // A new snapshot means the writer compacted (and may have dropped the
+    // segments we were following): start over from it.
+    if (snapshotSequenceOnDisk() != snapshotSequence) return open(dir, true);
+
+    const uint64_t before = appliedSequence;
+    eventLog.readNew([this](uint64_t sequence, const EventLog::Record &record) { apply(sequence, record); });
+    return appliedSequence != before;
+}
@@ -0,0 +1,86 @@
+#ifndef THREADSTORE_H
+#define THREADSTORE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "eventlog.h"
+
+// A topic thread as the backend keeps it. Topic and events are opaque JSON
+// strings; the store only orders and persists them.
+struct StoredThread {
+    std::string key;
+    std::string topic;
+    int64_t created = 0;
+    int64_t lastUpdated = 0;
+    bool finalized = false;
+    std::vector<std::string> events;
+};
+
+// Durable topic threads: every mutation is one EventLog record, and the
+// materialised state is checkpointed into snapshot.bin once the log since
+// the last snapshot grows past compactBytes. Opening loads the snapshot and
+// replays only the records after it. Compaction also applies retention:
+// threads idle for longer than maxAgeMs are dropped, then the oldest ones
+// until the snapshot fits in maxBytes.
+class ThreadStore {
+public:
+    struct Options {
+        uint64_t segmentBytes = 4 << 20;
+        uint64_t compactBytes = 16 << 20;
+        int64_t maxAgeMs = 7LL * 24 * 60 * 60 * 1000;
+        uint64_t maxBytes = 64 << 20;
+    };
+
+    enum RecordType : uint8_t {
+        CreateRecord = 1,     // payload: topic JSON
+        EventRecord = 2,      // payload: event JSON, empty to just touch the thread
+        FinalizeRecord = 3,
+        RemoveRecord = 4,
+        ClearRecord = 5,
+    };
+
+    ThreadStore() = default;
+    explicit ThreadStore(const Options &options) : options(options) {}
+
+    bool open(const std::filesystem::path &directory, bool readOnly = false);
+    void close();
+
+    // Writers. Each call is one appended record, so O(1) in the history size.
+    bool append(const std::string &key, const std::string &topic, int64_t timestampMs, const std::string &event);
+    bool finalize(const std::string &key, int64_t timestampMs);
+    bool remove(const std::string &key, int64_t timestampMs);
+    bool clear(int64_t timestampMs);
+    bool compact(int64_t nowMs);
+
+    // Readers: apply whatever the writer has appended since; true if anything changed
+    bool refresh();
+
+    const std::unordered_map<std::string, StoredThread> &threads() const { return state; }
+    uint64_t sequence() const { return appliedSequence; }
+    const EventLog &log() const { return eventLog; }
+    const std::string &lastError() const { return error; }
+
+private:
+    Options options;
+    std::filesystem::path dir;
+    bool readOnly = true;
+    EventLog eventLog;
+    std::unordered_map<std::string, StoredThread> state;
+    uint64_t appliedSequence = 0;
+    uint64_t snapshotSequence = 0;
+    uint64_t logBytesAtSnapshot = 0;
+    std::string error;
+
+    void apply(uint64_t sequence, const EventLog::Record &record);
+    bool record(RecordType type, const std::string &key, int64_t timestampMs, const std::string &payload);
+    bool loadSnapshot();
+    bool writeSnapshot();
+    void applyRetention(int64_t nowMs);
+    uint64_t snapshotSequenceOnDisk() const;
+    std::filesystem::path snapshotPath() const { return dir / "snapshot.bin"; }
+};
+
+#endif // THREADSTORE_H
@@ -0,0 +1,40 @@
+#include "countdownbar.h"
+#include <QPainter>
+
+namespace {
+
+quint64 paints = 0;
+
+} // namespace
+
+CountdownBar::CountdownBar(const QColor &color, QWidget *parent)
+    : QWidget(parent), color(color)
+{
+    setFixedHeight(4);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+}
+
+quint64 CountdownBar::paintCount() {
+    return paints;
+}
+
+int CountdownBar::barWidth() const {
+    return qRound(width() * fraction);
+}
+
+void CountdownBar::setRemaining(qreal value) {
+    fraction = qBound(qreal(0), value, qreal(1));
+    if (barWidth() != paintedWidth) update();
+}
+
+void CountdownBar::paintEvent(QPaintEvent *) {
+    ++paints;
+    paintedWidth = barWidth();
+    if (paintedWidth <= 0) return;
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(color);
+    painter.drawRoundedRect(QRectF(0, 0, paintedWidth, height()), 2, 2);
+}
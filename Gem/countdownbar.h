@@ -0,0 +1,35 @@
+#ifndef COUNTDOWNBAR_H
+#define COUNTDOWNBAR_H
+
+#include <QWidget>
+#include <QColor>
+
+// A thin bar showing the time left. It paints itself with QPainter and has
+// a fixed size hint, so changing the fraction only repaints the bar (and only
+// when its length in pixels actually changes) instead of relaying out the
+// parent the way animating maximumWidth did.
+class CountdownBar : public QWidget {
+    Q_OBJECT
+public:
+    explicit CountdownBar(const QColor &color, QWidget *parent = nullptr);
+
+    void setRemaining(qreal fraction);
+    qreal remaining() const { return fraction; }
+
+    QSize sizeHint() const override { return QSize(100, height()); }
+
+    // Repaints across all bars, for measuring animation cost
+    static quint64 paintCount();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QColor color;
+    qreal fraction = 1;
+    int paintedWidth = -1;
+
+    int barWidth() const;
+};
+
+#endif // COUNTDOWNBAR_H
@@ -1,61 +1,189 @@
 #include "debugwindow.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QDir>
 #include <QFile>
-#include <QTextStream>
 #include <QScrollBar>
+#include <QDateTime>
 #include <QCoreApplication>
+#include "scheduler.h"
+#include "configpath.h"
 
 DebugWindow::DebugWindow(QWidget *parent) : QWidget(parent) {
     QVBoxLayout *layout = new QVBoxLayout(this);
 
+    logPath = gemConfigPath("debug.log");
+    tail = new LogTail(logPath, 5000, this);
+    logIndex = new LogIndex(logPath, this);
+    logModel = new LogModel(logIndex, this);
+
+    // --- Live tab: raw tail of the newest lines ---
     logArea = new QPlainTextEdit(this);
     logArea->setReadOnly(true);
+    logArea->setMaximumBlockCount(tail->maxLines());
+
+    // --- Explorer tab: indexed, filterable view of the whole log ---
+    explorerTab = new QWidget(this);
+    QVBoxLayout *explorerLayout = new QVBoxLayout(explorerTab);
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+
+    stageFilter = new QComboBox(explorerTab);
+    stageFilter->addItem("All stages", -1);
+
+    levelFilter = new QComboBox(explorerTab);
+    levelFilter->addItem("All levels", LogIndex::Debug);
+    levelFilter->addItem("Info+", LogIndex::Info);
+    levelFilter->addItem("Warn+", LogIndex::Warn);
+    levelFilter->addItem("Errors", LogIndex::Error);
+
+    timeFilter = new QComboBox(explorerTab);
+    timeFilter->addItem("All time", 0);
+    timeFilter->addItem("Last 5 min", 5 * 60);
+    timeFilter->addItem("Last hour", 60 * 60);
+    timeFilter->addItem("Last 24 h", 24 * 60 * 60);
+
+    textFilter = new QLineEdit(explorerTab);
+    textFilter->setPlaceholderText("Search…");
+    textFilter->setClearButtonEnabled(true);
+
+    filterLayout->addWidget(stageFilter);
+    filterLayout->addWidget(levelFilter);
+    filterLayout->addWidget(timeFilter);
+    filterLayout->addWidget(textFilter, 1);
+
+    logView = new QListView(explorerTab);
+    logView->setModel(logModel);
+    logView->setUniformItemSizes(true);
+    logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    matchLabel = new QLabel(explorerTab);
+
+    explorerLayout->addLayout(filterLayout);
+    explorerLayout->addWidget(logView);
+    explorerLayout->addWidget(matchLabel);
+
+    tabs = new QTabWidget(this);
+    tabs->addTab(logArea, "Live");
+    tabs->addTab(explorerTab, "Explorer");
 
     clearButton = new QPushButton("Clear Log", this);
     connect(clearButton, &QPushButton::clicked, this, &DebugWindow::clearLog);
 
-    layout->addWidget(logArea);
-    layout->addWidget(clearButton);
+    // Power check: should stay near zero while the app is idle
+    wakeupLabel = new QLabel(this);
+
+    QHBoxLayout *footerLayout = new QHBoxLayout();
+    footerLayout->addWidget(wakeupLabel, 1);
+    footerLayout->addWidget(clearButton);
+
+    layout->addWidget(tabs);
+    layout->addLayout(footerLayout);
 
     setLayout(layout);
     setWindowTitle("Debug Log Viewer");
-    resize(600, 400);
+    resize(800, 500);
+
+    connect(tail, &LogTail::linesAppended, this, &DebugWindow::appendLines);
+    connect(tail, &LogTail::reset, this, [=]() {
+        logArea->clear();
+        // Rotation or truncation: the mapping points at the old file
+        logIndex->release();
+        if (explorerVisible()) logIndex->reload();
+    });
+
+    connect(logIndex, &LogIndex::stagesChanged, this, &DebugWindow::updateStages);
+    connect(logModel, &LogModel::filterApplied, this, [=](int matches) {
+        matchLabel->setText(QString("%1 records").arg(matches));
+    });
+    connect(logModel, &QAbstractItemModel::rowsInserted, this, [=]() {
+        QScrollBar *bar = logView->verticalScrollBar();
+        if (bar->value() >= bar->maximum() - 1) logView->scrollToBottom();
+    });
+
+    filterDebounce = new QTimer(this);
+    filterDebounce->setSingleShot(true);
+    filterDebounce->setInterval(250);
+    connect(filterDebounce, &QTimer::timeout, this, &DebugWindow::applyFilter);
+    connect(textFilter, &QLineEdit::textChanged, filterDebounce, qOverload<>(&QTimer::start));
+    connect(stageFilter, &QComboBox::currentIndexChanged, this, &DebugWindow::applyFilter);
+    connect(levelFilter, &QComboBox::currentIndexChanged, this, &DebugWindow::applyFilter);
+    connect(timeFilter, &QComboBox::currentIndexChanged, this, &DebugWindow::applyFilter);
+    connect(tabs, &QTabWidget::currentChanged, this, &DebugWindow::onTabChanged);
+
+    Scheduler::instance()->add("debug-wakeups", 2000, Scheduler::Normal, [=]() {
+        wakeupLabel->setText(QString("Wakeups: %1/min").arg(Scheduler::instance()->wakeupsPerMinute()));
+    }, this);
+}
 
-    timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &DebugWindow::updateLog);
-    timer->start(2000);
+void DebugWindow::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    tail->resume();
+    if (explorerVisible()) logIndex->refresh();
 }
 
-void DebugWindow::updateLog() {
-    QString logPath = QDir(QCoreApplication::applicationDirPath()).filePath("config/debug.log");
-    QFile file(logPath);
+void DebugWindow::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    tail->suspend();
+}
 
-    if (!file.exists())
-        return;
+bool DebugWindow::explorerVisible() const {
+    return isVisible() && tabs->currentWidget() == explorerTab;
+}
 
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QTextStream in(&file);
-        QString content = in.readAll();
-        file.close();
+void DebugWindow::onTabChanged(int) {
+    if (explorerVisible()) logIndex->refresh();
+}
 
-        if (content != lastLogContent) {
-            logArea->setPlainText(content);
-            logArea->verticalScrollBar()->setValue(logArea->verticalScrollBar()->maximum());
-            lastLogContent = content;
-        }
-    }
+void DebugWindow::appendLines(const QStringList &lines) {
+    QScrollBar *bar = logArea->verticalScrollBar();
+    const bool atBottom = bar->value() == bar->maximum();
+
+    logArea->appendPlainText(lines.join('\n'));
+
+    if (atBottom) bar->setValue(bar->maximum());
+
+    // The tail doubles as the change notification for the index
+    if (explorerVisible()) logIndex->refresh();
+}
+
+void DebugWindow::updateStages() {
+    const QString current = stageFilter->currentText();
+    const QStringList stages = logIndex->stageNames();
+
+    stageFilter->blockSignals(true);
+    stageFilter->clear();
+    stageFilter->addItem("All stages", -1);
+    for (int i = 0; i < stages.size(); ++i) stageFilter->addItem(stages[i], i);
+    const int index = stageFilter->findText(current);
+    stageFilter->setCurrentIndex(index >= 0 ? index : 0);
+    stageFilter->blockSignals(false);
+
+    if (index < 0 && current != "All stages") applyFilter();
+}
+
+void DebugWindow::applyFilter() {
+    LogFilter filter;
+    filter.stage = stageFilter->currentData().toInt();
+    filter.minLevel = levelFilter->currentData().toInt();
+    filter.text = textFilter->text().trimmed().toUtf8();
+
+    const int seconds = timeFilter->currentData().toInt();
+    if (seconds > 0)
+        filter.from = QDateTime::currentMSecsSinceEpoch() - qint64(seconds) * 1000;
+
+    logModel->setFilter(filter);
 }
 
 void DebugWindow::clearLog() {
-    QString logPath = QDir(QCoreApplication::applicationDirPath()).filePath("config/debug.log");
     QFile file(QDir::cleanPath(logPath));
 
     if (file.exists()) {
+        // A mapped file cannot be truncated on Windows
+        logIndex->release();
         if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
             file.close();
             logArea->clear();
-            lastLogContent.clear();
         }
     }
 }
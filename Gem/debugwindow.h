@@ -3,23 +3,54 @@
 
 #include <QWidget>
 #include <QPlainTextEdit>
-#include <QTimer>
 #include <QPushButton>
+#include <QTabWidget>
+#include <QListView>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTimer>
+#include "logtail.h"
+#include "logindex.h"
+#include "logmodel.h"
 
 class DebugWindow : public QWidget {
     Q_OBJECT
 public:
     explicit DebugWindow(QWidget *parent = nullptr);
 
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
-    void updateLog();
+    void appendLines(const QStringList &lines);
     void clearLog();
+    void applyFilter();
+    void updateStages();
+    void onTabChanged(int index);
 
 private:
+    QTabWidget *tabs;
     QPlainTextEdit *logArea;
-    QTimer *timer;
     QPushButton *clearButton;
-    QString lastLogContent;
+    LogTail *tail;
+    QString logPath;
+
+    // Explorer tab
+    QWidget *explorerTab;
+    LogIndex *logIndex;
+    LogModel *logModel;
+    QListView *logView;
+    QComboBox *stageFilter;
+    QComboBox *levelFilter;
+    QComboBox *timeFilter;
+    QLineEdit *textFilter;
+    QLabel *matchLabel;
+    QLabel *wakeupLabel;
+    QTimer *filterDebounce;
+
+    bool explorerVisible() const;
 };
 
 #endif // DEBUGWINDOW_H
@@ -0,0 +1,92 @@
+#include "frameclock.h"
+#include "countdownbar.h"
+#include "scheduler.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+namespace {
+
+const int FrameIntervalMs = 16;
+
+} // namespace
+
+FrameClock *FrameClock::instance() {
+    static FrameClock *clock = new FrameClock(QCoreApplication::instance());
+    return clock;
+}
+
+FrameClock::FrameClock(QObject *parent) : QObject(parent) {
+    clock.start();
+    reportStats = qEnvironmentVariableIsSet("GEM_FRAME_STATS");
+
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    timer->setInterval(FrameIntervalMs);
+    connect(timer, &QTimer::timeout, this, &FrameClock::tick);
+}
+
+void FrameClock::add(ClockAnimation *animation) {
+    if (!running.contains(animation)) running.append(animation);
+    if (!timer->isActive()) timer->start();
+}
+
+void FrameClock::remove(ClockAnimation *animation) {
+    running.removeOne(animation);
+    // The timer itself stops on the next tick, so a stop() followed by a
+    // start() in the same event doesn't restart it.
+}
+
+void FrameClock::tick() {
+    if (running.isEmpty()) {
+        timer->stop();
+        if (reportStats) {
+            qDebug() << "FrameClock: idle after" << frameCount << "frames," << stepCount << "steps,"
+                     << CountdownBar::paintCount() << "countdown repaints";
+        }
+        return;
+    }
+
+    ++frameCount;
+    Scheduler::instance()->noteWakeup();
+    const qint64 time = now();
+
+    // Animations may stop or start others from stepped()/finished()
+    const QList<ClockAnimation*> current = running;
+    for (ClockAnimation *animation : current) {
+        if (!running.contains(animation)) continue;
+        ++stepCount;
+        animation->advance(time);
+    }
+}
+
+ClockAnimation::ClockAnimation(QObject *parent) : QObject(parent) {}
+
+ClockAnimation::~ClockAnimation() {
+    if (runningFlag) FrameClock::instance()->remove(this);
+}
+
+void ClockAnimation::start() {
+    FrameClock *clock = FrameClock::instance();
+    startedAt = clock->now();
+    value = easing.valueForProgress(0);
+    runningFlag = true;
+    clock->add(this);
+    emit stepped(value);
+}
+
+void ClockAnimation::stop() {
+    if (!runningFlag) return;
+    runningFlag = false;
+    FrameClock::instance()->remove(this);
+}
+
+void ClockAnimation::advance(qint64 now) {
+    const qreal t = qMin(qreal(1), qreal(now - startedAt) / durationMs);
+    value = easing.valueForProgress(t);
+    emit stepped(value);
+
+    if (t >= 1 && runningFlag) {
+        stop();
+        emit finished();
+    }
+}
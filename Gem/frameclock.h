@@ -0,0 +1,77 @@
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QEasingCurve>
+#include <QList>
+
+class ClockAnimation;
+
+// One timer for every animation in the app. Running ClockAnimations are
+// stepped together on each frame, and the timer stops as soon as the last
+// one finishes, so an idle app gets no animation wakeups at all.
+class FrameClock : public QObject {
+    Q_OBJECT
+public:
+    static FrameClock *instance();
+
+    qint64 now() const { return clock.elapsed(); }
+    bool isTicking() const { return timer->isActive(); }
+
+    // Frames since startup, for measuring animation cost
+    quint64 frames() const { return frameCount; }
+    quint64 steps() const { return stepCount; }
+
+private:
+    explicit FrameClock(QObject *parent);
+
+    QTimer *timer;
+    QElapsedTimer clock;
+    QList<ClockAnimation*> running;
+    quint64 frameCount = 0;
+    quint64 stepCount = 0;
+    bool reportStats = false;
+
+    void add(ClockAnimation *animation);
+    void remove(ClockAnimation *animation);
+    void tick();
+
+    friend class ClockAnimation;
+};
+
+// A duration and an easing curve on the shared clock. Owners turn the
+// eased progress (0..1) into a position or a bar length in stepped().
+class ClockAnimation : public QObject {
+    Q_OBJECT
+public:
+    explicit ClockAnimation(QObject *parent = nullptr);
+    ~ClockAnimation();
+
+    void setDuration(int ms) { durationMs = qMax(1, ms); }
+    int duration() const { return durationMs; }
+    void setEasingCurve(const QEasingCurve &curve) { easing = curve; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return runningFlag; }
+    qreal progress() const { return value; }
+
+signals:
+    void stepped(qreal progress);
+    void finished();
+
+private:
+    int durationMs = 250;
+    QEasingCurve easing;
+    qint64 startedAt = 0;
+    qreal value = 0;
+    bool runningFlag = false;
+
+    void advance(qint64 now);
+
+    friend class FrameClock;
+};
+
+#endif // FRAMECLOCK_H
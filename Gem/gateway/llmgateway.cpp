@@ -0,0 +1,257 @@
+#include "llmgateway.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QDebug>
+#include <memory>
+
+namespace {
+
+const QString CompletionsPath = "/openai/v1/chat/completions";
+
+QJsonObject latencySummary(const HdrHistogram &histogram) {
+    QJsonObject summary;
+    summary["p50"] = double(histogram.valueAtPercentile(50)) / 1000.0;
+    summary["p95"] = double(histogram.valueAtPercentile(95)) / 1000.0;
+    summary["p99"] = double(histogram.valueAtPercentile(99)) / 1000.0;
+    summary["max"] = double(histogram.max()) / 1000.0;
+    return summary;
+}
+
+QByteArray errorBody(const QString &message) {
+    QJsonObject error;
+    error["message"] = message;
+    error["type"] = "gateway_error";
+    return QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+LlmGateway::LlmGateway(const Options &options, KvStore *cache, QObject *parent)
+    : QObject(parent), options(options), cache(cache)
+{
+    network = new QNetworkAccessManager(this);
+}
+
+void LlmGateway::install(HttpServer *server) {
+    server->route("POST", CompletionsPath, [this](const HttpServer::Request &request, const HttpServer::Respond &respond) {
+        complete(request, respond);
+    });
+    server->route("GET", "/stats", [this](const HttpServer::Request &, const HttpServer::Respond &respond) {
+        respond(200, QJsonDocument(stats()).toJson(QJsonDocument::Compact), "application/json");
+    });
+    server->route("GET", "/health", [](const HttpServer::Request &, const HttpServer::Respond &respond) {
+        respond(200, R"({"status":"healthy"})", "application/json");
+    });
+}
+
+QByteArray LlmGateway::cacheKey(const QString &path, const QJsonObject &body) {
+    // QJsonObject keeps keys sorted, so equal requests serialise identically
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(path.toUtf8());
+    hash.addData(QJsonDocument(body).toJson(QJsonDocument::Compact));
+    return "llm:" + hash.result().toHex();
+}
+
+quint64 LlmGateway::totalTokens(const QByteArray &completion) {
+    const QJsonObject usage = QJsonDocument::fromJson(completion).object().value("usage").toObject();
+    return quint64(usage.value("total_tokens").toInteger());
+}
+
+void LlmGateway::complete(const HttpServer::Request &request, const HttpServer::Respond &respond) {
+    QJsonParseError parseError;
+    const QJsonObject body = QJsonDocument::fromJson(request.body, &parseError).object();
+    if (parseError.error != QJsonParseError::NoError) {
+        respond(400, errorBody("request body is not JSON: " + parseError.errorString()), "application/json");
+        return;
+    }
+
+    const QString model = body.value("model").toString();
+    ModelStats &counters = models[model];
+    ++counters.requests;
+
+    const QByteArray cacheControl = request.headers.value("cache-control").toLower();
+    const bool streamed = body.value("stream").toBool();
+    const bool bypass = cacheControl.contains("no-store") || options.ttlSeconds <= 0;
+    const QByteArray authorization = request.headers.value("authorization");
+
+    if (streamed) {
+        relay(request, respond, model);
+        return;
+    }
+
+    if (bypass) {
+        const QByteArray key = "~" + QByteArray::number(++uncoalesced);
+        inFlight[key] = Flight{model, {respond}};
+        forward(request.path, key, model, request.body, authorization, false);
+        return;
+    }
+
+    const QByteArray key = cacheKey(request.path, body);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    std::string cached;
+    if (!cacheControl.contains("no-cache") && cache->get(key.toStdString(), now, &cached)) {
+        ++counters.cacheHits;
+        const QByteArray completion = QByteArray::fromStdString(cached);
+        counters.savedTokens += totalTokens(completion);
+        respond(200, completion, "application/json");
+        return;
+    }
+
+    auto flight = inFlight.find(key);
+    if (flight != inFlight.end()) {
+        ++counters.coalesced;
+        flight->waiters.append(respond);
+        return;
+    }
+
+    inFlight[key] = Flight{model, {respond}};
+    forward(request.path, key, model, request.body, authorization, true);
+}
+
+QNetworkRequest LlmGateway::upstreamRequest(const QString &path, const QByteArray &authorization) const {
+    QUrl url = options.upstream;
+    QString basePath = url.path();
+    while (basePath.endsWith('/')) basePath.chop(1);
+    url.setPath(basePath + path);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Authorization", !authorization.isEmpty() ? authorization
+                                                                   : "Bearer " + options.apiKey.toUtf8());
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setTransferTimeout(options.timeoutMs);
+    return request;
+}
+
+// Server-sent events go straight through: each read from upstream becomes a
+// chunk to the client, so the first token is not held back by the gateway.
+// Error statuses arrive whole and are answered as usual.
+void LlmGateway::relay(const HttpServer::Request &request, const HttpServer::Respond &respond, const QString &model) {
+    ++models[model].upstreamCalls;
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+    auto streaming = std::make_shared<bool>(false);
+
+    QNetworkReply *reply = network->post(upstreamRequest(request.path, request.headers.value("authorization")),
+                                         request.body);
+    connect(reply, &QNetworkReply::readyRead, this, [=]() {
+        if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) return;
+        if (!*streaming) {
+            *streaming = true;
+            QByteArray contentType = reply->header(QNetworkRequest::ContentTypeHeader).toByteArray();
+            if (contentType.isEmpty()) contentType = "text/event-stream";
+            HttpServer::beginChunked(request, 200, contentType);
+        }
+        // The client hung up: stop paying for tokens nobody reads
+        if (!HttpServer::writeChunk(request, reply->readAll())) reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        ModelStats &counters = models[model];
+        counters.upstreamLatency.record(quint64(timer->nsecsElapsed() / 1000));
+
+        if (*streaming) {
+            if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError)
+                ++counters.errors;
+            HttpServer::writeChunk(request, reply->readAll());
+            HttpServer::endChunked(request);
+            return;
+        }
+
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status != 200) ++counters.errors;
+        if (status == 0) {
+            qWarning() << "Gateway: upstream stream failed:" << reply->errorString();
+            respond(502, errorBody("upstream unreachable: " + reply->errorString()), "application/json");
+            return;
+        }
+        respond(status, reply->readAll(), "application/json");
+    });
+}
+
+void LlmGateway::forward(const QString &path, const QByteArray &key, const QString &model, const QByteArray &body,
+                         const QByteArray &authorization, bool store) {
+    ++models[model].upstreamCalls;
+    QElapsedTimer timer;
+    timer.start();
+
+    QNetworkReply *reply = network->post(upstreamRequest(path, authorization), body);
+    connect(reply, &QNetworkReply::finished, this, [=]() {
+        reply->deleteLater();
+        ModelStats &counters = models[model];
+        counters.upstreamLatency.record(quint64(timer.nsecsElapsed() / 1000));
+
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QByteArray response = reply->readAll();
+        if (status == 0) {
+            ++counters.errors;
+            qWarning() << "Gateway: upstream request failed:" << reply->errorString();
+            finish(key, 502, errorBody("upstream unreachable: " + reply->errorString()));
+            return;
+        }
+        if (status != 200) {
+            ++counters.errors;
+            finish(key, status, response);
+            return;
+        }
+
+        const QJsonObject usage = QJsonDocument::fromJson(response).object().value("usage").toObject();
+        counters.promptTokens += quint64(usage.value("prompt_tokens").toInteger());
+        counters.completionTokens += quint64(usage.value("completion_tokens").toInteger());
+
+        if (store) {
+            const qint64 now = QDateTime::currentMSecsSinceEpoch();
+            cache->set(key.toStdString(), response.toStdString(), now + qint64(options.ttlSeconds) * 1000, now);
+        }
+        finish(key, status, response);
+    });
+}
+
+void LlmGateway::finish(const QByteArray &key, int status, const QByteArray &body) {
+    const Flight flight = inFlight.take(key);
+
+    // Coalesced waiters got the same answer without paying for it
+    if (status == 200 && flight.waiters.size() > 1)
+        models[flight.model].savedTokens += totalTokens(body) * quint64(flight.waiters.size() - 1);
+
+    for (const HttpServer::Respond &respond : flight.waiters) respond(status, body, "application/json");
+}
+
+QJsonObject LlmGateway::stats() const {
+    QJsonObject perModel;
+    for (auto it = models.constBegin(); it != models.constEnd(); ++it) {
+        const ModelStats &counters = it.value();
+        QJsonObject entry;
+        entry["requests"] = qint64(counters.requests);
+        entry["cacheHits"] = qint64(counters.cacheHits);
+        entry["coalesced"] = qint64(counters.coalesced);
+        entry["upstreamCalls"] = qint64(counters.upstreamCalls);
+        entry["errors"] = qint64(counters.errors);
+        entry["promptTokens"] = qint64(counters.promptTokens);
+        entry["completionTokens"] = qint64(counters.completionTokens);
+        entry["savedTokens"] = qint64(counters.savedTokens);
+        entry["latencyMs"] = latencySummary(counters.upstreamLatency);
+        perModel[it.key().isEmpty() ? QString("(none)") : it.key()] = entry;
+    }
+
+    const KvStore::Stats cacheStats = cache->stats();
+    QJsonObject cacheEntry;
+    cacheEntry["entries"] = qint64(cache->size());
+    cacheEntry["bytes"] = qint64(cache->liveBytes());
+    cacheEntry["budget"] = qint64(cache->budgetBytes());
+    cacheEntry["evictions"] = qint64(cacheStats.evictions);
+    cacheEntry["expirations"] = qint64(cacheStats.expirations);
+
+    QJsonObject result;
+    result["upstream"] = options.upstream.toString();
+    result["ttlSeconds"] = options.ttlSeconds;
+    result["inFlight"] = inFlight.size();
+    result["cache"] = cacheEntry;
+    result["models"] = perModel;
+    return result;
+}
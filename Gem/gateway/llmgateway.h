@@ -0,0 +1,76 @@
+#ifndef LLMGATEWAY_H
+#define LLMGATEWAY_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QUrl>
+#include <QHash>
+#include <QList>
+#include <QJsonObject>
+#include "httpserver.h"
+#include "hdrhistogram.h"
+#include "kvstore.h"
+
+// Local front for the chat completions API every backend stage calls.
+//
+// Requests are keyed by a hash of their canonical JSON body. A key already
+// in the response cache is answered from it; a key already on its way
+// upstream gets attached to that request (single flight) instead of sending
+// another. Upstream calls share one QNetworkAccessManager, which keeps
+// connections alive and multiplexes over HTTP/2 where the provider offers
+// it. Streamed requests bypass the cache and coalescing and are relayed
+// chunk by chunk as the provider sends them. "Cache-Control: no-store" also
+// bypasses both; "no-cache" skips the lookup but still stores the answer.
+class LlmGateway : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QUrl upstream = QUrl("https://api.groq.com");
+        QString apiKey;        // used when the client sends no Authorization
+        int ttlSeconds = 600;
+        int timeoutMs = 60000;
+    };
+
+    LlmGateway(const Options &options, KvStore *cache, QObject *parent = nullptr);
+
+    void install(HttpServer *server);
+
+    QJsonObject stats() const;
+
+private:
+    struct Flight {
+        QString model;
+        QList<HttpServer::Respond> waiters;
+    };
+
+    struct ModelStats {
+        quint64 requests = 0;
+        quint64 cacheHits = 0;
+        quint64 coalesced = 0;
+        quint64 upstreamCalls = 0;
+        quint64 errors = 0;
+        quint64 promptTokens = 0;
+        quint64 completionTokens = 0;
+        quint64 savedTokens = 0;      // usage of answers served without a call
+        HdrHistogram upstreamLatency; // µs
+    };
+
+    Options options;
+    KvStore *cache;
+    QNetworkAccessManager *network;
+    QHash<QByteArray, Flight> inFlight;
+    QHash<QString, ModelStats> models;
+    quint64 uncoalesced = 0; // keys for requests that bypass single flight
+
+    void complete(const HttpServer::Request &request, const HttpServer::Respond &respond);
+    QNetworkRequest upstreamRequest(const QString &path, const QByteArray &authorization) const;
+    void relay(const HttpServer::Request &request, const HttpServer::Respond &respond, const QString &model);
+    void forward(const QString &path, const QByteArray &key, const QString &model, const QByteArray &body,
+                 const QByteArray &authorization, bool store);
+    void finish(const QByteArray &key, int status, const QByteArray &body);
+    static QByteArray cacheKey(const QString &path, const QJsonObject &body);
+    static quint64 totalTokens(const QByteArray &completion);
+};
+
+#endif // LLMGATEWAY_H
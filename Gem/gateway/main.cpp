@@ -0,0 +1,103 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QTimer>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "httpserver.h"
+#include "kvstore.h"
+#include "llmgateway.h"
+
+// gem-gateway: the backend's single route to the LLM provider.
+//
+// Serves the chat completions endpoint on a loopback port (point a Groq
+// client's baseURL at it) with single-flight coalescing and a TTL response
+// cache kept in a KvStore file, and reports per-model counters and upstream
+// latency at GET /stats. --upstream can name any compatible server, e.g.
+// gem-replay's mock LLM. Prints GEM_READY once listening; under the
+// supervisor (GEM_SUPERVISED) it exits when stdin closes.
+
+namespace {
+
+const int ExpireIntervalMs = 1000;
+const size_t ExpireChecks = 256;
+const int FlushIntervalMs = 5000;
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gem-gateway");
+
+    const QString defaultCache = QDir(QCoreApplication::applicationDirPath()).filePath("config/gem-gateway.db");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption portOption("port", "Loopback port to listen on.", "port",
+                                  qEnvironmentVariable("GEM_GATEWAY_PORT", "8787"));
+    QCommandLineOption upstreamOption("upstream", "Provider base URL.", "url",
+                                      qEnvironmentVariable("GROQ_BASE_URL", "https://api.groq.com"));
+    QCommandLineOption ttlOption("ttl", "Seconds a response stays cached (0 disables the cache).", "seconds", "600");
+    QCommandLineOption cacheOption("cache-file", "Response cache file.", "path", defaultCache);
+    QCommandLineOption budgetOption("cache-mb", "Response cache budget in MB.", "mb", "16");
+    QCommandLineOption timeoutOption("timeout", "Upstream request timeout.", "seconds", "60");
+    parser.addOptions({portOption, upstreamOption, ttlOption, cacheOption, budgetOption, timeoutOption});
+    parser.process(app);
+
+    KvStore::Options cacheOptions;
+    cacheOptions.budgetBytes = quint64(qMax(1, parser.value(budgetOption).toInt())) << 20;
+    cacheOptions.maxEntries = 16384;
+
+    KvStore cache;
+    if (!cache.open(parser.value(cacheOption).toStdString(), cacheOptions)) {
+        std::fprintf(stderr, "gem-gateway: %s\n", cache.lastError().c_str());
+        return 1;
+    }
+
+    LlmGateway::Options options;
+    options.upstream = QUrl(parser.value(upstreamOption));
+    options.apiKey = qEnvironmentVariable("GROQ_API_KEY");
+    options.ttlSeconds = qMax(0, parser.value(ttlOption).toInt());
+    options.timeoutMs = qMax(1, parser.value(timeoutOption).toInt()) * 1000;
+
+    HttpServer server;
+    LlmGateway gateway(options, &cache);
+    gateway.install(&server);
+
+    const quint16 port = quint16(parser.value(portOption).toUInt());
+    if (!server.listen(port)) {
+        std::fprintf(stderr, "gem-gateway: cannot listen on 127.0.0.1:%u: %s\n", unsigned(port),
+                     qPrintable(server.errorString()));
+        return 1;
+    }
+
+    QTimer expireTimer;
+    QObject::connect(&expireTimer, &QTimer::timeout, &app, [&cache]() {
+        cache.expireSome(QDateTime::currentMSecsSinceEpoch(), ExpireChecks);
+    });
+    expireTimer.start(ExpireIntervalMs);
+
+    QTimer flushTimer;
+    QObject::connect(&flushTimer, &QTimer::timeout, &app, [&cache]() { cache.flush(); });
+    flushTimer.start(FlushIntervalMs);
+
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &app, [&cache]() { cache.close(); });
+
+    if (qEnvironmentVariableIsSet("GEM_SUPERVISED")) {
+        // Blocking stdin reads stay off the event loop
+        std::thread([&app]() {
+            std::string line;
+            while (std::getline(std::cin, line)) {}
+            QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+        }).detach();
+    }
+
+    std::printf("gem-gateway: 127.0.0.1:%u -> %s, %zu cached responses\nGEM_READY\n",
+                unsigned(server.port()), qPrintable(options.upstream.toString()), cache.size());
+    std::fflush(stdout);
+
+    return app.exec();
+}
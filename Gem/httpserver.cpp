@@ -0,0 +1,178 @@
+#include "httpserver.h"
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+
+QByteArray statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 504: return "Gateway Timeout";
+    default: return "Unknown";
+    }
+}
+
+} // namespace
+
+HttpServer::HttpServer(QObject *parent) : QObject(parent) {
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &HttpServer::onNewConnection);
+}
+
+bool HttpServer::listen(quint16 port) {
+    if (!server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "HTTP: listen failed:" << server->errorString();
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::route(const QByteArray &method, const QString &path, Handler handler) {
+    routes.insert(method + ' ' + path.toUtf8(), std::move(handler));
+}
+
+void HttpServer::onNewConnection() {
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &HttpServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void HttpServer::onReadyRead() {
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket || !buffers.contains(socket)) return;
+
+    buffers[socket].append(socket->readAll());
+
+    // Pipelined requests are answered in arrival order as long as handlers
+    // respond synchronously; clients here never pipeline anyway. The buffer
+    // is looked up again each time round since a response can close the
+    // connection and drop it.
+    for (auto buffer = buffers.find(socket); buffer != buffers.end() && !buffer->isEmpty();
+         buffer = buffers.find(socket)) {
+        Request request;
+        bool complete = false;
+        if (!parseRequest(*buffer, &request, &complete)) {
+            writeResponse(socket, complete ? 413 : 400, QByteArray(), "text/plain", false);
+            socket->disconnectFromHost();
+            return;
+        }
+        if (!complete) return;
+        ++requests;
+        request.connection = socket;
+        request.keepAlive = request.headers.value("connection").toLower() != "close";
+        dispatch(socket, request);
+    }
+}
+
+bool HttpServer::parseRequest(QByteArray &buffer, Request *request, bool *complete) {
+    const int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        *complete = buffer.size() > MaxHeaderSize;
+        return !*complete;
+    }
+    if (headerEnd > MaxHeaderSize) {
+        *complete = true;
+        return false;
+    }
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) return false;
+
+    for (int i = 1; i < lines.size(); ++i) {
+        const int colon = lines[i].indexOf(':');
+        if (colon <= 0) continue;
+        request->headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+    }
+
+    bool ok = true;
+    const qint64 length = request->headers.value("content-length", "0").toLongLong(&ok);
+    if (!ok || length < 0) return false;
+    if (length > MaxBodySize) {
+        *complete = true;
+        return false;
+    }
+
+    const qint64 total = headerEnd + 4 + length;
+    if (buffer.size() < total) {
+        *complete = false;
+        return true;
+    }
+
+    const QUrl url(QString::fromUtf8(requestLine[1]));
+    request->method = requestLine[0];
+    request->path = url.path();
+    request->query = QUrlQuery(url);
+    request->body = buffer.mid(headerEnd + 4, length);
+    buffer.remove(0, total);
+    *complete = true;
+    return true;
+}
+
+void HttpServer::dispatch(QTcpSocket *socket, const Request &request) {
+    const bool keepAlive = request.keepAlive;
+    QPointer<QTcpSocket> target(socket);
+    Respond respond = [target, keepAlive](int status, const QByteArray &body, const QByteArray &contentType) {
+        if (!target || target->state() != QAbstractSocket::ConnectedState) return;
+        writeResponse(target, status, body, contentType, keepAlive);
+        if (!keepAlive) target->disconnectFromHost();
+    };
+
+    const auto handler = routes.constFind(request.method + ' ' + request.path.toUtf8());
+    if (handler == routes.constEnd()) {
+        respond(404, "{\"error\":\"not found\"}", "application/json");
+        return;
+    }
+    (*handler)(request, respond);
+}
+
+bool HttpServer::beginChunked(const Request &request, int status, const QByteArray &contentType) {
+    QTcpSocket *socket = request.connection;
+    if (!socket || socket->state() != QAbstractSocket::ConnectedState) return false;
+
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    head += "Content-Type: " + contentType + "\r\n";
+    head += "Cache-Control: no-cache\r\n";
+    head += "Transfer-Encoding: chunked\r\n";
+    head += request.keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    socket->write(head);
+    return true;
+}
+
+bool HttpServer::writeChunk(const Request &request, const QByteArray &data) {
+    QTcpSocket *socket = request.connection;
+    if (!socket || socket->state() != QAbstractSocket::ConnectedState) return false;
+    if (data.isEmpty()) return true; // an empty chunk would end the response
+    socket->write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+    return true;
+}
+
+void HttpServer::endChunked(const Request &request) {
+    QTcpSocket *socket = request.connection;
+    if (!socket || socket->state() != QAbstractSocket::ConnectedState) return;
+    socket->write("0\r\n\r\n");
+    if (!request.keepAlive) socket->disconnectFromHost();
+}
+
+void HttpServer::writeResponse(QTcpSocket *socket, int status, const QByteArray &body,
+                               const QByteArray &contentType, bool keepAlive) {
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    head += "Content-Type: " + contentType + "\r\n";
+    head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    head += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    socket->write(head);
+    socket->write(body);
+}
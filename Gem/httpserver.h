@@ -0,0 +1,72 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QHash>
+#include <QByteArray>
+#include <QUrlQuery>
+#include <functional>
+
+// Just enough HTTP/1.1 for the local tools (gem-replay's stand-ins, the LLM
+// gateway): one route per method and path, Content-Length bodies,
+// keep-alive. Handlers answer through the Respond callback, which may be
+// kept and called later (to simulate latency, or once an upstream request
+// finishes); a response for a connection that has closed in the meantime is
+// dropped. A handler can instead stream its answer with the chunked
+// helpers.
+class HttpServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int MaxHeaderSize = 64 * 1024;
+    static constexpr int MaxBodySize = 16 * 1024 * 1024;
+
+    struct Request {
+        QByteArray method;
+        QString path;
+        QUrlQuery query;
+        QHash<QByteArray, QByteArray> headers; // lower-cased names
+        QByteArray body;
+        QPointer<QTcpSocket> connection;       // for chunked responses
+        bool keepAlive = true;
+    };
+
+    using Respond = std::function<void(int status, const QByteArray &body, const QByteArray &contentType)>;
+    using Handler = std::function<void(const Request &request, const Respond &respond)>;
+
+    explicit HttpServer(QObject *parent = nullptr);
+
+    bool listen(quint16 port); // 0 picks a free port
+    quint16 port() const { return server->serverPort(); }
+    QString errorString() const { return server->errorString(); }
+
+    void route(const QByteArray &method, const QString &path, Handler handler);
+
+    // Chunked responses, for relaying a stream as it arrives: a handler may
+    // use these with its request instead of Respond. False once the client
+    // has gone.
+    static bool beginChunked(const Request &request, int status, const QByteArray &contentType);
+    static bool writeChunk(const Request &request, const QByteArray &data);
+    static void endChunked(const Request &request);
+
+    quint64 requestCount() const { return requests; }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    QTcpServer *server;
+    QHash<QByteArray, Handler> routes; // "METHOD path"
+    QHash<QTcpSocket*, QByteArray> buffers;
+    quint64 requests = 0;
+
+    bool parseRequest(QByteArray &buffer, Request *request, bool *complete);
+    void dispatch(QTcpSocket *socket, const Request &request);
+    static void writeResponse(QTcpSocket *socket, int status, const QByteArray &body,
+                              const QByteArray &contentType, bool keepAlive);
+};
+
+#endif // HTTPSERVER_H
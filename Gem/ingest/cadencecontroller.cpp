@@ -0,0 +1,86 @@
+#include "cadencecontroller.h"
+#include <cmath>
+#include "simhash.h"
+
+namespace {
+
+const int MaxScopes = 4096; // window titles come and go; start over past this
+
+} // namespace
+
+bool ChangeDetector::observe(const OcrFrame &frame) {
+    const quint64 print = simhash(frame.text.toStdString());
+    const QString scope = scopeOf(frame);
+
+    auto it = prints.find(scope);
+    if (it == prints.end()) {
+        if (prints.size() >= MaxScopes) prints.clear();
+        prints.insert(scope, print);
+        return true;
+    }
+    if (hammingDistance(*it, print) <= distanceLimit) return false;
+    *it = print;
+    return true;
+}
+
+CadenceController::CadenceController(const Options &opts, int initialMs)
+    : options(opts)
+{
+    options.minIntervalMs = qMax(100, options.minIntervalMs);
+    options.maxIntervalMs = qMax(options.minIntervalMs, options.maxIntervalMs);
+    options.step = qMax(1.01, options.step);
+    intervalMs = qBound(options.minIntervalMs, initialMs, options.maxIntervalMs);
+    last.intervalMs = last.previousMs = intervalMs;
+    last.reason = "steady";
+}
+
+CadenceController::Decision CadenceController::observe(const Sample &sample) {
+    auto smooth = [this](double average, double value) {
+        return average < 0 ? value : average + options.smoothing * (value - average);
+    };
+    if (sample.elapsedMs > 0)
+        changesPerMin = smooth(changesPerMin, sample.changed * 60000.0 / double(sample.elapsedMs));
+    if (sample.cleaned > 0)
+        hitRate = smooth(hitRate, 1.0 - double(qMin(sample.llmCalls, sample.cleaned)) / double(sample.cleaned));
+    const double load = double(sample.queued) / double(qMax(1, sample.capacity));
+    const double changes = qMax(0.0, changesPerMin);
+    const bool cached = hitRate >= options.cachedHitRate;
+
+    // +1 faster, -1 slower
+    int direction = 0;
+    QString reason = "steady";
+    if (load >= options.backlogLoad) {
+        direction = -1;
+        reason = "backlog";
+    } else if (changes >= options.busyChangesPerMin && !cached) {
+        direction = 1;
+        reason = "busy";
+    } else if (changes <= options.idleChangesPerMin) {
+        direction = -1;
+        reason = "idle";
+    } else if (cached) {
+        direction = -1;
+        reason = "cached";
+    }
+
+    if (direction == 0) streak = 0;
+    else if (direction > 0) streak = streak > 0 ? streak + 1 : 1;
+    else streak = streak < 0 ? streak - 1 : -1;
+
+    Decision decision;
+    decision.previousMs = intervalMs;
+    decision.reason = reason;
+    decision.changesPerMin = changes;
+    decision.hitRate = hitRate;
+    decision.load = load;
+
+    // A backlog can't wait; each other step needs its own run of sweeps
+    if (direction != 0 && (reason == "backlog" || std::abs(streak) >= options.confirmSweeps)) {
+        const double next = direction > 0 ? intervalMs / options.step : intervalMs * options.step;
+        intervalMs = qBound(options.minIntervalMs, int(std::lround(next)), options.maxIntervalMs);
+        streak = 0;
+    }
+    decision.intervalMs = intervalMs;
+    last = decision;
+    return decision;
+}
@@ -0,0 +1,90 @@
+#ifndef CADENCECONTROLLER_H
+#define CADENCECONTROLLER_H
+
+#include <QHash>
+#include <QString>
+#include "ocrframe.h"
+
+// Counts screen changes among OCR frames: a frame changed its screen when
+// its SimHash is more than maxDistance bits from the last changed frame of
+// the same app and window (so slow drift adds up to a change too). The
+// first frame of a window counts as a change.
+class ChangeDetector {
+public:
+    explicit ChangeDetector(int maxDistance = 6) : distanceLimit(maxDistance) {}
+
+    bool observe(const OcrFrame &frame);
+    void clear() { prints.clear(); }
+
+    static QString scopeOf(const OcrFrame &frame) { return frame.appName + QChar(0x1f) + frame.windowName; }
+
+private:
+    int distanceLimit;
+    QHash<QString, quint64> prints; // scope -> last fingerprint
+};
+
+// Picks the sweep interval from what the last sweeps saw. Three signals,
+// each smoothed over recent sweeps:
+//   - screen changes per minute, over every frame fetched (so the rate
+//     doesn't depend on how often we sweep)
+//   - the backend's cache hit rate, how many cleaned frames needed no LLM
+//   - queue load, frames waiting for the backend against capacity
+// A busy screen the cache can't absorb sweeps more often; a quiet or
+// mostly cached one, or a backlog, less often. The busy and idle
+// thresholds leave a dead band between them, and a step either way must be
+// called for confirmSweeps sweeps running (a backlog excepted), so the
+// interval doesn't flap around a threshold.
+class CadenceController {
+public:
+    struct Options {
+        int minIntervalMs = 2000;
+        int maxIntervalMs = 30000;
+        double busyChangesPerMin = 4.0; // faster at or above
+        double idleChangesPerMin = 1.0; // slower at or below
+        double cachedHitRate = 0.9;     // slower at or above, unless busy with misses
+        double backlogLoad = 0.5;       // slower at once at or above
+        double smoothing = 0.3;         // weight of the newest sweep
+        double step = 1.5;              // interval factor per decision
+        int confirmSweeps = 2;
+    };
+
+    struct Sample {
+        qint64 elapsedMs = 0; // since the previous sweep
+        int frames = 0;       // new frames fetched
+        int changed = 0;      // of which changed their screen
+        qint64 cleaned = 0;   // frames the backend cleaned since the last sample
+        qint64 llmCalls = 0;  // of which needed the LLM
+        int queued = 0;       // frames waiting for the backend
+        int capacity = 1;
+    };
+
+    struct Decision {
+        int intervalMs = 0;
+        int previousMs = 0;
+        // What the signals call for: busy, idle, cached, backlog or steady.
+        // The interval moves only once a step is confirmed, and not past
+        // the bounds.
+        QString reason;
+        double changesPerMin = 0.0;
+        double hitRate = -1.0; // -1 until the backend reports
+        double load = 0.0;
+
+        bool changed() const { return intervalMs != previousMs; }
+    };
+
+    CadenceController(const Options &options, int initialMs);
+
+    Decision observe(const Sample &sample);
+    int interval() const { return intervalMs; }
+    const Decision &lastDecision() const { return last; }
+
+private:
+    Options options;
+    int intervalMs;
+    double changesPerMin = -1.0; // -1 before the first sample
+    double hitRate = -1.0;
+    int streak = 0;              // > 0 sweeps calling for faster, < 0 for slower
+    Decision last;
+};
+
+#endif // CADENCECONTROLLER_H
@@ -0,0 +1,178 @@
+#include "ingestengine.h"
+#include <QDateTime>
+#include <algorithm>
+
+IngestEngine::IngestEngine(const Options &opts, QObject *parent)
+    : QObject(parent), options(opts), cadence(opts.cadence, opts.intervalMs)
+{
+    if (options.adaptive) options.intervalMs = cadence.interval();
+
+    client = new ScreenpipeClient(options.url, this);
+    connect(client, &ScreenpipeClient::frameParsed, this, &IngestEngine::onFrameParsed);
+    connect(client, &ScreenpipeClient::pageFinished, this, &IngestEngine::onPageFinished);
+
+    sweepTimer = new QTimer(this);
+    sweepTimer->setSingleShot(true);
+    connect(sweepTimer, &QTimer::timeout, this, &IngestEngine::sweep);
+}
+
+void IngestEngine::start(qint64 startCursor) {
+    cursorMs = startCursor > 0 ? startCursor
+                               : QDateTime::currentMSecsSinceEpoch() - options.intervalMs;
+    scheduleSweep(0);
+}
+
+void IngestEngine::stop() {
+    sweepTimer->stop();
+    client->abort();
+    sweeping = false;
+}
+
+void IngestEngine::setInterval(int ms) {
+    options.intervalMs = qMax(100, ms);
+
+    // Pull an idle wait in if the new interval is shorter
+    if (sweepTimer->isActive() && sweepTimer->remainingTime() > options.intervalMs)
+        sweepTimer->start(options.intervalMs);
+}
+
+void IngestEngine::reportCleaning(qint64 cleaned, qint64 llmCalls) {
+    // A restarted backend counts from zero again
+    if (cleaned < cleanedTotal || llmCalls < llmTotal) cleanedSampled = llmSampled = 0;
+    cleanedTotal = cleaned;
+    llmTotal = llmCalls;
+}
+
+OcrFrame IngestEngine::takeFrame() {
+    OcrFrame frame = queue.dequeue();
+
+    // Resume once the consumer has drained half the queue
+    if (blocked && queue.size() <= options.capacity / 2) {
+        blocked = false;
+        scheduleSweep(0);
+    }
+    return frame;
+}
+
+void IngestEngine::scheduleSweep(int delayMs) {
+    sweepTimer->start(qMax(0, delayMs));
+}
+
+void IngestEngine::sweep() {
+    if (sweeping) return;
+    if (queue.size() >= options.capacity) {
+        blocked = true;
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    windowStart = qMax<qint64>(0, cursorMs - options.lookbackMs);
+    windowEnd = qMin(now, cursorMs + options.maxWindowMs);
+    if (windowEnd <= windowStart) {
+        scheduleSweep(options.intervalMs);
+        return;
+    }
+
+    sweeping = true;
+    sweepStartedMs = now;
+    pageOffset = 0;
+    sweepFrames.clear();
+    client->fetchPage(windowStart, windowEnd, pageOffset, options.pageSize);
+}
+
+void IngestEngine::onFrameParsed(const OcrFrame &frame) {
+    if (sweeping) sweepFrames.append(frame);
+}
+
+void IngestEngine::onPageFinished(int items, bool ok, const QString &error) {
+    if (!sweeping) return;
+
+    if (!ok) {
+        // Cursor stays put; the same window is retried next time
+        sweeping = false;
+        sweepFrames.clear();
+        emit sweepFailed(error);
+        scheduleSweep(options.intervalMs);
+        return;
+    }
+
+    if (items >= options.pageSize) {
+        pageOffset += items;
+        client->fetchPage(windowStart, windowEnd, pageOffset, options.pageSize);
+        return;
+    }
+
+    commitSweep();
+}
+
+void IngestEngine::commitSweep() {
+    sweeping = false;
+
+    std::sort(sweepFrames.begin(), sweepFrames.end(), [](const OcrFrame &a, const OcrFrame &b) {
+        return a.timestampMs != b.timestampMs ? a.timestampMs < b.timestampMs : a.frameId < b.frameId;
+    });
+
+    const qint64 sweepEndedMs = QDateTime::currentMSecsSinceEpoch();
+    int fresh = 0, duplicates = 0, changed = 0;
+    QVector<OcrFrame *> accepted;
+    for (OcrFrame &frame : sweepFrames) {
+        const QString key = frame.key();
+        if (delivered.contains(key)) {
+            ++duplicates;
+            continue;
+        }
+        delivered.insert(key, frame.timestampMs);
+        if (changes.observe(frame)) ++changed;
+        frame.queryStartMs = sweepStartedMs;
+        frame.queryEndMs = sweepEndedMs;
+        accepted.append(&frame);
+    }
+
+    // Frames are in time order, so the last one seen of a window is its newest
+    QHash<QString, int> newest;
+    if (options.coalesce) {
+        for (int i = 0; i < accepted.size(); ++i) newest.insert(ChangeDetector::scopeOf(*accepted[i]), i);
+    }
+    int superseded = 0;
+    for (int i = 0; i < accepted.size(); ++i) {
+        if (options.coalesce && newest.value(ChangeDetector::scopeOf(*accepted[i])) != i) {
+            ++superseded;
+            continue;
+        }
+        queue.enqueue(*accepted[i]);
+        ++fresh;
+    }
+
+    if (options.adaptive) {
+        // Rates are over the span of recording this sweep covered, not wall
+        // time, so catching up after a pause doesn't read as a busy screen
+        CadenceController::Sample sample;
+        sample.elapsedMs = windowEnd - cursorMs;
+        sample.frames = accepted.size();
+        sample.changed = changed;
+        sample.cleaned = cleanedTotal - cleanedSampled;
+        sample.llmCalls = llmTotal - llmSampled;
+        sample.queued = queue.size();
+        sample.capacity = options.capacity;
+        cleanedSampled = cleanedTotal;
+        llmSampled = llmTotal;
+        options.intervalMs = cadence.observe(sample).intervalMs;
+    }
+    sweepFrames.clear();
+
+    cursorMs = windowEnd;
+
+    // Nothing older than the next window's start can be fetched again
+    const qint64 horizon = cursorMs - options.lookbackMs;
+    for (auto it = delivered.begin(); it != delivered.end();) {
+        if (it.value() < horizon) it = delivered.erase(it);
+        else ++it;
+    }
+
+    const qint64 lag = QDateTime::currentMSecsSinceEpoch() - cursorMs;
+    emit sweepFinished(fresh, duplicates, superseded, lag);
+    if (fresh > 0) emit frameAvailable();
+
+    // Still behind (after a pause or a backlog): keep sweeping until caught up
+    scheduleSweep(lag > options.maxWindowMs / 2 ? 0 : options.intervalMs);
+}
@@ -0,0 +1,98 @@
+#ifndef INGESTENGINE_H
+#define INGESTENGINE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QUrl>
+#include <QHash>
+#include <QQueue>
+#include <QVector>
+#include "ocrframe.h"
+#include "cadencecontroller.h"
+#include "screenpipeclient.h"
+
+// Pulls OCR frames from Screenpipe with a monotonic time cursor. Each sweep
+// covers [cursor - lookback, cursor + window], pages through it completely,
+// and only then advances the cursor; the lookback catches rows Screenpipe
+// inserts late, and a key set over that span drops anything already
+// delivered. New frames go to a bounded queue, and sweeps pause while the
+// queue is full so a slow consumer throttles fetching instead of losing data.
+//
+// With coalesce, a sweep queues only the newest frame of each app and
+// window, so the interval sets how many frames the backend cleans. With
+// adaptive, a CadenceController moves the interval between its bounds after
+// every sweep.
+class IngestEngine : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QUrl url = QUrl("http://localhost:3030");
+        int intervalMs = 10000;
+        int pageSize = 50;
+        int capacity = 256;
+        int lookbackMs = 5000;
+        int maxWindowMs = 60000;
+        bool coalesce = false;
+        bool adaptive = false;
+        CadenceController::Options cadence;
+    };
+
+    explicit IngestEngine(const Options &options, QObject *parent = nullptr);
+
+    // cursorMs = 0 starts one interval back from now
+    void start(qint64 cursorMs = 0);
+    void stop();
+
+    bool hasFrame() const { return !queue.isEmpty(); }
+    OcrFrame takeFrame();
+    int queueDepth() const { return queue.size(); }
+    int capacity() const { return options.capacity; }
+    qint64 cursor() const { return cursorMs; }
+
+    int interval() const { return options.intervalMs; }
+    void setInterval(int ms);
+
+    // Running totals from the backend: frames cleaned, and how many of them
+    // needed the LLM (the rest hit a cache); feeds the cadence controller
+    void reportCleaning(qint64 cleaned, qint64 llmCalls);
+    bool isAdaptive() const { return options.adaptive; }
+    const CadenceController::Decision &cadenceDecision() const { return cadence.lastDecision(); }
+
+signals:
+    void frameAvailable();
+    // superseded: older frames of a window dropped by coalescing
+    void sweepFinished(int newFrames, int duplicates, int superseded, qint64 lagMs);
+    void sweepFailed(const QString &error);
+
+private slots:
+    void sweep();
+    void onFrameParsed(const OcrFrame &frame);
+    void onPageFinished(int items, bool ok, const QString &error);
+
+private:
+    Options options;
+    ScreenpipeClient *client;
+    QTimer *sweepTimer;
+
+    qint64 cursorMs = 0;
+    qint64 windowStart = 0;
+    qint64 windowEnd = 0;
+    qint64 sweepStartedMs = 0;
+    int pageOffset = 0;
+    bool sweeping = false;
+    bool blocked = false;
+
+    ChangeDetector changes;
+    CadenceController cadence;
+    qint64 cleanedTotal = 0, llmTotal = 0;     // as reported
+    qint64 cleanedSampled = 0, llmSampled = 0; // at the last sample
+
+    QVector<OcrFrame> sweepFrames;
+    QHash<QString, qint64> delivered; // key -> timestamp, pruned to the lookback span
+    QQueue<OcrFrame> queue;
+
+    void scheduleSweep(int delayMs);
+    void commitSweep();
+};
+
+#endif // INGESTENGINE_H
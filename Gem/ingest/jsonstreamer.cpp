@@ -0,0 +1,119 @@
+#include "jsonstreamer.h"
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+} // namespace
+
+JsonArrayStreamer::JsonArrayStreamer(std::string key) : key(std::move(key)) {}
+
+void JsonArrayStreamer::reset() {
+    state = State::SeekingKey;
+    depth = 0;
+    arrayDepth = 0;
+    inString = false;
+    escape = false;
+    expectColon = false;
+    inElement = false;
+    currentString.clear();
+    element.clear();
+}
+
+void JsonArrayStreamer::finishElement(const Callback &onElement) {
+    while (!element.empty() && isSpace(element.back())) element.pop_back();
+    if (!element.empty()) onElement(element);
+    element.clear();
+    inElement = false;
+}
+
+bool JsonArrayStreamer::feed(std::string_view chunk, const Callback &onElement) {
+    for (char c : chunk) {
+        if (state == State::Done || state == State::Failed) break;
+        if (inElement) element.push_back(c);
+
+        if (inString) {
+            if (escape) {
+                escape = false;
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                inString = false;
+                expectColon = state == State::SeekingKey && depth == 1;
+                continue;
+            }
+            if (state == State::SeekingKey && depth == 1 && currentString.size() <= key.size())
+                currentString.push_back(c);
+            continue;
+        }
+
+        if (isSpace(c)) continue;
+
+        switch (state) {
+        case State::SeekingKey: {
+            const bool keyMatched = expectColon && c == ':' && currentString == key;
+            expectColon = false;
+            if (keyMatched) {
+                state = State::SeekingArray;
+            } else if (c == '"') {
+                inString = true;
+                currentString.clear();
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth < 0) state = State::Failed;
+                else if (depth == 0) state = State::Done; // document ended without the key
+            }
+            break;
+        }
+        case State::SeekingArray:
+            if (c == '[') {
+                arrayDepth = ++depth;
+                state = State::InArray;
+            } else {
+                state = State::Done; // null or some other non-array value
+            }
+            break;
+        case State::InArray:
+            if (!inElement) {
+                if (c == ',') break;
+                if (c == ']') {
+                    --depth;
+                    state = State::Done;
+                    break;
+                }
+                inElement = true;
+                element.assign(1, c);
+                if (c == '"') inString = true;
+                else if (c == '{' || c == '[') ++depth;
+                break;
+            }
+
+            if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (depth == arrayDepth) {
+                    // Closing bracket of the array right after a scalar element
+                    element.pop_back();
+                    finishElement(onElement);
+                    --depth;
+                    state = State::Done;
+                } else if (--depth == arrayDepth) {
+                    finishElement(onElement);
+                }
+            } else if (c == ',' && depth == arrayDepth) {
+                element.pop_back();
+                finishElement(onElement);
+            }
+            break;
+        case State::Done:
+        case State::Failed:
+            break;
+        }
+    }
+    return state != State::Failed;
+}
@@ -0,0 +1,42 @@
+#ifndef JSONSTREAMER_H
+#define JSONSTREAMER_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Incrementally splits the elements of one top-level array member (e.g. the
+// "data" array of a Screenpipe /search response) out of a JSON document fed
+// in arbitrary chunks. Only the element currently being read is buffered, so
+// memory stays bounded by the largest element rather than the whole body.
+class JsonArrayStreamer {
+public:
+    using Callback = std::function<void(std::string_view element)>;
+
+    explicit JsonArrayStreamer(std::string key = "data");
+
+    // Returns false once the input can no longer be a well-formed document
+    bool feed(std::string_view chunk, const Callback &onElement);
+    void reset();
+
+    bool finished() const { return state == State::Done; }
+    bool failed() const { return state == State::Failed; }
+
+private:
+    enum class State { SeekingKey, SeekingArray, InArray, Done, Failed };
+
+    std::string key;
+    State state = State::SeekingKey;
+    int depth = 0;
+    int arrayDepth = 0;
+    bool inString = false;
+    bool escape = false;
+    bool expectColon = false;
+    bool inElement = false;
+    std::string currentString;
+    std::string element;
+
+    void finishElement(const Callback &onElement);
+};
+
+#endif // JSONSTREAMER_H
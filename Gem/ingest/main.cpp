@@ -0,0 +1,140 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "ingestengine.h"
+
+// gem-ingest: streams Screenpipe OCR frames to the node poller.
+//
+// stdout carries one JSON object per line: {"type":"frame","frame":{...}},
+// {"type":"status",...}, {"type":"error",...} and a first {"type":"ready"}.
+// stdin carries flow control: "credit N" allows N more frames to be written.
+// Frames wait in the engine's bounded queue until there is credit, and the
+// process exits when stdin closes. With --adaptive, stdin also carries
+// "cleaned TOTAL LLM", the backend's running count of frames cleaned and of
+// those that needed the LLM, and status messages carry the cadence
+// controller's last decision.
+
+namespace {
+
+void writeLine(const QJsonObject &message) {
+    const QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+    std::fwrite(line.constData(), 1, size_t(line.size()), stdout);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gem-ingest");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption urlOption("url", "Screenpipe base URL.", "url",
+                                 QString("http://localhost:%1").arg(qEnvironmentVariable("SCREENPIPE_PORT", "3030")));
+    QCommandLineOption intervalOption("interval", "Seconds between sweeps.", "seconds", "10");
+    QCommandLineOption pageOption("page-size", "Items per /search request.", "count", "50");
+    QCommandLineOption capacityOption("capacity", "Frames buffered before fetching pauses.", "count", "256");
+    QCommandLineOption lookbackOption("lookback", "Seconds re-read behind the cursor for late rows.", "seconds", "5");
+    QCommandLineOption cursorOption("cursor", "Resume from this time (ms since epoch).", "ms", "0");
+    QCommandLineOption coalesceOption("coalesce", "Queue only the newest frame of each window per sweep.");
+    QCommandLineOption adaptiveOption("adaptive", "Adapt the interval to the screen's change rate; "
+                                      "--interval is where it starts.");
+    QCommandLineOption minIntervalOption("min-interval", "Shortest adaptive interval.", "seconds", "2");
+    QCommandLineOption maxIntervalOption("max-interval", "Longest adaptive interval.", "seconds", "30");
+    parser.addOptions({urlOption, intervalOption, pageOption, capacityOption, lookbackOption, cursorOption,
+                       coalesceOption, adaptiveOption, minIntervalOption, maxIntervalOption});
+    parser.process(app);
+
+    IngestEngine::Options options;
+    options.url = QUrl(parser.value(urlOption));
+    options.intervalMs = qMax(1, parser.value(intervalOption).toInt()) * 1000;
+    options.pageSize = qMax(1, parser.value(pageOption).toInt());
+    options.capacity = qMax(1, parser.value(capacityOption).toInt());
+    options.lookbackMs = qMax(0, parser.value(lookbackOption).toInt()) * 1000;
+    options.adaptive = parser.isSet(adaptiveOption);
+    options.coalesce = parser.isSet(coalesceOption);
+    options.cadence.minIntervalMs = qMax(1, parser.value(minIntervalOption).toInt()) * 1000;
+    options.cadence.maxIntervalMs = qMax(1, parser.value(maxIntervalOption).toInt()) * 1000;
+
+    IngestEngine engine(options);
+    qint64 credits = 0;
+
+    auto pump = [&]() {
+        while (credits > 0 && engine.hasFrame()) {
+            QJsonObject message;
+            message["type"] = "frame";
+            message["frame"] = engine.takeFrame().toJson();
+            writeLine(message);
+            --credits;
+        }
+    };
+
+    QObject::connect(&engine, &IngestEngine::frameAvailable, &app, pump);
+
+    QObject::connect(&engine, &IngestEngine::sweepFinished, &app,
+                     [&](int fresh, int duplicates, int superseded, qint64 lag) {
+        QJsonObject message;
+        message["type"] = "status";
+        message["new"] = fresh;
+        message["duplicates"] = duplicates;
+        message["superseded"] = superseded;
+        message["lagMs"] = lag;
+        message["queue"] = engine.queueDepth();
+        message["cursor"] = engine.cursor();
+        message["intervalMs"] = engine.interval();
+        if (engine.isAdaptive()) {
+            const CadenceController::Decision &decision = engine.cadenceDecision();
+            QJsonObject cadence;
+            cadence["intervalMs"] = decision.intervalMs;
+            cadence["previousMs"] = decision.previousMs;
+            cadence["reason"] = decision.reason;
+            cadence["changesPerMin"] = decision.changesPerMin;
+            cadence["hitRate"] = decision.hitRate;
+            cadence["load"] = decision.load;
+            message["cadence"] = cadence;
+        }
+        writeLine(message);
+    });
+
+    QObject::connect(&engine, &IngestEngine::sweepFailed, &app, [&](const QString &error) {
+        QJsonObject message;
+        message["type"] = "error";
+        message["message"] = error;
+        writeLine(message);
+    });
+
+    // Blocking stdin reads stay off the event loop
+    std::thread([&app, &engine, &credits, &pump]() {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.rfind("cleaned ", 0) == 0) {
+                long long cleaned = 0, llmCalls = 0;
+                if (std::sscanf(line.c_str() + 8, "%lld %lld", &cleaned, &llmCalls) != 2) continue;
+                QMetaObject::invokeMethod(&app, [&engine, cleaned, llmCalls]() {
+                    engine.reportCleaning(cleaned, llmCalls);
+                }, Qt::QueuedConnection);
+                continue;
+            }
+            if (line.rfind("credit ", 0) != 0) continue;
+            const qint64 granted = std::atoll(line.c_str() + 7);
+            if (granted <= 0) continue;
+            QMetaObject::invokeMethod(&app, [&credits, &pump, granted]() {
+                credits += granted;
+                pump();
+            }, Qt::QueuedConnection);
+        }
+        QMetaObject::invokeMethod(&app, &QCoreApplication::quit, Qt::QueuedConnection);
+    }).detach();
+
+    writeLine(QJsonObject{{"type", "ready"}});
+    engine.start(parser.value(cursorOption).toLongLong());
+
+    return app.exec();
+}
@@ -0,0 +1,86 @@
+#include "ocrframe.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+
+namespace {
+
+// Screenpipe reports nanosecond precision; Qt only parses milliseconds
+qint64 parseTimestamp(const QString &timestamp) {
+    QString trimmed = timestamp;
+    const int dot = trimmed.indexOf('.');
+    if (dot >= 0) {
+        int end = dot + 1;
+        while (end < trimmed.size() && trimmed[end].isDigit()) ++end;
+        trimmed = trimmed.left(qMin(end, dot + 4)) + trimmed.mid(end);
+    }
+    const QDateTime parsed = QDateTime::fromString(trimmed, Qt::ISODateWithMs);
+    return parsed.isValid() ? parsed.toMSecsSinceEpoch() : 0;
+}
+
+} // namespace
+
+QString OcrFrame::key() const {
+    if (frameId > 0)
+        return QString("%1\x1f%2\x1f%3").arg(frameId).arg(appName, windowName);
+
+    // No frame id: fall back to time plus content
+    const QByteArray digest = QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QString("%1\x1f%2").arg(timestamp, QString::fromLatin1(digest));
+}
+
+bool OcrFrame::fromSearchItem(const QJsonObject &item, OcrFrame *frame) {
+    if (item.value("type").toString().compare("OCR", Qt::CaseInsensitive) != 0) return false;
+
+    const QJsonObject content = item.value("content").toObject();
+    frame->frameId = content.value("frame_id").toVariant().toLongLong();
+    frame->timestamp = content.value("timestamp").toString();
+    frame->timestampMs = parseTimestamp(frame->timestamp);
+    frame->appName = content.value("app_name").toString();
+    frame->windowName = content.value("window_name").toString();
+    frame->browserUrl = content.value("browser_url").toString();
+    frame->text = content.value("text").toString();
+    return frame->timestampMs > 0;
+}
+
+bool OcrFrame::fromJson(const QJsonObject &json, OcrFrame *frame) {
+    frame->frameId = json.value("frameId").toVariant().toLongLong();
+    frame->timestamp = json.value("timestamp").toString();
+    frame->timestampMs = parseTimestamp(frame->timestamp);
+    frame->appName = json.value("appName").toString();
+    frame->windowName = json.value("windowName").toString();
+    frame->browserUrl = json.value("browserUrl").toString();
+    frame->text = json.value("text").toString();
+    return frame->timestampMs > 0;
+}
+
+QJsonObject OcrFrame::toSearchItem() const {
+    QJsonObject content;
+    content["frame_id"] = frameId;
+    content["timestamp"] = timestamp;
+    content["app_name"] = appName;
+    content["window_name"] = windowName;
+    content["browser_url"] = browserUrl;
+    content["text"] = text;
+
+    QJsonObject item;
+    item["type"] = "OCR";
+    item["content"] = content;
+    return item;
+}
+
+QJsonObject OcrFrame::toJson() const {
+    QJsonObject json;
+    json["frameId"] = frameId;
+    json["timestamp"] = timestamp;
+    json["appName"] = appName;
+    json["windowName"] = windowName;
+    json["browserUrl"] = browserUrl;
+    json["text"] = text;
+    if (queryEndMs > 0) {
+        QJsonObject query;
+        query["start"] = queryStartMs;
+        query["end"] = queryEndMs;
+        json["query"] = query;
+    }
+    return json;
+}
@@ -0,0 +1,35 @@
+#ifndef OCRFRAME_H
+#define OCRFRAME_H
+
+#include <QString>
+#include <QJsonObject>
+
+// One OCR result from Screenpipe, normalised to the field names the node
+// poller already uses.
+struct OcrFrame {
+    qint64 frameId = 0;
+    qint64 timestampMs = 0;
+    QString timestamp;
+    QString appName;
+    QString windowName;
+    QString browserUrl;
+    QString text;
+
+    // When the Screenpipe query that returned this frame ran (for tracing)
+    qint64 queryStartMs = 0;
+    qint64 queryEndMs = 0;
+
+    // Screenpipe stores one OCR row per window of a frame, so the frame id
+    // alone is not unique across monitors and windows.
+    QString key() const;
+
+    static bool fromSearchItem(const QJsonObject &item, OcrFrame *frame);
+    QJsonObject toJson() const;
+
+    // Inverses of the above: read back toJson() output (gem-ingest's frame
+    // messages), and rebuild a /search item (for gem-replay's stand-in)
+    static bool fromJson(const QJsonObject &json, OcrFrame *frame);
+    QJsonObject toSearchItem() const;
+};
+
+#endif // OCRFRAME_H
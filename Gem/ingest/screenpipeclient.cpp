@@ -0,0 +1,81 @@
+#include "screenpipeclient.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QUrlQuery>
+
+namespace {
+
+QString isoTime(qint64 ms) {
+    return QDateTime::fromMSecsSinceEpoch(ms, Qt::UTC).toString(Qt::ISODateWithMs);
+}
+
+} // namespace
+
+ScreenpipeClient::ScreenpipeClient(const QUrl &url, QObject *parent)
+    : QObject(parent), baseUrl(url)
+{
+    network = new QNetworkAccessManager(this);
+}
+
+void ScreenpipeClient::fetchPage(qint64 startMs, qint64 endMs, int offset, int limit) {
+    if (reply) return;
+
+    QUrl url = baseUrl;
+    url.setPath("/search");
+
+    QUrlQuery query;
+    query.addQueryItem("content_type", "ocr");
+    query.addQueryItem("start_time", isoTime(startMs));
+    query.addQueryItem("end_time", isoTime(endMs));
+    query.addQueryItem("offset", QString::number(offset));
+    query.addQueryItem("limit", QString::number(limit));
+    query.addQueryItem("include_frames", "false");
+    url.setQuery(query);
+
+    QNetworkRequest request(url);
+    request.setRawHeader("Connection", "keep-alive");
+
+    streamer.reset();
+    items = 0;
+    reply = network->get(request);
+    connect(reply, &QNetworkReply::readyRead, this, &ScreenpipeClient::onReadyRead);
+    connect(reply, &QNetworkReply::finished, this, &ScreenpipeClient::onFinished);
+}
+
+void ScreenpipeClient::abort() {
+    if (reply) reply->abort();
+}
+
+void ScreenpipeClient::onReadyRead() {
+    const QByteArray chunk = reply->readAll();
+
+    streamer.feed(std::string_view(chunk.constData(), size_t(chunk.size())), [this](std::string_view element) {
+        ++items;
+        const QJsonDocument doc = QJsonDocument::fromJson(
+            QByteArray::fromRawData(element.data(), int(element.size())));
+
+        OcrFrame frame;
+        if (doc.isObject() && OcrFrame::fromSearchItem(doc.object(), &frame))
+            emit frameParsed(frame);
+    });
+}
+
+void ScreenpipeClient::onFinished() {
+    if (reply->bytesAvailable() > 0) onReadyRead();
+
+    QNetworkReply *finished = reply;
+    reply = nullptr;
+    finished->deleteLater();
+
+    if (finished->error() != QNetworkReply::NoError) {
+        emit pageFinished(items, false, finished->errorString());
+        return;
+    }
+    if (streamer.failed() || !streamer.finished()) {
+        emit pageFinished(items, false, "malformed /search response");
+        return;
+    }
+    emit pageFinished(items, true, QString());
+}
@@ -0,0 +1,41 @@
+#ifndef SCREENPIPECLIENT_H
+#define SCREENPIPECLIENT_H
+
+#include <QObject>
+#include <QUrl>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include "jsonstreamer.h"
+#include "ocrframe.h"
+
+// Thin client for Screenpipe's /search endpoint. One QNetworkAccessManager
+// is kept for the lifetime of the client so requests reuse the same
+// keep-alive connection, and response bodies are split into items as they
+// arrive instead of being parsed as one document.
+class ScreenpipeClient : public QObject {
+    Q_OBJECT
+public:
+    explicit ScreenpipeClient(const QUrl &baseUrl, QObject *parent = nullptr);
+
+    // Items are newest first, as Screenpipe returns them
+    void fetchPage(qint64 startMs, qint64 endMs, int offset, int limit);
+    void abort();
+    bool isBusy() const { return reply != nullptr; }
+
+signals:
+    void frameParsed(const OcrFrame &frame);
+    void pageFinished(int items, bool ok, const QString &error);
+
+private slots:
+    void onReadyRead();
+    void onFinished();
+
+private:
+    QNetworkAccessManager *network;
+    QUrl baseUrl;
+    QNetworkReply *reply = nullptr;
+    JsonArrayStreamer streamer;
+    int items = 0;
+};
+
+#endif // SCREENPIPECLIENT_H
@@ -0,0 +1,116 @@
+#include "ipcserver.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QtEndian>
+#include <QDebug>
+
+IpcServer::IpcServer(QObject *parent) : QObject(parent) {
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &IpcServer::onNewConnection);
+}
+
+bool IpcServer::listen(const QString &name) {
+    // A stale socket file is left behind if a previous instance crashed
+    QLocalServer::removeServer(name);
+
+    if (!server->listen(name)) {
+        qWarning() << "IPC listen failed:" << server->errorString();
+        return false;
+    }
+
+    qDebug() << "IPC listening on" << server->fullServerName();
+    return true;
+}
+
+QString IpcServer::fullServerName() const {
+    return server->fullServerName();
+}
+
+bool IpcServer::isConnected() const {
+    return !buffers.isEmpty();
+}
+
+bool IpcServer::send(const QString &type, const QJsonObject &payload) {
+    if (buffers.isEmpty()) return false;
+
+    QJsonObject message = payload;
+    message["v"] = ProtocolVersion;
+    message["type"] = type;
+
+    QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    QByteArray frame(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(body.size()), frame.data());
+    frame.append(body);
+
+    bool sent = false;
+    for (auto it = buffers.cbegin(); it != buffers.cend(); ++it) {
+        QLocalSocket *socket = it.key();
+        if (socket->write(frame) == frame.size()) {
+            socket->flush();
+            sent = true;
+        }
+    }
+    return sent;
+}
+
+void IpcServer::onNewConnection() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        const bool wasConnected = isConnected();
+        buffers.insert(socket, QByteArray());
+
+        connect(socket, &QLocalSocket::readyRead, this, &IpcServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &IpcServer::onDisconnected);
+
+        qDebug() << "IPC client connected";
+        if (!wasConnected) emit connectionChanged(true);
+    }
+}
+
+void IpcServer::onReadyRead() {
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket || !buffers.contains(socket)) return;
+
+    QByteArray &buffer = buffers[socket];
+    buffer.append(socket->readAll());
+
+    while (buffer.size() >= 4) {
+        const quint32 length = qFromBigEndian<quint32>(buffer.constData());
+        if (length > MaxFrameSize) {
+            qWarning() << "IPC frame too large, dropping client:" << length;
+            socket->abort();
+            return;
+        }
+        if (quint32(buffer.size()) < 4 + length) break;
+
+        QByteArray body = buffer.mid(4, length);
+        buffer.remove(0, 4 + length);
+
+        QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(body, &error);
+        if (!doc.isObject()) {
+            qWarning() << "IPC frame is not a JSON object:" << error.errorString();
+            continue;
+        }
+
+        QJsonObject message = doc.object();
+        const int version = message.value("v").toInt();
+        if (version < 1 || version > ProtocolVersion) {
+            qWarning() << "IPC frame has unsupported version:" << version;
+            continue;
+        }
+
+        emit messageReceived(message.value("type").toString(), message);
+    }
+}
+
+void IpcServer::onDisconnected() {
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) return;
+
+    buffers.remove(socket);
+    socket->deleteLater();
+
+    qDebug() << "IPC client disconnected";
+    if (!isConnected()) emit connectionChanged(false);
+}
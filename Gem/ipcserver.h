@@ -0,0 +1,46 @@
+#ifndef IPCSERVER_H
+#define IPCSERVER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QHash>
+
+// Local-socket channel between the Qt app and the node backend.
+// Each frame is a 4-byte big-endian length followed by a UTF-8 JSON object
+// carrying "v" (protocol version) and "type" (suggestion, response,
+// manual_summary, summary_progress, summary_chunk, summary_done,
+// summary_cancel, status, hello, settings, spans, threads_changed, cadence).
+class IpcServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int ProtocolVersion = 1;
+    static constexpr quint32 MaxFrameSize = 16 * 1024 * 1024;
+
+    explicit IpcServer(QObject *parent = nullptr);
+
+    bool listen(const QString &name = "gem-ipc");
+    QString fullServerName() const;
+    bool isConnected() const;
+
+    // Broadcasts a message to every connected client. Returns false when no
+    // client is connected so callers can fall back to the file hand-off.
+    bool send(const QString &type, const QJsonObject &payload = QJsonObject());
+
+signals:
+    void messageReceived(const QString &type, const QJsonObject &message);
+    void connectionChanged(bool connected);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    QLocalServer *server;
+    QHash<QLocalSocket*, QByteArray> buffers;
+};
+
+#endif // IPCSERVER_H
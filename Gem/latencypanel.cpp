@@ -0,0 +1,150 @@
+#include "latencypanel.h"
+#include "scheduler.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPainter>
+
+namespace {
+
+const int RowHeight = 14;
+const int LabelWidth = 70;
+const int AxisHeight = 18;
+
+QString formatUs(quint64 us) {
+    if (us < 1000) return QString("%1 µs").arg(us);
+    if (us < 1000000) return QString("%1 ms").arg(double(us) / 1000, 0, 'f', us < 10000 ? 1 : 0);
+    return QString("%1 s").arg(double(us) / 1000000, 0, 'f', 2);
+}
+
+} // namespace
+
+WaterfallView::WaterfallView(TraceCollector *collector, QWidget *parent)
+    : QWidget(parent), collector(collector)
+{
+    setMinimumHeight(AxisHeight + RowHeight * 4);
+}
+
+QSize WaterfallView::sizeHint() const {
+    return QSize(400, AxisHeight + RowHeight * MaxRows);
+}
+
+QColor WaterfallView::stageColor(int stage) {
+    static const QColor colors[TraceCollector::StageCount] = {
+        QColor("#8e44ad"), QColor("#2980b9"), QColor("#16a085"), QColor("#7f8c8d"),
+        QColor("#d35400"), QColor("#c0392b"), QColor("#f1c40f"), QColor("#27ae60")
+    };
+    return colors[qBound(0, stage, TraceCollector::StageCount - 1)];
+}
+
+void WaterfallView::paintEvent(QPaintEvent *) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+
+    const QList<TraceCollector::Trace> &traces = collector->recentTraces();
+    const int rows = qMin(int(traces.size()), MaxRows);
+    if (rows == 0) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "No traces yet");
+        return;
+    }
+
+    // One scale for every row so durations compare at a glance
+    qint64 longest = 1;
+    for (int i = 0; i < rows; ++i) longest = qMax(longest, traces[i].endUs - traces[i].startUs);
+
+    const int plotLeft = LabelWidth;
+    const int plotWidth = qMax(1, width() - plotLeft - 4);
+    auto xFor = [&](qint64 offsetUs) { return plotLeft + int(double(offsetUs) / double(longest) * plotWidth); };
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(QRect(plotLeft, 0, plotWidth, AxisHeight), Qt::AlignLeft | Qt::AlignVCenter, "0");
+    painter.drawText(QRect(plotLeft, 0, plotWidth, AxisHeight), Qt::AlignRight | Qt::AlignVCenter,
+                     formatUs(quint64(longest)));
+
+    for (int i = 0; i < rows; ++i) {
+        const TraceCollector::Trace &trace = traces[i];
+        const int y = AxisHeight + i * RowHeight;
+
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRect(0, y, LabelWidth - 4, RowHeight), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(trace.id, 16).right(8));
+
+        painter.setPen(Qt::NoPen);
+        for (int stage = 0; stage < TraceCollector::StageCount; ++stage) {
+            if (trace.spanEnd[size_t(stage)] == 0) continue;
+            const int left = xFor(trace.spanStart[size_t(stage)] - trace.startUs);
+            const int right = xFor(trace.spanEnd[size_t(stage)] - trace.startUs);
+            painter.setBrush(stageColor(stage));
+            painter.drawRect(QRect(left, y + 2, qMax(2, right - left), RowHeight - 4));
+        }
+    }
+}
+
+LatencyPanel::LatencyPanel(TraceCollector *collector, QWidget *parent)
+    : QWidget(parent), collector(collector)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    stageTable = new QTableWidget(TraceCollector::StageCount, 5, this);
+    stageTable->setHorizontalHeaderLabels({"Count", "p50", "p95", "p99", "Max"});
+    stageTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    stageTable->setSelectionMode(QAbstractItemView::NoSelection);
+    stageTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    stageTable->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    for (int stage = 0; stage < TraceCollector::StageCount; ++stage) {
+        QTableWidgetItem *header = new QTableWidgetItem(TraceCollector::stageName(stage));
+        header->setForeground(WaterfallView::stageColor(stage));
+        stageTable->setVerticalHeaderItem(stage, header);
+        for (int column = 0; column < 5; ++column) {
+            QTableWidgetItem *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            stageTable->setItem(stage, column, item);
+        }
+    }
+
+    waterfall = new WaterfallView(collector, this);
+    summaryLabel = new QLabel(this);
+    resetButton = new QPushButton("Reset", this);
+
+    QHBoxLayout *footerLayout = new QHBoxLayout();
+    footerLayout->addWidget(summaryLabel, 1);
+    footerLayout->addWidget(resetButton);
+
+    layout->addWidget(stageTable);
+    layout->addWidget(new QLabel("Recent traces:", this));
+    layout->addWidget(waterfall, 1);
+    layout->addLayout(footerLayout);
+
+    connect(resetButton, &QPushButton::clicked, collector, &TraceCollector::reset);
+    connect(collector, &TraceCollector::updated, this, [=]() {
+        dirty = true;
+        if (isVisible()) refresh();
+    });
+
+    // Spans are only folded in while someone is looking
+    Scheduler::instance()->add("latency-panel", 1000, Scheduler::Normal, [=]() {
+        collector->drain();
+        if (dirty) refresh();
+    }, this);
+}
+
+void LatencyPanel::refresh() {
+    dirty = false;
+
+    for (int stage = 0; stage < TraceCollector::StageCount; ++stage) {
+        const HdrHistogram &histogram = collector->histogram(stage);
+        const bool empty = histogram.count() == 0;
+        stageTable->item(stage, 0)->setText(QString::number(histogram.count()));
+        stageTable->item(stage, 1)->setText(empty ? "–" : formatUs(histogram.valueAtPercentile(50)));
+        stageTable->item(stage, 2)->setText(empty ? "–" : formatUs(histogram.valueAtPercentile(95)));
+        stageTable->item(stage, 3)->setText(empty ? "–" : formatUs(histogram.valueAtPercentile(99)));
+        stageTable->item(stage, 4)->setText(empty ? "–" : formatUs(histogram.max()));
+    }
+
+    summaryLabel->setText(QString("%1 recent traces, %2 spans dropped")
+                              .arg(collector->recentTraces().size())
+                              .arg(collector->droppedSpans()));
+    waterfall->update();
+}
@@ -0,0 +1,46 @@
+#ifndef LATENCYPANEL_H
+#define LATENCYPANEL_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QLabel>
+#include <QPushButton>
+#include "tracecollector.h"
+
+// Waterfall of the most recent traces: one row per trace, one bar per stage,
+// on a shared time axis starting at each trace's first span.
+class WaterfallView : public QWidget {
+    Q_OBJECT
+public:
+    static constexpr int MaxRows = 20;
+
+    explicit WaterfallView(TraceCollector *collector, QWidget *parent = nullptr);
+
+    QSize sizeHint() const override;
+    static QColor stageColor(int stage);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    TraceCollector *collector;
+};
+
+// "Latency" tab: p50/p95/p99 per pipeline stage and the waterfall above.
+class LatencyPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit LatencyPanel(TraceCollector *collector, QWidget *parent = nullptr);
+
+private:
+    TraceCollector *collector;
+    QTableWidget *stageTable;
+    WaterfallView *waterfall;
+    QLabel *summaryLabel;
+    QPushButton *resetButton;
+    bool dirty = true;
+
+    void refresh();
+};
+
+#endif // LATENCYPANEL_H
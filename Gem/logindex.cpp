@@ -0,0 +1,351 @@
+#include "logindex.h"
+#include <QDate>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+
+namespace {
+
+const int BatchLines = 65536;
+const char LegacyStage[] = "legacy";
+
+inline char foldAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c + 32) : c;
+}
+
+struct FoldHash {
+    size_t operator()(char c) const { return size_t(uchar(foldAscii(c))); }
+};
+
+struct FoldEqual {
+    bool operator()(char a, char b) const { return foldAscii(a) == foldAscii(b); }
+};
+
+inline int digits(const char *p, int n) {
+    int value = 0;
+    for (int i = 0; i < n; ++i) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+// Parses the fixed "YYYY-MM-DDTHH:mm:ss.sssZ" shape produced by toISOString()
+qint64 parseIsoTimestamp(const char *p, qint64 available) {
+    if (available < 24 || p[4] != '-' || p[10] != 'T' || p[23] != 'Z') return 0;
+
+    const int year = digits(p, 4), month = digits(p + 5, 2), day = digits(p + 8, 2);
+    const int hour = digits(p + 11, 2), minute = digits(p + 14, 2), second = digits(p + 17, 2);
+    const int millis = digits(p + 20, 3);
+    if (year < 0 || month < 0 || day < 0 || hour < 0 || minute < 0 || second < 0 || millis < 0)
+        return 0;
+
+    const QDate date(year, month, day);
+    if (!date.isValid()) return 0;
+
+    const qint64 days = date.toJulianDay() - QDate(1970, 1, 1).toJulianDay();
+    return ((days * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL + millis;
+}
+
+// Value of a "key":"value" pair near the start of a record
+QByteArray fieldValue(const char *data, quint32 length, const QByteArray &key) {
+    const char *end = data + std::min<quint32>(length, 512);
+    const char *hit = std::search(data, end, key.constBegin(), key.constEnd());
+    if (hit == end) return QByteArray();
+
+    const char *value = hit + key.size();
+    const char *close = std::find(value, end, '"');
+    if (close == end) return QByteArray();
+    return QByteArray(value, int(close - value));
+}
+
+int levelFromName(const QByteArray &name) {
+    if (name == "error") return LogIndex::Error;
+    if (name == "warn") return LogIndex::Warn;
+    if (name == "debug") return LogIndex::Debug;
+    return LogIndex::Info;
+}
+
+} // namespace
+
+LogIndex::LogIndex(const QString &path, QObject *parent)
+    : QObject(parent), filePath(path)
+{
+    thread = new QThread(this);
+    worker = new QObject();
+    worker->moveToThread(thread);
+    thread->start(QThread::LowPriority);
+}
+
+LogIndex::~LogIndex() {
+    latestGeneration.fetchAndAddOrdered(1); // abandon any running filter
+    thread->quit();
+    thread->wait();
+    delete worker;
+
+    QWriteLocker locker(&lock);
+    unmapLocked();
+}
+
+void LogIndex::refresh() {
+    if (!refreshQueued.testAndSetOrdered(0, 1)) return; // one pass covers every pending append
+    QMetaObject::invokeMethod(worker, [this]() { indexPending(); }, Qt::QueuedConnection);
+}
+
+void LogIndex::reload() {
+    QMetaObject::invokeMethod(worker, [this]() {
+        {
+            QWriteLocker locker(&lock);
+            clearLocked();
+        }
+        emit cleared();
+        emit stagesChanged();
+        indexPending();
+    }, Qt::QueuedConnection);
+}
+
+void LogIndex::release() {
+    QWriteLocker locker(&lock);
+    unmapLocked();
+}
+
+int LogIndex::count() const {
+    QReadLocker locker(&lock);
+    return records.size();
+}
+
+LogRecord LogIndex::record(int row) const {
+    QReadLocker locker(&lock);
+    return (row >= 0 && row < records.size()) ? records.at(row) : LogRecord();
+}
+
+QByteArray LogIndex::line(int row) const {
+    QReadLocker locker(&lock);
+    if (!map || row < 0 || row >= records.size()) return QByteArray();
+
+    const LogRecord &r = records.at(row);
+    return QByteArray(reinterpret_cast<const char*>(map) + r.offset, int(r.length));
+}
+
+QString LogIndex::stageName(int stage) const {
+    QReadLocker locker(&lock);
+    return stages.value(stage);
+}
+
+QStringList LogIndex::stageNames() const {
+    QReadLocker locker(&lock);
+    return stages;
+}
+
+QString LogIndex::levelName(int level) {
+    switch (level) {
+    case Debug: return "DEBUG";
+    case Warn: return "WARN";
+    case Error: return "ERROR";
+    default: return "INFO";
+    }
+}
+
+void LogIndex::clearLocked() {
+    records.clear();
+    stageRows.clear();
+    stages.clear();
+    stageIds.clear();
+    indexedBytes = 0;
+    lastTimestamp = 0;
+}
+
+void LogIndex::unmapLocked() {
+    if (map) file.unmap(map);
+    map = nullptr;
+    mappedSize = 0;
+    file.close();
+}
+
+quint16 LogIndex::internStage(const QByteArray &name, QStringList &newStages) {
+    auto it = stageIds.constFind(name);
+    if (it != stageIds.constEnd()) return it.value();
+
+    const quint16 id = quint16(stageIds.size());
+    stageIds.insert(name, id);
+    newStages.append(QString::fromUtf8(name));
+    return id;
+}
+
+LogRecord LogIndex::parseLine(qint64 offset, const char *data, quint32 length, QStringList &newStages) {
+    static const QByteArray tsKey("{\"ts\":\"");
+    static const QByteArray levelKey("\"level\":\"");
+    static const QByteArray stageKey("\"stage\":\"");
+
+    LogRecord r;
+    r.offset = offset;
+    r.length = length;
+
+    if (length > quint32(tsKey.size()) && std::equal(tsKey.constBegin(), tsKey.constEnd(), data)) {
+        const qint64 ts = parseIsoTimestamp(data + tsKey.size(), length - tsKey.size());
+        if (ts) lastTimestamp = ts;
+        r.timestamp = lastTimestamp;
+        r.level = quint8(levelFromName(fieldValue(data, length, levelKey)));
+
+        QByteArray stage = fieldValue(data, length, stageKey);
+        r.stage = internStage(stage.isEmpty() ? QByteArray(LegacyStage) : stage, newStages);
+        return r;
+    }
+
+    // Older "[timestamp] label" header or a line of its pretty-printed payload
+    if (length > 25 && data[0] == '[' && data[25] == ']') {
+        const qint64 ts = parseIsoTimestamp(data + 1, length - 1);
+        if (ts) lastTimestamp = ts;
+    }
+    r.timestamp = lastTimestamp;
+    r.level = quint8(QByteArray::fromRawData(data, int(length)).contains("\xE2\x9D\x8C") ? Error : Info);
+    r.stage = internStage(QByteArray(LegacyStage), newStages);
+    return r;
+}
+
+void LogIndex::indexPending() {
+    refreshQueued.storeRelease(0);
+
+    bool truncated = false;
+    {
+        QWriteLocker locker(&lock);
+        if (!file.isOpen()) {
+            file.setFileName(filePath);
+            if (!file.open(QIODevice::ReadOnly)) return;
+        }
+
+        const qint64 size = file.size();
+        if (size < indexedBytes) {
+            unmapLocked();
+            clearLocked();
+            truncated = true;
+            file.open(QIODevice::ReadOnly);
+        }
+
+        if (file.isOpen() && size > mappedSize) {
+            if (map) file.unmap(map);
+            map = size > 0 ? file.map(0, size) : nullptr;
+            mappedSize = map ? size : 0;
+        }
+    }
+    if (truncated) {
+        emit cleared();
+        emit stagesChanged();
+    }
+
+    for (;;) {
+        QVector<LogRecord> batch;
+        QStringList newStages;
+        qint64 consumed;
+        {
+            QReadLocker locker(&lock);
+            if (!map) return;
+
+            const char *data = reinterpret_cast<const char*>(map);
+            const char *end = data + mappedSize;
+            const char *cursor = data + indexedBytes;
+
+            batch.reserve(BatchLines);
+            while (batch.size() < BatchLines) {
+                const char *newline = static_cast<const char*>(memchr(cursor, '\n', size_t(end - cursor)));
+                if (!newline) break; // partial last line, picked up on the next pass
+
+                quint32 length = quint32(newline - cursor);
+                if (length && cursor[length - 1] == '\r') --length;
+                batch.append(parseLine(cursor - data, cursor, length, newStages));
+                cursor = newline + 1;
+            }
+            consumed = cursor - data;
+        }
+
+        if (batch.isEmpty()) return;
+
+        int first, last;
+        {
+            QWriteLocker locker(&lock);
+            first = records.size();
+            records.append(batch);
+            last = records.size() - 1;
+            for (int row = first; row <= last; ++row)
+                stageRows[records.at(row).stage].append(row);
+            stages.append(newStages);
+            indexedBytes = consumed;
+        }
+
+        if (!newStages.isEmpty()) emit stagesChanged();
+        emit rowsIndexed(first, last);
+
+        if (batch.size() < BatchLines) return;
+    }
+}
+
+void LogIndex::filter(const LogFilter &f, int fromRow, quint64 generation) {
+    latestGeneration.storeRelease(generation);
+
+    QMetaObject::invokeMethod(worker, [this, f, fromRow, generation]() {
+        auto stale = [&]() { return latestGeneration.loadAcquire() != generation; };
+        if (stale()) return;
+
+        auto matches = [&f](const LogRecord &r) {
+            if (f.stage >= 0 && r.stage != f.stage) return false;
+            if (r.level < f.minLevel) return false;
+            if (f.from && r.timestamp < f.from) return false;
+            if (f.to && r.timestamp > f.to) return false;
+            return true;
+        };
+
+        QVector<int> rows;
+        int toRow;
+        {
+            QReadLocker locker(&lock);
+            toRow = records.size();
+            const int start = qBound(0, fromRow, toRow);
+
+            if (!f.text.isEmpty()) {
+                if (!map || start == toRow) {
+                    emit filtered(rows, fromRow, toRow, generation);
+                    return;
+                }
+
+                // Search the mapped bytes directly and map hits back to rows
+                const char *data = reinterpret_cast<const char*>(map);
+                const char *end = data + indexedBytes;
+                const char *cursor = data + records.at(start).offset;
+                const std::boyer_moore_horspool_searcher<const char*, FoldHash, FoldEqual>
+                    searcher(f.text.constBegin(), f.text.constEnd());
+
+                int checks = 0;
+                while (cursor < end) {
+                    const char *hit = std::search(cursor, end, searcher);
+                    if (hit == end) break;
+
+                    const qint64 at = hit - data;
+                    auto it = std::upper_bound(records.cbegin() + start, records.cbegin() + toRow, at,
+                                               [](qint64 value, const LogRecord &r) { return value < r.offset; });
+                    const int row = int(it - records.cbegin()) - 1;
+                    const LogRecord &r = records.at(row);
+                    if (matches(r)) rows.append(row);
+
+                    cursor = data + r.offset + r.length + 1;
+                    if (++checks % 4096 == 0 && stale()) return;
+                }
+            } else if (f.stage >= 0) {
+                const QVector<int> candidates = stageRows.value(f.stage);
+                auto it = std::lower_bound(candidates.cbegin(), candidates.cend(), start);
+                for (int checks = 0; it != candidates.cend(); ++it) {
+                    if (matches(records.at(*it))) rows.append(*it);
+                    if (++checks % 65536 == 0 && stale()) return;
+                }
+            } else {
+                for (int row = start; row < toRow; ++row) {
+                    if (matches(records.at(row))) rows.append(row);
+                    if ((row & 0xFFFF) == 0 && stale()) return;
+                }
+            }
+        }
+
+        emit filtered(rows, fromRow, toRow, generation);
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,97 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QObject>
+#include <QFile>
+#include <QThread>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QHash>
+#include <QStringList>
+#include <QByteArray>
+#include <QAtomicInteger>
+
+struct LogRecord {
+    qint64 offset = 0;
+    qint64 timestamp = 0; // ms since epoch
+    quint32 length = 0;   // without the trailing newline
+    quint16 stage = 0;
+    quint8 level = 0;
+};
+
+struct LogFilter {
+    int stage = -1;     // -1 matches every stage
+    int minLevel = 0;
+    qint64 from = 0;    // ms since epoch, 0 for unbounded
+    qint64 to = 0;
+    QByteArray text;    // ASCII case-insensitive substring
+
+    bool isEmpty() const {
+        return stage < 0 && minLevel == 0 && from == 0 && to == 0 && text.isEmpty();
+    }
+};
+
+// Memory-maps debug.log and keeps a line-offset index plus per-stage row
+// lists, built on a worker thread. Records are written by backend/utility/
+// logger.js as one JSON object per line with ts, level and stage up front;
+// lines in the older free-form format are indexed under the "legacy" stage.
+class LogIndex : public QObject {
+    Q_OBJECT
+public:
+    enum Level { Debug, Info, Warn, Error };
+
+    explicit LogIndex(const QString &path, QObject *parent = nullptr);
+    ~LogIndex();
+
+    void refresh(); // index whatever was appended since the last pass
+    void reload();  // drop the index and rebuild it from the top
+    void release(); // unmap now, e.g. before the file is truncated
+
+    // Matching rows in [fromRow, count) arrive through filtered()
+    void filter(const LogFilter &filter, int fromRow, quint64 generation);
+
+    int count() const;
+    LogRecord record(int row) const;
+    QByteArray line(int row) const;
+    QString stageName(int stage) const;
+    QStringList stageNames() const;
+
+    static QString levelName(int level);
+
+signals:
+    void rowsIndexed(int first, int last);
+    void cleared();
+    void stagesChanged();
+    void filtered(const QVector<int> &rows, int fromRow, int toRow, quint64 generation);
+
+private:
+    QString filePath;
+    QThread *thread;
+    QObject *worker;
+
+    // Guards everything below; the worker only holds the write lock to
+    // commit a parsed batch or to remap.
+    mutable QReadWriteLock lock;
+    QFile file;
+    uchar *map = nullptr;
+    qint64 mappedSize = 0;
+    qint64 indexedBytes = 0;
+    QVector<LogRecord> records;
+    QHash<int, QVector<int>> stageRows;
+    QStringList stages;
+
+    // Worker-thread only
+    QHash<QByteArray, quint16> stageIds;
+    qint64 lastTimestamp = 0;
+
+    QAtomicInteger<quint64> latestGeneration;
+    QAtomicInt refreshQueued;
+
+    void indexPending();
+    void clearLocked();
+    void unmapLocked();
+    LogRecord parseLine(qint64 offset, const char *data, quint32 length, QStringList &newStages);
+    quint16 internStage(const QByteArray &name, QStringList &newStages);
+};
+
+#endif // LOGINDEX_H
@@ -0,0 +1,158 @@
+#include "logmodel.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QColor>
+#include <algorithm>
+
+LogModel::LogModel(LogIndex *index, QObject *parent)
+    : QAbstractListModel(parent), logIndex(index), formatted(2000)
+{
+    connect(logIndex, &LogIndex::rowsIndexed, this, &LogModel::onRowsIndexed);
+    connect(logIndex, &LogIndex::cleared, this, &LogModel::onCleared);
+    connect(logIndex, &LogIndex::filtered, this, &LogModel::onFiltered);
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) return 0;
+    return filtering ? filteredRows.size() : sourceCount;
+}
+
+int LogModel::sourceRow(int row) const {
+    return filtering ? filteredRows.value(row, -1) : row;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    const int source = sourceRow(index.row());
+    if (source < 0) return QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return format(source);
+    case Qt::ForegroundRole: {
+        const int level = logIndex->record(source).level;
+        if (level == LogIndex::Error) return QColor("#e06c75");
+        if (level == LogIndex::Warn) return QColor("#d19a66");
+        return QVariant();
+    }
+    case Qt::ToolTipRole: {
+        const QByteArray line = logIndex->line(source);
+        QJsonDocument doc = QJsonDocument::fromJson(line);
+        QString text = doc.isObject() ? QString::fromUtf8(doc.toJson(QJsonDocument::Indented))
+                                      : QString::fromUtf8(line);
+        return text.left(4000);
+    }
+    default:
+        return QVariant();
+    }
+}
+
+QString LogModel::format(int source) const {
+    if (QString *cached = formatted.object(source)) return *cached;
+
+    const QByteArray line = logIndex->line(source);
+    QString text;
+
+    QJsonDocument doc = QJsonDocument::fromJson(line);
+    if (doc.isObject()) {
+        const QJsonObject record = doc.object();
+        const QDateTime ts = QDateTime::fromString(record["ts"].toString(), Qt::ISODateWithMs);
+        text = QString("%1  %2  %3  %4")
+                   .arg(ts.toLocalTime().toString("hh:mm:ss.zzz"),
+                        record["level"].toString().toUpper().leftJustified(5),
+                        record["stage"].toString(),
+                        record["msg"].toString());
+
+        if (record.contains("data")) {
+            const QJsonValue data = record["data"];
+            QString payload;
+            if (data.isObject())
+                payload = QString::fromUtf8(QJsonDocument(data.toObject()).toJson(QJsonDocument::Compact));
+            else if (data.isArray())
+                payload = QString::fromUtf8(QJsonDocument(data.toArray()).toJson(QJsonDocument::Compact));
+            else
+                payload = data.toVariant().toString();
+            if (payload.size() > 300) payload = payload.left(300) + "…";
+            text += "  " + payload.simplified();
+        }
+    } else {
+        text = QString::fromUtf8(line);
+    }
+
+    formatted.insert(source, new QString(text));
+    return text;
+}
+
+void LogModel::setFilter(const LogFilter &newFilter) {
+    filter = newFilter;
+    ++generation;
+
+    if (filter.isEmpty()) {
+        beginResetModel();
+        filtering = false;
+        filteredRows.clear();
+        filteredUpTo = 0;
+        awaitingReset = false;
+        endResetModel();
+        emit filterApplied(sourceCount);
+        return;
+    }
+
+    // Keep showing the previous result until the worker answers
+    awaitingReset = true;
+    logIndex->filter(filter, 0, generation);
+}
+
+void LogModel::onRowsIndexed(int first, int last) {
+    if (filtering) {
+        sourceCount = last + 1;
+    } else {
+        beginInsertRows(QModelIndex(), first, last);
+        sourceCount = last + 1;
+        endInsertRows();
+    }
+
+    if (!filter.isEmpty()) logIndex->filter(filter, first, generation);
+}
+
+void LogModel::onCleared() {
+    beginResetModel();
+    sourceCount = 0;
+    filteredRows.clear();
+    filteredUpTo = 0;
+    formatted.clear();
+    endResetModel();
+}
+
+void LogModel::onFiltered(const QVector<int> &rows, int fromRow, int toRow, quint64 resultGeneration) {
+    if (resultGeneration != generation || filter.isEmpty()) return;
+
+    if (awaitingReset) {
+        if (fromRow != 0) return;
+        beginResetModel();
+        filtering = true;
+        filteredRows = rows;
+        filteredUpTo = toRow;
+        awaitingReset = false;
+        endResetModel();
+        emit filterApplied(filteredRows.size());
+        return;
+    }
+
+    if (toRow <= filteredUpTo) return;
+
+    // Earlier passes may already have covered part of this range
+    auto fresh = std::lower_bound(rows.cbegin(), rows.cend(), filteredUpTo);
+    const int added = int(rows.cend() - fresh);
+    filteredUpTo = toRow;
+    if (added == 0) return;
+
+    const int first = filteredRows.size();
+    beginInsertRows(QModelIndex(), first, first + added - 1);
+    for (; fresh != rows.cend(); ++fresh) filteredRows.append(*fresh);
+    endInsertRows();
+    emit filterApplied(filteredRows.size());
+}
@@ -0,0 +1,50 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QVector>
+#include "logindex.h"
+
+// List model over a LogIndex. Rows are formatted only when a view asks for
+// them, so a QListView with uniform item sizes touches just the visible page.
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit LogModel(LogIndex *index, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void setFilter(const LogFilter &filter);
+    const LogFilter &currentFilter() const { return filter; }
+    bool isFiltering() const { return filtering; }
+
+signals:
+    void filterApplied(int matches);
+
+private slots:
+    void onRowsIndexed(int first, int last);
+    void onCleared();
+    void onFiltered(const QVector<int> &rows, int fromRow, int toRow, quint64 generation);
+
+private:
+    LogIndex *logIndex;
+    LogFilter filter;
+    quint64 generation = 0;
+    int sourceCount = 0;
+
+    // Source rows matching the filter, and how far the filter has scanned.
+    // A new filter only replaces the shown rows once its first pass lands.
+    bool filtering = false;
+    QVector<int> filteredRows;
+    int filteredUpTo = 0;
+    bool awaitingReset = false;
+
+    mutable QCache<int, QString> formatted;
+
+    int sourceRow(int row) const;
+    QString format(int source) const;
+};
+
+#endif // LOGMODEL_H
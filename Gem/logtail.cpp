@@ -0,0 +1,133 @@
+#include "logtail.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+LogTail::LogTail(const QString &path, int maxLines, QObject *parent)
+    : QObject(parent),
+      filePath(QDir::cleanPath(path)),
+      dirPath(QFileInfo(path).absolutePath()),
+      ring(maxLines)
+{
+    watcher = new QFileSystemWatcher(this);
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &LogTail::onFileChanged);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &LogTail::onDirectoryChanged);
+}
+
+void LogTail::suspend() {
+    if (suspended) return;
+    suspended = true;
+
+    if (!watcher->files().isEmpty()) watcher->removePaths(watcher->files());
+    if (!watcher->directories().isEmpty()) watcher->removePaths(watcher->directories());
+}
+
+void LogTail::resume() {
+    if (!suspended) return;
+    suspended = false;
+
+    watch();
+    readNewData();
+}
+
+QStringList LogTail::lines() const {
+    QStringList result;
+    result.reserve(ring.count());
+    for (int i = ring.firstIndex(); i <= ring.lastIndex(); ++i)
+        result.append(ring.at(i));
+    return result;
+}
+
+void LogTail::watch() {
+    // The directory watch catches the file being (re)created after rotation
+    if (QFileInfo::exists(dirPath) && !watcher->directories().contains(dirPath))
+        watcher->addPath(dirPath);
+    if (QFileInfo::exists(filePath) && !watcher->files().contains(filePath))
+        watcher->addPath(filePath);
+}
+
+void LogTail::restart() {
+    offset = 0;
+    partialLine.clear();
+    skipToNextLine = false;
+    ring.clear();
+    emit reset();
+}
+
+void LogTail::onFileChanged(const QString &) {
+    if (suspended) return;
+
+    // Removed or renamed away: the watch is gone, wait for the directory to
+    // report a new file at the same path.
+    if (!watcher->files().contains(filePath)) {
+        restart();
+        if (QFileInfo::exists(filePath)) {
+            watch();
+            readNewData();
+        }
+        return;
+    }
+
+    readNewData();
+}
+
+void LogTail::onDirectoryChanged(const QString &) {
+    if (suspended) return;
+
+    if (QFileInfo::exists(filePath) && !watcher->files().contains(filePath)) {
+        restart();
+        watch();
+        readNewData();
+    }
+}
+
+void LogTail::readNewData() {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    const qint64 size = file.size();
+    if (size < offset) restart(); // truncated in place
+    if (size == offset) return;
+
+    qint64 start = offset;
+    if (size - start > maxReadBytes) {
+        start = size - maxReadBytes;
+        partialLine.clear();
+        skipToNextLine = true;
+    }
+
+    if (!file.seek(start)) return;
+    QByteArray data = file.read(size - start);
+    offset = start + data.size();
+
+    int pos = 0;
+    if (skipToNextLine) {
+        int newline = data.indexOf('\n');
+        if (newline < 0) return;
+        pos = newline + 1;
+        skipToNextLine = false;
+    }
+
+    QStringList appended;
+    int newline;
+    while ((newline = data.indexOf('\n', pos)) >= 0) {
+        QByteArray line = partialLine.isEmpty()
+            ? data.mid(pos, newline - pos)
+            : partialLine + data.mid(pos, newline - pos);
+        partialLine.clear();
+        if (line.endsWith('\r')) line.chop(1);
+
+        QString text = QString::fromUtf8(line);
+        ring.append(text);
+        appended.append(text);
+        pos = newline + 1;
+    }
+    partialLine += data.mid(pos);
+    if (partialLine.size() > maxReadBytes) partialLine = partialLine.right(maxReadBytes);
+
+    // Only the newest lines survive the ring; don't hand older ones out
+    if (appended.size() > ring.capacity())
+        appended = appended.mid(appended.size() - ring.capacity());
+
+    if (!appended.isEmpty()) emit linesAppended(appended);
+}
@@ -0,0 +1,54 @@
+#ifndef LOGTAIL_H
+#define LOGTAIL_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QContiguousCache>
+#include <QStringList>
+#include <QByteArray>
+
+// Follows a growing text file without re-reading it. Only bytes past the last
+// offset are read, complete lines land in a ring of at most maxLines entries,
+// and truncation or rotation restarts from the top of the new file.
+class LogTail : public QObject {
+    Q_OBJECT
+public:
+    explicit LogTail(const QString &path, int maxLines = 5000, QObject *parent = nullptr);
+
+    // A suspended tail drops its watches and does no work at all
+    void suspend();
+    void resume();
+    bool isSuspended() const { return suspended; }
+
+    QStringList lines() const;
+    int maxLines() const { return ring.capacity(); }
+
+    // Bytes read per update are capped; anything older is skipped since it
+    // would fall out of the ring anyway.
+    void setMaxReadBytes(qint64 bytes) { maxReadBytes = bytes; }
+
+signals:
+    void linesAppended(const QStringList &lines);
+    void reset();
+
+private slots:
+    void onFileChanged(const QString &path);
+    void onDirectoryChanged(const QString &path);
+
+private:
+    QString filePath;
+    QString dirPath;
+    QFileSystemWatcher *watcher;
+    QContiguousCache<QString> ring;
+    QByteArray partialLine;
+    qint64 offset = 0;
+    qint64 maxReadBytes = 4 * 1024 * 1024;
+    bool suspended = true;
+    bool skipToNextLine = false;
+
+    void watch();
+    void restart();
+    void readNewData();
+};
+
+#endif // LOGTAIL_H
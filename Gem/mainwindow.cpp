@@ -7,6 +7,7 @@
 #include <QCoreApplication>
 #include <QProcess>
 #include <QTimer>
+#include <QTime>
 #include <QFile>
 #include <QTextStream>
 #include <QScrollBar>
@@ -18,13 +19,15 @@
 #include <QLineEdit>
 #include <QMessageBox>
 #include <QMovie>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
-#include <QPropertyAnimation>
-#include "suggestionpopup.h"
+#include <QProcessEnvironment>
+#include <QFileInfo>
+#include "notificationmanager.h"
+#include "scheduler.h"
+#include "latencypanel.h"
+#include "threadpanel.h"
 #include "debugwindow.h"
 #include "summarytext.h"
+#include "configpath.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -39,6 +42,8 @@ MainWindow::MainWindow(QWidget *parent)
     startButton = new QPushButton("Start");
     stopButton = new QPushButton("Stop");
     statusLabel = new QLabel("Status: Idle", this);
+    cadenceLabel = new QLabel("", this);
+    cadenceLabel->hide();
     loadingLabel = new QLabel("", this);
     loadingLabel->setAlignment(Qt::AlignCenter);
 
@@ -46,6 +51,7 @@ MainWindow::MainWindow(QWidget *parent)
     buttonLayout->addWidget(stopButton);
     mainLayout->addLayout(buttonLayout);
     mainLayout->addWidget(statusLabel);
+    mainLayout->addWidget(cadenceLabel);
     mainLayout->addWidget(loadingLabel);
 
     // --- Settings Layout ---
@@ -72,6 +78,11 @@ MainWindow::MainWindow(QWidget *parent)
     winButtonsLayout->addWidget(addWindowButton);
     winButtonsLayout->addWidget(removeWindowButton);
 
+    QLabel *previewTitle = new QLabel("Test an app or window title:");
+    previewInput = new QLineEdit();
+    previewInput->setPlaceholderText("e.g. Google Chrome — Inbox");
+    previewLabel = new QLabel();
+
     QLabel *label = new QLabel("Preferred Mail:", this);
     mailDropdown = new QComboBox(this);
     mailDropdown->addItems({"none", "gmail", "outlook"});
@@ -84,14 +95,26 @@ MainWindow::MainWindow(QWidget *parent)
     settingsLayout->addWidget(windowBlacklistList);
     settingsLayout->addWidget(windowInput);
     settingsLayout->addLayout(winButtonsLayout);
+    settingsLayout->addWidget(previewTitle);
+    settingsLayout->addWidget(previewInput);
+    settingsLayout->addWidget(previewLabel);
     settingsLayout->addWidget(label);
     settingsLayout->addWidget(mailDropdown);
 
     settingsTab->setLayout(settingsLayout);
-    mainLayout->addWidget(settingsTab);
 
-    // Start... Animation
-    loadingAnimation = new QPropertyAnimation(loadingLabel, "windowOpacity", this);
+    // --- Latency tab: where the time goes between a screen change and a popup ---
+    traces = new TraceCollector(this);
+    latencyPanel = new LatencyPanel(traces);
+
+    // --- Threads tab: what the backend thinks is going on, as it changes ---
+    threadPanel = new ThreadPanel(getConfigPath("threads"), getConfigPath("threads.json"));
+
+    tabWidget = new QTabWidget(this);
+    tabWidget->addTab(settingsTab, "Settings");
+    tabWidget->addTab(threadPanel, "Threads");
+    tabWidget->addTab(latencyPanel, "Latency");
+    mainLayout->addWidget(tabWidget);
 
     // Debug window
     debugWindow = new DebugWindow(nullptr);
@@ -100,8 +123,11 @@ MainWindow::MainWindow(QWidget *parent)
     centralWidget->setLayout(mainLayout);
     setCentralWidget(centralWidget);
 
+    settings = new SettingsStore(getConfigPath("settings.json"), this);
     loadSettings();
+    rebuildBlacklistMatchers();
 
+    connect(previewInput, &QLineEdit::textChanged, this, &MainWindow::updateBlacklistPreview);
     connect(startButton, &QPushButton::clicked, this, &MainWindow::onStartClicked);
     connect(stopButton, &QPushButton::clicked, this, &MainWindow::onStopClicked);
     connect(mailDropdown, &QComboBox::currentTextChanged, this, &MainWindow::savePreference);
@@ -110,170 +136,120 @@ MainWindow::MainWindow(QWidget *parent)
     connect(removeAppButton, &QPushButton::clicked, this, &MainWindow::removeSelectedApp);
     connect(removeWindowButton, &QPushButton::clicked, this, &MainWindow::removeSelectedWindow);
 
-    QTimer *suggestionTimer = new QTimer(this);
-    connect(suggestionTimer, &QTimer::timeout, this, &MainWindow::checkForSuggestion);
-    suggestionTimer->start(3000);
-}
-
-QString MainWindow::getConfigPath(const QString &filename) {
-    return QDir(QCoreApplication::applicationDirPath()).filePath("config/" + filename);
-}
-
-void MainWindow::onStartClicked() {
-    QString scriptPath = QDir(QCoreApplication::applicationDirPath()).filePath("backend/utility/start-assistant.js");
-
-    // Start backend detached
-    bool success = QProcess::startDetached("node", QStringList() << scriptPath);
-
-    if (!success) {
-        QMessageBox::critical(this, "Error", "Failed to start backend process.");
-        statusLabel->setText("Status: Backend start failed");
-        return;
-    }
-
-    qDebug() << "Backend process started (detached)";
-
-    // Setup loading animation text
-    if (loadingTextTimer) {
-        loadingTextTimer->stop();
-        loadingTextTimer->deleteLater();
-    }
-    loadingDotCount = 0;
-    loadingTextTimer = new QTimer(this);
-
-    connect(loadingTextTimer, &QTimer::timeout, this, [=]() {
+    // Suggestions are pushed over the IPC channel; the file poll only runs
+    // while no backend client is connected.
+    ipcServer = new IpcServer(this);
+    connect(ipcServer, &IpcServer::messageReceived, this, &MainWindow::handleIpcMessage);
+    connect(ipcServer, &IpcServer::connectionChanged, this, &MainWindow::onIpcConnectionChanged);
+    ipcServer->listen(qEnvironmentVariable("GEM_IPC_NAME", "gem-ipc"));
+
+    // The backend hot-swaps settings from these instead of re-reading disk
+    connect(settings, &SettingsStore::changed, this, [=](const QStringList &keys) { pushSettings(keys); });
+
+    // Suggestion cards are pooled, stacked and rate limited
+    notifications = new NotificationManager(this);
+    connect(notifications, &NotificationManager::responded, this, &MainWindow::onSuggestionResponded);
+    connect(notifications, &NotificationManager::expired, this, &MainWindow::onSuggestionExpired);
+
+    // Without a socket, latest_suggestion.json is picked up when it appears.
+    // The slow poll only covers file systems that don't deliver change events.
+    QDir().mkpath(QFileInfo(getConfigPath("latest_suggestion.json")).absolutePath());
+    suggestionWatcher = new QFileSystemWatcher(this);
+    connect(suggestionWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::checkForSuggestion);
+    suggestionPollTask = Scheduler::instance()->add("suggestion-file", 60000, Scheduler::Background,
+                                                    [=]() { checkForSuggestion(); });
+    onIpcConnectionChanged(false);
+
+    // "Starting..." dots, only while the window can be seen
+    loadingTask = Scheduler::instance()->add("loading-dots", 500, Scheduler::Interactive, [=]() {
         loadingDotCount = (loadingDotCount + 1) % 4;
         QString dots(loadingDotCount, '.');
         if (loadingLabel) {
             loadingLabel->setText("Starting" + dots);
         }
-    });
+    }, this);
+    Scheduler::instance()->setEnabled(loadingTask, false);
 
-    loadingTextTimer->start(500);
+    // Backend processes
+    supervisor = new BackendSupervisor(this);
 
-    // Create a simple opacity animation
-    if (loadingAnimation) {
-        loadingAnimation->stop();
-        loadingAnimation->deleteLater();
-    }
+    connect(supervisor, &BackendSupervisor::ready, this, [=]() {
+        statusLabel->setText("Status: Running!");
+        stopLoadingAnimation();
+        loadingLabel->clear();
+        this->showMinimized();
+    });
 
-    loadingAnimation = new QPropertyAnimation(loadingLabel, "windowOpacity", this);
-    loadingAnimation->setDuration(1500);
-    loadingAnimation->setStartValue(0.2);
-    loadingAnimation->setEndValue(1.0);
-    loadingAnimation->setEasingCurve(QEasingCurve::InOutSine);
-    loadingAnimation->setLoopCount(-1); // infinite loop
-    loadingAnimation->start();
-    statusLabel->setText("Status: Starting...");
+    connect(supervisor, &BackendSupervisor::failed, this, [=](const QString &reason) {
+        stopLoadingAnimation();
+        statusLabel->setText("Status: Failed to start backend");
+        loadingLabel->setText("Failed to Start.");
+        QMessageBox::critical(this, "Error", reason);
+    });
 
-    // Start health check polling
-    startHealthCheck();
+    connect(supervisor, &BackendSupervisor::childStatus, this, [=](const QString &name, const QString &status) {
+        qDebug() << "Backend" << name << status;
+        if (supervisor->isRunning() && status.startsWith("restarting"))
+            statusLabel->setText(QString("Status: %1 %2").arg(name, status));
+    });
 }
 
-void MainWindow::startHealthCheck() {
-    if (healthCheckTimer) {
-        healthCheckTimer->stop();
-        healthCheckTimer->deleteLater();
-    }
+QString MainWindow::getConfigPath(const QString &filename) {
+    return gemConfigPath(filename);
+}
 
-    int retries = 0;
-    const int maxRetries = 20; // Retry 20 times = 20s timeout
-
-    healthCheckTimer = new QTimer(this);
-
-    connect(healthCheckTimer, &QTimer::timeout, this, [=]() mutable {
-        QNetworkAccessManager *nam = new QNetworkAccessManager(this);
-        QNetworkRequest req(QUrl("http://localhost:3030/health"));
-        auto reply = nam->get(req);
-
-        connect(reply, &QNetworkReply::finished, this, [=]() mutable {
-            if (reply->error() == QNetworkReply::NoError) {
-                // Health OK
-                statusLabel->setText("Status: Running!");
-                if (loadingTextTimer) {
-                    loadingTextTimer->stop();
-                    loadingTextTimer->deleteLater();
-                    loadingTextTimer = nullptr;
-                }
-                loadingLabel->clear();
-
-                healthCheckTimer->stop();
-                healthCheckTimer->deleteLater();
-                healthCheckTimer = nullptr;
-
-                reply->deleteLater();
-                nam->deleteLater();
-
-                this->showMinimized();
-                return;
-            }
-
-            retries++;
-            if (retries >= maxRetries) {
-                // Health failed after max retries
-                if (loadingTextTimer) {
-                    loadingTextTimer->stop();
-                    loadingTextTimer->deleteLater();
-                    loadingTextTimer = nullptr;
-                }
-
-                healthCheckTimer->stop();
-                healthCheckTimer->deleteLater();
-                healthCheckTimer = nullptr;
-
-                statusLabel->setText("Status: Failed to start backend");
-                loadingLabel->setText("Failed to Start.");
-                QMessageBox::critical(this, "Error", "Backend did not become healthy in time.");
-            }
-
-            reply->deleteLater();
-            nam->deleteLater();
-        });
-    });
+void MainWindow::onStartClicked() {
+    if (supervisor->isRunning()) return;
+
+    // Setup loading animation text
+    loadingDotCount = 0;
+    loadingLabel->setText("Starting");
+    Scheduler::instance()->setEnabled(loadingTask, true);
+    statusLabel->setText("Status: Starting...");
 
-    healthCheckTimer->start(1000); // Check every second
+    // Children report readiness through the supervisor
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("GEM_IPC_PATH", ipcServer->fullServerName());
+    supervisor->setEnvironment(env);
+    supervisor->start();
 }
 
-void MainWindow::onStopClicked() {
-    QString scriptPath = QDir(QCoreApplication::applicationDirPath()).filePath("backend/utility/stop-assistant.js");
+void MainWindow::stopLoadingAnimation() {
+    Scheduler::instance()->setEnabled(loadingTask, false);
+}
 
-    QProcess::startDetached("node", QStringList() << scriptPath);
+void MainWindow::onStopClicked() {
+    supervisor->stop();
+    stopLoadingAnimation();
+    loadingLabel->clear();
     statusLabel->setText("Status: Stopped");
+    cadenceLabel->hide();
+    cadenceChanges.clear();
 }
 
 void MainWindow::savePreference() {
-    QString selected = mailDropdown->currentText();
-    QString settingsPath = getConfigPath("settings.json");
-
-    qDebug() << "Saving to:" << settingsPath;
-    QFile file(settingsPath);
-    if (file.open(QIODevice::WriteOnly)) {
-        QTextStream out(&file);
-        out << QString("{ \"preferredMailMethod\": \"%1\" }").arg(selected);
-        file.close();
-    }
+    settings->setValue("preferredMailMethod", mailDropdown->currentText());
 }
 
 void MainWindow::loadSettings() {
-    QString settingsPath = getConfigPath("settings.json");
-    QFile file(settingsPath);
-    if (file.open(QIODevice::ReadOnly)) {
-        QString json = file.readAll();
-        file.close();
-        QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
-        if (doc.isObject()) {
-            QString pref = doc.object().value("preferredMailMethod").toString();
-            int index = mailDropdown->findText(pref);
-            if (index >= 0) mailDropdown->setCurrentIndex(index);
+    QString pref = settings->value("preferredMailMethod").toString();
+    int index = mailDropdown->findText(pref);
+    if (index >= 0) mailDropdown->setCurrentIndex(index);
 
-            // Load blacklist
-            QJsonArray apps = doc.object().value("blacklistedApps").toArray();
-            for (auto a : apps) appBlacklistList->addItem(a.toString());
+    // Load blacklist
+    QJsonArray apps = settings->value("blacklistedApps").toArray();
+    for (auto a : apps) appBlacklistList->addItem(a.toString());
 
-            QJsonArray wins = doc.object().value("blacklistedWindows").toArray();
-            for (auto w : wins) windowBlacklistList->addItem(w.toString());
-        }
-    }
+    QJsonArray wins = settings->value("blacklistedWindows").toArray();
+    for (auto w : wins) windowBlacklistList->addItem(w.toString());
+}
+
+void MainWindow::pushSettings(const QStringList &changedKeys) {
+    QJsonObject message;
+    message["version"] = double(settings->version());
+    message["changed"] = QJsonArray::fromStringList(changedKeys);
+    message["settings"] = settings->snapshot();
+    ipcServer->send("settings", message);
 }
 
 void MainWindow::keyPressEvent(QKeyEvent *event) {
@@ -287,7 +263,13 @@ void MainWindow::keyPressEvent(QKeyEvent *event) {
     }
 }
 
-void MainWindow::sendResponse(bool accepted) {
+void MainWindow::sendResponse(bool accepted, const QString &suggestionId) {
+    QJsonObject response;
+    response["accepted"] = accepted;
+    if (!suggestionId.isEmpty()) response["id"] = suggestionId;
+    if (ipcServer->send("response", response)) return;
+
+    // Fallback: backend is not connected to the socket
     QString path = getConfigPath("user_response.json");
     QFile file(path);
     if (file.open(QIODevice::WriteOnly)) {
@@ -297,9 +279,8 @@ void MainWindow::sendResponse(bool accepted) {
     }
 }
 
-void MainWindow::showSuggestion(const QString &text) {
+void MainWindow::showSuggestion(const QString &text, const QString &suggestionId) {
     qDebug() << "Triggering Show Suggestion";
-    SuggestionPopup *popup = new SuggestionPopup(text, this);
 
     QStringList lines = text.split("\n");
     QString action;
@@ -311,27 +292,40 @@ void MainWindow::showSuggestion(const QString &text) {
         }
     }
 
-    connect(popup, &SuggestionPopup::accepted, this, [=]() {
-        qDebug() << action;
-        if (action == "summarise_pdf") {
-            SummaryText *summary = new SummaryText(this);
-            summary->slideIn();
+    notifications->notify(text, suggestionId, action);
+}
 
-            connect(summary, &SummaryText::userAccepted, this, [=]() {
-                sendResponse(true);
-            });
+void MainWindow::onSuggestionResponded(const QString &suggestionId, const QString &action, bool accepted) {
+    if (suggestionTraces.contains(suggestionId)) {
+        const PendingTrace pending = suggestionTraces.take(suggestionId);
+        traces->record(pending.trace, TraceCollector::User, pending.shownUs, TraceCollector::nowUs());
+    }
 
-            connect(summary, &SummaryText::userRejected, this, [=]() {
-                sendResponse(true);
-            });
-        } else {
-            sendResponse(true);
-        }
-    });
+    if (!accepted) {
+        sendResponse(false, suggestionId);
+        return;
+    }
 
-    connect(popup, &SuggestionPopup::rejected, this, [=]() {
-        sendResponse(false);
-    });
+    qDebug() << action;
+    if (action == "summarise_pdf") {
+        // Accept straight away so the backend is already waiting for the
+        // panel's text, then streams the summary back into the same panel
+        sendResponse(true, suggestionId);
+        SummaryText *summary = new SummaryText(ipcServer, suggestionId, this);
+        summaries.insert(suggestionId, summary);
+        connect(summary, &QObject::destroyed, this, [this, suggestionId]() {
+            summaries.remove(suggestionId);
+        });
+        summary->slideIn();
+    } else {
+        sendResponse(true, suggestionId);
+    }
+}
+
+void MainWindow::onSuggestionExpired(const QString &suggestionId) {
+    // Nobody answered, so there is no user stage to record
+    suggestionTraces.remove(suggestionId);
+    sendResponse(false, suggestionId);
 }
 
 void MainWindow::checkForSuggestion() {
@@ -348,19 +342,154 @@ void MainWindow::checkForSuggestion() {
         QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
         if (!doc.isObject()) return;
 
-        QString action = doc["action"].toString();
-        QString reason = doc["reason"].toString();
-
-        QString message = QString("Suggested Action: %1\n\nReason: %2").arg(action, reason);
-        showSuggestion(message);
+        dispatchSuggestion(doc.object());
 
         file.remove(); // Prevent repeat trigger
     }
 }
 
+namespace {
+
+// Twice the longest a suggestion can wait for an answer
+const qint64 TraceHorizonUs = 2 * qint64(NotificationManager::DefaultExpiryMs) * 1000;
+
+} // namespace
+
+void MainWindow::dispatchSuggestion(const QJsonObject &suggestion) {
+    QString action = suggestion["action"].toString();
+    QString reason = suggestion["reason"].toString();
+
+    // Hand-off runs from the backend sending it to here; the user stage from
+    // here to the answer
+    const quint64 trace = TraceCollector::parseTraceId(suggestion["trace"].toString());
+    const QString id = suggestion["id"].toString();
+    if (trace != 0 && !id.isEmpty()) {
+        const qint64 now = TraceCollector::nowUs();
+        const double sentAt = suggestion["sentAt"].toDouble();
+        if (sentAt > 0) traces->record(trace, TraceCollector::Handoff, qint64(sentAt * 1000), now);
+        // Anything still here long after its card could have expired was
+        // lost on the way (a repeated id, a card never shown)
+        for (auto it = suggestionTraces.begin(); it != suggestionTraces.end();)
+            it = now - it->shownUs > TraceHorizonUs ? suggestionTraces.erase(it) : std::next(it);
+        suggestionTraces.insert(id, {trace, now});
+    }
+
+    QString message = QString("Suggested Action: %1\n\nReason: %2").arg(action, reason);
+    showSuggestion(message, id);
+}
+
+void MainWindow::handleIpcMessage(const QString &type, const QJsonObject &message) {
+    if (type == "suggestion") {
+        dispatchSuggestion(message);
+    } else if (type == "spans") {
+        traces->ingest(message["spans"].toArray());
+    } else if (type == "summary_progress") {
+        if (SummaryText *summary = summaries.value(message["id"].toString()))
+            summary->showProgress(message["done"].toInt(), message["total"].toInt());
+    } else if (type == "summary_chunk") {
+        if (SummaryText *summary = summaries.value(message["id"].toString()))
+            summary->appendSummary(message["text"].toString());
+    } else if (type == "summary_done") {
+        qDebug() << "Summary stream:" << message["ttftMs"].toInt() << "ms to first token,"
+                 << message["tokensPerSec"].toDouble() << "tok/s";
+        if (SummaryText *summary = summaries.value(message["id"].toString()))
+            summary->finishSummary(message);
+    } else if (type == "threads_changed") {
+        threadPanel->notifyChanged();
+    } else if (type == "status") {
+        statusLabel->setText("Status: " + message["text"].toString());
+    } else if (type == "cadence") {
+        showCadence(message);
+    } else if (type == "hello") {
+        qDebug() << "Backend client:" << message["role"].toString() << message["pid"].toInt();
+        pushSettings(); // current state for the new client
+    }
+}
+
+void MainWindow::showCadence(const QJsonObject &cadence) {
+    const double seconds = cadence["intervalMs"].toInt() / 1000.0;
+    const QString reason = cadence["reason"].toString();
+    QString text = QString("Capture: every %1 s — %2 (%3 changes/min")
+        .arg(seconds, 0, 'f', seconds < 10 ? 1 : 0)
+        .arg(reason)
+        .arg(cadence["changesPerMin"].toDouble(), 0, 'f', 1);
+    const double hitRate = cadence["hitRate"].toDouble(-1.0);
+    if (hitRate >= 0) text += QString(", %1% cached").arg(qRound(hitRate * 100));
+    cadenceLabel->setText(text + ")");
+    cadenceLabel->show();
+
+    const int previousMs = cadence["previousMs"].toInt();
+    if (previousMs != cadence["intervalMs"].toInt()) {
+        cadenceChanges.prepend(QString("%1  %2 s → %3 s (%4)")
+            .arg(QTime::currentTime().toString("HH:mm:ss"))
+            .arg(previousMs / 1000.0, 0, 'f', 1)
+            .arg(seconds, 0, 'f', 1)
+            .arg(reason));
+        while (cadenceChanges.size() > 10) cadenceChanges.removeLast();
+        cadenceLabel->setToolTip(cadenceChanges.join("\n"));
+    }
+}
+
+void MainWindow::onIpcConnectionChanged(bool connected) {
+    const QString configDir = QFileInfo(getConfigPath("latest_suggestion.json")).absolutePath();
+    Scheduler::instance()->setEnabled(suggestionPollTask, !connected);
+
+    if (connected) {
+        suggestionWatcher->removePath(configDir);
+    } else {
+        suggestionWatcher->addPath(configDir);
+        // No stream is coming back for any open summary
+        for (const QPointer<SummaryText> &summary : std::as_const(summaries)) {
+            if (summary) summary->finishSummary(QJsonObject{{"error", "backend disconnected"}});
+        }
+    }
+    checkForSuggestion(); // pick up anything written before the switch
+}
+
+namespace {
+
+std::vector<std::string> listPatterns(const QListWidget *list) {
+    std::vector<std::string> patterns;
+    patterns.reserve(size_t(list->count()));
+    for (int i = 0; i < list->count(); ++i)
+        patterns.push_back(list->item(i)->text().trimmed().toStdString());
+    return patterns;
+}
+
+} // namespace
+
+void MainWindow::rebuildBlacklistMatchers() {
+    appMatcher.compile(listPatterns(appBlacklistList));
+    windowMatcher.compile(listPatterns(windowBlacklistList));
+    updateBlacklistPreview();
+}
+
+void MainWindow::updateBlacklistPreview() {
+    const QByteArray title = previewInput->text().trimmed().toUtf8();
+    if (title.isEmpty()) {
+        previewLabel->clear();
+        return;
+    }
+
+    // The backend checks app names and window titles against separate lists;
+    // a preview string is checked against both.
+    const std::string_view text(title.constData(), size_t(title.size()));
+    const int app = appMatcher.findFirst(text);
+    const int window = windowMatcher.findFirst(text);
+
+    if (app >= 0) {
+        previewLabel->setText(QString("🚫 Ignored by app rule \"%1\"")
+                                  .arg(QString::fromStdString(appMatcher.patterns()[size_t(app)])));
+    } else if (window >= 0) {
+        previewLabel->setText(QString("🚫 Ignored by window rule \"%1\"")
+                                  .arg(QString::fromStdString(windowMatcher.patterns()[size_t(window)])));
+    } else {
+        previewLabel->setText("✅ Not blacklisted");
+    }
+}
+
 void MainWindow::saveBlacklistToSettings() {
-    QJsonObject obj;
-    obj["preferredMailMethod"] = mailDropdown->currentText();
+    rebuildBlacklistMatchers();
 
     QJsonArray apps, windows;
     for (int i = 0; i < appBlacklistList->count(); ++i)
@@ -369,15 +498,10 @@ void MainWindow::saveBlacklistToSettings() {
     for (int i = 0; i < windowBlacklistList->count(); ++i)
         windows.append(windowBlacklistList->item(i)->text());
 
-    obj["blacklistedApps"] = apps;
-    obj["blacklistedWindows"] = windows;
-
-    QString path = getConfigPath("settings.json");
-    QFile file(path);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(obj).toJson());
-        file.close();
-    }
+    QJsonObject changes;
+    changes["blacklistedApps"] = apps;
+    changes["blacklistedWindows"] = windows;
+    settings->setValues(changes);
 }
 
 void MainWindow::removeSelectedApp() {
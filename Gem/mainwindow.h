@@ -9,11 +9,24 @@
 #include <QKeyEvent>
 #include <QListWidget>
 #include <QLabel>
-#include <QPropertyAnimation>
+#include <QFileSystemWatcher>
+#include <QJsonObject>
+#include <QHash>
+#include <QPointer>
 #include "debugwindow.h"
+#include "ipcserver.h"
+#include "backendsupervisor.h"
+#include "settingsstore.h"
+#include "notificationmanager.h"
+#include "tracecollector.h"
+#include "blacklistmatcher.h"
+#include "summarytext.h"
+#include "threadpanel.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
+    friend class GemBench;
+    friend class ReplayHarness;
 
 protected:
     void keyPressEvent(QKeyEvent *event) override;
@@ -25,9 +38,13 @@ private slots:
     void onStartClicked();
     void onStopClicked();
     void savePreference();
-    void showSuggestion(const QString &text);
-    void sendResponse(bool accepted);
+    void showSuggestion(const QString &text, const QString &suggestionId = QString());
+    void sendResponse(bool accepted, const QString &suggestionId = QString());
+    void onSuggestionResponded(const QString &suggestionId, const QString &action, bool accepted);
+    void onSuggestionExpired(const QString &suggestionId);
     void checkForSuggestion();
+    void handleIpcMessage(const QString &type, const QJsonObject &message);
+    void onIpcConnectionChanged(bool connected);
     void removeSelectedApp();
     void removeSelectedWindow();
     QString getConfigPath(const QString& filename);
@@ -44,9 +61,21 @@ private:
     QLabel *statusLabel;
     QLabel *loadingLabel;
 
+    // Capture cadence from gem-ingest's adaptive sweeps; the tooltip keeps
+    // the last few interval changes
+    QLabel *cadenceLabel;
+    QStringList cadenceChanges;
+    void showCadence(const QJsonObject &cadence);
+
     QTabWidget *tabWidget;
     DebugWindow *debugWindow;
 
+    IpcServer *ipcServer;
+    QFileSystemWatcher *suggestionWatcher;
+    int suggestionPollTask;
+    NotificationManager *notifications;
+    void dispatchSuggestion(const QJsonObject &suggestion);
+
     QListWidget *appBlacklistList;
     QListWidget *windowBlacklistList;
     QLineEdit *appInput;
@@ -58,16 +87,39 @@ private:
     void saveBlacklistToSettings();
     void addAppToBlacklist();
     void addWindowToBlacklist();
+
+    // Live preview: the lists compiled the same way the backend compiles them
+    QLineEdit *previewInput;
+    QLabel *previewLabel;
+    BlacklistMatcher appMatcher;
+    BlacklistMatcher windowMatcher;
+    void rebuildBlacklistMatchers();
+    void updateBlacklistPreview();
     int debugTabIndex;
 
+    SettingsStore *settings;
     void loadSettings();
-
-    QTimer* healthCheckTimer = nullptr;
-    void startHealthCheck();
-    QTimer* loadingTextTimer = nullptr;
+    void pushSettings(const QStringList &changedKeys = QStringList());
+
+    // Pipeline tracing; suggestions remember their trace until answered or
+    // expired, and never for longer than TraceHorizonUs
+    struct PendingTrace {
+        quint64 trace;
+        qint64 shownUs;
+    };
+    TraceCollector *traces;
+    QWidget *latencyPanel;
+    QHash<QString, PendingTrace> suggestionTraces;
+
+    ThreadPanel *threadPanel;
+
+    // Open summary panels by suggestion id, fed by the backend's stream
+    QHash<QString, QPointer<SummaryText>> summaries;
+
+    BackendSupervisor *supervisor;
+    void stopLoadingAnimation();
+    int loadingTask;
     int loadingDotCount = 0;
-
-    QPropertyAnimation *loadingAnimation;
 };
 
 #endif // MAINWINDOW_H
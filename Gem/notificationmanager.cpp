@@ -0,0 +1,199 @@
+#include "notificationmanager.h"
+#include <QGuiApplication>
+#include <QScreen>
+
+namespace {
+
+const int GatherMs = 250;      // suggestions arriving this close together are one burst
+const int MinShowMs = 3000;    // never flash a card for less than this
+const int Spacing = 12;
+const int DigestPreview = 4;   // items listed on a digest card
+
+} // namespace
+
+NotificationManager::NotificationManager(QWidget *parentWidget)
+    : NotificationManager(parentWidget, Limits())
+{
+}
+
+NotificationManager::NotificationManager(QWidget *parentWidget, const Limits &limits)
+    : QObject(parentWidget), parentWidget(parentWidget), maxVisible(qMax(1, limits.maxVisible)),
+      burst(qMax(1, limits.burst)), refillMs(qMax(1, limits.refillMs)), expiryMs(limits.expiryMs),
+      tokens(burst)
+{
+    clock.start();
+
+    // Pre-built pool: one card per visible position, reused forever
+    pool.resize(maxVisible);
+    for (int i = 0; i < pool.size(); ++i) {
+        SuggestionPopup *popup = new SuggestionPopup(parentWidget);
+        connect(popup, &SuggestionPopup::accepted, this, [=]() { onFinished(i, true); });
+        connect(popup, &SuggestionPopup::rejected, this, [=]() { onFinished(i, false); });
+        connect(popup, &SuggestionPopup::timedOut, this, [=]() { onExpired(i); });
+        pool[i].popup = popup;
+    }
+
+    pumpTimer = new QTimer(this);
+    pumpTimer->setSingleShot(true);
+    connect(pumpTimer, &QTimer::timeout, this, &NotificationManager::pump);
+
+    layoutTimer = new QTimer(this);
+    layoutTimer->setSingleShot(true);
+    layoutTimer->setInterval(0);
+    connect(layoutTimer, &QTimer::timeout, this, &NotificationManager::relayout);
+}
+
+void NotificationManager::notify(const QString &text, const QString &id, const QString &action) {
+    Item item;
+    item.text = text;
+    item.id = id;
+    item.action = action;
+    item.queuedAt = clock.elapsed();
+    pending.append(item);
+
+    if (!pumpTimer->isActive()) pumpTimer->start(GatherMs);
+}
+
+QList<SuggestionPopup *> NotificationManager::cards() const {
+    QList<SuggestionPopup *> visible;
+    for (int slot : stack) visible.append(pool[slot].popup);
+    return visible;
+}
+
+int NotificationManager::idleSlot() const {
+    for (int i = 0; i < pool.size(); ++i)
+        if (!pool[i].popup->isPresenting()) return i;
+    return -1;
+}
+
+void NotificationManager::refill() {
+    const qint64 now = clock.elapsed();
+    tokens = qMin(double(burst), tokens + double(now - lastRefill) / refillMs);
+    lastRefill = now;
+}
+
+void NotificationManager::expirePending() {
+    // Items opened from a digest were asked for, so they stay for as long
+    // as the backend still waits on them; their queuedAt is still when the
+    // backend sent them, which is what the window runs from
+    const qint64 now = clock.elapsed();
+    for (int i = 0; i < pending.size();) {
+        const qint64 left = expiryMs - (now - pending[i].queuedAt);
+        if (left <= (pending[i].expanded ? 0 : MinShowMs)) {
+            const Item item = pending.takeAt(i);
+            emit expired(item.id, item.action);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void NotificationManager::pump() {
+    expirePending();
+    refill();
+
+    // Expanded digest items first, one card each, ignoring the rate limit
+    int slot;
+    while (!pending.isEmpty() && pending.first().expanded && (slot = idleSlot()) >= 0)
+        present(slot, {pending.takeFirst()});
+
+    if (!pending.isEmpty() && !pending.first().expanded && (slot = idleSlot()) >= 0) {
+        if (tokens >= 1.0) {
+            tokens -= 1.0;
+            // Everything that piled up goes out together
+            QList<Item> batch;
+            while (!pending.isEmpty() && !pending.first().expanded) batch.append(pending.takeFirst());
+            present(slot, batch);
+        }
+    }
+
+    if (pending.isEmpty()) return;
+
+    // Come back when a token is due or the oldest item is about to expire;
+    // a card finishing pumps again on its own
+    const qint64 now = clock.elapsed();
+    qint64 expires = pending.first().queuedAt + expiryMs;
+    for (const Item &item : std::as_const(pending))
+        expires = qMin(expires, item.queuedAt + expiryMs - (item.expanded ? 0 : MinShowMs));
+    int wait = int(expires - now);
+    if (idleSlot() >= 0 && tokens < 1.0) wait = qMin(wait, int((1.0 - tokens) * refillMs) + 1);
+    pumpTimer->start(qMax(GatherMs, wait));
+}
+
+void NotificationManager::present(int slot, const QList<Item> &items) {
+    pool[slot].items = items;
+
+    const qint64 now = clock.elapsed();
+    qint64 oldest = now;
+    for (const Item &item : items) oldest = qMin(oldest, item.queuedAt);
+    // Never past the backend's window; only a digest item can have less
+    // than MinShowMs of it left
+    const int left = int(expiryMs - (now - oldest));
+    const int timeoutMs = items.first().expanded ? qMax(1, left) : qMax(MinShowMs, left);
+
+    stack.removeAll(slot);
+    stack.prepend(slot);
+
+    // Target position is settled by relayout(); start from the bottom slot
+    const QRect screen = QGuiApplication::primaryScreen()->availableGeometry();
+    SuggestionPopup *popup = pool[slot].popup;
+    const QPoint target(screen.right() - popup->width() - 20, screen.bottom() - popup->height() - 20);
+
+    if (items.size() == 1) {
+        popup->present(items.first().text, timeoutMs, target);
+    } else {
+        QString text = QString("%1 suggestions while you were busy:\n").arg(items.size());
+        for (int i = 0; i < items.size() && i < DigestPreview; ++i)
+            text += "\n• " + items[i].text.section('\n', 0, 0).section(':', 1).trimmed();
+        if (items.size() > DigestPreview) text += QString("\n• …and %1 more").arg(items.size() - DigestPreview);
+        popup->present(text, timeoutMs, target, "Review", "Dismiss all");
+    }
+
+    layoutTimer->start();
+}
+
+void NotificationManager::onFinished(int slot, bool accepted) {
+    const QList<Item> items = pool[slot].items;
+    pool[slot].items.clear();
+    stack.removeAll(slot);
+    layoutTimer->start();
+
+    if (items.size() == 1) {
+        emit responded(items.first().id, items.first().action, accepted);
+    } else if (accepted) {
+        // Review: the digest opens up into individual cards
+        for (int i = items.size() - 1; i >= 0; --i) {
+            Item item = items[i];
+            item.expanded = true;
+            pending.prepend(item);
+        }
+    } else {
+        for (const Item &item : items) emit responded(item.id, item.action, false);
+    }
+
+    // A card is free again
+    if (!pending.isEmpty()) pumpTimer->start(0);
+}
+
+void NotificationManager::onExpired(int slot) {
+    const QList<Item> items = pool[slot].items;
+    pool[slot].items.clear();
+    stack.removeAll(slot);
+    layoutTimer->start();
+
+    for (const Item &item : items) emit expired(item.id, item.action);
+
+    if (!pending.isEmpty()) pumpTimer->start(0);
+}
+
+void NotificationManager::relayout() {
+    const QRect screen = QGuiApplication::primaryScreen()->availableGeometry();
+    int bottom = screen.bottom() - 20;
+
+    for (int slot : stack) {
+        SuggestionPopup *popup = pool[slot].popup;
+        const QPoint target(screen.right() - popup->width() - 20, bottom - popup->height());
+        popup->moveTo(target);
+        bottom -= popup->height() + Spacing;
+    }
+}
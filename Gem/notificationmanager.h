@@ -0,0 +1,93 @@
+#ifndef NOTIFICATIONMANAGER_H
+#define NOTIFICATIONMANAGER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QList>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "suggestionpopup.h"
+
+// Shows suggestions through a fixed pool of SuggestionPopup cards.
+//  - At most maxVisible cards are on screen; the rest wait in a queue.
+//  - New cards are rate limited by a token bucket (burst, one token back
+//    every refillMs).
+//  - When more than one suggestion is waiting, they are shown as a single
+//    digest card; accepting it ("Review") shows them one by one.
+// Waiting suggestions expire after expiryMs, matching how long the backend
+// waits for an answer, and count as rejected. That window runs from when a
+// suggestion arrived, also for the cards a digest opens into. A suggestion
+// nobody answered, on a card or in the queue, is reported through expired()
+// rather than responded().
+class NotificationManager : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int DefaultMaxVisible = 3;
+    static constexpr int DefaultBurst = 3;
+    static constexpr int DefaultRefillMs = 20000;
+    static constexpr int DefaultExpiryMs = 15000;
+
+    // Pool size, rate limit and expiry; the defaults are the app's
+    struct Limits {
+        int maxVisible = DefaultMaxVisible;
+        int burst = DefaultBurst;
+        int refillMs = DefaultRefillMs;
+        int expiryMs = DefaultExpiryMs;
+    };
+
+    explicit NotificationManager(QWidget *parentWidget);
+    NotificationManager(QWidget *parentWidget, const Limits &limits);
+
+    void notify(const QString &text, const QString &id, const QString &action);
+
+    // Cards on screen, newest first, and suggestions waiting for one
+    QList<SuggestionPopup *> cards() const;
+    int queued() const { return int(pending.size()); }
+
+signals:
+    void responded(const QString &id, const QString &action, bool accepted);
+    void expired(const QString &id, const QString &action);
+
+private slots:
+    void pump();
+    void relayout();
+
+private:
+    struct Item {
+        QString text;
+        QString id;
+        QString action;
+        qint64 queuedAt = 0;
+        bool expanded = false;   // from an accepted digest: skips the rate limit
+    };
+
+    struct Slot {
+        SuggestionPopup *popup = nullptr;
+        QList<Item> items;       // one item, or several for a digest
+    };
+
+    QWidget *parentWidget;
+    QVector<Slot> pool;         // the pool; visible ones are in stack order
+    QList<int> stack;            // slot indices, newest first
+    QList<Item> pending;
+    QTimer *pumpTimer;
+    QTimer *layoutTimer;
+    QElapsedTimer clock;
+
+    int maxVisible;
+    int burst;
+    int refillMs;
+    int expiryMs;
+    double tokens;
+    qint64 lastRefill = 0;
+
+    void present(int slot, const QList<Item> &items);
+    void onFinished(int slot, bool accepted);
+    void onExpired(int slot);
+    void refill();
+    void expirePending();
+    int idleSlot() const;
+};
+
+#endif // NOTIFICATIONMANAGER_H
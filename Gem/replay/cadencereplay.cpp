@@ -0,0 +1,257 @@
+#include "cadencereplay.h"
+#include <QCryptographicHash>
+#include <QHash>
+#include <QJsonArray>
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include "hdrhistogram.h"
+#include "simhash.h"
+#include "textdelta.h"
+
+namespace {
+
+// The backend's defaults (ocr/frame-delta.js, ocr/cache-ocr.js)
+const double DeltaMaxChange = 0.6; // OCR_DELTA_MAX_CHANGE
+const int DeltaMinLength = 120;    // OCR_DELTA_MIN_CHARS
+const int NearDupDistance = 6;     // OCR_NEAR_DUP_DISTANCE
+const int NearDupCapacity = 4096;
+const int NearDupMinLength = 40;
+const qint64 CacheTtlMs = 600000;  // EX on ocr: keys
+const int Scopes = 4096;
+
+// frame-delta.js: a frame is cleaned whole when it is a window's first or
+// more than DeltaMaxChange of it changed, as a delta when its changed lines
+// hold at least DeltaMinLength characters other than spaces, punctuation
+// and symbols, and not at all otherwise. Whole frames become the baseline
+// the next one is diffed against at once, deltas once commit() says they
+// were cleaned.
+class FrameDeltas {
+public:
+    enum Kind { Full, Delta, Unchanged };
+
+    Kind next(const QString &scope, const QString &text, QString *changedText) {
+        const std::string key = scope.toStdString(), bytes = text.toStdString();
+        const TextDeltaTracker::Delta delta = tracker.peek(key, bytes);
+        if (delta.baseline || double(delta.changedBytes) > double(delta.totalBytes) * DeltaMaxChange) {
+            tracker.commit(key);
+            return Full;
+        }
+
+        QStringList spans;
+        for (const TextDeltaTracker::Span &span : delta.spans)
+            spans << QString::fromUtf8(bytes.data() + span.offset, qsizetype(span.length));
+        *changedText = spans.join('\n');
+        int length = 0;
+        for (QChar c : std::as_const(*changedText))
+            if (!c.isSpace() && !c.isPunct() && !c.isSymbol()) ++length;
+        return length < DeltaMinLength ? Unchanged : Delta;
+    }
+
+    void commit(const QString &scope) { tracker.commit(scope.toStdString()); }
+
+private:
+    TextDeltaTracker tracker{Scopes};
+};
+
+// What cleaning a frame costs the backend, as getCleanedTextWithCache does
+// it: nothing for an unchanged frame or one the near-duplicate index or the
+// exact cache already knows (a delta frame is then left out of the
+// baseline), and otherwise an LLM call, for the changed lines of a delta
+// unless they were cleaned recently
+class BackendModel {
+public:
+    bool needsLlm(const OcrFrame &frame) {
+        const QString scope = ChangeDetector::scopeOf(frame);
+        QString changedText;
+        const FrameDeltas::Kind kind = deltas.next(scope, frame.text, &changedText);
+        if (kind == FrameDeltas::Unchanged) return false;
+
+        const std::string key = scope.toStdString();
+        const bool fingerprinted = frame.text.size() >= NearDupMinLength;
+        const quint64 print = fingerprinted ? simhash(frame.text.toStdString()) : 0;
+        if (fingerprinted && nearDuplicates.lookup(key, print)) return false;
+        if (cached(frame.text, frame.timestampMs)) {
+            if (fingerprinted) nearDuplicates.insert(key, print, std::string());
+            return false;
+        }
+
+        deltas.commit(scope);
+        if (fingerprinted) nearDuplicates.insert(key, print, std::string());
+        // A delta's key holds the screen's topic in the backend; the window
+        // stands in
+        const QString cleanedKey = kind == FrameDeltas::Delta ? scope + QChar(0x1f) + changedText : frame.text;
+        if (kind == FrameDeltas::Delta && cached(cleanedKey, frame.timestampMs)) return false;
+        written.insert(hashOf(cleanedKey), frame.timestampMs);
+        return true;
+    }
+
+private:
+    FrameDeltas deltas;
+    NearDuplicateIndex nearDuplicates{NearDupDistance, NearDupCapacity};
+    QHash<QByteArray, qint64> written; // exact cache key -> when it was written
+
+    static QByteArray hashOf(const QString &key) {
+        return QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha256);
+    }
+
+    // Whether key is in the exact cache at nowMs
+    bool cached(const QString &key, qint64 nowMs) const {
+        auto it = written.constFind(hashOf(key));
+        return it != written.constEnd() && nowMs - *it < CacheTtlMs;
+    }
+};
+
+} // namespace
+
+CadenceReplay::CadenceReplay(const QVector<OcrFrame> &frames) : frames(frames) {
+    FrameDeltas deltas;
+    ChangeDetector detector;
+    changed.reserve(frames.size());
+    detected.reserve(frames.size());
+    for (const OcrFrame &frame : frames) {
+        const QString scope = ChangeDetector::scopeOf(frame);
+        QString changedText;
+        const bool change = deltas.next(scope, frame.text, &changedText) != FrameDeltas::Unchanged;
+        if (change) deltas.commit(scope);
+        changed.append(change);
+        detected.append(detector.observe(frame));
+    }
+}
+
+QJsonObject CadenceReplay::run(const Options &options) const {
+    QJsonObject report;
+    report["frames"] = frames.size();
+    report["changes"] = qint64(changed.count(true));
+    report["hours"] = frames.isEmpty() ? 0.0
+        : double(frames.last().timestampMs - frames.first().timestampMs) / 3600000.0;
+
+    QJsonArray policies;
+    for (int fixedMs : options.fixedMs) {
+        if (fixedMs > 0) policies.append(simulate(fixedMs, options));
+    }
+    policies.append(simulate(0, options));
+    report["policies"] = policies;
+    return report;
+}
+
+QJsonObject CadenceReplay::simulate(int fixedMs, const Options &options) const {
+    CadenceController controller(options.cadence, options.initialMs);
+    BackendModel backend;
+    HdrHistogram detection; // µs from a change to the sweep that queues it
+    qint64 sweeps = 0, queued = 0, llmCalls = 0, missed = 0, intervalChanges = 0;
+    double intervalSum = 0.0;
+
+    int intervalMs = fixedMs > 0 ? fixedMs : controller.interval();
+    qint64 cursor = frames.isEmpty() ? 0 : frames.first().timestampMs - 1;
+    int next = 0;
+    while (next < frames.size()) {
+        const qint64 sweepAt = cursor + intervalMs;
+        const int begin = next;
+        while (next < frames.size() && frames[next].timestampMs <= sweepAt) ++next;
+
+        // Newest first: the first frame seen of a window is the one queued,
+        // and a change with a later change of its window behind it is lost
+        QHash<QString, int> newest;
+        QSet<QString> changedScopes;
+        int sweepDetected = 0;
+        for (int i = next - 1; i >= begin; --i) {
+            const QString scope = ChangeDetector::scopeOf(frames[i]);
+            if (!newest.contains(scope)) newest.insert(scope, i);
+            if (detected[i]) ++sweepDetected;
+            if (!changed[i]) continue;
+            if (changedScopes.contains(scope)) {
+                ++missed;
+                continue;
+            }
+            changedScopes.insert(scope);
+            detection.record(uint64_t(sweepAt - frames[i].timestampMs) * 1000);
+        }
+
+        // In the order gem-ingest queues them
+        QVector<int> queue(newest.cbegin(), newest.cend());
+        std::sort(queue.begin(), queue.end());
+        int sweepCalls = 0;
+        for (int index : std::as_const(queue)) {
+            if (backend.needsLlm(frames[index])) ++sweepCalls;
+        }
+        queued += newest.size();
+        llmCalls += sweepCalls;
+        ++sweeps;
+        intervalSum += intervalMs;
+
+        if (fixedMs <= 0) {
+            CadenceController::Sample sample;
+            sample.elapsedMs = sweepAt - cursor;
+            sample.frames = next - begin;
+            sample.changed = sweepDetected;
+            sample.cleaned = newest.size();
+            sample.llmCalls = sweepCalls;
+            const CadenceController::Decision decision = controller.observe(sample);
+            if (decision.changed()) ++intervalChanges;
+            intervalMs = decision.intervalMs;
+        }
+        cursor = sweepAt;
+    }
+
+    const double hours = frames.isEmpty() ? 0.0
+        : qMax<qint64>(1, frames.last().timestampMs - frames.first().timestampMs) / 3600000.0;
+    const int minSeconds = options.cadence.minIntervalMs / 1000, maxSeconds = options.cadence.maxIntervalMs / 1000;
+
+    QJsonObject latency;
+    latency["count"] = qint64(detection.count());
+    latency["p50Ms"] = double(detection.valueAtPercentile(50)) / 1000.0;
+    latency["p95Ms"] = double(detection.valueAtPercentile(95)) / 1000.0;
+    latency["maxMs"] = double(detection.max()) / 1000.0;
+    latency["meanMs"] = detection.mean() / 1000.0;
+
+    QJsonObject policy;
+    policy["policy"] = fixedMs > 0 ? QString("fixed %1 s").arg(fixedMs / 1000.0)
+                                   : QString("adaptive %1-%2 s").arg(minSeconds).arg(maxSeconds);
+    policy["meanIntervalMs"] = sweeps ? intervalSum / double(sweeps) : 0.0;
+    policy["intervalChanges"] = intervalChanges;
+    policy["sweeps"] = sweeps;
+    policy["sweepsPerHour"] = hours > 0 ? double(sweeps) / hours : 0.0;
+    policy["queued"] = queued;
+    policy["llmCalls"] = llmCalls;
+    policy["llmCallsPerHour"] = hours > 0 ? double(llmCalls) / hours : 0.0;
+    policy["missed"] = missed;
+    policy["detection"] = latency;
+    return policy;
+}
+
+void CadenceReplay::print(const QJsonObject &report) {
+    const qint64 changes = report["changes"].toInteger();
+
+    QStringList lines;
+    lines << QString("Cadence over %1 frames, %2 h of recording, %3 screen changes")
+                 .arg(report["frames"].toInteger())
+                 .arg(report["hours"].toDouble(), 0, 'f', 2)
+                 .arg(changes);
+    lines << QString("  %1 %2 %3 %4 %5 %6 %7 %8")
+                 .arg(QString("policy"), -18).arg(QString("mean s"), 7)
+                 .arg(QString("sweeps/h"), 9).arg(QString("LLM/h"), 8)
+                 .arg(QString("p50 s"), 7).arg(QString("p95 s"), 7)
+                 .arg(QString("max s"), 7).arg(QString("missed"), 8);
+    for (const QJsonValue &value : report["policies"].toArray()) {
+        const QJsonObject policy = value.toObject();
+        const QJsonObject detection = policy["detection"].toObject();
+        const double missedShare = changes ? 100.0 * double(policy["missed"].toInteger()) / double(changes) : 0.0;
+        lines << QString("  %1 %2 %3 %4 %5 %6 %7 %8%")
+                     .arg(policy["policy"].toString(), -18)
+                     .arg(policy["meanIntervalMs"].toDouble() / 1000.0, 7, 'f', 1)
+                     .arg(policy["sweepsPerHour"].toDouble(), 9, 'f', 0)
+                     .arg(policy["llmCallsPerHour"].toDouble(), 8, 'f', 0)
+                     .arg(detection["p50Ms"].toDouble() / 1000.0, 7, 'f', 1)
+                     .arg(detection["p95Ms"].toDouble() / 1000.0, 7, 'f', 1)
+                     .arg(detection["maxMs"].toDouble() / 1000.0, 7, 'f', 1)
+                     .arg(missedShare, 7, 'f', 1);
+    }
+
+    const QByteArray text = lines.join('\n').toUtf8() + '\n';
+    std::fwrite(text.constData(), 1, size_t(text.size()), stdout);
+    std::fflush(stdout);
+}
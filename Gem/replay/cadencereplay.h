@@ -0,0 +1,42 @@
+#ifndef CADENCEREPLAY_H
+#define CADENCEREPLAY_H
+
+#include <QJsonObject>
+#include <QVector>
+#include "cadencecontroller.h"
+#include "ocrframe.h"
+
+// Offline comparison of sweep cadences over recorded frames. Each policy
+// sweeps the recording on a virtual clock the way gem-ingest does with
+// --coalesce: every sweep queues the newest frame of each window. The
+// queued frames go through a model of the backend's cleaning (frame deltas
+// behind the near-duplicate index and the exact cache, as in
+// ocr/cache-ocr.js), which counts the LLM calls. A screen change is a frame the same frame deltas
+// would clean, against every frame captured. For each policy the replay
+// reports LLM calls, how long a change waits for the sweep that picks it
+// up, and the changes lost because a later change of the same window came
+// before the sweep. The adaptive policy is fed SimHash changes, as
+// gem-ingest counts them. No backend runs, so there is never a backlog.
+class CadenceReplay {
+public:
+    struct Options {
+        QVector<int> fixedMs = {2000, 5000, 10000, 30000};
+        int initialMs = 10000; // where the adaptive policy starts
+        CadenceController::Options cadence;
+    };
+
+    explicit CadenceReplay(const QVector<OcrFrame> &frames);
+
+    // One entry per fixed interval, then the adaptive policy
+    QJsonObject run(const Options &options) const;
+    static void print(const QJsonObject &report);
+
+private:
+    const QVector<OcrFrame> &frames; // sorted by timestamp
+    QVector<bool> changed;           // frame has something new to clean
+    QVector<bool> detected;          // gem-ingest's ChangeDetector saw a change
+
+    QJsonObject simulate(int fixedMs, const Options &options) const; // 0: adaptive
+};
+
+#endif // CADENCEREPLAY_H
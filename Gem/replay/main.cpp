@@ -0,0 +1,120 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <cstdio>
+#include "cadencereplay.h"
+#include "replaytimeline.h"
+#include "replayharness.h"
+
+// gem-replay: headless end-to-end run of the node backend against recorded
+// Screenpipe frames and a scripted LLM.
+//
+// Frames are NDJSON, e.g. gem-ingest's stdout captured during a real session
+// (gem-ingest --cursor <ms> > frames.ndjson). The backend is started with its
+// Screenpipe and Groq endpoints pointed at this process and its IPC socket
+// connected to an offscreen MainWindow, whose suggestion cards are clicked
+// as soon as they show; throughput and latency are printed when the replay
+// ends and optionally written as JSON.
+//
+// --cadence skips the backend: the frames are swept on a virtual clock at
+// fixed intervals and with the adaptive controller, and the LLM calls and
+// change detection latency of each are compared.
+
+int main(int argc, char *argv[]) {
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gem-replay");
+
+    const QString root = QDir(QCoreApplication::applicationDirPath()).absolutePath();
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption framesOption("frames", "Recorded frames (NDJSON).", "file");
+    QCommandLineOption speedOption("speed", "Replay speed; 10 plays ten seconds of recording per second.", "factor", "1");
+    QCommandLineOption portOption("port", "Port for the Screenpipe and LLM stand-ins (0 picks one).", "port", "0");
+    QCommandLineOption latencyOption("llm-latency", "Mock LLM response time.", "ms", "300");
+    QCommandLineOption jitterOption("llm-jitter", "Extra deterministic per-prompt delay, up to this much.", "ms", "0");
+    QCommandLineOption scriptOption("llm-script", "Mock LLM response rules (JSON).", "file");
+    QCommandLineOption quietOption("no-suggest", "Built-in LLM replies never propose an action.");
+    QCommandLineOption nodeOption("node", "Node executable.", "path", "node");
+    QCommandLineOption pollerOption("poller", "Backend entry point.", "file",
+                                    QDir(root).filePath("backend/ocr/screenpipe-poller.js"));
+    QCommandLineOption cacheOption("cache-url", "REDIS_URL for the OCR cache (off by default).", "url");
+    QCommandLineOption gatewayOption("gateway", "Route LLM calls through a gem-gateway at this URL "
+                                     "(started with --upstream pointing at this tool's --port).", "url");
+    QCommandLineOption pollOption("poll", "POLL_FREQ for the backend.", "seconds", "2");
+    QCommandLineOption acceptOption("accept", "Click accept on suggestion cards instead of reject.");
+    QCommandLineOption drainOption("drain", "Seconds to keep running after the last frame.", "seconds", "10");
+    QCommandLineOption durationOption("duration", "Stop after this many seconds regardless.", "seconds", "0");
+    QCommandLineOption reportOption("report", "Write the report as JSON.", "file");
+    QCommandLineOption cadenceOption("cadence", "Compare sweep cadences offline instead of replaying.");
+    QCommandLineOption minIntervalOption("min-interval", "Shortest adaptive interval with --cadence.", "seconds", "2");
+    QCommandLineOption maxIntervalOption("max-interval", "Longest adaptive interval with --cadence.", "seconds", "30");
+    parser.addOptions({framesOption, speedOption, portOption, latencyOption, jitterOption, scriptOption,
+                       quietOption, nodeOption, pollerOption, cacheOption, gatewayOption, pollOption, acceptOption,
+                       drainOption, durationOption, reportOption, cadenceOption, minIntervalOption,
+                       maxIntervalOption});
+    parser.process(app);
+
+    if (!parser.isSet(framesOption)) {
+        std::fprintf(stderr, "gem-replay: --frames is required\n");
+        return 2;
+    }
+
+    if (parser.isSet(cadenceOption)) {
+        ReplayTimeline timeline;
+        QString error;
+        if (!timeline.load(parser.value(framesOption), &error)) {
+            std::fprintf(stderr, "gem-replay: %s\n", qPrintable(error));
+            return 1;
+        }
+        CadenceReplay::Options cadence;
+        cadence.initialMs = qMax(1, parser.value(pollOption).toInt()) * 1000;
+        cadence.cadence.minIntervalMs = qMax(1, parser.value(minIntervalOption).toInt()) * 1000;
+        cadence.cadence.maxIntervalMs = qMax(1, parser.value(maxIntervalOption).toInt()) * 1000;
+
+        const QJsonObject report = CadenceReplay(timeline.recorded()).run(cadence);
+        CadenceReplay::print(report);
+        if (parser.isSet(reportOption)) {
+            QFile file(parser.value(reportOption));
+            if (!file.open(QIODevice::WriteOnly)) {
+                std::fprintf(stderr, "gem-replay: could not write %s\n", qPrintable(file.fileName()));
+                return 1;
+            }
+            file.write(QJsonDocument(report).toJson());
+        }
+        return 0;
+    }
+
+    ReplayHarness::Options options;
+    options.framesPath = parser.value(framesOption);
+    options.speed = qMax(0.01, parser.value(speedOption).toDouble());
+    options.port = quint16(parser.value(portOption).toUInt());
+    options.llm.latencyMs = qMax(0, parser.value(latencyOption).toInt());
+    options.llm.jitterMs = qMax(0, parser.value(jitterOption).toInt());
+    options.llm.suggest = !parser.isSet(quietOption);
+    options.llmScript = parser.value(scriptOption);
+    options.node = parser.value(nodeOption);
+    options.poller = parser.value(pollerOption);
+    options.cacheUrl = parser.value(cacheOption);
+    options.gatewayUrl = parser.value(gatewayOption);
+    options.pollFreq = QString::number(qMax(1, parser.value(pollOption).toInt()));
+    options.accept = parser.isSet(acceptOption);
+    options.drainMs = qMax(0, parser.value(drainOption).toInt()) * 1000;
+    options.durationMs = qMax(0, parser.value(durationOption).toInt()) * 1000;
+    options.reportPath = parser.value(reportOption);
+
+    ReplayHarness harness(options);
+    QObject::connect(&harness, &ReplayHarness::finished, &app, [&app](int exitCode) {
+        app.exit(exitCode);
+    });
+
+    QString error;
+    if (!harness.start(&error)) {
+        std::fprintf(stderr, "gem-replay: %s\n", qPrintable(error));
+        return 1;
+    }
+    return app.exec();
+}
@@ -0,0 +1,182 @@
+#include "mockllm.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QDateTime>
+#include <QCryptographicHash>
+
+namespace {
+
+// Fields the backend's prompts embed; see clean-ocr.js and suggestion-agent.js
+const QRegularExpression AppPattern(R"re(The app name is "([^"]*)")re");
+const QRegularExpression TopicPattern(R"re("(?:thread_)?topic":\s*"([^"]*)")re");
+const QRegularExpression InputPattern(R"re(OCR input:\n([\s\S]*)$)re");
+
+QString firstCapture(const QRegularExpression &pattern, const QString &text) {
+    const QRegularExpressionMatch match = pattern.match(text);
+    return match.hasMatch() ? match.captured(1).trimmed() : QString();
+}
+
+QString jsonString(const QString &text) {
+    const QByteArray quoted = QJsonDocument(QJsonArray{text}).toJson(QJsonDocument::Compact);
+    return QString::fromUtf8(quoted.mid(1, quoted.size() - 2));
+}
+
+} // namespace
+
+MockLlm::MockLlm(const Options &options, QObject *parent)
+    : QObject(parent), options(options) {}
+
+bool MockLlm::loadScript(const QString &path, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonArray script = QJsonDocument::fromJson(file.readAll(), &parseError).array();
+    if (parseError.error != QJsonParseError::NoError) {
+        *error = parseError.errorString();
+        return false;
+    }
+
+    rules.clear();
+    for (const QJsonValue &value : script) {
+        const QJsonObject entry = value.toObject();
+        Rule rule;
+        rule.match = QRegularExpression(entry.value("match").toString());
+        rule.response = entry.value("response").toString();
+        rule.latencyMs = entry.value("latencyMs").toInt(-1);
+        if (!rule.match.isValid()) {
+            *error = QString("bad pattern %1: %2").arg(rule.match.pattern(), rule.match.errorString());
+            return false;
+        }
+        rules.append(rule);
+    }
+    return true;
+}
+
+void MockLlm::install(HttpServer *server) {
+    server->route("POST", "/openai/v1/chat/completions",
+                  [this](const HttpServer::Request &request, const HttpServer::Respond &respond) {
+        complete(request, respond);
+    });
+}
+
+void MockLlm::complete(const HttpServer::Request &request, const HttpServer::Respond &respond) {
+    const QJsonObject body = QJsonDocument::fromJson(request.body).object();
+    const QJsonArray messages = body.value("messages").toArray();
+    if (messages.isEmpty()) {
+        respond(400, R"({"error":{"message":"messages is required"}})", "application/json");
+        return;
+    }
+    const QString prompt = messages.last().toObject().value("content").toString();
+
+    QString reply;
+    int latency = options.latencyMs;
+    bool matched = false;
+    for (const Rule &rule : rules) {
+        if (!rule.match.match(prompt).hasMatch()) continue;
+        reply = expand(rule.response, prompt);
+        if (rule.latencyMs >= 0) latency = rule.latencyMs;
+        matched = true;
+        break;
+    }
+    if (!matched) reply = builtinReply(prompt);
+
+    // Jitter from the prompt's hash, not a RNG, so runs repeat exactly
+    if (options.jitterMs > 0) {
+        const QByteArray digest = QCryptographicHash::hash(prompt.toUtf8(), QCryptographicHash::Md5);
+        const quint32 seed = quint32(quint8(digest[0])) | quint32(quint8(digest[1])) << 8;
+        latency += int(seed % quint32(options.jitterMs + 1));
+    }
+
+    const quint64 id = ++calls;
+    const bool streamed = body.value("stream").toBool();
+    const QByteArray response = streamed ? streamBody(body.value("model").toString(), reply, id)
+                                         : completionBody(body.value("model").toString(), reply, id);
+    const QByteArray contentType = streamed ? "text/event-stream" : "application/json";
+    QTimer::singleShot(latency, this, [respond, response, contentType]() {
+        respond(200, response, contentType);
+    });
+}
+
+QString MockLlm::builtinReply(const QString &prompt) const {
+    if (prompt.contains("screen text cleaner")) {
+        const QString app = firstCapture(AppPattern, prompt);
+        return QString(R"({"cleaned_text": %1, "topic": %2})")
+            .arg(jsonString(firstCapture(InputPattern, prompt)),
+                 jsonString(QString("working on %1").arg(app.isEmpty() ? "unknown app" : app)));
+    }
+    if (prompt.contains("Available tools:") && options.suggest) {
+        // Skip the example in the instructions; the threads follow this
+        const QString topic = firstCapture(TopicPattern, prompt.mid(prompt.indexOf("User Activity:")));
+        if (topic.isEmpty()) return "{}";
+        return QString(R"({"action": "send_mail", "reason": "Replay suggestion.", )"
+                       R"("trigger_data": {"thread_topic": %1, "text": "replayed"}})")
+            .arg(jsonString(topic));
+    }
+    return "{}";
+}
+
+QString MockLlm::expand(QString text, const QString &prompt) {
+    text.replace("{{app}}", firstCapture(AppPattern, prompt));
+    text.replace("{{topic}}", firstCapture(TopicPattern, prompt));
+    text.replace("{{input}}", firstCapture(InputPattern, prompt));
+    return text;
+}
+
+QByteArray MockLlm::completionBody(const QString &model, const QString &content, quint64 id) {
+    QJsonObject message;
+    message["role"] = "assistant";
+    message["content"] = content;
+
+    QJsonObject choice;
+    choice["index"] = 0;
+    choice["message"] = message;
+    choice["finish_reason"] = "stop";
+
+    QJsonObject usage;
+    usage["prompt_tokens"] = 0;
+    usage["completion_tokens"] = 0;
+    usage["total_tokens"] = 0;
+
+    QJsonObject completion;
+    completion["id"] = QString("replay-%1").arg(id);
+    completion["object"] = "chat.completion";
+    completion["created"] = QDateTime::currentSecsSinceEpoch();
+    completion["model"] = model;
+    completion["choices"] = QJsonArray{choice};
+    completion["usage"] = usage;
+    return QJsonDocument(completion).toJson(QJsonDocument::Compact);
+}
+
+QByteArray MockLlm::streamBody(const QString &model, const QString &content, quint64 id) {
+    QByteArray events;
+    const auto event = [&](const QJsonObject &delta, const QJsonValue &finishReason) {
+        QJsonObject choice;
+        choice["index"] = 0;
+        choice["delta"] = delta;
+        choice["finish_reason"] = finishReason;
+
+        QJsonObject chunk;
+        chunk["id"] = QString("replay-%1").arg(id);
+        chunk["object"] = "chat.completion.chunk";
+        chunk["created"] = QDateTime::currentSecsSinceEpoch();
+        chunk["model"] = model;
+        chunk["choices"] = QJsonArray{choice};
+        events += "data: " + QJsonDocument(chunk).toJson(QJsonDocument::Compact) + "\n\n";
+    };
+
+    event(QJsonObject{{"role", "assistant"}, {"content", ""}}, QJsonValue::Null);
+    // Words keep their trailing whitespace so the pieces join back exactly
+    static const QRegularExpression word(R"re(\S+\s*|\s+)re");
+    for (auto it = word.globalMatch(content); it.hasNext();)
+        event(QJsonObject{{"content", it.next().captured()}}, QJsonValue::Null);
+    event(QJsonObject{}, "stop");
+    events += "data: [DONE]\n\n";
+    return events;
+}
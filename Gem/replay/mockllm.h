@@ -0,0 +1,53 @@
+#ifndef MOCKLLM_H
+#define MOCKLLM_H
+
+#include <QObject>
+#include <QRegularExpression>
+#include <QVector>
+#include "httpserver.h"
+
+// Deterministic stand-in for the Groq chat completions endpoint the backend
+// calls (groq-sdk honours GROQ_BASE_URL). Each prompt is answered by the
+// first script rule whose pattern matches it, or by a built-in reply shaped
+// like what the cleaner and the suggestion agent expect. Replies are held
+// for latencyMs plus a jitter derived from the prompt, so a given recording
+// replays with the same timings every run. Streamed requests get the same
+// reply as server-sent events, one word per chunk.
+class MockLlm : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        int latencyMs = 300;
+        int jitterMs = 0;
+        bool suggest = true; // built-in suggestion reply proposes an action
+    };
+
+    explicit MockLlm(const Options &options, QObject *parent = nullptr);
+
+    // JSON array of {"match": regex, "response": text, "latencyMs": n}.
+    // Responses may use {{app}}, {{topic}} and {{input}}.
+    bool loadScript(const QString &path, QString *error);
+
+    void install(HttpServer *server);
+
+    quint64 completions() const { return calls; }
+
+private:
+    struct Rule {
+        QRegularExpression match;
+        QString response;
+        int latencyMs = -1; // -1 uses the default
+    };
+
+    Options options;
+    QVector<Rule> rules;
+    quint64 calls = 0;
+
+    void complete(const HttpServer::Request &request, const HttpServer::Respond &respond);
+    QString builtinReply(const QString &prompt) const;
+    static QString expand(QString text, const QString &prompt);
+    static QByteArray completionBody(const QString &model, const QString &content, quint64 id);
+    static QByteArray streamBody(const QString &model, const QString &content, quint64 id);
+};
+
+#endif // MOCKLLM_H
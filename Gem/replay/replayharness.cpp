@@ -0,0 +1,347 @@
+#include "replayharness.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QProcessEnvironment>
+#include <cstdio>
+
+namespace {
+
+const int ReadyTimeoutMs = 60000;
+
+QJsonObject summarize(const HdrHistogram &histogram) {
+    QJsonObject summary;
+    summary["count"] = qint64(histogram.count());
+    summary["p50Ms"] = double(histogram.valueAtPercentile(50)) / 1000.0;
+    summary["p95Ms"] = double(histogram.valueAtPercentile(95)) / 1000.0;
+    summary["p99Ms"] = double(histogram.valueAtPercentile(99)) / 1000.0;
+    summary["maxMs"] = double(histogram.max()) / 1000.0;
+    summary["meanMs"] = histogram.mean() / 1000.0;
+    return summary;
+}
+
+QString summaryLine(const QString &name, const QJsonObject &summary) {
+    return QString("  %1 %2 %3 %4 %5 %6")
+        .arg(name, -18)
+        .arg(summary["count"].toInteger(), 7)
+        .arg(summary["p50Ms"].toDouble(), 9, 'f', 1)
+        .arg(summary["p95Ms"].toDouble(), 9, 'f', 1)
+        .arg(summary["p99Ms"].toDouble(), 9, 'f', 1)
+        .arg(summary["maxMs"].toDouble(), 9, 'f', 1);
+}
+
+} // namespace
+
+ReplayHarness::ReplayHarness(const Options &options, QObject *parent)
+    : QObject(parent), options(options)
+{
+    http = new HttpServer(this);
+    llm = new MockLlm(options.llm, this);
+    poller = new QProcess(this);
+    tickTimer = new QTimer(this);
+    tickTimer->setInterval(250);
+
+    connect(poller, &QProcess::readyReadStandardOutput, this, &ReplayHarness::onPollerOutput);
+    connect(poller, &QProcess::finished, this, &ReplayHarness::onPollerFinished);
+    connect(tickTimer, &QTimer::timeout, this, &ReplayHarness::tick);
+}
+
+ReplayHarness::~ReplayHarness() {
+    delete window;
+}
+
+bool ReplayHarness::start(QString *error) {
+    if (!timeline.load(options.framesPath, error)) {
+        *error = QString("%1: %2").arg(options.framesPath, *error);
+        return false;
+    }
+    if (!options.llmScript.isEmpty() && !llm->loadScript(options.llmScript, error)) {
+        *error = QString("%1: %2").arg(options.llmScript, *error);
+        return false;
+    }
+    if (!configDir.isValid()) {
+        *error = "could not create a config directory";
+        return false;
+    }
+
+    installScreenpipe();
+    llm->install(http);
+    if (!http->listen(options.port)) {
+        *error = "could not listen on the stand-in port";
+        return false;
+    }
+
+    // The app reads the same scratch config as the backend, and listens on
+    // its own socket rather than a running Gem's
+    qputenv("GEM_IPC_NAME", QString("gem-replay-%1").arg(QCoreApplication::applicationPid()).toUtf8());
+    qputenv("GEM_CONFIG_DIR", configDir.path().toUtf8());
+    window = new MainWindow();
+    if (window->ipcServer->fullServerName().isEmpty()) {
+        *error = "could not open the IPC socket";
+        return false;
+    }
+    connect(window->ipcServer, &IpcServer::messageReceived, this, &ReplayHarness::onIpcMessage);
+    connect(window->notifications, &NotificationManager::responded, this, [this]() { ++responses; });
+    connect(window->notifications, &NotificationManager::expired, this, [this]() { ++responses; });
+
+    // Same variables the supervisor and .env provide, pointed at the
+    // stand-ins; existing ones win over .env because dotenv never overrides
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    const QString base = QString("http://127.0.0.1:%1").arg(http->port());
+    env.insert("SCREENPIPE_PORT", QString::number(http->port()));
+    env.insert("GROQ_BASE_URL", base);
+    env.insert("GROQ_API_KEY", "replay");
+    env.insert("GEM_IPC_PATH", window->ipcServer->fullServerName());
+    env.insert("GEM_SUPERVISED", "1");
+    env.insert("GEM_CONFIG_DIR", configDir.path());
+    env.insert("POLL_FREQ", options.pollFreq);
+    env.insert("REDIS_URL", options.cacheUrl.isEmpty() ? QString("none") : options.cacheUrl);
+    if (!options.gatewayUrl.isEmpty()) env.insert("GEM_GATEWAY_URL", options.gatewayUrl);
+    else env.remove("GEM_GATEWAY_URL");
+    poller->setProcessEnvironment(env);
+    poller->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    poller->setWorkingDirectory(QFileInfo(options.poller).absolutePath());
+
+    poller->start(options.node, {options.poller});
+    if (!poller->waitForStarted(5000)) {
+        *error = QString("could not start %1: %2").arg(options.node, poller->errorString());
+        return false;
+    }
+    std::fprintf(stderr, "gem-replay: %d frames, stand-ins on %s, waiting for the backend...\n",
+                 timeline.size(), qPrintable(base));
+
+    QTimer::singleShot(ReadyTimeoutMs, this, [this]() {
+        if (startedMs != 0) return;
+        std::fprintf(stderr, "gem-replay: backend never reported GEM_READY\n");
+        finish(1);
+    });
+    return true;
+}
+
+void ReplayHarness::installScreenpipe() {
+    http->route("GET", "/health", [](const HttpServer::Request &, const HttpServer::Respond &respond) {
+        respond(200, R"({"status":"healthy"})", "application/json");
+    });
+
+    http->route("GET", "/search", [this](const HttpServer::Request &request, const HttpServer::Respond &respond) {
+        ++searchRequests;
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (startedMs == 0) {
+            respond(200, R"({"data":[],"pagination":{"limit":0,"offset":0,"total":0}})", "application/json");
+            return;
+        }
+
+        auto timeParam = [&](const char *name, qint64 fallback) {
+            const QDateTime time = QDateTime::fromString(request.query.queryItemValue(name), Qt::ISODateWithMs);
+            return time.isValid() ? time.toMSecsSinceEpoch() : fallback;
+        };
+        const qint64 startMs = timeParam("start_time", 0);
+        const qint64 endMs = timeParam("end_time", now);
+        const int offset = qMax(0, request.query.queryItemValue("offset").toInt());
+        const int limit = qBound(1, request.query.queryItemValue("limit").toInt(), 1000);
+
+        const QJsonObject response = timeline.search(startMs, endMs, offset, limit, now);
+        framesServed += quint64(response["data"].toArray().size());
+        respond(200, QJsonDocument(response).toJson(QJsonDocument::Compact), "application/json");
+    });
+}
+
+void ReplayHarness::onPollerOutput() {
+    while (poller->canReadLine()) {
+        const QByteArray line = poller->readLine().trimmed();
+        if (line != "GEM_READY" || startedMs != 0) continue;
+
+        startedMs = QDateTime::currentMSecsSinceEpoch();
+        timeline.start(startedMs, options.speed);
+        tickTimer->start();
+        std::fprintf(stderr, "gem-replay: backend ready, replaying at %.2gx\n", options.speed);
+    }
+}
+
+void ReplayHarness::onPollerFinished(int exitCode, QProcess::ExitStatus status) {
+    if (stopping) return;
+    std::fprintf(stderr, "gem-replay: backend exited early (%s, code %d)\n",
+                 status == QProcess::CrashExit ? "crashed" : "exited", exitCode);
+    finish(1);
+}
+
+void ReplayHarness::onIpcMessage(const QString &type, const QJsonObject &message) {
+    const qint64 now = TraceCollector::nowUs();
+
+    if (type == "spans") {
+        const QJsonArray spans = message["spans"].toArray();
+        traces.ingest(spans);
+        for (const QJsonValue &value : spans) {
+            const QJsonArray span = value.toArray();
+            if (span.size() < 4) continue;
+            const quint64 trace = TraceCollector::parseTraceId(span[0].toString());
+            const int stage = TraceCollector::stageFromName(span[1].toString());
+            if (stage == TraceCollector::ScreenpipeQuery) {
+                queryStarts.insert(trace, qint64(span[2].toDouble() * 1000));
+            } else if (stage == TraceCollector::AddToThread) {
+                ++framesThreaded;
+                const auto start = queryStarts.constFind(trace);
+                if (start != queryStarts.constEnd())
+                    frameLatency.record(quint64(qMax<qint64>(0, qint64(span[3].toDouble() * 1000) - *start)));
+            }
+        }
+        resolveSuggestions();
+    } else if (type == "suggestion") {
+        ++suggestions;
+        const quint64 trace = TraceCollector::parseTraceId(message["trace"].toString());
+        const double sentAt = message["sentAt"].toDouble();
+        if (trace != 0) {
+            pendingSuggestions.insert(trace, now);
+            if (sentAt > 0) traces.record(trace, TraceCollector::Handoff, qint64(sentAt * 1000), now);
+        }
+        resolveSuggestions();
+        // MainWindow queues the card itself; answerCards() clicks it once shown
+    }
+}
+
+void ReplayHarness::answerCards() {
+    for (SuggestionPopup *card : window->notifications->cards()) {
+        QMetaObject::invokeMethod(card, options.accept ? "onAccept" : "onReject");
+        ++cardsAnswered;
+    }
+}
+
+void ReplayHarness::resolveSuggestions() {
+    for (auto it = pendingSuggestions.begin(); it != pendingSuggestions.end();) {
+        const auto start = queryStarts.constFind(it.key());
+        if (start == queryStarts.constEnd()) {
+            ++it;
+            continue;
+        }
+        suggestionLatency.record(quint64(qMax<qint64>(0, it.value() - *start)));
+        it = pendingSuggestions.erase(it);
+    }
+}
+
+void ReplayHarness::tick() {
+    answerCards();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (options.durationMs > 0 && now - startedMs >= options.durationMs) {
+        finish(0);
+        return;
+    }
+    if (exhaustedMs == 0 && now >= timeline.lastFrameTime()) {
+        exhaustedMs = now;
+        std::fprintf(stderr, "gem-replay: all frames released, draining for %d s\n", options.drainMs / 1000);
+    }
+    if (exhaustedMs != 0 && now - exhaustedMs >= options.drainMs) finish(0);
+}
+
+void ReplayHarness::finish(int exitCode) {
+    if (stopping) return;
+    stopping = true;
+    tickTimer->stop();
+
+    // Supervised children exit when stdin closes
+    if (poller->state() != QProcess::NotRunning) {
+        poller->closeWriteChannel();
+        if (!poller->waitForFinished(3000)) {
+            poller->kill();
+            poller->waitForFinished(1000);
+        }
+    }
+
+    traces.drain();
+    const QJsonObject summary = report();
+    printReport(summary);
+
+    if (!options.reportPath.isEmpty()) {
+        QFile file(options.reportPath);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(QJsonDocument(summary).toJson());
+        } else {
+            std::fprintf(stderr, "gem-replay: could not write %s\n", qPrintable(options.reportPath));
+            exitCode = exitCode ? exitCode : 1;
+        }
+    }
+    emit finished(exitCode);
+}
+
+QJsonObject ReplayHarness::report() const {
+    const qint64 end = QDateTime::currentMSecsSinceEpoch();
+    const double seconds = startedMs ? qMax<qint64>(1, end - startedMs) / 1000.0 : 0.0;
+    const qint64 released = startedMs ? timeline.released(end) : 0;
+
+    QJsonObject throughput;
+    throughput["seconds"] = seconds;
+    throughput["speed"] = options.speed;
+    throughput["framesRecorded"] = timeline.size();
+    throughput["framesReleased"] = released;
+    throughput["framesServed"] = qint64(framesServed);
+    throughput["framesThreaded"] = qint64(framesThreaded);
+    throughput["framesPerSec"] = seconds > 0 ? double(framesThreaded) / seconds : 0.0;
+    throughput["suggestions"] = qint64(suggestions);
+    throughput["suggestionsPerSec"] = seconds > 0 ? double(suggestions) / seconds : 0.0;
+    throughput["cardsAnswered"] = qint64(cardsAnswered);
+    throughput["responses"] = qint64(responses);
+    throughput["searchRequests"] = qint64(searchRequests);
+    throughput["llmCompletions"] = qint64(llm->completions());
+    throughput["droppedSpans"] = qint64(traces.droppedSpans());
+
+    QJsonObject stages;
+    for (int stage = 0; stage < TraceCollector::StageCount; ++stage) {
+        if (traces.histogram(stage).count() > 0)
+            stages[TraceCollector::stageName(stage)] = summarize(traces.histogram(stage));
+    }
+
+    QJsonObject latency;
+    latency["frame"] = summarize(frameLatency);
+    latency["suggestion"] = summarize(suggestionLatency);
+    latency["stages"] = stages;
+
+    QJsonObject result;
+    result["throughput"] = throughput;
+    result["latency"] = latency;
+    return result;
+}
+
+void ReplayHarness::printReport(const QJsonObject &report) const {
+    const QJsonObject throughput = report["throughput"].toObject();
+    const QJsonObject latency = report["latency"].toObject();
+
+    QStringList lines;
+    lines << QString("Replayed %1 of %2 frames in %3 s at %4x")
+                 .arg(throughput["framesReleased"].toInteger())
+                 .arg(throughput["framesRecorded"].toInteger())
+                 .arg(throughput["seconds"].toDouble(), 0, 'f', 1)
+                 .arg(throughput["speed"].toDouble());
+    lines << QString("  frames threaded    %1 (%2/s)")
+                 .arg(throughput["framesThreaded"].toInteger())
+                 .arg(throughput["framesPerSec"].toDouble(), 0, 'f', 2);
+    lines << QString("  suggestions        %1 (%2/s)")
+                 .arg(throughput["suggestions"].toInteger())
+                 .arg(throughput["suggestionsPerSec"].toDouble(), 0, 'f', 3);
+    lines << QString("  cards answered     %1, responses %2")
+                 .arg(throughput["cardsAnswered"].toInteger())
+                 .arg(throughput["responses"].toInteger());
+    lines << QString("  /search requests   %1, LLM completions %2, dropped spans %3")
+                 .arg(throughput["searchRequests"].toInteger())
+                 .arg(throughput["llmCompletions"].toInteger())
+                 .arg(throughput["droppedSpans"].toInteger());
+    lines << QString();
+    lines << QString("  %1 %2 %3 %4 %5 %6")
+                 .arg(QString("latency (ms)"), -18).arg(QString("count"), 7)
+                 .arg(QString("p50"), 9).arg(QString("p95"), 9)
+                 .arg(QString("p99"), 9).arg(QString("max"), 9);
+    lines << summaryLine("frame end-to-end", latency["frame"].toObject());
+    lines << summaryLine("suggestion e2e", latency["suggestion"].toObject());
+    const QJsonObject stages = latency["stages"].toObject();
+    for (int stage = 0; stage < TraceCollector::StageCount; ++stage) {
+        const QString name = TraceCollector::stageName(stage);
+        if (stages.contains(name)) lines << summaryLine(name, stages[name].toObject());
+    }
+
+    const QByteArray text = lines.join('\n').toUtf8() + '\n';
+    std::fwrite(text.constData(), 1, size_t(text.size()), stdout);
+    std::fflush(stdout);
+}
@@ -0,0 +1,94 @@
+#ifndef REPLAYHARNESS_H
+#define REPLAYHARNESS_H
+
+#include <QObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QHash>
+#include <QJsonObject>
+#include "httpserver.h"
+#include "replaytimeline.h"
+#include "mockllm.h"
+#include "mainwindow.h"
+#include "tracecollector.h"
+#include "hdrhistogram.h"
+
+// Runs the real node backend (screenpipe-poller.js and everything it starts)
+// against local stand-ins: ReplayTimeline behind a Screenpipe-shaped
+// /search and MockLlm behind the Groq endpoint. The app is the real one, an
+// offscreen MainWindow: suggestions go through its IPC server,
+// dispatchSuggestion() and NotificationManager's cards, and only the user is
+// simulated, clicking every card's accept or reject button as soon as it is
+// shown (Review or Dismiss all on a digest). Spans arrive over IPC exactly as
+// they do in Gem, so the report's latencies are the ones the Latency tab
+// would show.
+class ReplayHarness : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        QString framesPath;
+        double speed = 1.0;
+        quint16 port = 0;
+        MockLlm::Options llm;
+        QString llmScript;
+        QString node = "node";
+        QString poller;        // screenpipe-poller.js
+        QString cacheUrl;      // REDIS_URL for the OCR cache; empty turns it off
+        QString gatewayUrl;    // GEM_GATEWAY_URL, to put gem-gateway between the backend and the mock
+        QString pollFreq = "2";
+        bool accept = false;   // answer suggestions with accept instead of reject
+        int drainMs = 10000;   // keep running this long after the last frame
+        int durationMs = 0;    // hard stop; 0 runs until drained
+        QString reportPath;
+    };
+
+    explicit ReplayHarness(const Options &options, QObject *parent = nullptr);
+    ~ReplayHarness();
+
+    bool start(QString *error);
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void onPollerOutput();
+    void onPollerFinished(int exitCode, QProcess::ExitStatus status);
+    void onIpcMessage(const QString &type, const QJsonObject &message);
+    void tick();
+
+private:
+    Options options;
+    HttpServer *http;
+    MockLlm *llm;
+    MainWindow *window = nullptr;
+    QProcess *poller;
+    QTimer *tickTimer;
+    QTemporaryDir configDir;
+    ReplayTimeline timeline;
+    TraceCollector traces;
+
+    qint64 startedMs = 0;   // GEM_READY seen, replay clock running
+    qint64 exhaustedMs = 0; // last frame released
+    bool stopping = false;
+
+    quint64 searchRequests = 0;
+    quint64 framesServed = 0;
+    quint64 framesThreaded = 0;
+    quint64 suggestions = 0;
+    quint64 cardsAnswered = 0; // clicks, a digest being one
+    quint64 responses = 0;     // answers the app sent back, expiries included
+    HdrHistogram frameLatency;      // µs, Screenpipe query start -> filed into a thread
+    HdrHistogram suggestionLatency; // µs, query start of the triggering frame -> suggestion at the app
+    QHash<quint64, qint64> queryStarts;     // trace -> µs
+    QHash<quint64, qint64> pendingSuggestions; // trace -> µs received, until its spans arrive
+
+    void installScreenpipe();
+    void answerCards();
+    void resolveSuggestions();
+    void finish(int exitCode);
+    QJsonObject report() const;
+    void printReport(const QJsonObject &report) const;
+};
+
+#endif // REPLAYHARNESS_H
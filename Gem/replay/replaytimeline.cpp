@@ -0,0 +1,101 @@
+#include "replaytimeline.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <algorithm>
+
+bool ReplayTimeline::load(const QString &path, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    frames.clear();
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonObject json = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            *error = QString("line %1: %2").arg(lineNumber).arg(parseError.errorString());
+            return false;
+        }
+
+        OcrFrame frame;
+        bool ok = false;
+        if (json.contains("content")) {
+            ok = OcrFrame::fromSearchItem(json, &frame);
+        } else if (json.value("type").toString() == "frame") {
+            ok = OcrFrame::fromJson(json.value("frame").toObject(), &frame);
+        } else if (!json.contains("type")) {
+            ok = OcrFrame::fromJson(json, &frame);
+        } else {
+            continue; // status, ready and error lines from a gem-ingest capture
+        }
+        if (ok) frames.append(frame);
+    }
+
+    std::stable_sort(frames.begin(), frames.end(), [](const OcrFrame &a, const OcrFrame &b) {
+        return a.timestampMs < b.timestampMs;
+    });
+
+    if (frames.isEmpty()) {
+        *error = "no frames";
+        return false;
+    }
+    return true;
+}
+
+void ReplayTimeline::start(qint64 wallStartMs, double replaySpeed) {
+    wallStart = wallStartMs;
+    speed = replaySpeed > 0 ? replaySpeed : 1.0;
+}
+
+qint64 ReplayTimeline::replayTime(int index) const {
+    return wallStart + qint64(double(frames[index].timestampMs - frames.first().timestampMs) / speed);
+}
+
+int ReplayTimeline::released(qint64 nowMs) const {
+    int lo = 0;
+    int hi = frames.size();
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (replayTime(mid) <= nowMs) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+QJsonObject ReplayTimeline::search(qint64 startMs, qint64 endMs, int offset, int limit, qint64 nowMs) const {
+    const qint64 until = qMin(endMs, nowMs);
+
+    // Matching frames form one contiguous run of the sorted list
+    int first = 0;
+    while (first < frames.size() && replayTime(first) < startMs) ++first;
+    int last = first;
+    while (last < frames.size() && replayTime(last) <= until) ++last;
+    const int total = last - first;
+
+    QJsonArray data;
+    for (int i = last - 1 - offset; i >= first && data.size() < limit; --i) {
+        OcrFrame frame = frames[i];
+        frame.timestampMs = replayTime(i);
+        frame.timestamp = QDateTime::fromMSecsSinceEpoch(frame.timestampMs).toUTC().toString(Qt::ISODateWithMs);
+        data.append(frame.toSearchItem());
+    }
+
+    QJsonObject pagination;
+    pagination["limit"] = limit;
+    pagination["offset"] = offset;
+    pagination["total"] = total;
+
+    QJsonObject response;
+    response["data"] = data;
+    response["pagination"] = pagination;
+    return response;
+}
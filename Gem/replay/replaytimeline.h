@@ -0,0 +1,39 @@
+#ifndef REPLAYTIMELINE_H
+#define REPLAYTIMELINE_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include "ocrframe.h"
+
+// Recorded OCR frames laid out on a replay clock. Frame i becomes visible at
+// wallStart + (timestamp_i - timestamp_0) / speed and is served with that
+// shifted timestamp, so the poller sees a live Screenpipe whose history
+// starts when the replay does.
+class ReplayTimeline {
+public:
+    // NDJSON: gem-ingest frame messages ({"type":"frame","frame":{...}}),
+    // bare frame objects, or Screenpipe /search items ({"content":{...}})
+    bool load(const QString &path, QString *error);
+
+    void start(qint64 wallStartMs, double speed);
+
+    int size() const { return frames.size(); }
+    const QVector<OcrFrame> &recorded() const { return frames; }
+    qint64 replayTime(int index) const;
+    qint64 lastFrameTime() const { return frames.isEmpty() ? wallStart : replayTime(frames.size() - 1); }
+
+    // Frames visible by nowMs in [startMs, endMs], newest first like
+    // Screenpipe, as a /search response body
+    QJsonObject search(qint64 startMs, qint64 endMs, int offset, int limit, qint64 nowMs) const;
+
+    // Frames that have become visible so far
+    int released(qint64 nowMs) const;
+
+private:
+    QVector<OcrFrame> frames; // sorted by timestamp
+    qint64 wallStart = 0;
+    double speed = 1.0;
+};
+
+#endif // REPLAYTIMELINE_H
@@ -0,0 +1,179 @@
+#include "scheduler.h"
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QEvent>
+#include <algorithm>
+
+namespace {
+
+const int InactiveStretch = 4; // background apps poll this many times less often
+
+} // namespace
+
+Scheduler *Scheduler::instance() {
+    static Scheduler *scheduler = new Scheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+Scheduler::Scheduler(QObject *parent) : QObject(parent) {
+    clock.start();
+
+    timer = new QTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &Scheduler::wake);
+
+    if (auto *app = qobject_cast<QGuiApplication*>(QCoreApplication::instance())) {
+        appActive = app->applicationState() == Qt::ApplicationActive;
+        connect(app, &QGuiApplication::applicationStateChanged, this, [=](Qt::ApplicationState state) {
+            appActive = state == Qt::ApplicationActive;
+            reschedule();
+        });
+    }
+}
+
+int Scheduler::add(const QString &name, int intervalMs, Priority priority, std::function<void()> work,
+                   QWidget *visibleWith) {
+    Task task;
+    task.id = nextId++;
+    task.name = name;
+    task.intervalMs = qMax(1, intervalMs);
+    task.priority = priority;
+    task.work = std::move(work);
+    task.widget = visibleWith;
+    task.tiedToWidget = visibleWith != nullptr;
+    task.due = clock.elapsed() + effectiveInterval(task);
+    tasks.append(task);
+
+    if (visibleWith) visibleWith->installEventFilter(this);
+    reschedule();
+    return task.id;
+}
+
+void Scheduler::remove(int id) {
+    for (int i = 0; i < tasks.size(); ++i) {
+        if (tasks[i].id == id) {
+            tasks.removeAt(i);
+            break;
+        }
+    }
+    reschedule();
+}
+
+Scheduler::Task *Scheduler::find(int id) {
+    for (Task &task : tasks)
+        if (task.id == id) return &task;
+    return nullptr;
+}
+
+void Scheduler::setEnabled(int id, bool enabled) {
+    Task *task = find(id);
+    if (!task || task->enabled == enabled) return;
+    task->enabled = enabled;
+    if (enabled) task->due = clock.elapsed() + effectiveInterval(*task);
+    reschedule();
+}
+
+void Scheduler::trigger(int id) {
+    Task *task = find(id);
+    if (!task) return;
+    task->due = clock.elapsed();
+    reschedule();
+}
+
+bool Scheduler::runnable(const Task &task) const {
+    if (!task.enabled) return false;
+    if (task.tiedToWidget) return task.widget && task.widget->isVisible();
+    return true;
+}
+
+int Scheduler::effectiveInterval(const Task &task) const {
+    if (appActive || task.priority == Interactive) return task.intervalMs;
+    return task.intervalMs * InactiveStretch;
+}
+
+qint64 Scheduler::latestStart(const Task &task) const {
+    switch (task.priority) {
+    case Interactive: return task.due;
+    case Normal: return task.due + effectiveInterval(task) / 4;
+    case Background: return task.due + effectiveInterval(task) / 2;
+    }
+    return task.due;
+}
+
+bool Scheduler::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() == QEvent::Show || event->type() == QEvent::Hide) {
+        // Work that was skipped while hidden is due as soon as it is shown
+        const qint64 now = clock.elapsed();
+        for (Task &task : tasks)
+            if (task.widget == watched && event->type() == QEvent::Show) task.due = qMin(task.due, now);
+        reschedule();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void Scheduler::reschedule() {
+    // Wake at the earliest point some task can no longer be put off
+    qint64 wakeAt = -1;
+    bool precise = false;
+    for (const Task &task : tasks) {
+        if (!runnable(task)) continue;
+        const qint64 latest = latestStart(task);
+        if (wakeAt < 0 || latest < wakeAt) {
+            wakeAt = latest;
+            precise = task.priority == Interactive;
+        }
+    }
+
+    if (wakeAt < 0) {
+        timer->stop();
+        return;
+    }
+
+    timer->setTimerType(precise ? Qt::PreciseTimer : Qt::CoarseTimer);
+    timer->start(int(qMax<qint64>(0, wakeAt - clock.elapsed())));
+}
+
+void Scheduler::wake() {
+    noteWakeup();
+    const qint64 now = clock.elapsed();
+
+    // Everything already due rides along with the task that forced the wakeup.
+    // Work may add or remove tasks, so go by id.
+    QList<int> due;
+    for (const Task &task : tasks)
+        if (runnable(task) && task.due <= now) due.append(task.id);
+
+    for (int id : due) {
+        Task *task = find(id);
+        if (!task || !runnable(*task)) continue;
+        task->due = now + effectiveInterval(*task);
+        const std::function<void()> work = task->work;
+        work();
+    }
+
+    reschedule();
+}
+
+void Scheduler::advanceBuckets(qint64 second) const {
+    // Clear the seconds that passed without a wakeup
+    if (second - bucketSecond >= Buckets) {
+        std::fill(std::begin(buckets), std::end(buckets), 0);
+    } else {
+        for (qint64 s = bucketSecond + 1; s <= second; ++s) buckets[s % Buckets] = 0;
+    }
+    bucketSecond = qMax(bucketSecond, second);
+}
+
+void Scheduler::noteWakeup() {
+    const qint64 second = clock.elapsed() / 1000;
+    advanceBuckets(second);
+    ++buckets[second % Buckets];
+    ++wakeupCount;
+}
+
+int Scheduler::wakeupsPerMinute() const {
+    advanceBuckets(clock.elapsed() / 1000);
+    quint64 total = 0;
+    for (quint32 count : buckets) total += count;
+    return int(total);
+}
@@ -0,0 +1,84 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <QObject>
+#include <QWidget>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <functional>
+
+// Runs the app's periodic work from a single timer.
+//  - Each task has an interval and a priority. Lower priorities tolerate
+//    running late by a fraction of their interval, which lets nearby
+//    deadlines share one wakeup.
+//  - A task tied to a widget only runs while that widget is visible.
+//  - While the app is in the background, everything except Interactive
+//    work runs at a quarter of its normal rate.
+// Anything that can be driven by file or socket events should be; this is
+// for what's left. wakeupsPerMinute() counts the scheduler's own wakeups
+// plus any reported through noteWakeup(), and should sit near zero when
+// nothing is happening.
+class Scheduler : public QObject {
+    Q_OBJECT
+public:
+    enum Priority {
+        Interactive, // on time
+        Normal,      // may run up to a quarter interval late
+        Background   // may run up to half an interval late
+    };
+
+    static Scheduler *instance();
+
+    // Tasks start enabled; the first run is one interval from now
+    int add(const QString &name, int intervalMs, Priority priority, std::function<void()> work,
+            QWidget *visibleWith = nullptr);
+    void remove(int id);
+    void setEnabled(int id, bool enabled);
+    void trigger(int id); // run at the next wakeup instead of waiting out the interval
+
+    void noteWakeup();
+    int wakeupsPerMinute() const;
+    quint64 wakeups() const { return wakeupCount; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Task {
+        int id = 0;
+        QString name;
+        int intervalMs = 0;
+        Priority priority = Normal;
+        std::function<void()> work;
+        QPointer<QWidget> widget;
+        bool tiedToWidget = false;
+        bool enabled = true;
+        qint64 due = 0;
+    };
+
+    explicit Scheduler(QObject *parent);
+
+    QTimer *timer;
+    QElapsedTimer clock;
+    QList<Task> tasks;
+    int nextId = 1;
+    bool appActive = true;
+
+    // Wakeups per second over the last minute
+    static constexpr int Buckets = 60;
+    mutable quint32 buckets[Buckets] = {};
+    mutable qint64 bucketSecond = 0;
+    quint64 wakeupCount = 0;
+
+    Task *find(int id);
+    bool runnable(const Task &task) const;
+    int effectiveInterval(const Task &task) const;
+    qint64 latestStart(const Task &task) const;
+    void advanceBuckets(qint64 second) const;
+    void reschedule();
+    void wake();
+};
+
+#endif // SCHEDULER_H
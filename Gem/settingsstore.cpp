@@ -0,0 +1,85 @@
+#include "settingsstore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QDebug>
+
+namespace {
+
+const int SaveDelayMs = 500;
+const char *VersionKey = "version";
+
+} // namespace
+
+SettingsStore::SettingsStore(const QString &path, QObject *parent)
+    : QObject(parent), path(path)
+{
+    saveTimer = new QTimer(this);
+    saveTimer->setSingleShot(true);
+    saveTimer->setInterval(SaveDelayMs);
+    connect(saveTimer, &QTimer::timeout, this, &SettingsStore::flush);
+
+    load();
+}
+
+SettingsStore::~SettingsStore() {
+    if (saveTimer->isActive()) flush();
+}
+
+void SettingsStore::load() {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (!doc.isObject()) {
+        qWarning() << "Settings: ignoring unreadable" << path << error.errorString();
+        return;
+    }
+
+    values = doc.object();
+    currentVersion = quint64(values.take(VersionKey).toDouble());
+}
+
+void SettingsStore::setValue(const QString &key, const QJsonValue &value) {
+    QJsonObject changes;
+    changes[key] = value;
+    setValues(changes);
+}
+
+void SettingsStore::setValues(const QJsonObject &changes) {
+    QStringList keys;
+    for (auto it = changes.begin(); it != changes.end(); ++it) {
+        if (it.key() == VersionKey || values.value(it.key()) == it.value()) continue;
+        values[it.key()] = it.value();
+        keys.append(it.key());
+    }
+    if (keys.isEmpty()) return;
+
+    ++currentVersion;
+    saveTimer->start();
+    emit changed(keys, currentVersion);
+}
+
+bool SettingsStore::flush() {
+    saveTimer->stop();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QJsonObject document = values;
+    document[VersionKey] = double(currentVersion);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Settings: cannot write" << path << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(document).toJson());
+    if (!file.commit()) {
+        qWarning() << "Settings: commit failed for" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
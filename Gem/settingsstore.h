@@ -0,0 +1,42 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QStringList>
+#include <QTimer>
+
+// Owns the canonical settings object (config/settings.json). Every change
+// bumps a version number and emits changed(); writes are coalesced and go
+// through QSaveFile, so a burst of edits costs one atomic write and other
+// keys are never lost. Pending changes are flushed on destruction.
+class SettingsStore : public QObject {
+    Q_OBJECT
+public:
+    explicit SettingsStore(const QString &path, QObject *parent = nullptr);
+    ~SettingsStore();
+
+    QJsonValue value(const QString &key) const { return values.value(key); }
+    QJsonObject snapshot() const { return values; }
+    quint64 version() const { return currentVersion; }
+
+    void setValue(const QString &key, const QJsonValue &value);
+    // Several keys as one change (one version bump, one event)
+    void setValues(const QJsonObject &changes);
+
+    bool flush();
+
+signals:
+    void changed(const QStringList &keys, quint64 version);
+
+private:
+    QString path;
+    QJsonObject values;
+    quint64 currentVersion = 0;
+    QTimer *saveTimer;
+
+    void load();
+};
+
+#endif // SETTINGSSTORE_H
@@ -1,60 +1,47 @@
 #include "suggestionpopup.h"
-#include <QPropertyAnimation>
 #include <QEasingCurve>
 #include <QScreen>
 #include <QGuiApplication>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QLabel>
-#include <QPushButton>
-#include <QTimer>
-#include <QFrame>
 
-QList<SuggestionPopup*> SuggestionPopup::activePopups;
+namespace {
 
-SuggestionPopup::SuggestionPopup(const QString &message, QWidget *parent)
+// Dark theme, shared by every pooled card and parsed once per card
+const QString PopupStyle =
+    "SuggestionPopup, QLabel { background-color: #2e2e2e; border: 1px solid #444; border-radius: 10px; padding: 10px; }"
+    "QLabel#message { color: #f0f0f0; font-size: 14px; }"
+    "QPushButton { background-color: #444; color: #f0f0f0; border: none; border-radius: 6px;"
+    " padding: 6px 12px; font-size: 13px; }"
+    "QPushButton:hover { background-color: #555; }";
+
+} // namespace
+
+SuggestionPopup::SuggestionPopup(QWidget *parent)
     : QWidget(parent, Qt::FramelessWindowHint | Qt::Tool | Qt::WindowStaysOnTopHint)
 {
     setAttribute(Qt::WA_TranslucentBackground);
-
-    // Dark theme styling
-    setStyleSheet("background-color: #2e2e2e; border: 1px solid #444; border-radius: 10px; padding: 10px;");
+    setAttribute(Qt::WA_StyledBackground);
+    setStyleSheet(PopupStyle);
 
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(15, 15, 10, 10);
     layout->setSpacing(10);
 
     // Countdown progress bar (shrinking blue line)
-    QFrame *progressBar = new QFrame(this);
-    progressBar->setFixedHeight(4);
-    progressBar->setStyleSheet("background-color: #007bff; border-radius: 2px;");
+    progressBar = new CountdownBar(QColor("#007bff"), this);
     layout->addWidget(progressBar);
 
     // Message label
-    QLabel *label = new QLabel(message, this);
+    label = new QLabel(this);
+    label->setObjectName("message");
     label->setWordWrap(true);
     label->setMaximumWidth(300);
-    label->setStyleSheet("color: #f0f0f0; font-size: 14px;");
     layout->addWidget(label);
 
     // Buttons
-    QPushButton *acceptBtn = new QPushButton("Accept", this);
-    QPushButton *rejectBtn = new QPushButton("Reject", this);
-
-    QString btnStyle = "QPushButton {"
-                       "background-color: #444;"
-                       "color: #f0f0f0;"
-                       "border: none;"
-                       "border-radius: 6px;"
-                       "padding: 6px 12px;"
-                       "font-size: 13px;"
-                       "}"
-                       "QPushButton:hover {"
-                       "background-color: #555;"
-                       "}";
-
-    acceptBtn->setStyleSheet(btnStyle);
-    rejectBtn->setStyleSheet(btnStyle);
+    acceptBtn = new QPushButton("Accept", this);
+    rejectBtn = new QPushButton("Reject", this);
     acceptBtn->setFixedWidth(100);
     rejectBtn->setFixedWidth(100);
 
@@ -68,70 +55,73 @@ SuggestionPopup::SuggestionPopup(const QString &message, QWidget *parent)
     connect(acceptBtn, &QPushButton::clicked, this, &SuggestionPopup::onAccept);
     connect(rejectBtn, &QPushButton::clicked, this, &SuggestionPopup::onReject);
 
-    adjustSize();
+    slideAnim = new ClockAnimation(this);
+    slideAnim->setDuration(400);
+    slideAnim->setEasingCurve(QEasingCurve::OutCubic);
+    connect(slideAnim, &ClockAnimation::stepped, this, [=](qreal progress) {
+        move(slideFrom + (slideTo - slideFrom) * progress);
+    });
+
+    // Countdown doubles as the auto-dismiss timer
+    countdown = new ClockAnimation(this);
+    countdown->setEasingCurve(QEasingCurve::Linear);
+    connect(countdown, &ClockAnimation::stepped, this, [=](qreal progress) {
+        progressBar->setRemaining(1 - progress);
+    });
+    connect(countdown, &ClockAnimation::finished, this, &SuggestionPopup::onTimeout);
+}
 
-    // Position
-    QScreen *screen = QGuiApplication::primaryScreen();
-    QRect screenGeometry = screen->availableGeometry();
-    int finalX = screenGeometry.right() - width() - 20;
-    int finalY = screenGeometry.bottom() - height() - 20;
-    int startX = screenGeometry.right() + 10;
-    int startY = finalY;
+void SuggestionPopup::present(const QString &message, int timeoutMs, const QPoint &target,
+                              const QString &acceptText, const QString &rejectText) {
+    presenting = true;
+    label->setText(message);
+    acceptBtn->setText(acceptText);
+    rejectBtn->setText(rejectText);
+    progressBar->setRemaining(1);
+    adjustSize();
 
-    activePopups.prepend(this);  // add to stack
-    repositionStack();
+    // Slide in from the right edge of the screen
+    const QRect screenGeometry = QGuiApplication::primaryScreen()->availableGeometry();
+    slideFrom = QPoint(screenGeometry.right() + 10, target.y());
+    slideTo = target;
+    move(slideFrom);
     show();
 
-    // Slide-in animation
-    QPropertyAnimation *slideAnim = new QPropertyAnimation(this, "pos");
-    slideAnim->setDuration(400);
-    slideAnim->setStartValue(QPoint(startX, startY));
-    slideAnim->setEndValue(QPoint(finalX, finalY));
-    slideAnim->setEasingCurve(QEasingCurve::OutCubic);
-    slideAnim->start(QAbstractAnimation::DeleteWhenStopped);
-
-    // Shrinking progress bar animation
-    QPropertyAnimation *barAnim = new QPropertyAnimation(progressBar, "maximumWidth");
-    barAnim->setDuration(15000); // 15 seconds
-    barAnim->setStartValue(progressBar->width());
-    barAnim->setEndValue(0);
-    barAnim->setEasingCurve(QEasingCurve::Linear);
-    barAnim->start(QAbstractAnimation::DeleteWhenStopped);
-
-    // Auto-dismiss timer
-    dismissTimer = new QTimer(this);
-    dismissTimer->setSingleShot(true);
-    dismissTimer->setInterval(15000);
-    connect(dismissTimer, &QTimer::timeout, this, &SuggestionPopup::onReject);
-    dismissTimer->start();
+    slideAnim->start();
+
+    countdown->setDuration(timeoutMs);
+    countdown->start();
+}
+
+void SuggestionPopup::moveTo(const QPoint &target) {
+    if (slideAnim->isRunning()) {
+        slideTo = target;
+    } else if (pos() != target) {
+        move(target);
+    }
+}
+
+void SuggestionPopup::finish() {
+    slideAnim->stop();
+    countdown->stop();
+    presenting = false;
+    hide();
 }
 
 void SuggestionPopup::onAccept() {
-    if (dismissTimer) dismissTimer->stop();
-    activePopups.removeOne(this);
+    if (!presenting) return;
+    finish();
     emit accepted();
-    close();
 }
 
 void SuggestionPopup::onReject() {
-    if (dismissTimer) dismissTimer->stop();
-    activePopups.removeOne(this);
+    if (!presenting) return;
+    finish();
     emit rejected();
-    close();
 }
 
-void SuggestionPopup::repositionStack() {
-    QScreen *screen = QGuiApplication::primaryScreen();
-    QRect screenGeometry = screen->availableGeometry();
-    int baseX = screenGeometry.right() - width() - 20;
-    int baseY = screenGeometry.bottom() - height() - 20;
-
-    const int spacing = 12;
-    for (int i = 0; i < activePopups.size(); ++i) {
-        SuggestionPopup *popup = activePopups[i];
-        if (popup) {
-            int yOffset = baseY - i * (popup->height() + spacing);
-            popup->move(baseX, yOffset);
-        }
-    }
+void SuggestionPopup::onTimeout() {
+    if (!presenting) return;
+    finish();
+    emit timedOut();
 }
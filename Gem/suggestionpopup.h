@@ -4,27 +4,45 @@
 #include <QWidget>
 #include <QPushButton>
 #include <QLabel>
-#include <QVBoxLayout>
-#include <QTimer>
 #include <QString>
+#include "frameclock.h"
+#include "countdownbar.h"
 
+// One notification card. Built once and reused by NotificationManager:
+// present() fills in the text and restarts the countdown, and the card
+// hides itself (rather than closing) when answered or timed out.
 class SuggestionPopup : public QWidget {
     Q_OBJECT
-private:
-    static QList<SuggestionPopup*> activePopups;
-    QTimer *dismissTimer;
-    void repositionStack();
-
 public:
-    SuggestionPopup(const QString &message, QWidget *parent = nullptr);
+    explicit SuggestionPopup(QWidget *parent = nullptr);
+
+    void present(const QString &message, int timeoutMs, const QPoint &target,
+                 const QString &acceptText = "Accept", const QString &rejectText = "Reject");
+    void moveTo(const QPoint &target);
+    bool isPresenting() const { return presenting; }
 
 signals:
     void accepted();
     void rejected();
+    void timedOut();
 
 private slots:
     void onAccept();
     void onReject();
+    void onTimeout();
+
+private:
+    CountdownBar *progressBar;
+    QLabel *label;
+    QPushButton *acceptBtn;
+    QPushButton *rejectBtn;
+    ClockAnimation *slideAnim;
+    ClockAnimation *countdown;   // runs out into onTimeout()
+    QPoint slideFrom;
+    QPoint slideTo;
+    bool presenting = false;
+
+    void finish();
 };
 
 #endif // SUGGESTIONPOPUP_H
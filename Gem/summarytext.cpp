@@ -6,11 +6,17 @@
 #include <QDir>
 #include <QScreen>
 #include <QGuiApplication>
-#include <QProgressBar>
-
-SummaryText::SummaryText(QWidget *parent) : QWidget(parent) {
+#include <QJsonObject>
+#include <QClipboard>
+#include <QScrollBar>
+#include <QTextCursor>
+#include "configpath.h"
+
+SummaryText::SummaryText(IpcServer *ipc, const QString &runId, QWidget *parent)
+    : QWidget(parent), ipcServer(ipc), runId(runId) {
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Dialog);
     setFixedSize(420, 240);
+    setAttribute(Qt::WA_DeleteOnClose);
 
     // styling
     setStyleSheet(R"(
@@ -30,6 +36,11 @@ SummaryText::SummaryText(QWidget *parent) : QWidget(parent) {
     inputField->setStyleSheet("color: white; background-color: #2e2e2e; border: 1px solid #555;");
     layout->addWidget(inputField);
 
+    statsLabel = new QLabel(this);
+    statsLabel->setStyleSheet("color: #aaa; border: none; font-size: 11px;");
+    statsLabel->hide();
+    layout->addWidget(statsLabel);
+
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     okButton = new QPushButton("OK", this);
     noButton = new QPushButton("No", this);
@@ -42,42 +53,28 @@ SummaryText::SummaryText(QWidget *parent) : QWidget(parent) {
     layout->addLayout(buttonLayout);
 
     // Timer bar
-    progressBar = new QProgressBar(this);
-    progressBar->setTextVisible(false);
-    progressBar->setRange(0, 100);
-    progressBar->setValue(100);
-    progressBar->setStyleSheet(R"(
-        QProgressBar {
-            background-color: transparent;
-            border: none;
-            height: 4px;
-        }
-        QProgressBar::chunk {
-            background-color: #007acc;
-        }
-    )");
+    progressBar = new CountdownBar(QColor("#007acc"), this);
     layout->addWidget(progressBar);
 
     // Connect buttons
     connect(okButton, &QPushButton::clicked, this, &SummaryText::onOkClicked);
     connect(noButton, &QPushButton::clicked, this, &SummaryText::onNoClicked);
 
-    // Setup countdown bar + auto timeout
-    autoCloseTimer = new QTimer(this);
-    autoCloseTimer->setSingleShot(true);
-    connect(autoCloseTimer, &QTimer::timeout, this, &SummaryText::onTimeout);
-    autoCloseTimer->start(10000);  // 10 seconds
-
-    // Animate the progress bar
-    QTimer *progressTimer = new QTimer(this);
-    int duration = 10000;
-    int interval = 100;
-    connect(progressTimer, &QTimer::timeout, this, [=]() mutable {
-        int elapsed = duration - autoCloseTimer->remainingTime();
-        int value = qMax(0, 100 - (elapsed * 100 / duration));
-        progressBar->setValue(value);
+    animation = new ClockAnimation(this);
+    animation->setDuration(300);
+    connect(animation, &ClockAnimation::stepped, this, [=](qreal progress) {
+        move(slideFrom + (slideTo - slideFrom) * progress);
+    });
+
+    // Countdown bar + auto timeout (10 seconds)
+    countdown = new ClockAnimation(this);
+    countdown->setDuration(10000);
+    countdown->setEasingCurve(QEasingCurve::Linear);
+    connect(countdown, &ClockAnimation::stepped, this, [=](qreal progress) {
+        progressBar->setRemaining(1 - progress);
     });
-    progressTimer->start(interval);
+    connect(countdown, &ClockAnimation::finished, this, &SummaryText::onTimeout);
+    countdown->start();
 }
 
 void SummaryText::slideIn() {
@@ -86,40 +83,140 @@ void SummaryText::slideIn() {
     int endX = screenRect.left() + 20;
     int y = screenRect.bottom() - height() - 50;
 
-    move(startX, y);
+    slideFrom = QPoint(startX, y);
+    slideTo = QPoint(endX, y);
+    move(slideFrom);
     show();
     raise();
     activateWindow();
 
-    animation = new QPropertyAnimation(this, "pos");
-    animation->setDuration(300);
-    animation->setStartValue(QPoint(startX, y));
-    animation->setEndValue(QPoint(endX, y));
     animation->start();
 }
 
+// Nothing of ours keeps ticking once the panel is gone
+void SummaryText::dismiss() {
+    animation->stop();
+    countdown->stop();
+    close();
+}
+
 void SummaryText::onOkClicked() {
-    if (autoCloseTimer) autoCloseTimer->stop();
+    if (stage != Stage::Input) {
+        QGuiApplication::clipboard()->setText(inputField->toPlainText());
+        return;
+    }
     writeManualSummaryResponse(true, inputField->toPlainText());
-    close();
     emit userAccepted();
+    beginResult("Summarising your text…");
 }
 
 void SummaryText::onNoClicked() {
-    if (autoCloseTimer) autoCloseTimer->stop();
+    if (stage == Stage::Streaming) {
+        if (ipcServer) ipcServer->send("summary_cancel", QJsonObject{{"id", runId}});
+        noButton->setText("Cancelling…");
+        noButton->setEnabled(false);
+        return;
+    }
+    if (stage == Stage::Done) {
+        dismiss();
+        return;
+    }
     writeManualSummaryResponse(false);
-    close();
     emit userRejected();
+    beginResult("Summarising what's on screen…");
 }
 
 void SummaryText::onTimeout() {
+    if (stage != Stage::Input) return;
     writeManualSummaryResponse(false);
-    close();
     emit userRejected();
+    beginResult("Summarising what's on screen…");
+}
+
+// The input panel turns into the result view. Without the socket the backend
+// can only put the summary on the clipboard, so there is nothing to show.
+void SummaryText::beginResult(const QString &waitingText) {
+    countdown->stop();
+    if (!ipcServer || !ipcServer->isConnected()) {
+        dismiss();
+        return;
+    }
+
+    stage = Stage::Streaming;
+    progressBar->hide();
+    label->setText("📝 Summary");
+    inputField->clear();
+    inputField->setReadOnly(true);
+    inputField->setPlaceholderText(waitingText);
+    okButton->setText("Copy");
+    okButton->setEnabled(false);
+    noButton->setText("Cancel");
+    statsLabel->setText("Waiting for first token…");
+    statsLabel->show();
+    gotFirstChunk = false;
+    streamClock.start();
+}
+
+// Long documents are summarised part by part before anything streams
+void SummaryText::showProgress(int done, int total) {
+    if (stage != Stage::Streaming || gotFirstChunk) return;
+    statsLabel->setText(done < total ? QString("Summarising part %1 of %2…").arg(done + 1).arg(total)
+                                     : QString("Combining %1 parts…").arg(total));
+}
+
+void SummaryText::appendSummary(const QString &delta) {
+    if (stage != Stage::Streaming || delta.isEmpty()) return;
+
+    if (!gotFirstChunk) {
+        gotFirstChunk = true;
+        statsLabel->setText(QString("First token after %1 ms…").arg(streamClock.elapsed()));
+        okButton->setEnabled(true);
+    }
+
+    // Follow the end only if the reader has not scrolled up
+    QScrollBar *bar = inputField->verticalScrollBar();
+    const bool atEnd = bar->value() >= bar->maximum() - 4;
+    QTextCursor cursor(inputField->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(delta);
+    if (atEnd) bar->setValue(bar->maximum());
+}
+
+void SummaryText::finishSummary(const QJsonObject &done) {
+    if (stage != Stage::Streaming) return;
+    stage = Stage::Done;
+    countdown->stop();
+
+    QStringList parts;
+    if (done["cancelled"].toBool()) parts << "Cancelled";
+    else if (done.contains("error")) parts << "Failed: " + done["error"].toString();
+    else if (done["ok"].toBool()) parts << "Copied to clipboard";
+
+    if (done["ttftMs"].isDouble())
+        parts << QString("first token %1 ms").arg(done["ttftMs"].toInt());
+    if (done["tokensPerSec"].isDouble())
+        parts << QString("%1 tok/s").arg(done["tokensPerSec"].toDouble(), 0, 'f', 1);
+    if (done["tokens"].toInt() > 0)
+        parts << QString("%1 tokens").arg(done["tokens"].toInt());
+    if (done["chunks"].toInt() > 1)
+        parts << QString("%1 parts, %2 cached").arg(done["chunks"].toInt()).arg(done["cachedChunks"].toInt());
+
+    statsLabel->setText(parts.join(" · "));
+    statsLabel->show();
+    okButton->setEnabled(!inputField->toPlainText().isEmpty());
+    noButton->setText("Close");
+    noButton->setEnabled(true);
 }
 
 void SummaryText::writeManualSummaryResponse(bool accepted, const QString &text) {
-    QString path = QDir(QCoreApplication::applicationDirPath()).filePath("config/manual_summary.json");
+    QJsonObject response;
+    response["manual"] = accepted;
+    response["id"] = runId;
+    if (accepted) response["text"] = text;
+    if (ipcServer && ipcServer->send("manual_summary", response)) return;
+
+    // Fallback: backend is not connected to the socket
+    QString path = gemConfigPath("manual_summary.json");
     QFile file(path);
     if (file.open(QIODevice::WriteOnly)) {
         QTextStream out(&file);
@@ -5,17 +5,26 @@
 #include <QTextEdit>
 #include <QPushButton>
 #include <QLabel>
-#include <QTimer>
-#include <QPropertyAnimation>
-#include <QProgressBar>
-
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "ipcserver.h"
+#include "frameclock.h"
+#include "countdownbar.h"
+
+// Asks for the text to summarise, then shows the summary as the backend
+// streams it in (summary_chunk / summary_done), with a cancel button while
+// it runs and the time to first token and tokens/sec once it ends.
 class SummaryText : public QWidget {
     Q_OBJECT
 
 public:
-    explicit SummaryText(QWidget *parent = nullptr);
+    SummaryText(IpcServer *ipc, const QString &runId, QWidget *parent = nullptr);
     void slideIn();
 
+    void showProgress(int done, int total);
+    void appendSummary(const QString &delta);
+    void finishSummary(const QJsonObject &done);
+
 signals:
     void userAccepted();
     void userRejected();
@@ -26,14 +35,26 @@ private slots:
     void onTimeout();
 
 private:
+    enum class Stage { Input, Streaming, Done };
+
     QLabel *label;
+    QLabel *statsLabel;
     QTextEdit *inputField;
     QPushButton *okButton;
     QPushButton *noButton;
-    QPropertyAnimation *animation;
-    QTimer *autoCloseTimer = nullptr;
-    QProgressBar *progressBar;
-
+    ClockAnimation *animation;
+    ClockAnimation *countdown;   // runs out into onTimeout()
+    CountdownBar *progressBar;
+    IpcServer *ipcServer;
+    QString runId;
+    Stage stage = Stage::Input;
+    QElapsedTimer streamClock;   // local time to first chunk, until the backend reports
+    bool gotFirstChunk = false;
+    QPoint slideFrom;
+    QPoint slideTo;
+
+    void dismiss();
+    void beginResult(const QString &waitingText);
     void writeManualSummaryResponse(bool accepted, const QString &text = "");
 };
 
@@ -0,0 +1,255 @@
+#include "threadfeed.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+namespace {
+
+// Per signal, so a first load of a long history reaches the view in pieces
+const int BatchThreads = 128;
+const int BatchEvents = 2000;
+const int MaxEventText = 4000;
+
+// QJsonDocument only takes objects and arrays at the top level
+QJsonValue parseValue(const std::string &json) {
+    QByteArray wrapped;
+    wrapped.reserve(int(json.size()) + 2);
+    wrapped.append('[').append(json.data(), qsizetype(json.size())).append(']');
+    const QJsonDocument doc = QJsonDocument::fromJson(wrapped);
+    return doc.isArray() && !doc.array().isEmpty() ? doc.array().first() : QJsonValue(QString::fromStdString(json));
+}
+
+std::string jsonText(const QJsonValue &value) {
+    const QByteArray wrapped = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+    return wrapped.mid(1, wrapped.size() - 2).toStdString();
+}
+
+qint64 timestampOf(const QJsonValue &value) {
+    if (value.isDouble()) return qint64(value.toDouble());
+    QDateTime at = QDateTime::fromString(value.toString(), Qt::ISODateWithMs);
+    if (!at.isValid()) at = QDateTime::fromString(value.toString(), Qt::ISODate);
+    return at.isValid() ? at.toMSecsSinceEpoch() : 0;
+}
+
+// Topics are a string or the LLM's { topic, ... } object
+QString topicText(const std::string &json) {
+    const QJsonValue topic = parseValue(json);
+    if (topic.isString()) return topic.toString();
+    if (topic.isObject() && topic.toObject()["topic"].isString()) return topic.toObject()["topic"].toString();
+    return QString::fromStdString(json);
+}
+
+ThreadEvent parseEvent(const std::string &json) {
+    const QJsonValue value = parseValue(json);
+    ThreadEvent event;
+    if (!value.isObject()) {
+        event.text = value.isString() ? value.toString() : QString::fromStdString(json);
+    } else {
+        const QJsonObject object = value.toObject();
+        event.timestamp = timestampOf(object["timestamp"]);
+        event.app = object["app_name"].toString();
+        event.window = object["window_name"].toString();
+        event.url = object["browser_url"].toString();
+        event.text = object["text"].toString();
+    }
+    if (event.text.size() > MaxEventText) event.text = event.text.left(MaxEventText) + "…";
+    return event;
+}
+
+} // namespace
+
+ThreadFeed::ThreadFeed(const QString &storeDir, const QString &jsonPath, QObject *parent)
+    : QObject(parent), storeDir(QDir::cleanPath(storeDir)), jsonPath(QDir::cleanPath(jsonPath))
+{
+    qRegisterMetaType<ThreadDelta>();
+    qRegisterMetaType<QVector<ThreadDelta>>();
+
+    watcher = new QFileSystemWatcher(this);
+    auto onChange = [this]() {
+        watch(); // segments come and go, snapshot.bin and threads.json are replaced
+        emit changed();
+    };
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, onChange);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, onChange);
+
+    thread = new QThread(this);
+    worker = new QObject();
+    worker->moveToThread(thread);
+    thread->start(QThread::LowPriority);
+}
+
+ThreadFeed::~ThreadFeed() {
+    thread->quit();
+    thread->wait();
+    delete worker;
+}
+
+void ThreadFeed::refresh() {
+    if (!refreshQueued.testAndSetOrdered(0, 1)) return; // one pass covers every pending change
+    QMetaObject::invokeMethod(worker, [this]() { readPending(); }, Qt::QueuedConnection);
+}
+
+void ThreadFeed::setWatching(bool enabled) {
+    if (watching == enabled) return;
+    watching = enabled;
+
+    if (!watching) {
+        if (!watcher->files().isEmpty()) watcher->removePaths(watcher->files());
+        if (!watcher->directories().isEmpty()) watcher->removePaths(watcher->directories());
+        return;
+    }
+    watch();
+}
+
+void ThreadFeed::watch() {
+    if (!watching) return;
+
+    // The config directory catches the store or threads.json appearing;
+    // segment files are watched one by one since appends don't touch the
+    // directory
+    QStringList directories{QFileInfo(storeDir).absolutePath()};
+    QStringList files;
+    if (QFileInfo::exists(storeDir)) {
+        directories.append(storeDir);
+        const QDir dir(storeDir);
+        for (const QString &name : dir.entryList(QDir::Files)) files.append(dir.filePath(name));
+    }
+    if (QFileInfo::exists(jsonPath)) files.append(jsonPath);
+
+    for (const QString &path : directories) {
+        if (QFileInfo::exists(path) && !watcher->directories().contains(path)) watcher->addPath(path);
+    }
+    QStringList stale;
+    for (const QString &path : watcher->files()) {
+        if (!files.contains(path)) stale.append(path);
+    }
+    if (!stale.isEmpty()) watcher->removePaths(stale);
+    for (const QString &path : files) {
+        if (!watcher->files().contains(path)) watcher->addPath(path);
+    }
+}
+
+void ThreadFeed::readPending() {
+    refreshQueued.storeRelease(0);
+
+    bool changed = false;
+    if (readStore(changed)) {
+        if (changed) publish(store.threads());
+        return;
+    }
+
+    std::unordered_map<std::string, StoredThread> threads;
+    if (readJson(threads)) publish(threads);
+}
+
+bool ThreadFeed::readStore(bool &changed) {
+    if (!storeOpen) {
+        if (!QFileInfo::exists(storeDir)) return false;
+        storeOpen = store.open(storeDir.toStdString(), true);
+        changed = storeOpen;
+        return storeOpen;
+    }
+
+    // Reopens from the new snapshot by itself after the writer compacts
+    changed = store.refresh();
+    if (!store.lastError().empty() && !QFileInfo::exists(storeDir)) {
+        store.close();
+        storeOpen = false;
+        return false;
+    }
+    return true;
+}
+
+bool ThreadFeed::readJson(std::unordered_map<std::string, StoredThread> &threads) {
+    const QFileInfo info(jsonPath);
+    if (!info.exists()) {
+        if (jsonSize < 0) return false;
+        jsonSize = -1; // gone: report every thread removed
+        return true;
+    }
+    if (info.size() == jsonSize && info.lastModified() == jsonModified) return false;
+
+    QFile file(jsonPath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject()) return false; // caught mid-write; the next change brings the rest
+    jsonSize = info.size();
+    jsonModified = info.lastModified();
+
+    const QJsonObject object = doc.object();
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        const QJsonObject stored = it.value().toObject();
+        StoredThread &thread = threads[it.key().toStdString()];
+        thread.key = it.key().toStdString();
+        thread.topic = jsonText(stored["topic"]);
+        thread.created = qint64(stored["created"].toDouble());
+        thread.lastUpdated = qint64(stored["last_updated"].toDouble());
+        thread.finalized = stored["finalized"].toBool();
+        for (const QJsonValue &event : stored["events"].toArray()) thread.events.push_back(jsonText(event));
+    }
+    return true;
+}
+
+void ThreadFeed::publish(const std::unordered_map<std::string, StoredThread> &threads) {
+    // Gone, or shorter than what was reported (removed and started again)
+    QStringList removed;
+    for (auto it = published.begin(); it != published.end();) {
+        auto stored = threads.find(it.key().toStdString());
+        if (stored == threads.end() || int(stored->second.events.size()) < it->events) {
+            removed.append(it.key());
+            it = published.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!removed.isEmpty()) emit threadsRemoved(removed);
+
+    std::vector<const StoredThread*> changedThreads;
+    for (const auto &entry : threads) {
+        const StoredThread &stored = entry.second;
+        auto it = published.constFind(QString::fromStdString(stored.key));
+        if (it != published.constEnd() && it->events == int(stored.events.size())
+            && it->lastUpdated == stored.lastUpdated && it->finalized == stored.finalized)
+            continue;
+        changedThreads.push_back(&stored);
+    }
+    // New threads land in the order they were started
+    std::sort(changedThreads.begin(), changedThreads.end(), [](const StoredThread *a, const StoredThread *b) {
+        return a->created != b->created ? a->created < b->created : a->key < b->key;
+    });
+
+    QVector<ThreadDelta> batch;
+    int batchEvents = 0;
+    for (const StoredThread *stored : changedThreads) {
+        const QString key = QString::fromStdString(stored->key);
+        Published &seen = published[key];
+
+        ThreadDelta delta;
+        delta.key = key;
+        delta.topic = topicText(stored->topic);
+        delta.created = stored->created;
+        delta.lastUpdated = stored->lastUpdated;
+        delta.finalized = stored->finalized;
+        delta.firstEvent = seen.events;
+        delta.events.reserve(int(stored->events.size()) - seen.events);
+        for (size_t i = size_t(seen.events); i < stored->events.size(); ++i)
+            delta.events.append(parseEvent(stored->events[i]));
+
+        seen.events = int(stored->events.size());
+        seen.lastUpdated = stored->lastUpdated;
+        seen.finalized = stored->finalized;
+
+        batchEvents += delta.events.size();
+        batch.append(std::move(delta));
+        if (batch.size() >= BatchThreads || batchEvents >= BatchEvents) {
+            emit threadsUpdated(batch);
+            batch.clear();
+            batchEvents = 0;
+        }
+    }
+    if (!batch.isEmpty()) emit threadsUpdated(batch);
+}
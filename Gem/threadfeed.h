@@ -0,0 +1,86 @@
+#ifndef THREADFEED_H
+#define THREADFEED_H
+
+#include <QObject>
+#include <QThread>
+#include <QFileSystemWatcher>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QAtomicInt>
+#include "threadstore.h"
+
+struct ThreadEvent {
+    qint64 timestamp = 0; // ms since epoch, 0 if the event had none
+    QString app;
+    QString window;
+    QString url;
+    QString text;
+};
+
+// What changed in one thread since the last update: its current fields and
+// the events from firstEvent on (all of them for a thread seen first)
+struct ThreadDelta {
+    QString key;
+    QString topic;
+    qint64 created = 0;
+    qint64 lastUpdated = 0;
+    bool finalized = false;
+    int firstEvent = 0;
+    QVector<ThreadEvent> events;
+};
+
+Q_DECLARE_METATYPE(ThreadDelta)
+
+// Follows the backend's topic threads from a worker thread. The native
+// thread store (config/threads) is opened read-only and each refresh
+// applies only the records appended since the last one; without it,
+// threads.json is re-read when it changes. Either way only threads that
+// changed are reported, with just their new events, in batches small
+// enough for the view to take in as they arrive.
+class ThreadFeed : public QObject {
+    Q_OBJECT
+public:
+    ThreadFeed(const QString &storeDir, const QString &jsonPath, QObject *parent = nullptr);
+    ~ThreadFeed();
+
+    void refresh(); // report whatever changed since the last pass
+
+    // File watches; changed() fires when the store or threads.json moves
+    void setWatching(bool watching);
+
+signals:
+    void changed();
+    void threadsUpdated(const QVector<ThreadDelta> &deltas);
+    void threadsRemoved(const QStringList &keys);
+
+private:
+    QString storeDir;
+    QString jsonPath;
+    QThread *thread;
+    QObject *worker;
+    QFileSystemWatcher *watcher;
+    bool watching = false;
+    QAtomicInt refreshQueued;
+
+    // Worker-thread only
+    struct Published {
+        int events = 0;
+        qint64 lastUpdated = 0;
+        bool finalized = false;
+    };
+    ThreadStore store;
+    bool storeOpen = false;
+    QDateTime jsonModified;
+    qint64 jsonSize = -1;
+    QHash<QString, Published> published;
+
+    void watch();
+    void readPending();
+    bool readStore(bool &changed);
+    bool readJson(std::unordered_map<std::string, StoredThread> &threads);
+    void publish(const std::unordered_map<std::string, StoredThread> &threads);
+};
+
+#endif // THREADFEED_H
@@ -0,0 +1,232 @@
+#include "threadmodel.h"
+#include <QColor>
+#include <QDateTime>
+#include <QUrl>
+
+namespace {
+
+const int PreviewLength = 160;
+
+} // namespace
+
+ThreadModel::ThreadModel(ThreadFeed *feed, QObject *parent)
+    : QAbstractItemModel(parent)
+{
+    connect(feed, &ThreadFeed::threadsUpdated, this, &ThreadModel::onThreadsUpdated);
+    connect(feed, &ThreadFeed::threadsRemoved, this, &ThreadModel::onThreadsRemoved);
+}
+
+QModelIndex ThreadModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < 0 || column < 0 || column >= ColumnCount) return QModelIndex();
+
+    if (!parent.isValid()) {
+        if (row >= int(threads.size())) return QModelIndex();
+        return createIndex(row, column, nullptr);
+    }
+
+    // Events hang off a thread row; nothing hangs off an event
+    if (parent.internalPointer() || parent.row() >= int(threads.size())) return QModelIndex();
+    Thread *thread = threads[size_t(parent.row())].get();
+    if (row >= thread->events.size()) return QModelIndex();
+    return createIndex(row, column, thread);
+}
+
+QModelIndex ThreadModel::parent(const QModelIndex &child) const {
+    if (!child.isValid() || !child.internalPointer()) return QModelIndex();
+    const Thread *thread = static_cast<const Thread*>(child.internalPointer());
+    return createIndex(thread->row, 0, nullptr);
+}
+
+int ThreadModel::rowCount(const QModelIndex &parent) const {
+    if (!parent.isValid()) return int(threads.size());
+    if (parent.internalPointer() || parent.column() != 0 || parent.row() >= int(threads.size())) return 0;
+    return threads[size_t(parent.row())]->events.size();
+}
+
+int ThreadModel::columnCount(const QModelIndex &) const {
+    return ColumnCount;
+}
+
+QVariant ThreadModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    switch (section) {
+    case TopicColumn: return "Topic";
+    case EventsColumn: return "Events";
+    case StatusColumn: return "Status";
+    case UpdatedColumn: return "Updated";
+    default: return QVariant();
+    }
+}
+
+QVariant ThreadModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    if (const Thread *thread = static_cast<const Thread*>(index.internalPointer()))
+        return eventData(*thread, index.row(), index.column(), role);
+    if (index.row() >= int(threads.size())) return QVariant();
+    return threadData(*threads[size_t(index.row())], index.column(), role);
+}
+
+QVariant ThreadModel::threadData(const Thread &thread, int column, int role) const {
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (column) {
+        case TopicColumn: return thread.topic;
+        case EventsColumn: return int(thread.events.size());
+        case StatusColumn: return thread.finalized ? "finalized" : "active";
+        case UpdatedColumn: return formatAge(QDateTime::currentMSecsSinceEpoch() - thread.lastUpdated);
+        }
+        break;
+    case SortRole:
+        switch (column) {
+        case TopicColumn: return thread.topic.toLower();
+        case EventsColumn: return int(thread.events.size());
+        case StatusColumn: return thread.finalized;
+        case UpdatedColumn: return thread.lastUpdated;
+        }
+        break;
+    case Qt::TextAlignmentRole:
+        if (column == EventsColumn) return int(Qt::AlignRight | Qt::AlignVCenter);
+        break;
+    case Qt::ForegroundRole:
+        if (thread.finalized) return QColor(Qt::gray);
+        break;
+    case Qt::ToolTipRole:
+        return QString("%1\nStarted %2, last event %3")
+            .arg(thread.key,
+                 QDateTime::fromMSecsSinceEpoch(thread.created).toString("yyyy-MM-dd hh:mm:ss"),
+                 QDateTime::fromMSecsSinceEpoch(thread.lastUpdated).toString("yyyy-MM-dd hh:mm:ss"));
+    case FinalizedRole:
+        return thread.finalized;
+    case KeyRole:
+        return thread.key;
+    }
+    return QVariant();
+}
+
+QVariant ThreadModel::eventData(const Thread &thread, int row, int column, int role) const {
+    if (row < 0 || row >= thread.events.size()) return QVariant();
+    const ThreadEvent &event = thread.events.at(row);
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (column) {
+        case TopicColumn: {
+            QString where = event.app;
+            if (!event.window.isEmpty()) where += (where.isEmpty() ? "" : " — ") + event.window;
+            QString preview = event.text.left(PreviewLength * 2).simplified();
+            if (preview.size() > PreviewLength) preview = preview.left(PreviewLength) + "…";
+            return where.isEmpty() ? preview : where + ": " + preview;
+        }
+        case EventsColumn: return QString("#%1").arg(row + 1);
+        case StatusColumn: return event.url.isEmpty() ? QString() : QUrl(event.url).host();
+        case UpdatedColumn:
+            return event.timestamp ? QDateTime::fromMSecsSinceEpoch(event.timestamp).toString("hh:mm:ss") : QString();
+        }
+        break;
+    case SortRole:
+        return column == UpdatedColumn ? QVariant(event.timestamp) : QVariant(row);
+    case Qt::TextAlignmentRole:
+        if (column == EventsColumn) return int(Qt::AlignRight | Qt::AlignVCenter);
+        break;
+    case Qt::ForegroundRole:
+        if (thread.finalized) return QColor(Qt::gray);
+        break;
+    case Qt::ToolTipRole: {
+        QStringList header;
+        for (const QString &part : {event.app, event.window, event.url}) {
+            if (!part.isEmpty()) header.append(part);
+        }
+        return (header.isEmpty() ? QString() : header.join("\n") + "\n\n") + event.text;
+    }
+    case FinalizedRole:
+        return thread.finalized;
+    case KeyRole:
+        return thread.key;
+    }
+    return QVariant();
+}
+
+QString ThreadModel::formatAge(qint64 ms) {
+    const qint64 seconds = qMax<qint64>(0, ms / 1000);
+    if (seconds < 60) return QString("%1 s ago").arg(seconds);
+    if (seconds < 3600) return QString("%1 min ago").arg(seconds / 60);
+    if (seconds < 86400) return QString("%1 h ago").arg(seconds / 3600);
+    return QString("%1 d ago").arg(seconds / 86400);
+}
+
+void ThreadModel::refreshAges() {
+    if (threads.empty()) return;
+    emit dataChanged(index(0, UpdatedColumn), index(int(threads.size()) - 1, UpdatedColumn), {Qt::DisplayRole});
+}
+
+void ThreadModel::onThreadsUpdated(const QVector<ThreadDelta> &deltas) {
+    QVector<const ThreadDelta*> added;
+
+    for (const ThreadDelta &delta : deltas) {
+        Thread *thread = byKey.value(delta.key);
+        if (!thread) {
+            added.append(&delta);
+            continue;
+        }
+
+        const QModelIndex parent = createIndex(thread->row, 0, nullptr);
+        const int have = thread->events.size();
+        if (delta.firstEvent < have) { // only if the feed restarted; replace the tail
+            beginRemoveRows(parent, delta.firstEvent, have - 1);
+            thread->events.resize(delta.firstEvent);
+            events -= have - delta.firstEvent;
+            endRemoveRows();
+        }
+        if (!delta.events.isEmpty()) {
+            const int first = thread->events.size();
+            beginInsertRows(parent, first, first + delta.events.size() - 1);
+            thread->events += delta.events;
+            events += delta.events.size();
+            endInsertRows();
+        }
+
+        active += int(thread->finalized) - int(delta.finalized);
+        thread->topic = delta.topic;
+        thread->lastUpdated = delta.lastUpdated;
+        thread->finalized = delta.finalized;
+        emit dataChanged(parent, createIndex(thread->row, ColumnCount - 1, nullptr));
+    }
+
+    if (added.isEmpty()) return;
+
+    const int first = int(threads.size());
+    beginInsertRows(QModelIndex(), first, first + added.size() - 1);
+    for (const ThreadDelta *delta : added) {
+        auto thread = std::make_unique<Thread>();
+        thread->key = delta->key;
+        thread->topic = delta->topic;
+        thread->created = delta->created;
+        thread->lastUpdated = delta->lastUpdated;
+        thread->finalized = delta->finalized;
+        thread->events = delta->events;
+        thread->row = int(threads.size());
+
+        active += delta->finalized ? 0 : 1;
+        events += thread->events.size();
+        byKey.insert(thread->key, thread.get());
+        threads.push_back(std::move(thread));
+    }
+    endInsertRows();
+}
+
+void ThreadModel::onThreadsRemoved(const QStringList &keys) {
+    for (const QString &key : keys) {
+        Thread *thread = byKey.value(key);
+        if (!thread) continue;
+
+        const int row = thread->row;
+        beginRemoveRows(QModelIndex(), row, row);
+        active -= thread->finalized ? 0 : 1;
+        events -= thread->events.size();
+        byKey.remove(key);
+        threads.erase(threads.begin() + row);
+        for (size_t i = size_t(row); i < threads.size(); ++i) threads[i]->row = int(i);
+        endRemoveRows();
+    }
+}
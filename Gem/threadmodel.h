@@ -0,0 +1,66 @@
+#ifndef THREADMODEL_H
+#define THREADMODEL_H
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <memory>
+#include <vector>
+#include "threadfeed.h"
+
+// Two-level model over a ThreadFeed: one row per topic thread, its events
+// as children. Updates are applied as row inserts and dataChanged on the
+// rows that moved, never a reset, so views keep their scroll position and
+// expansion; rows are formatted only when a view asks for them.
+class ThreadModel : public QAbstractItemModel {
+    Q_OBJECT
+public:
+    enum Column { TopicColumn, EventsColumn, StatusColumn, UpdatedColumn, ColumnCount };
+    enum Role {
+        SortRole = Qt::UserRole, // numbers and times as such, for sorting
+        FinalizedRole,
+        KeyRole
+    };
+
+    explicit ThreadModel(ThreadFeed *feed, QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    int activeThreads() const { return active; }
+    int eventCount() const { return events; }
+
+    // Ages are relative to now; views call this on a timer
+    void refreshAges();
+
+    static QString formatAge(qint64 ms);
+
+private slots:
+    void onThreadsUpdated(const QVector<ThreadDelta> &deltas);
+    void onThreadsRemoved(const QStringList &keys);
+
+private:
+    struct Thread {
+        QString key;
+        QString topic;
+        qint64 created = 0;
+        qint64 lastUpdated = 0;
+        bool finalized = false;
+        QVector<ThreadEvent> events;
+        int row = 0;
+    };
+
+    // Children point at their thread, which stays put while rows shift
+    std::vector<std::unique_ptr<Thread>> threads;
+    QHash<QString, Thread*> byKey;
+    int active = 0;
+    int events = 0;
+
+    QVariant threadData(const Thread &thread, int column, int role) const;
+    QVariant eventData(const Thread &thread, int row, int column, int role) const;
+};
+
+#endif // THREADMODEL_H
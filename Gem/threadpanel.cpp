@@ -0,0 +1,101 @@
+#include "threadpanel.h"
+#include "scheduler.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+
+void ThreadFilterModel::setTopicFilter(const QString &text) {
+    topicFilter = text.trimmed();
+    invalidateFilter();
+}
+
+void ThreadFilterModel::setShowFinalized(bool show) {
+    showFinalized = show;
+    invalidateFilter();
+}
+
+bool ThreadFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    if (sourceParent.isValid()) return true;
+
+    const QModelIndex index = sourceModel()->index(sourceRow, ThreadModel::TopicColumn);
+    if (!showFinalized && index.data(ThreadModel::FinalizedRole).toBool()) return false;
+    return topicFilter.isEmpty() || index.data().toString().contains(topicFilter, Qt::CaseInsensitive);
+}
+
+ThreadPanel::ThreadPanel(const QString &storeDir, const QString &jsonPath, QWidget *parent)
+    : QWidget(parent)
+{
+    feed = new ThreadFeed(storeDir, jsonPath, this);
+    model = new ThreadModel(feed, this);
+    proxy = new ThreadFilterModel(this);
+    proxy->setSourceModel(model);
+    proxy->setSortRole(ThreadModel::SortRole);
+
+    topicFilter = new QLineEdit(this);
+    topicFilter->setPlaceholderText("Filter topics");
+    topicFilter->setClearButtonEnabled(true);
+    showFinalized = new QCheckBox("Show finalized", this);
+    showFinalized->setChecked(true);
+
+    // Uniform rows let the view lay out only the visible page, however many
+    // events are expanded
+    view = new QTreeView(this);
+    view->setModel(proxy);
+    view->setUniformRowHeights(true);
+    view->setSortingEnabled(true);
+    view->sortByColumn(ThreadModel::UpdatedColumn, Qt::DescendingOrder);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    view->setAlternatingRowColors(true);
+    view->header()->setStretchLastSection(false);
+    view->header()->setSectionResizeMode(ThreadModel::TopicColumn, QHeaderView::Stretch);
+    for (int column = ThreadModel::EventsColumn; column < ThreadModel::ColumnCount; ++column)
+        view->header()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+
+    summaryLabel = new QLabel(this);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout();
+    filterLayout->addWidget(topicFilter, 1);
+    filterLayout->addWidget(showFinalized);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(filterLayout);
+    layout->addWidget(view, 1);
+    layout->addWidget(summaryLabel);
+
+    connect(topicFilter, &QLineEdit::textChanged, proxy, &ThreadFilterModel::setTopicFilter);
+    connect(showFinalized, &QCheckBox::toggled, proxy, &ThreadFilterModel::setShowFinalized);
+    connect(feed, &ThreadFeed::changed, this, &ThreadPanel::notifyChanged);
+    connect(model, &QAbstractItemModel::rowsInserted, this, &ThreadPanel::updateSummary);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &ThreadPanel::updateSummary);
+    connect(model, &QAbstractItemModel::dataChanged, this, &ThreadPanel::updateSummary);
+
+    // Ages tick over while someone is looking
+    Scheduler::instance()->add("thread-ages", 5000, Scheduler::Background, [=]() {
+        model->refreshAges();
+    }, this);
+
+    updateSummary();
+}
+
+void ThreadPanel::notifyChanged() {
+    if (isVisible()) feed->refresh(); // otherwise caught up on the next show
+}
+
+void ThreadPanel::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    feed->setWatching(true);
+    feed->refresh();
+}
+
+void ThreadPanel::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    feed->setWatching(false);
+}
+
+void ThreadPanel::updateSummary() {
+    const int threads = model->rowCount();
+    summaryLabel->setText(QString("%1 threads, %2 active, %3 events")
+                              .arg(threads)
+                              .arg(model->activeThreads())
+                              .arg(model->eventCount()));
+}
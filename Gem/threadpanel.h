@@ -0,0 +1,55 @@
+#ifndef THREADPANEL_H
+#define THREADPANEL_H
+
+#include <QWidget>
+#include <QTreeView>
+#include <QSortFilterProxyModel>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QLabel>
+#include "threadfeed.h"
+#include "threadmodel.h"
+
+// Thread rows by topic text and status; events always pass with their thread
+class ThreadFilterModel : public QSortFilterProxyModel {
+public:
+    using QSortFilterProxyModel::QSortFilterProxyModel;
+
+    void setTopicFilter(const QString &text);
+    void setShowFinalized(bool show);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QString topicFilter;
+    bool showFinalized = true;
+};
+
+// "Threads" tab: what the backend currently thinks the user is doing. Reads
+// only while visible, and then only what changed since the last look.
+class ThreadPanel : public QWidget {
+    Q_OBJECT
+public:
+    ThreadPanel(const QString &storeDir, const QString &jsonPath, QWidget *parent = nullptr);
+
+    // The backend reported a change over IPC
+    void notifyChanged();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    ThreadFeed *feed;
+    ThreadModel *model;
+    ThreadFilterModel *proxy;
+    QTreeView *view;
+    QLineEdit *topicFilter;
+    QCheckBox *showFinalized;
+    QLabel *summaryLabel;
+
+    void updateSummary();
+};
+
+#endif // THREADPANEL_H
@@ -0,0 +1,97 @@
+#include "tracecollector.h"
+#include <QDateTime>
+
+namespace {
+
+const int RingCapacity = 8192;
+
+const char *const StageNames[] = {
+    "screenpipe_query", "clean_ocr", "add_to_thread", "debounce",
+    "suggest", "handoff", "user", "perform_action"
+};
+
+} // namespace
+
+TraceCollector::TraceCollector(QObject *parent) : QObject(parent), ring(RingCapacity) {}
+
+QString TraceCollector::stageName(int stage) {
+    if (stage < 0 || stage >= StageCount) return QString();
+    return QString::fromLatin1(StageNames[stage]);
+}
+
+int TraceCollector::stageFromName(const QString &name) {
+    for (int i = 0; i < StageCount; ++i)
+        if (name == QLatin1String(StageNames[i])) return i;
+    return -1;
+}
+
+quint64 TraceCollector::parseTraceId(const QString &id) {
+    bool ok = false;
+    const quint64 value = id.toULongLong(&ok, 16);
+    return ok ? value : 0;
+}
+
+qint64 TraceCollector::nowUs() {
+    return QDateTime::currentMSecsSinceEpoch() * 1000;
+}
+
+void TraceCollector::record(quint64 trace, int stage, qint64 startUs, qint64 endUs) {
+    if (trace == 0 || stage < 0 || stage >= StageCount) return;
+
+    Span span;
+    span.trace = trace;
+    span.stage = stage;
+    span.startUs = startUs;
+    span.endUs = qMax(startUs, endUs);
+    ring.push(span);
+
+    // Don't let a long stretch without a viewer overflow the ring
+    if (ring.size() > ring.capacity() / 2) drain();
+}
+
+void TraceCollector::ingest(const QJsonArray &spans) {
+    for (const QJsonValue &value : spans) {
+        const QJsonArray span = value.toArray();
+        if (span.size() < 4) continue;
+        // Backend times are fractional epoch milliseconds
+        record(parseTraceId(span[0].toString()), stageFromName(span[1].toString()),
+               qint64(span[2].toDouble() * 1000), qint64(span[3].toDouble() * 1000));
+    }
+}
+
+TraceCollector::Trace *TraceCollector::traceFor(quint64 id, qint64 startUs) {
+    for (Trace &trace : recent)
+        if (trace.id == id) return &trace;
+
+    Trace trace;
+    trace.id = id;
+    trace.startUs = startUs;
+    trace.endUs = startUs;
+    recent.prepend(trace);
+    if (recent.size() > MaxRecentTraces) recent.removeLast();
+    return &recent.first();
+}
+
+void TraceCollector::drain() {
+    Span span;
+    bool any = false;
+    while (ring.pop(span)) {
+        any = true;
+        histograms[size_t(span.stage)].record(quint64(span.endUs - span.startUs));
+
+        Trace *trace = traceFor(span.trace, span.startUs);
+        trace->spanStart[size_t(span.stage)] = span.startUs;
+        trace->spanEnd[size_t(span.stage)] = span.endUs;
+        trace->startUs = qMin(trace->startUs, span.startUs);
+        trace->endUs = qMax(trace->endUs, span.endUs);
+    }
+    if (any) emit updated();
+}
+
+void TraceCollector::reset() {
+    Span span;
+    while (ring.pop(span)) {}
+    for (HdrHistogram &histogram : histograms) histogram.reset();
+    recent.clear();
+    emit updated();
+}
@@ -0,0 +1,80 @@
+#ifndef TRACECOLLECTOR_H
+#define TRACECOLLECTOR_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QList>
+#include <QHash>
+#include <array>
+#include "spscring.h"
+#include "hdrhistogram.h"
+
+// Latency of the suggestion pipeline, one trace per OCR frame. The backend
+// batches its spans over IPC ("spans"); the app adds the ones it sees itself
+// (hand-off and the user's answer). Recording is one slot copy into a
+// lock-free ring; the per-stage histograms and the recent-trace list are only
+// updated when the ring is drained, which the latency tab does while it is
+// visible (and record() does itself once the ring is half full).
+class TraceCollector : public QObject {
+    Q_OBJECT
+public:
+    // Pipeline order; names match backend/utility/tracing.js
+    enum Stage {
+        ScreenpipeQuery,
+        CleanOcr,
+        AddToThread,
+        Debounce,
+        Suggest,
+        Handoff,
+        User,
+        PerformAction,
+        StageCount
+    };
+
+    struct Trace {
+        quint64 id = 0;
+        qint64 startUs = 0; // earliest span start
+        qint64 endUs = 0;   // latest span end
+        std::array<qint64, StageCount> spanStart{};
+        std::array<qint64, StageCount> spanEnd{};  // 0 when the stage was not seen
+    };
+
+    static constexpr int MaxRecentTraces = 50;
+
+    explicit TraceCollector(QObject *parent = nullptr);
+
+    static QString stageName(int stage);
+    static int stageFromName(const QString &name);
+    static quint64 parseTraceId(const QString &id);
+    static qint64 nowUs(); // wall clock, comparable with the backend's timestamps
+
+    void record(quint64 trace, int stage, qint64 startUs, qint64 endUs);
+    void ingest(const QJsonArray &spans); // [[trace, stage, startMs, endMs], ...]
+
+    // Folds everything recorded so far into the statistics
+    void drain();
+    void reset();
+
+    const HdrHistogram &histogram(int stage) const { return histograms[size_t(stage)]; }
+    const QList<Trace> &recentTraces() const { return recent; } // newest first
+    quint64 droppedSpans() const { return ring.dropped(); }
+
+signals:
+    void updated();
+
+private:
+    struct Span {
+        quint64 trace = 0;
+        qint64 startUs = 0;
+        qint64 endUs = 0;
+        int stage = 0;
+    };
+
+    SpscRing<Span> ring;
+    std::array<HdrHistogram, StageCount> histograms;
+    QList<Trace> recent;
+
+    Trace *traceFor(quint64 id, qint64 startUs);
+};
+
+#endif // TRACECOLLECTOR_H
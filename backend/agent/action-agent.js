@@ -1,26 +1,21 @@
-import path from "path";
 import fs from "fs/promises";
-import { configDotenv } from "dotenv";
-import { fileURLToPath } from "url";
 
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
 import { parseLLMJson } from "../utility/llm-json-parser.js";
+import { isIpcConnected, waitForMessage } from "../utility/ipc-client.js";
 
 import { sendMail } from "../tools/send-mail.js";
 import { summarisePdf } from "../tools/summarise-document.js";
 
-import Groq from "groq-sdk";
+import { groq } from "../utility/llm.js";
+import { buildThreadContext } from "../utility/prompt-builder.js";
+import { configPath } from "../utility/config-path.js";
 
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
+const logToFile = createLogger("action");
 
-const summaryPath = path.resolve(__dirname, "../../config/manual_summary.json");
+const MODEL = "llama-3.3-70b-versatile"; // "gemma2-9b-it"
 
-// Initialize Groq SDK
-const groq = new Groq({ apiKey: process.env.GROQ_API_KEY });
-
-// Load .env from project root
-configDotenv({ path: path.resolve(__dirname, "../../.env") });
+const summaryPath = configPath("manual_summary.json");
 
 export async function performAction(suggestion, thread) {
     try {
@@ -37,8 +32,10 @@ export async function performAction(suggestion, thread) {
         // Override if action is summarise_pdf
         if (suggestion.action === "summarise_pdf") {
             try {
-                const manualText = await waitForManualSummary(10000);
-                let text;
+                // The app accepts first and then shows its input panel, so this
+                // is already listening when the text arrives
+                const manualText = await waitForManualSummary(15000, suggestion.id);
+                let text = "";
                 for (const event of thread.events) {
                     // Congregate text from all events
                     if (event.text) {
@@ -48,15 +45,13 @@ export async function performAction(suggestion, thread) {
 
                 const content = manualText || text;
 
-                if (!content) {
-                    logToFile("❌ No content available for summarisation.");
-                    return { success: false, message: "No content" };
-                }
+                // Still goes through summarisePdf so the app's panel hears back
+                if (!content) logToFile("❌ No content available for summarisation.");
 
-                const result = await summarisePdf({ content });
+                const result = await summarisePdf({ content, streamId: suggestion.id });
                 return {
-                    "success": true,
-                    "message": "Action performed successfully.",
+                    "success": result.success,
+                    "message": result.success ? "Action performed successfully." : result.message,
                     "service_response": result.summary
                 }
             }
@@ -77,7 +72,7 @@ export async function performAction(suggestion, thread) {
         let raw = null;
         try {
             const response = await groq.chat.completions.create({
-                model: "llama-3.3-70b-versatile", // "gemma2-9b-it",
+                model: MODEL,
                 messages: [{ role: "user", content: prompt }]
             });
           
@@ -147,9 +142,24 @@ export async function performAction(suggestion, thread) {
     }
 }
 
+// What the suggestion saw in the thread, to rank its events by
+function suggestionKeywords(suggestion) {
+    const seen = [suggestion.reason, suggestion.trigger_data?.thread_topic, suggestion.trigger_data?.text]
+        .filter(text => typeof text === "string")
+        .join(" ");
+    return [...new Set(seen.toLowerCase().split(/[^\p{L}\p{N}@.]+/u).filter(word => word.length > 3))];
+}
+
 function generatePrompt(suggestion, thread) {
     let prompt;
     if (suggestion.action == "send_mail") {
+        const context = buildThreadContext([thread], {
+            model: MODEL,
+            keywords: suggestionKeywords(suggestion),
+            label: "send_mail"
+        });
+        const events = JSON.parse(context.text)[0]?.events ?? [];
+
         prompt = `
         You are an intelligent assistant agent. The user is performing some activity on the screen that suggests they need to send an email.
         Based on the user's activity, you need to draft an email response. You need to:
@@ -167,7 +177,7 @@ function generatePrompt(suggestion, thread) {
 
         The user's activity summary is as follows:
         Topic: ${thread.topic}
-        Events: ${JSON.stringify(thread.events, null, 2)}
+        Events: ${JSON.stringify(events)}
         `
     }
     else if (suggestion.action == "schedule_meeting") {
@@ -201,7 +211,16 @@ Suggestion format:
 }
  */
 
-export async function waitForManualSummary(maxWaitMs = 10000) {
+export async function waitForManualSummary(maxWaitMs = 10000, id = null) {
+  if (isIpcConnected()) {
+    const message = await waitForMessage("manual_summary", {
+      timeoutMs: maxWaitMs,
+      filter: (m) => !id || !m.id || m.id === id
+    });
+    if (message?.manual === true && message.text?.trim()) return message.text.trim();
+    return null;
+  }
+
   const start = Date.now();
 
   while (Date.now() - start < maxWaitMs) {
@@ -1,6 +1,9 @@
 import { getActiveThreads } from "../threads/thread-manager.js";
 import { suggestAndAct } from "./suggest-and-act.js";
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
+import { latestThreadedTrace, recordSpan } from "../utility/tracing.js";
+
+const logToFile = createLogger("suggestion-poller");
 
 let lastHash = null;
 let debounceTimer = null;
@@ -25,7 +28,10 @@ function checkForChangesAndDebounce() {
     clearTimeout(debounceTimer);
     debounceTimer = setTimeout(() => {
       logToFile("🧠 Threads idle — triggering LLM agent.", "suggestion-poller");
-      suggestAndAct();
+      // The suggestion is attributed to the newest frame that reached a thread
+      const threaded = latestThreadedTrace();
+      if (threaded) recordSpan(threaded.trace, "debounce", threaded.at);
+      suggestAndAct(threaded?.trace ?? null);
     }, DEBOUNCE_DELAY_MS);
   }
 }
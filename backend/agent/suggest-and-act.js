@@ -1,31 +1,51 @@
 import { configDotenv } from "dotenv";
 import path from "path";
 import { fileURLToPath } from "url";
+import { randomUUID } from "crypto";
 import fs from "fs";
 
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
+import { isIpcConnected, sendMessage, waitForMessage } from "../utility/ipc-client.js";
 import { getActiveThreads } from "../threads/thread-manager.js";
 import { suggestRelevantTools } from "./suggestion-agent.js";
 import { performAction } from "./action-agent.js";
+import { traceNow, traced } from "../utility/tracing.js";
+import { configPath } from "../utility/config-path.js";
+
+const logToFile = createLogger("suggest-and-act");
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 
 configDotenv({ path: path.resolve(__dirname, "../../.env") });
 
-const RESPONSE_PATH = path.resolve(__dirname, "../../config/user_response.json");
-const SUGGESTION_PATH = path.resolve(__dirname, "../../config/latest_suggestion.json");
+const RESPONSE_PATH = configPath("user_response.json");
+const SUGGESTION_PATH = configPath("latest_suggestion.json");
 
 const cooldown = process.env.COOLDOWN || "12000"; // Time between prompting the user for a suggestion (in seconds)
 let lastSuggestionTime = 0; // Time of the last suggestion prompt
 
 let llmIsBusy = false;
 
+// Push the suggestion over IPC; the JSON file is only a fallback for when the app is not connected
 async function writeLatestSuggestion(suggestion) {
+    suggestion.sentAt = traceNow(); // the app times the hand-off from here
+    if (sendMessage("suggestion", suggestion)) return;
     await fs.writeFileSync(SUGGESTION_PATH, JSON.stringify(suggestion, null, 2));
 }
 
-function waitForUserResponse(timeoutMs = 15000) {
+async function waitForUserResponse(suggestionId, timeoutMs = 15000) {
+  if (isIpcConnected()) {
+    const message = await waitForMessage("response", {
+      timeoutMs,
+      filter: (m) => !m.id || m.id === suggestionId
+    });
+    return message || { accepted: false };
+  }
+  return waitForResponseFile(timeoutMs);
+}
+
+function waitForResponseFile(timeoutMs) {
   return new Promise((resolve) => {
     const start = Date.now();
 
@@ -54,7 +74,7 @@ function waitForUserResponse(timeoutMs = 15000) {
   });
 }
 
-export async function suggestAndAct() {
+export async function suggestAndAct(trace = null) {
     const now = Date.now();
     if (now - lastSuggestionTime < cooldown) {
       logToFile("🛑 Global cooldown active — skipping suggest cycle.");
@@ -77,7 +97,7 @@ export async function suggestAndAct() {
     llmIsBusy = true;
     logToFile("🔍 Triggering suggestion agent with current threads...", "suggest-and-act");
 
-    const suggestion = await suggestRelevantTools(activeThreads);
+    const suggestion = await traced(trace, "suggest", () => suggestRelevantTools(activeThreads));
 
     if (!suggestion || !suggestion.action) {
       logToFile("🤷 No helpful action found this cycle.", "suggest-and-act");
@@ -85,10 +105,12 @@ export async function suggestAndAct() {
       return { success: false, message: "No suggestions" };
     }
 
-    writeLatestSuggestion(suggestion);
+    suggestion.id = randomUUID();
+    if (trace) suggestion.trace = trace;
+    await writeLatestSuggestion(suggestion);
     logToFile("📤 Waiting for user to accept or reject...", suggestion);
 
-    const userResponse = await waitForUserResponse();
+    const userResponse = await waitForUserResponse(suggestion.id);
     logToFile("📩 User responded:", userResponse);
 
     if (!userResponse.accepted) {
@@ -101,7 +123,7 @@ export async function suggestAndAct() {
       (t) => t.topic === suggestion.trigger_data?.thread_topic
     );
 
-    const result = await performAction(suggestion, targetThread);
+    const result = await traced(trace, "perform_action", () => performAction(suggestion, targetThread));
     llmIsBusy = false;
     return result;
 }
\ No newline at end of file
@@ -1,18 +1,12 @@
-import path from "path";
-import { configDotenv } from "dotenv";
-import { fileURLToPath } from "url";
-
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
 import { parseLLMJson } from "../utility/llm-json-parser.js";
 
-import Groq from "groq-sdk";
-
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
+import { groq } from "../utility/llm.js";
+import { buildThreadContext } from "../utility/prompt-builder.js";
 
-configDotenv({ path: path.resolve(__dirname, "../../.env") });
+const logToFile = createLogger("suggestion");
 
-const groq = new Groq({ apiKey: process.env.GROQ_API_KEY });
+const MODEL = "llama-3.3-70b-versatile"; // "gemma2-9b-it"
 
 const TOOLSET = [
   {
@@ -32,13 +26,23 @@ const TOOLSET = [
   }
 ];
 
+// Words that make an event worth its place in the prompt: what the tools'
+// triggers look for
+const TOOL_KEYWORDS = [
+  "email", "mail", "inbox", "reply", "invitation", "invite",
+  "pdf", "paper", "article", "document", "abstract",
+  "meeting", "schedule", "calendar", "tomorrow", "deadline"
+];
+
 export async function suggestRelevantTools(threads) {
   const toolListText = TOOLSET.map(
     (tool, i) =>
       `${i + 1}. ${tool.action} — ${tool.description}\n   When: ${tool.trigger}`
   ).join("\n");
 
-  const threadsJSON = JSON.stringify(threads, null, 2);
+  // Fit the session to the model's budget instead of sending it whole,
+  // which grew with the session and eventually overflowed the window
+  const context = buildThreadContext(threads, { model: MODEL, keywords: TOOL_KEYWORDS, label: "suggestion" });
 
   const prompt = `
 You are an intelligent assistant agent. Based on the user's recent screen activity, decide if any of the following tools can help.
@@ -63,12 +67,12 @@ Instructions:
 - No extra text or formatting. RETURN A VALID JSON OBJECT ONLY.
 
 User Activity:
-${threadsJSON}
+${context.text}
 `;
 
   try {
     const response = await groq.chat.completions.create({
-      model: "llama-3.3-70b-versatile", // "gemma2-9b-it",
+      model: MODEL,
       messages: [{ role: "user", content: prompt }]
     });
 
@@ -0,0 +1,62 @@
+// Micro-benchmark: blacklist checks with the old `.some(... .includes(...))`
+// scan versus the compiled matcher (native addon when built, JS otherwise).
+//
+//   node bench/blacklist-bench.js [patterns] [iterations]
+
+import { performance } from "perf_hooks";
+
+import { native } from "../utility/native.js";
+import { compileMatcher, JsBlacklistMatcher } from "../utility/blacklist-matcher.js";
+
+const patternCount = parseInt(process.argv[2] || "300");
+const iterations = parseInt(process.argv[3] || "200000");
+
+// Deterministic pseudo-random words
+let seed = 42;
+function random() {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed / 0x7fffffff;
+}
+function word(min, max) {
+  const length = min + Math.floor(random() * (max - min + 1));
+  let out = "";
+  for (let i = 0; i < length; i++) out += String.fromCharCode(97 + Math.floor(random() * 26));
+  return out;
+}
+
+const patterns = Array.from({ length: patternCount }, () => word(5, 14));
+const titles = Array.from({ length: 1024 }, (_, i) => {
+  const title = `${word(4, 10)} - ${word(3, 12)} ${word(3, 12)} — ${word(5, 9)}`;
+  // Roughly one title in ten is blacklisted
+  return i % 10 === 0 ? `${title} ${patterns[i % patterns.length]}` : title;
+});
+
+function run(name, check) {
+  let hits = 0;
+  for (let i = 0; i < 1000; i++) hits += check(titles[i % titles.length]) ? 1 : 0; // warm up
+
+  hits = 0;
+  const start = performance.now();
+  for (let i = 0; i < iterations; i++) hits += check(titles[i % titles.length]) ? 1 : 0;
+  const elapsed = performance.now() - start;
+
+  console.log(
+    `${name.padEnd(28)} ${(elapsed * 1e6 / iterations).toFixed(0).padStart(8)} ns/check  ${hits} hits`
+  );
+}
+
+console.log(`${patternCount} patterns, ${iterations} checks`);
+
+const lowered = patterns.map(p => p.toLowerCase());
+run(".some/.includes (baseline)", title => {
+  const name = title.toLowerCase();
+  return lowered.some(p => name.includes(p));
+});
+
+run("JsBlacklistMatcher", (matcher => title => matcher.matches(title))(new JsBlacklistMatcher(patterns)));
+
+if (native) {
+  run("native Aho-Corasick", (matcher => title => matcher.matches(title))(compileMatcher(patterns)));
+} else {
+  console.log("native addon not built — run `npm run build:native` to include it");
+}
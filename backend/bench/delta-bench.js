@@ -0,0 +1,152 @@
+// What reaches cleanOCR and the threads on an OCR trace: whole frames (the
+// near-duplicate index in front of the exact cache, as cache-ocr.js does
+// without frame deltas) against frame deltas, where a frame that would
+// cost a call anyway has only its changed lines cleaned and stored.
+//
+//   node bench/delta-bench.js [trace.ndjson] [maxChange] [minLength]
+//
+// Traces as in neardup-bench.js; without one, a synthetic trace is used.
+// Prompt tokens are of the whole prompt clean-ocr.js sends, instructions
+// and all; OCR tokens of the text in it.
+
+import crypto from "crypto";
+import { performance } from "perf_hooks";
+
+import { native } from "../utility/native.js";
+import { cleanPrompt } from "../ocr/clean-prompt.js";
+import { createFrameDeltas } from "../ocr/frame-delta.js";
+import { loadTrace, syntheticTrace } from "./ocr-trace.js";
+
+const tracePath = process.argv[2] && process.argv[2] !== "-" ? process.argv[2] : null;
+const maxChange = parseFloat(process.argv[3] || "0.6");
+const minLength = parseInt(process.argv[4] || "120"); // OCR_DELTA_MIN_CHARS
+const MIN_LENGTH = 40; // near-duplicate fingerprints, as in cache-ocr.js
+
+if (!native) {
+  console.log("native addon not built — run `npm run build:native` first");
+  process.exit(1);
+}
+
+const frames = tracePath ? loadTrace(tracePath) : syntheticTrace();
+console.log(`${frames.length} frames from ${tracePath || "synthetic trace"}, maxChange ${maxChange}, minLength ${minLength}`);
+
+const tokenizer = new native.TextChunker({});
+const sha = (text) => crypto.createHash("sha256").update(text).digest("hex");
+const scopeOf = (frame) => `${frame.app}\u001f${frame.window}`;
+const topicOf = (frame) => `reading ${frame.window} on ${frame.app}`; // stands in for the cleaned topic
+
+function mode() {
+  return { calls: 0, ocrTokens: 0, promptTokens: 0, largest: 0, events: 0, eventBytes: 0, touches: 0 };
+}
+
+// One cleanOCR call on text
+function call(stats, frame, text, context) {
+  const tokens = tokenizer.countTokens(cleanPrompt(text, frame.app, frame.window, "", context));
+  stats.calls++;
+  stats.ocrTokens += tokenizer.countTokens(text);
+  stats.promptTokens += tokens;
+  stats.largest = Math.max(stats.largest, tokens);
+}
+
+// What the near-duplicate index or the exact cache already has for frame:
+// "whole", "delta" or null
+function known(index, seen, frame, fingerprint) {
+  const match = fingerprint !== null ? index.lookup(scopeOf(frame), fingerprint) : null;
+  if (match) return match.payload;
+  return seen.has(sha(frame.text)) ? "whole" : null;
+}
+
+function fingerprintOf(index, frame) {
+  return frame.text.length >= MIN_LENGTH ? index.fingerprint(frame.text) : null;
+}
+
+function cleanWhole(stats, index, seen, frame, fingerprint) {
+  const hash = sha(frame.text);
+  if (!seen.has(hash)) {
+    seen.add(hash);
+    call(stats, frame, frame.text);
+  }
+  if (fingerprint !== null) index.insert(scopeOf(frame), fingerprint, "whole");
+  stats.events++;
+  stats.eventBytes += Buffer.byteLength(frame.text);
+}
+
+const whole = mode();
+{
+  const index = new native.NearDuplicateIndex({});
+  const seen = new Set();
+  for (const frame of frames) {
+    const fingerprint = fingerprintOf(index, frame);
+    if (known(index, seen, frame, fingerprint)) {
+      whole.events++; // a reused result is still filed as a full event
+      whole.eventBytes += Buffer.byteLength(frame.text);
+    } else {
+      cleanWhole(whole, index, seen, frame, fingerprint);
+    }
+  }
+}
+
+// As getCleanedTextWithCache: unchanged frames and frames the caches know
+// cost nothing and file nothing; the rest are cleaned whole or as a delta
+const delta = mode();
+let diffTime = 0;
+const kinds = { full: 0, delta: 0, unchanged: 0, known: 0 };
+{
+  const deltas = createFrameDeltas({ maxChange, minLength });
+  const index = new native.NearDuplicateIndex({});
+  const seen = new Set();
+  const deltaSeen = new Set();
+  const topics = new Set();
+  for (const frame of frames) {
+    const scope = scopeOf(frame);
+    const start = performance.now();
+    const step = deltas.next(scope, frame.text);
+    diffTime += performance.now() - start;
+
+    if (step.kind === "unchanged" && topics.has(scope)) {
+      kinds.unchanged++;
+      delta.touches++;
+      continue;
+    }
+    const fingerprint = fingerprintOf(index, frame);
+    const reuse = known(index, seen, frame, fingerprint);
+    if (reuse === "delta" || (reuse && step.kind === "delta" && topics.has(scope))) {
+      kinds.known++;
+      delta.touches++;
+      continue;
+    }
+
+    if (reuse) {
+      delta.events++;
+      delta.eventBytes += Buffer.byteLength(frame.text);
+    } else if (step.kind === "delta" && topics.has(scope)) {
+      kinds.delta++;
+      const hash = sha(`${topicOf(frame)}\u001f${step.text}`);
+      if (!deltaSeen.has(hash)) {
+        deltaSeen.add(hash);
+        call(delta, frame, step.text, { previousTopic: topicOf(frame) });
+      }
+      if (fingerprint !== null) index.insert(scope, fingerprint, "delta");
+      delta.events++;
+      delta.eventBytes += Buffer.byteLength(step.text);
+    } else {
+      kinds.full++;
+      cleanWhole(delta, index, seen, frame, fingerprint);
+    }
+    deltas.keep(scope);
+    topics.add(scope);
+  }
+}
+
+const row = (name, stats) => console.log(
+  `${name.padEnd(14)} ${String(stats.calls).padStart(6)} ${String(stats.ocrTokens).padStart(10)} ` +
+  `${String(stats.promptTokens).padStart(10)} ${(stats.promptTokens / Math.max(stats.calls, 1)).toFixed(0).padStart(10)} ` +
+  `${String(stats.largest).padStart(8)} ${String(stats.events).padStart(7)} ${(stats.eventBytes / 1024).toFixed(0).padStart(9)} KiB`);
+
+console.log(`\n${"".padEnd(14)} ${"calls".padStart(6)} ${"OCR tokens".padStart(10)} ${"prompt".padStart(10)} ` +
+  `${"per call".padStart(10)} ${"largest".padStart(8)} ${"events".padStart(7)} ${"event text".padStart(13)}`);
+row("whole frames", whole);
+row("frame deltas", delta);
+console.log(`\nframes: ${kinds.full} cleaned whole, ${kinds.delta} as deltas, ${kinds.unchanged} unchanged and ` +
+  `${kinds.known} already known (thread kept alive, no event); diff ` +
+  `${(diffTime * 1000 / Math.max(frames.length, 1)).toFixed(1)} us/frame`);
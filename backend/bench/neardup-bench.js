@@ -0,0 +1,67 @@
+// How many cleanOCR (LLM) calls the near-duplicate index avoids on an OCR
+// trace, compared with the exact SHA-256 cache alone.
+//
+//   node bench/neardup-bench.js [trace.ndjson] [maxDistance]
+//
+// A trace is NDJSON as written by gem-ingest ({"type":"frame","frame":{...}}),
+// bare frames ({appName, windowName, text}) or Screenpipe search items
+// ({content:{app_name, window_name, text}}). Record one with
+//   gem-ingest --cursor <ms> > trace.ndjson
+// Without a trace, a synthetic one (clock ticks, cursor blinks, scrolling)
+// is generated.
+
+import crypto from "crypto";
+import { performance } from "perf_hooks";
+
+import { native } from "../utility/native.js";
+import { loadTrace, syntheticTrace } from "./ocr-trace.js";
+
+const tracePath = process.argv[2] && process.argv[2] !== "-" ? process.argv[2] : null;
+const maxDistance = parseInt(process.argv[3] || "6");
+const MIN_LENGTH = 40; // as in cache-ocr.js
+
+if (!native) {
+  console.log("native addon not built — run `npm run build:native` first");
+  process.exit(1);
+}
+
+const frames = tracePath ? loadTrace(tracePath) : syntheticTrace();
+console.log(`${frames.length} frames from ${tracePath || "synthetic trace"}, maxDistance ${maxDistance}`);
+
+// Exact cache only (what cache-ocr.js did before)
+const exact = new Set();
+let exactCalls = 0;
+for (const frame of frames) {
+  const hash = crypto.createHash("sha256").update(frame.text).digest("hex");
+  if (!exact.has(hash)) {
+    exact.add(hash);
+    exactCalls++;
+  }
+}
+
+// Near-duplicate index in front of the exact cache
+const index = new native.NearDuplicateIndex({ maxDistance });
+const seen = new Set();
+let nearCalls = 0;
+let lookupTime = 0;
+for (const frame of frames) {
+  const scope = `${frame.app}\u001f${frame.window}`;
+  const start = performance.now();
+  const fingerprint = frame.text.length >= MIN_LENGTH ? index.fingerprint(frame.text) : null;
+  const match = fingerprint !== null ? index.lookup(scope, fingerprint) : null;
+  lookupTime += performance.now() - start;
+  if (match) continue;
+
+  const hash = crypto.createHash("sha256").update(frame.text).digest("hex");
+  if (!seen.has(hash)) {
+    seen.add(hash);
+    nearCalls++;
+  }
+  if (fingerprint !== null) index.insert(scope, fingerprint, hash);
+}
+
+const stats = index.stats();
+console.log(`LLM calls, exact cache only:      ${exactCalls}`);
+console.log(`LLM calls, near-duplicate + exact: ${nearCalls}`);
+console.log(`avoided:                           ${exactCalls - nearCalls} (${((1 - nearCalls / Math.max(exactCalls, 1)) * 100).toFixed(1)}%)`);
+console.log(`index hits ${stats.hits}, misses ${stats.misses}, ${(lookupTime * 1000 / Math.max(frames.length, 1)).toFixed(1)} us/frame`);
@@ -0,0 +1,111 @@
+// Text normalisation on OCR-sized events: the regex thread-manager.js used
+// to run on every event of every query, the JS fallback in
+// utility/text-search.js, and the native kernels (each one this CPU has).
+// Then a send-mail context query over the same threads, rescanned with the
+// old regex against the inverted index that took the place of a keyword
+// scan (threads/thread-index.js, normalising through the addon when built).
+//
+//   node bench/normalize-bench.js [events] [threads] [queries]
+
+import { performance } from "perf_hooks";
+
+import { native } from "../utility/native.js";
+import { jsNormalizeText } from "../utility/text-search.js";
+import { ThreadIndex } from "../threads/thread-index.js";
+
+const eventCount = parseInt(process.argv[2] || "20000");
+const threadCount = parseInt(process.argv[3] || "200");
+const queries = parseInt(process.argv[4] || "100");
+
+// Deterministic pseudo-random words; one event in five has some non-ASCII
+// text, which the SIMD kernels hand to the scalar path
+let seed = 42;
+function random() {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed / 0x7fffffff;
+}
+function word(min, max) {
+  const length = min + Math.floor(random() * (max - min + 1));
+  let out = "";
+  for (let i = 0; i < length; i++) out += String.fromCharCode(97 + Math.floor(random() * 26));
+  return random() < 0.1 ? out[0].toUpperCase() + out.slice(1) : out;
+}
+const ACCENTED = ["Café", "Über", "résumé", "Ärger", "naïve", "—", "“quoted”", "Привет"];
+function sentence(words, accented) {
+  const parts = Array.from({ length: words }, () => word(2, 10));
+  if (accented) parts[Math.floor(random() * parts.length)] = ACCENTED[Math.floor(random() * ACCENTED.length)];
+  return parts.join(random() < 0.2 ? ", " : " ") + ". ";
+}
+
+const threads = Array.from({ length: threadCount }, (_, i) => ({ key: `topic ${i}`, topic: `Topic ${word(4, 9)} ${i}`, events: [] }));
+const byKey = new Map(threads.map(t => [t.key, t]));
+const eventText = (e) => [e.app_name, e.window_name, e.text].join(" ");
+for (let i = 0; i < eventCount; i++) {
+  const accented = random() < 0.2;
+  let text = "";
+  while (text.length < 600) text += sentence(6 + Math.floor(random() * 10), accented);
+  if (i % 997 === 0) text += " Compose - Inbox (3) - someone@mail.google.com";
+  threads[i % threadCount].events.push({ app_name: "Google Chrome", window_name: `${word(4, 10)} - ${word(3, 8)}`, text });
+}
+const texts = threads.flatMap(t => t.events.map(eventText));
+const totalBytes = texts.reduce((sum, text) => sum + Buffer.byteLength(text), 0);
+console.log(`${eventCount} events in ${threadCount} threads (${(totalBytes / 1e6).toFixed(1)} MB), ${queries} queries`);
+
+// What thread-manager.js did before user-020
+const oldNormalize = (text) => String(text || "").toLowerCase().replace(/[^a-z0-9]/gi, " ").trim();
+
+function normalizeAll(name, normalize) {
+  for (let i = 0; i < 1000; i++) normalize(texts[i % texts.length]); // warm up
+  let bytes = 0;
+  const start = performance.now();
+  for (const text of texts) bytes += normalize(text).length;
+  const elapsed = performance.now() - start;
+  console.log(`${name.padEnd(28)} ${(elapsed * 1e6 / texts.length).toFixed(0).padStart(8)} ns/event ` +
+    `${(totalBytes / 1e3 / elapsed).toFixed(0).padStart(6)} MB/s`);
+  return bytes;
+}
+
+console.log("\nnormalise every event");
+normalizeAll("regex (old thread-manager)", oldNormalize);
+normalizeAll("jsNormalizeText", jsNormalizeText);
+if (!native?.normalizeText) {
+  console.log("native addon not built — run `npm run build:native` to include it");
+} else {
+  const best = native.textKernel();
+  for (const kernel of ["scalar", "sse4.2", "avx2"]) {
+    if (native.setTextKernel(kernel) !== kernel) continue; // not on this CPU
+    normalizeAll(`native ${kernel}`, native.normalizeText);
+  }
+  native.setTextKernel(best);
+  const differ = texts.filter(text => native.normalizeText(text) !== jsNormalizeText(text)).length;
+  console.log(`native and JS differ on ${differ} of ${texts.length} events`);
+}
+
+// isContextActive for send-mail, before and after
+const keywords = ["gmail", "mail.google.com", "inbox", "compose", "mail", "email"];
+
+function perQuery(name, fn, runs = queries) {
+  fn();
+  const start = performance.now();
+  let matched = 0;
+  for (let i = 0; i < runs; i++) matched = fn();
+  console.log(`${name.padEnd(28)} ${((performance.now() - start) * 1000 / runs).toFixed(1).padStart(10)} µs/query  (${matched} threads)`);
+}
+
+// The old scan renormalises every event per keyword, so a few runs do
+console.log("\nsend-mail context query");
+perQuery("regex per call (old)", () => threads.filter(thread => {
+  const topic = oldNormalize(thread.topic);
+  return keywords.some(keyword => {
+    const k = oldNormalize(keyword);
+    return topic.includes(k) || thread.events.some(e => oldNormalize(eventText(e)).includes(k));
+  });
+}).length, Math.min(queries, 3));
+
+const index = new ThreadIndex({
+  textOf: (key, ordinal) => (ordinal < 0 ? byKey.get(key).topic : eventText(byKey.get(key).events[ordinal]))
+});
+const start = performance.now();
+for (const t of threads) index.addThread(t.key, t.topic, t.events.map(eventText));
+console.log(`${"index build".padEnd(28)} ${(performance.now() - start).toFixed(0).padStart(10)} ms, once, as events arrive`);
+perQuery("index query", () => index.query(keywords).size);
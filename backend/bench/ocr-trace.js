@@ -0,0 +1,48 @@
+// OCR traces for the benches: NDJSON as written by gem-ingest
+// ({"type":"frame","frame":{...}}), bare frames ({appName, windowName, text})
+// or Screenpipe search items ({content:{app_name, window_name, text}}); or a
+// synthetic one (clock ticks, cursor blinks, scrolling).
+
+import { readFileSync } from "fs";
+
+export function loadTrace(file) {
+  const frames = [];
+  for (const line of readFileSync(file, "utf8").split("\n")) {
+    if (!line.trim()) continue;
+    let record;
+    try {
+      record = JSON.parse(line);
+    } catch {
+      continue;
+    }
+    if (record.type && record.type !== "frame") continue;
+    const frame = record.frame || record.content || record;
+    frames.push({
+      app: frame.appName ?? frame.app_name ?? "",
+      window: frame.windowName ?? frame.window_name ?? "",
+      text: frame.text ?? ""
+    });
+  }
+  return frames;
+}
+
+export function syntheticTrace() {
+  let seed = 7;
+  const random = () => (seed = (seed * 1103515245 + 12345) & 0x7fffffff) / 0x7fffffff;
+  const vocabulary = "the budget meeting review code plan notes team report draft email inbox reply chart sales file edit view help window build test deploy issue merge branch commit".split(" ");
+  const sentence = (n) => Array.from({ length: n }, () => vocabulary[Math.floor(random() * vocabulary.length)]).join(" ");
+
+  const frames = [];
+  for (let screen = 0; screen < 40; screen++) {
+    const app = ["Google Chrome", "Code", "Slack", "Outlook"][screen % 4];
+    const window = `${sentence(3)} ${screen}`;
+    let lines = Array.from({ length: 20 }, () => sentence(8));
+    for (let tick = 0; tick < 30; tick++) {
+      const clock = `${9 + Math.floor(tick / 60)}:${String(tick % 60).padStart(2, "0")}`;
+      const cursor = tick % 2 ? "|" : "";
+      if (random() < 0.2) lines = [...lines.slice(1), sentence(8)]; // scroll one line
+      frames.push({ app, window, text: `${lines.join("\n")}${cursor}\n${clock}` });
+    }
+  }
+  return frames;
+}
@@ -0,0 +1,83 @@
+// Suggestion-prompt context as a session grows: the old pretty-printed dump
+// of every thread against the budgeted context from prompt-builder.js, in
+// tokens and in time to build; "next ms" is the following request, after
+// one more event, which is what a running session pays each time. Set
+// LLM_TOKENIZER_PATH for exact counts.
+//
+//   node bench/prompt-bench.js [max events] [threads] [budget]
+
+import { performance } from "perf_hooks";
+
+import { buildThreadContext, countTokens, getPromptStats } from "../utility/prompt-builder.js";
+
+const maxEvents = parseInt(process.argv[2] || "4000");
+const threadCount = parseInt(process.argv[3] || "12");
+const budget = parseInt(process.argv[4] || "3000");
+
+// Deterministic pseudo-random words
+let seed = 42;
+function random() {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed / 0x7fffffff;
+}
+function word(min, max) {
+  const length = min + Math.floor(random() * (max - min + 1));
+  let out = "";
+  for (let i = 0; i < length; i++) out += String.fromCharCode(97 + Math.floor(random() * 26));
+  return out;
+}
+function sentence(words) {
+  return Array.from({ length: words }, () => word(2, 10)).join(" ") + ". ";
+}
+
+// OCR-sized events, a session's worth a few seconds apart; about a third
+// repeat an earlier screen of their thread, as a static page does
+const threads = Array.from({ length: threadCount }, (_, i) => ({ topic: `topic ${word(4, 9)} ${i}`, events: [] }));
+const start = Date.parse("2025-04-17T09:00:00Z");
+function addEvent(i) {
+  const thread = threads[i % threadCount];
+  let text;
+  if (thread.events.length > 0 && random() < 0.33) {
+    text = thread.events[Math.floor(random() * thread.events.length)].text;
+  } else {
+    text = "";
+    while (text.length < 600) text += sentence(6 + Math.floor(random() * 10));
+    if (i % 97 === 0) text += " Compose - Inbox (3) - reply to the meeting invitation";
+  }
+  thread.events.push({
+    timestamp: new Date(start + i * 5000).toISOString(),
+    app_name: "Google Chrome",
+    window_name: `${word(4, 10)} - ${word(3, 8)}`,
+    browser_url: `https://${word(4, 8)}.com/${word(3, 6)}`,
+    text
+  });
+}
+
+const keywords = ["email", "mail", "inbox", "reply", "invitation", "meeting", "schedule"];
+
+console.log(`threads=${threadCount} budget=${budget} exact=${getPromptStats().exact}`);
+console.log("events   raw tokens   raw ms   context tokens   context ms   next ms   kept");
+
+let added = 0;
+for (let events = 250; events <= maxEvents; events *= 2) {
+  while (added < events) addEvent(added++);
+
+  let begin = performance.now();
+  const raw = countTokens(JSON.stringify(threads, null, 2));
+  const rawMs = performance.now() - begin;
+
+  begin = performance.now();
+  const context = buildThreadContext(threads, { maxTokens: budget, keywords });
+  const contextMs = performance.now() - begin;
+
+  addEvent(added++);
+  begin = performance.now();
+  buildThreadContext(threads, { maxTokens: budget, keywords });
+  const nextMs = performance.now() - begin;
+
+  console.log(
+    `${String(events).padStart(6)}   ${String(raw).padStart(10)}   ${rawMs.toFixed(1).padStart(6)}   ` +
+    `${String(context.tokens).padStart(14)}   ${contextMs.toFixed(1).padStart(10)}   ${nextMs.toFixed(1).padStart(7)}   ` +
+    `${context.kept}/${context.events}`
+  );
+}
@@ -0,0 +1,93 @@
+// Context queries against the inverted index in threads/thread-index.js as
+// history grows, measured every `step` events up to `events`; then the cost
+// of evicting finalised threads.
+//
+//   node bench/thread-index-bench.js [events] [threads] [step]
+
+import { performance } from "perf_hooks";
+
+import { ThreadIndex } from "../threads/thread-index.js";
+
+const eventCount = parseInt(process.argv[2] || "50000");
+const threadCount = parseInt(process.argv[3] || "500");
+const step = parseInt(process.argv[4] || "10000");
+const QUERIES = 200;
+
+// Deterministic pseudo-random text from a Zipf-ish vocabulary, so common
+// terms have long postings and rare ones short
+let seed = 42;
+function random() {
+  seed = (Math.imul(seed, 1103515245) + 12345) & 0x7fffffff;
+  return seed / 0x7fffffff;
+}
+const vocabulary = Array.from({ length: 50000 }, () => {
+  const length = 3 + Math.floor(random() * 8);
+  let out = "";
+  for (let i = 0; i < length; i++) out += String.fromCharCode(97 + Math.floor(random() * 26));
+  return out;
+});
+const wordAt = () => vocabulary[Math.floor(vocabulary.length * Math.pow(random(), 2))];
+function ocrText() {
+  let text = "";
+  while (text.length < 600) text += wordAt() + (random() < 0.1 ? ". " : " ");
+  return text;
+}
+
+const threads = Array.from({ length: threadCount }, (_, i) => ({ key: `topic ${i}`, topic: `topic ${i}`, events: [] }));
+const byKey = new Map(threads.map(t => [t.key, t]));
+const eventText = (e) => [e.app_name, e.window_name, e.text].join(" ");
+
+const index = new ThreadIndex({
+  textOf: (key, ordinal) => (ordinal < 0 ? byKey.get(key).topic : eventText(byKey.get(key).events[ordinal]))
+});
+for (const t of threads) index.addThread(t.key, t.topic);
+
+const queries = [
+  ["any of 6 (send-mail)", ["gmail", "mail.google.com", "inbox", "compose", "mail", "email"]],
+  ["phrase", ["compose email"]],
+  ["prefix", ["offic*"]],
+  ["boolean", { all: ["compose"], any: ["gmail", "outlook"], none: ["draft*"] }],
+  ["absent", ["zzyzx", "qwertyuiop"]]
+];
+
+function perQuery(fn) {
+  fn();
+  const start = performance.now();
+  for (let i = 0; i < QUERIES; i++) fn();
+  return (performance.now() - start) * 1000 / QUERIES;
+}
+
+let insertMs = 0;
+for (let i = 0; i < eventCount; i++) {
+  const thread = threads[i % threadCount];
+  let text = ocrText();
+  if (i % 997 === 0) text += " Compose email - Inbox (3) - someone@mail.google.com";
+  if (i % 1499 === 0) text += " Outlook - Office365";
+  const event = { app_name: "Google Chrome", window_name: `${wordAt()} - ${wordAt()}`, text };
+  thread.events.push(event);
+
+  const start = performance.now();
+  index.addEvent(thread.key, thread.events.length - 1, eventText(event));
+  insertMs += performance.now() - start;
+
+  if ((i + 1) % step !== 0 && i + 1 !== eventCount) continue;
+
+  const { terms, postings } = index.stats();
+  console.log(`\n${i + 1} events in ${threadCount} threads — ${terms} terms, ${postings} postings, ` +
+    `index insert ${(insertMs * 1e6 / (i + 1)).toFixed(0)} ns/event`);
+  const column = (us) => us.toFixed(1).padStart(8);
+  console.log(`  ${"".padEnd(22)} ${"some".padStart(8)} ${"query".padStart(8)}  µs (threads)`);
+  for (const [name, query] of queries) {
+    // isContextActive: index.some; getRelevantThreadsByKeywords: index.query
+    const some = perQuery(() => index.some(query));
+    const all = perQuery(() => index.query(query).size);
+    console.log(`  ${name.padEnd(22)} ${column(some)} ${column(all)}  (${index.query(query).size})`);
+  }
+}
+
+// Finalising every thread empties the index
+const start = performance.now();
+for (const t of threads) index.removeThread(t.key);
+const elapsed = performance.now() - start;
+console.log(`\nevicted ${threadCount} threads in ${elapsed.toFixed(1)} ms (${(elapsed * 1e3 / threadCount).toFixed(0)} µs/thread)`,
+  index.stats());
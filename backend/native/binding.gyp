@@ -0,0 +1,37 @@
+{
+  "targets": [
+    {
+      "target_name": "gem_native",
+      "sources": [
+        "src/addon.cc",
+        "src/matcher_binding.cc",
+        "src/neardup_binding.cc",
+        "src/threadstore_binding.cc",
+        "src/chunker_binding.cc",
+        "src/textkernels_binding.cc",
+        "src/textdelta_binding.cc",
+        "src/prompt_binding.cc",
+        "../../Gem/core/blacklistmatcher.cpp",
+        "../../Gem/core/simhash.cpp",
+        "../../Gem/core/eventlog.cpp",
+        "../../Gem/core/threadstore.cpp",
+        "../../Gem/core/textchunker.cpp",
+        "../../Gem/core/textkernels.cpp",
+        "../../Gem/core/textdelta.cpp",
+        "../../Gem/core/bpetokenizer.cpp",
+        "../../Gem/core/promptbuilder.cpp"
+      ],
+      "include_dirs": ["../../Gem/core"],
+      "defines": ["NAPI_VERSION=8"],
+      "cflags_cc": ["-std=c++17", "-O3"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "xcode_settings": {
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+        "GCC_OPTIMIZATION_LEVEL": "3"
+      },
+      "msvs_settings": {
+        "VCCLCompilerTool": { "AdditionalOptions": ["/std:c++17"] }
+      }
+    }
+  ]
+}
@@ -0,0 +1,18 @@
+#include "napi_util.h"
+
+// gem_native: the Gem/core libraries exposed to the node backend. Loaded
+// through backend/utility/native.js, which falls back to plain JS when the
+// addon has not been built.
+
+static napi_value Init(napi_env env, napi_value exports) {
+    if (!InitMatcher(env, exports)) return nullptr;
+    if (!InitNearDuplicate(env, exports)) return nullptr;
+    if (!InitThreadStore(env, exports)) return nullptr;
+    if (!InitTextChunker(env, exports)) return nullptr;
+    if (!InitTextKernels(env, exports)) return nullptr;
+    if (!InitTextDelta(env, exports)) return nullptr;
+    if (!InitPromptBuilder(env, exports)) return nullptr;
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,92 @@
+#include "napi_util.h"
+#include "bpetokenizer.h"
+#include "textchunker.h"
+#include <algorithm>
+
+// new TextChunker({ maxTokens, overlapTokens, vocab })   vocab as for PromptBuilder
+//   .split(text)       -> [{ text, tokens }]
+//   .countTokens(text) -> number
+
+namespace {
+
+std::string text;
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    napi_value options = argc > 0 ? args[0] : nullptr;
+    TextChunker::Options chunking;
+    chunking.maxTokens = size_t(std::max<int64_t>(getIntOption(env, options, "maxTokens", 2048), 1));
+    chunking.overlapTokens = size_t(std::max<int64_t>(getIntOption(env, options, "overlapTokens", 128), 0));
+
+    std::string vocab;
+    TextChunker::TokenCounter counter = estimateTokens;
+    if (getStringOption(env, options, "vocab", vocab) && !vocab.empty()) {
+        const BpeTokenizer *tokenizer = sharedTokenizer(env, vocab);
+        if (!tokenizer) return nullptr;
+        counter = [tokenizer](std::string_view t) { return tokenizer->count(t); };
+    }
+
+    TextChunker *chunker = new TextChunker(chunking, counter);
+    if (napi_wrap(env, self, chunker, [](napi_env, void *data, void *) {
+            delete static_cast<TextChunker*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete chunker;
+        napi_throw_error(env, nullptr, "could not wrap TextChunker");
+        return nullptr;
+    }
+    return self;
+}
+
+napi_value split(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    TextChunker *chunker = unwrapThis<TextChunker>(env, info, &argc, args);
+    if (!chunker) return nullptr;
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    const std::vector<TextChunker::Chunk> chunks = chunker->split(text);
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_array_with_length(env, chunks.size(), &result));
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const TextChunker::Chunk &chunk = chunks[i];
+        napi_value entry, body, tokens;
+        NAPI_CALL(env, napi_create_object(env, &entry));
+        NAPI_CALL(env, napi_create_string_utf8(env, text.data() + chunk.begin, chunk.end - chunk.begin, &body));
+        NAPI_CALL(env, napi_create_uint32(env, uint32_t(chunk.tokens), &tokens));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "text", body));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "tokens", tokens));
+        NAPI_CALL(env, napi_set_element(env, result, uint32_t(i), entry));
+    }
+    return result;
+}
+
+napi_value countTokens(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    TextChunker *chunker = unwrapThis<TextChunker>(env, info, &argc, args);
+    if (!chunker) return nullptr;
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_double(env, double(chunker->countTokens(text)), &result));
+    return result;
+}
+
+} // namespace
+
+napi_value InitTextChunker(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"split", nullptr, split, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"countTokens", nullptr, countTokens, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "TextChunker", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "TextChunker", constructor));
+    return exports;
+}
@@ -0,0 +1,97 @@
+#include "napi_util.h"
+#include "blacklistmatcher.h"
+
+// new BlacklistMatcher(patterns)
+//   .findFirst(text) -> index into patterns, or -1
+//   .matches(text)   -> boolean
+//   .size            -> number of distinct non-empty patterns
+
+namespace {
+
+BlacklistMatcher *unwrap(napi_env env, napi_callback_info info, napi_value *arg) {
+    size_t argc = arg ? 1 : 0;
+    return unwrapThis<BlacklistMatcher>(env, info, &argc, arg);
+}
+
+// Reused between calls; the addon is only ever used from the main thread
+std::string scratch;
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    std::vector<std::string> patterns;
+    if (argc > 0 && !getStringArray(env, args[0], patterns)) return nullptr;
+
+    BlacklistMatcher *matcher = new BlacklistMatcher(patterns);
+    if (napi_wrap(env, self, matcher, [](napi_env, void *data, void *) {
+            delete static_cast<BlacklistMatcher*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete matcher;
+        napi_throw_error(env, nullptr, "could not wrap BlacklistMatcher");
+        return nullptr;
+    }
+    return self;
+}
+
+napi_value findFirst(napi_env env, napi_callback_info info) {
+    napi_value arg = nullptr;
+    BlacklistMatcher *matcher = unwrap(env, info, &arg);
+    if (!matcher) return nullptr;
+
+    int index = -1;
+    napi_valuetype type = napi_undefined;
+    if (arg) napi_typeof(env, arg, &type);
+    if (type == napi_string) {
+        if (!getString(env, arg, scratch)) return nullptr;
+        index = matcher->findFirst(scratch);
+    }
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_int32(env, index, &result));
+    return result;
+}
+
+napi_value matches(napi_env env, napi_callback_info info) {
+    napi_value arg = nullptr;
+    BlacklistMatcher *matcher = unwrap(env, info, &arg);
+    if (!matcher) return nullptr;
+
+    bool found = false;
+    napi_valuetype type = napi_undefined;
+    if (arg) napi_typeof(env, arg, &type);
+    if (type == napi_string) {
+        if (!getString(env, arg, scratch)) return nullptr;
+        found = matcher->matches(scratch);
+    }
+
+    napi_value result;
+    NAPI_CALL(env, napi_get_boolean(env, found, &result));
+    return result;
+}
+
+napi_value size(napi_env env, napi_callback_info info) {
+    BlacklistMatcher *matcher = unwrap(env, info, nullptr);
+    if (!matcher) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_uint32(env, uint32_t(matcher->patterns().size()), &result));
+    return result;
+}
+
+} // namespace
+
+napi_value InitMatcher(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"findFirst", nullptr, findFirst, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"matches", nullptr, matches, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"size", nullptr, nullptr, size, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "BlacklistMatcher", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "BlacklistMatcher", constructor));
+    return exports;
+}
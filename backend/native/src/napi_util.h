@@ -0,0 +1,133 @@
+#ifndef NAPI_UTIL_H
+#define NAPI_UTIL_H
+
+#include <node_api.h>
+#include <string>
+#include <vector>
+
+// Small helpers shared by the bindings. On failure they leave a pending
+// JS exception and return false; callers then return nullptr.
+
+#define NAPI_CALL(env, call)                                              \
+    do {                                                                  \
+        if ((call) != napi_ok) {                                          \
+            const napi_extended_error_info *info = nullptr;               \
+            napi_get_last_error_info((env), &info);                       \
+            bool pending = false;                                         \
+            napi_is_exception_pending((env), &pending);                   \
+            if (!pending)                                                 \
+                napi_throw_error((env), nullptr,                          \
+                                 info && info->error_message              \
+                                     ? info->error_message                \
+                                     : "native call failed");             \
+            return nullptr;                                               \
+        }                                                                 \
+    } while (0)
+
+inline bool getString(napi_env env, napi_value value, std::string &out) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "expected a string");
+        return false;
+    }
+    out.resize(length);
+    napi_get_value_string_utf8(env, value, out.data(), length + 1, &length);
+    return true;
+}
+
+inline bool getStringArray(napi_env env, napi_value value, std::vector<std::string> &out) {
+    bool isArray = false;
+    napi_is_array(env, value, &isArray);
+    if (!isArray) {
+        napi_throw_type_error(env, nullptr, "expected an array of strings");
+        return false;
+    }
+
+    uint32_t length = 0;
+    napi_get_array_length(env, value, &length);
+    out.clear();
+    out.reserve(length);
+    for (uint32_t i = 0; i < length; ++i) {
+        napi_value element;
+        napi_get_element(env, value, i, &element);
+        std::string item;
+        if (!getString(env, element, item)) return false;
+        out.push_back(std::move(item));
+    }
+    return true;
+}
+
+// The wrapped native object behind `this`, filling up to *argc arguments
+template <typename T>
+T *unwrapThis(napi_env env, napi_callback_info info, size_t *argc, napi_value *argv) {
+    size_t none = 0;
+    napi_value self;
+    if (napi_get_cb_info(env, info, argc ? argc : &none, argv, &self, nullptr) != napi_ok) return nullptr;
+
+    void *object = nullptr;
+    if (napi_unwrap(env, self, &object) != napi_ok || !object) {
+        napi_throw_error(env, nullptr, "method called on the wrong object");
+        return nullptr;
+    }
+    return static_cast<T*>(object);
+}
+
+// Integer property of an options object, or fallback when absent
+inline int64_t getIntOption(napi_env env, napi_value options, const char *name, int64_t fallback) {
+    napi_valuetype type = napi_undefined;
+    if (!options || napi_typeof(env, options, &type) != napi_ok || type != napi_object) return fallback;
+
+    napi_value value;
+    if (napi_get_named_property(env, options, name, &value) != napi_ok) return fallback;
+    if (napi_typeof(env, value, &type) != napi_ok || type != napi_number) return fallback;
+
+    int64_t result = fallback;
+    napi_get_value_int64(env, value, &result);
+    return result;
+}
+
+inline bool getBoolOption(napi_env env, napi_value options, const char *name, bool fallback) {
+    napi_valuetype type = napi_undefined;
+    if (!options || napi_typeof(env, options, &type) != napi_ok || type != napi_object) return fallback;
+
+    napi_value value;
+    bool result = fallback;
+    if (napi_get_named_property(env, options, name, &value) != napi_ok) return fallback;
+    if (napi_get_value_bool(env, value, &result) != napi_ok) return fallback;
+    return result;
+}
+
+// String property of an options object; false when absent or not a string
+inline bool getStringOption(napi_env env, napi_value options, const char *name, std::string &out) {
+    napi_valuetype type = napi_undefined;
+    if (!options || napi_typeof(env, options, &type) != napi_ok || type != napi_object) return false;
+
+    napi_value value;
+    if (napi_get_named_property(env, options, name, &value) != napi_ok) return false;
+    if (napi_typeof(env, value, &type) != napi_ok || type != napi_string) return false;
+    return getString(env, value, out);
+}
+
+inline bool getInt64(napi_env env, napi_value value, int64_t &out) {
+    if (napi_get_value_int64(env, value, &out) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "expected a number");
+        return false;
+    }
+    return true;
+}
+
+// The BPE vocabulary at path, loaded once per process and kept (defined in
+// prompt_binding.cc); nullptr with a pending exception if it can't be read
+class BpeTokenizer;
+const BpeTokenizer *sharedTokenizer(napi_env env, const std::string &path);
+
+// Registration hooks, one per binding source
+napi_value InitMatcher(napi_env env, napi_value exports);
+napi_value InitNearDuplicate(napi_env env, napi_value exports);
+napi_value InitThreadStore(napi_env env, napi_value exports);
+napi_value InitTextChunker(napi_env env, napi_value exports);
+napi_value InitTextKernels(napi_env env, napi_value exports);
+napi_value InitTextDelta(napi_env env, napi_value exports);
+napi_value InitPromptBuilder(napi_env env, napi_value exports);
+
+#endif // NAPI_UTIL_H
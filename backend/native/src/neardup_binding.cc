@@ -0,0 +1,143 @@
+#include "napi_util.h"
+#include "simhash.h"
+
+// new NearDuplicateIndex({ maxDistance, capacity })
+//   .fingerprint(text)                  -> BigInt SimHash
+//   .lookup(scope, fingerprint)         -> { payload, distance } or null
+//   .insert(scope, fingerprint, payload)
+//   .stats()                            -> { hits, misses, inserts, evictions, size }
+//   .clear()
+
+namespace {
+
+std::string scope;
+std::string text;
+
+bool getFingerprint(napi_env env, napi_value value, uint64_t &out) {
+    bool lossless = true;
+    if (napi_get_value_bigint_uint64(env, value, &out, &lossless) != napi_ok) {
+        napi_throw_type_error(env, nullptr, "fingerprint must be a BigInt");
+        return false;
+    }
+    return true;
+}
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    napi_value options = argc > 0 ? args[0] : nullptr;
+    const int64_t maxDistance = getIntOption(env, options, "maxDistance", 6);
+    const int64_t capacity = getIntOption(env, options, "capacity", 4096);
+
+    NearDuplicateIndex *index = new NearDuplicateIndex(int(maxDistance), size_t(capacity > 0 ? capacity : 1));
+    if (napi_wrap(env, self, index, [](napi_env, void *data, void *) {
+            delete static_cast<NearDuplicateIndex*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete index;
+        napi_throw_error(env, nullptr, "could not wrap NearDuplicateIndex");
+        return nullptr;
+    }
+    return self;
+}
+
+napi_value fingerprint(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    if (!unwrapThis<NearDuplicateIndex>(env, info, &argc, args)) return nullptr;
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_bigint_uint64(env, simhash(text), &result));
+    return result;
+}
+
+napi_value lookup(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    NearDuplicateIndex *index = unwrapThis<NearDuplicateIndex>(env, info, &argc, args);
+    if (!index) return nullptr;
+
+    uint64_t print = 0;
+    if (argc < 2 || !getString(env, args[0], scope) || !getFingerprint(env, args[1], print)) return nullptr;
+
+    const NearDuplicateIndex::Match match = index->lookup(scope, print);
+
+    napi_value result;
+    if (!match) {
+        NAPI_CALL(env, napi_get_null(env, &result));
+        return result;
+    }
+
+    napi_value payload, distance;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_string_utf8(env, match.payload->data(), match.payload->size(), &payload));
+    NAPI_CALL(env, napi_create_int32(env, match.distance, &distance));
+    NAPI_CALL(env, napi_set_named_property(env, result, "payload", payload));
+    NAPI_CALL(env, napi_set_named_property(env, result, "distance", distance));
+    return result;
+}
+
+napi_value insert(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    NearDuplicateIndex *index = unwrapThis<NearDuplicateIndex>(env, info, &argc, args);
+    if (!index) return nullptr;
+
+    uint64_t print = 0;
+    std::string payload;
+    if (argc < 3 || !getString(env, args[0], scope) || !getFingerprint(env, args[1], print)
+        || !getString(env, args[2], payload))
+        return nullptr;
+
+    index->insert(scope, print, std::move(payload));
+    return nullptr;
+}
+
+napi_value stats(napi_env env, napi_callback_info info) {
+    NearDuplicateIndex *index = unwrapThis<NearDuplicateIndex>(env, info, nullptr, nullptr);
+    if (!index) return nullptr;
+
+    const NearDuplicateIndex::Stats &counters = index->stats();
+    const struct { const char *name; double value; } fields[] = {
+        {"hits", double(counters.hits)},
+        {"misses", double(counters.misses)},
+        {"inserts", double(counters.inserts)},
+        {"evictions", double(counters.evictions)},
+        {"size", double(index->size())},
+    };
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    for (const auto &field : fields) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_double(env, field.value, &value));
+        NAPI_CALL(env, napi_set_named_property(env, result, field.name, value));
+    }
+    return result;
+}
+
+napi_value clear(napi_env env, napi_callback_info info) {
+    NearDuplicateIndex *index = unwrapThis<NearDuplicateIndex>(env, info, nullptr, nullptr);
+    if (index) index->clear();
+    return nullptr;
+}
+
+} // namespace
+
+napi_value InitNearDuplicate(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"fingerprint", nullptr, fingerprint, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"lookup", nullptr, lookup, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"insert", nullptr, insert, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stats", nullptr, stats, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"clear", nullptr, clear, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "NearDuplicateIndex", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "NearDuplicateIndex", constructor));
+    return exports;
+}
@@ -0,0 +1,228 @@
+#include "napi_util.h"
+#include "bpetokenizer.h"
+#include "promptbuilder.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+// new PromptBuilder({ vocab })   vocab: tiktoken rank file; token estimates without
+//   .build(threads, { maxTokens, maxEventTokens, minEventTokens, halfLifeMs, keywords })
+//       threads: [{ topic, events: [{ timestamp, time, app_name, window_name, browser_url, text, delta }] }]
+//       -> { text, tokens, sourceTokens, events, kept, duplicates, truncated }
+//   .countTokens(text)         -> number
+//   .truncate(text, maxTokens) -> string
+//   .exact()                   -> true when counting with a vocabulary
+
+namespace {
+
+std::string text;
+
+struct Builder {
+    explicit Builder(const BpeTokenizer *tokenizer)
+        : tokenizer(tokenizer),
+          builder(tokenizer ? TextChunker::TokenCounter([tokenizer](std::string_view t) { return tokenizer->count(t); })
+                            : TextChunker::TokenCounter(estimateTokens)) {}
+
+    const BpeTokenizer *tokenizer;
+    PromptBuilder builder;
+};
+
+// Missing or mistyped fields read as empty, as JSON.stringify would drop them
+void readString(napi_env env, napi_value object, const char *name, std::string &out) {
+    out.clear();
+    napi_value value;
+    napi_valuetype type = napi_undefined;
+    if (napi_get_named_property(env, object, name, &value) != napi_ok) return;
+    if (napi_typeof(env, value, &type) != napi_ok || type != napi_string) return;
+    size_t length = 0;
+    napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+    out.resize(length);
+    napi_get_value_string_utf8(env, value, out.data(), length + 1, &length);
+}
+
+bool readThreads(napi_env env, napi_value array, std::vector<PromptBuilder::Thread> &threads) {
+    bool isArray = false;
+    napi_is_array(env, array, &isArray);
+    if (!isArray) {
+        napi_throw_type_error(env, nullptr, "expected an array of threads");
+        return false;
+    }
+
+    uint32_t count = 0;
+    napi_get_array_length(env, array, &count);
+    threads.resize(count);
+    for (uint32_t t = 0; t < count; ++t) {
+        napi_value thread, events;
+        napi_valuetype type = napi_undefined;
+        napi_get_element(env, array, t, &thread);
+        if (napi_typeof(env, thread, &type) != napi_ok || type != napi_object) continue;
+        readString(env, thread, "topic", threads[t].topic);
+
+        bool hasEvents = false;
+        if (napi_get_named_property(env, thread, "events", &events) != napi_ok) continue;
+        napi_is_array(env, events, &hasEvents);
+        if (!hasEvents) continue;
+
+        uint32_t eventCount = 0;
+        napi_get_array_length(env, events, &eventCount);
+        threads[t].events.resize(eventCount);
+        for (uint32_t e = 0; e < eventCount; ++e) {
+            napi_value event, field;
+            napi_get_element(env, events, e, &event);
+            if (napi_typeof(env, event, &type) != napi_ok || type != napi_object) continue;
+
+            PromptBuilder::Event &out = threads[t].events[e];
+            readString(env, event, "timestamp", out.timestamp);
+            readString(env, event, "app_name", out.app);
+            readString(env, event, "window_name", out.window);
+            readString(env, event, "browser_url", out.url);
+            readString(env, event, "text", out.text);
+            out.timeMs = getIntOption(env, event, "time", 0);
+            if (napi_get_named_property(env, event, "delta", &field) == napi_ok) {
+                bool delta = false;
+                if (napi_get_value_bool(env, field, &delta) == napi_ok) out.delta = delta;
+            }
+        }
+    }
+    return true;
+}
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    napi_value options = argc > 0 ? args[0] : nullptr;
+    std::string vocab;
+    const BpeTokenizer *tokenizer = nullptr;
+    if (getStringOption(env, options, "vocab", vocab) && !vocab.empty()) {
+        tokenizer = sharedTokenizer(env, vocab);
+        if (!tokenizer) return nullptr;
+    }
+
+    Builder *builder = new Builder(tokenizer);
+    if (napi_wrap(env, self, builder, [](napi_env, void *data, void *) {
+            delete static_cast<Builder*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete builder;
+        napi_throw_error(env, nullptr, "could not wrap PromptBuilder");
+        return nullptr;
+    }
+    return self;
+}
+
+napi_value build(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    Builder *builder = unwrapThis<Builder>(env, info, &argc, args);
+    if (!builder) return nullptr;
+
+    std::vector<PromptBuilder::Thread> threads;
+    if (argc < 1 || !readThreads(env, args[0], threads)) return nullptr;
+
+    napi_value options = argc > 1 ? args[1] : nullptr;
+    PromptBuilder::Options building;
+    building.maxTokens = size_t(std::max<int64_t>(getIntOption(env, options, "maxTokens", int64_t(building.maxTokens)), 1));
+    building.maxEventTokens = size_t(std::max<int64_t>(
+        getIntOption(env, options, "maxEventTokens", int64_t(building.maxEventTokens)), 1));
+    building.minEventTokens = size_t(std::max<int64_t>(
+        getIntOption(env, options, "minEventTokens", int64_t(building.minEventTokens)), 0));
+    building.halfLifeMs = std::max<int64_t>(getIntOption(env, options, "halfLifeMs", building.halfLifeMs), 1);
+
+    std::vector<std::string> keywords;
+    napi_value list;
+    napi_valuetype type = napi_undefined;
+    if (options && napi_typeof(env, options, &type) == napi_ok && type == napi_object &&
+        napi_get_named_property(env, options, "keywords", &list) == napi_ok &&
+        napi_typeof(env, list, &type) == napi_ok && type == napi_object &&
+        !getStringArray(env, list, keywords))
+        return nullptr;
+
+    const PromptBuilder::Result built = builder->builder.build(threads, keywords, building);
+
+    napi_value result, json;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_create_string_utf8(env, built.json.data(), built.json.size(), &json));
+    NAPI_CALL(env, napi_set_named_property(env, result, "text", json));
+
+    const struct { const char *name; double value; } fields[] = {
+        {"tokens", double(built.tokens)},
+        {"sourceTokens", double(built.sourceTokens)},
+        {"events", double(built.events)},
+        {"kept", double(built.kept)},
+        {"duplicates", double(built.duplicates)},
+        {"truncated", double(built.truncated)},
+    };
+    for (const auto &field : fields) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_double(env, field.value, &value));
+        NAPI_CALL(env, napi_set_named_property(env, result, field.name, value));
+    }
+    return result;
+}
+
+napi_value countTokens(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    Builder *builder = unwrapThis<Builder>(env, info, &argc, args);
+    if (!builder) return nullptr;
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_double(env, double(builder->builder.countTokens(text)), &result));
+    return result;
+}
+
+napi_value truncate(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    Builder *builder = unwrapThis<Builder>(env, info, &argc, args);
+    if (!builder) return nullptr;
+    int64_t maxTokens = 0;
+    if (argc < 2 || !getString(env, args[0], text) || !getInt64(env, args[1], maxTokens)) return nullptr;
+
+    const std::string cut = builder->builder.truncate(text, size_t(std::max<int64_t>(maxTokens, 0)));
+    napi_value result;
+    NAPI_CALL(env, napi_create_string_utf8(env, cut.data(), cut.size(), &result));
+    return result;
+}
+
+napi_value exact(napi_env env, napi_callback_info info) {
+    Builder *builder = unwrapThis<Builder>(env, info, nullptr, nullptr);
+    if (!builder) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_get_boolean(env, builder->tokenizer != nullptr, &result));
+    return result;
+}
+
+} // namespace
+
+const BpeTokenizer *sharedTokenizer(napi_env env, const std::string &path) {
+    static std::unordered_map<std::string, std::unique_ptr<BpeTokenizer>> tokenizers;
+
+    auto found = tokenizers.find(path);
+    if (found != tokenizers.end()) return found->second.get();
+
+    auto tokenizer = std::make_unique<BpeTokenizer>();
+    if (!tokenizer->load(path)) {
+        napi_throw_error(env, nullptr, tokenizer->lastError().c_str());
+        return nullptr;
+    }
+    return tokenizers.emplace(path, std::move(tokenizer)).first->second.get();
+}
+
+napi_value InitPromptBuilder(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"build", nullptr, build, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"countTokens", nullptr, countTokens, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"truncate", nullptr, truncate, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exact", nullptr, exact, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "PromptBuilder", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "PromptBuilder", constructor));
+    return exports;
+}
@@ -0,0 +1,164 @@
+#include "napi_util.h"
+#include "textdelta.h"
+#include <algorithm>
+
+// new TextDeltaTracker({ capacity, maxEdits })
+//   .update(scope, text) -> { baseline, spans: [{ text, line, lines }], changedLines,
+//                             totalLines, changedBytes, totalBytes }
+//   .peek(scope, text)   -> the same, without keeping text until
+//   .commit(scope)       -> boolean
+//   .forget(scope)
+//   .stats()             -> { frames, baselines, unchanged, bytesIn, bytesOut, evictions, size }
+//   .clear()
+
+namespace {
+
+std::string scope;
+std::string text;
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    napi_value options = argc > 0 ? args[0] : nullptr;
+    const int64_t capacity = getIntOption(env, options, "capacity", 256);
+    const int64_t maxEdits = getIntOption(env, options, "maxEdits", 1000);
+
+    TextDeltaTracker *tracker = new TextDeltaTracker(size_t(std::max<int64_t>(capacity, 1)),
+                                                     size_t(std::max<int64_t>(maxEdits, 1)));
+    if (napi_wrap(env, self, tracker, [](napi_env, void *data, void *) {
+            delete static_cast<TextDeltaTracker*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete tracker;
+        napi_throw_error(env, nullptr, "could not wrap TextDeltaTracker");
+        return nullptr;
+    }
+    return self;
+}
+
+// update and peek; span texts are cut from text
+napi_value diff(napi_env env, napi_callback_info info, bool keep) {
+    size_t argc = 2;
+    napi_value args[2];
+    TextDeltaTracker *tracker = unwrapThis<TextDeltaTracker>(env, info, &argc, args);
+    if (!tracker) return nullptr;
+    if (argc < 2 || !getString(env, args[0], scope) || !getString(env, args[1], text)) return nullptr;
+
+    const TextDeltaTracker::Delta delta = keep ? tracker->update(scope, text) : tracker->peek(scope, text);
+
+    napi_value result, spans, baseline;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    NAPI_CALL(env, napi_get_boolean(env, delta.baseline, &baseline));
+    NAPI_CALL(env, napi_set_named_property(env, result, "baseline", baseline));
+
+    // Spans start and end on a line, so never inside a UTF-8 sequence
+    NAPI_CALL(env, napi_create_array_with_length(env, delta.spans.size(), &spans));
+    for (size_t i = 0; i < delta.spans.size(); ++i) {
+        const TextDeltaTracker::Span &span = delta.spans[i];
+        napi_value entry, body, line, lines;
+        NAPI_CALL(env, napi_create_object(env, &entry));
+        NAPI_CALL(env, napi_create_string_utf8(env, text.data() + span.offset, span.length, &body));
+        NAPI_CALL(env, napi_create_uint32(env, uint32_t(span.line), &line));
+        NAPI_CALL(env, napi_create_uint32(env, uint32_t(span.lines), &lines));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "text", body));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "line", line));
+        NAPI_CALL(env, napi_set_named_property(env, entry, "lines", lines));
+        NAPI_CALL(env, napi_set_element(env, spans, uint32_t(i), entry));
+    }
+    NAPI_CALL(env, napi_set_named_property(env, result, "spans", spans));
+
+    const struct { const char *name; double value; } fields[] = {
+        {"changedLines", double(delta.changedLines)},
+        {"totalLines", double(delta.totalLines)},
+        {"changedBytes", double(delta.changedBytes)},
+        {"totalBytes", double(delta.totalBytes)},
+    };
+    for (const auto &field : fields) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_double(env, field.value, &value));
+        NAPI_CALL(env, napi_set_named_property(env, result, field.name, value));
+    }
+    return result;
+}
+
+napi_value update(napi_env env, napi_callback_info info) {
+    return diff(env, info, true);
+}
+
+napi_value peek(napi_env env, napi_callback_info info) {
+    return diff(env, info, false);
+}
+
+napi_value commit(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    TextDeltaTracker *tracker = unwrapThis<TextDeltaTracker>(env, info, &argc, args);
+    if (!tracker) return nullptr;
+    if (argc < 1 || !getString(env, args[0], scope)) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_get_boolean(env, tracker->commit(scope), &result));
+    return result;
+}
+
+napi_value forget(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    TextDeltaTracker *tracker = unwrapThis<TextDeltaTracker>(env, info, &argc, args);
+    if (!tracker) return nullptr;
+    if (argc < 1 || !getString(env, args[0], scope)) return nullptr;
+
+    tracker->forget(scope);
+    return nullptr;
+}
+
+napi_value stats(napi_env env, napi_callback_info info) {
+    TextDeltaTracker *tracker = unwrapThis<TextDeltaTracker>(env, info, nullptr, nullptr);
+    if (!tracker) return nullptr;
+
+    const TextDeltaTracker::Stats &counters = tracker->stats();
+    const struct { const char *name; double value; } fields[] = {
+        {"frames", double(counters.frames)},
+        {"baselines", double(counters.baselines)},
+        {"unchanged", double(counters.unchanged)},
+        {"bytesIn", double(counters.bytesIn)},
+        {"bytesOut", double(counters.bytesOut)},
+        {"evictions", double(counters.evictions)},
+        {"size", double(tracker->size())},
+    };
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    for (const auto &field : fields) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_double(env, field.value, &value));
+        NAPI_CALL(env, napi_set_named_property(env, result, field.name, value));
+    }
+    return result;
+}
+
+napi_value clear(napi_env env, napi_callback_info info) {
+    TextDeltaTracker *tracker = unwrapThis<TextDeltaTracker>(env, info, nullptr, nullptr);
+    if (tracker) tracker->clear();
+    return nullptr;
+}
+
+} // namespace
+
+napi_value InitTextDelta(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"update", nullptr, update, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"peek", nullptr, peek, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"commit", nullptr, commit, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"forget", nullptr, forget, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stats", nullptr, stats, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"clear", nullptr, clear, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "TextDeltaTracker", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "TextDeltaTracker", constructor));
+    return exports;
+}
@@ -0,0 +1,62 @@
+#include "napi_util.h"
+#include "textkernels.h"
+
+// normalizeText(text)     -> string
+// textKernel()            -> "avx2" | "sse4.2" | "scalar"
+// setTextKernel(name)     -> name actually in use (benchmarks)
+
+namespace {
+
+std::string text;
+std::string normalized;
+
+napi_value makeString(napi_env env, const char *value) {
+    napi_value result;
+    napi_create_string_utf8(env, value, NAPI_AUTO_LENGTH, &result);
+    return result;
+}
+
+napi_value normalize(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    normalizeText(text, normalized);
+    napi_value result;
+    NAPI_CALL(env, napi_create_string_utf8(env, normalized.data(), normalized.size(), &result));
+    return result;
+}
+
+napi_value kernel(napi_env env, napi_callback_info) {
+    return makeString(env, textKernelName(textKernel()));
+}
+
+napi_value setKernel(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, nullptr, nullptr));
+    if (argc < 1 || !getString(env, args[0], text)) return nullptr;
+
+    TextKernel wanted = TextKernel::Avx2;
+    if (text == "scalar") wanted = TextKernel::Scalar;
+    else if (text == "sse4.2") wanted = TextKernel::Sse42;
+    setTextKernel(wanted);
+    return makeString(env, textKernelName(textKernel()));
+}
+
+} // namespace
+
+napi_value InitTextKernels(napi_env env, napi_value exports) {
+    const struct { const char *name; napi_callback callback; } functions[] = {
+        {"normalizeText", normalize},
+        {"textKernel", kernel},
+        {"setTextKernel", setKernel},
+    };
+    for (const auto &function : functions) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_function(env, function.name, NAPI_AUTO_LENGTH, function.callback, nullptr, &value));
+        NAPI_CALL(env, napi_set_named_property(env, exports, function.name, value));
+    }
+    return exports;
+}
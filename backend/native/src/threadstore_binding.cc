@@ -0,0 +1,202 @@
+#include "napi_util.h"
+#include "threadstore.h"
+
+// new ThreadStore(directory, { readOnly, segmentBytes, compactBytes, maxAgeMs, maxBytes })
+//   .append(key, topicJson, timestampMs, eventJson) -> boolean
+//   .finalize(key, timestampMs) / .remove(key, timestampMs) -> boolean
+//   .clear(timestampMs) / .compact(nowMs) -> boolean
+//   .refresh() -> boolean (read-only stores: anything new?)
+//   .threads() -> [{ key, topic, created, lastUpdated, finalized, events }]
+//   .stats() -> { sequence, segments, logBytes, threads, discardedBytes }
+//   .lastError() -> string
+//   .close()
+//
+// Topic and events stay JSON strings; the caller parses them.
+
+namespace {
+
+std::string key;
+std::string payload;
+
+napi_value makeBool(napi_env env, bool value) {
+    napi_value result;
+    napi_get_boolean(env, value, &result);
+    return result;
+}
+
+napi_value construct(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2], self;
+    NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, &self, nullptr));
+
+    std::string directory;
+    if (argc < 1 || !getString(env, args[0], directory)) return nullptr;
+    napi_value options = argc > 1 ? args[1] : nullptr;
+
+    ThreadStore::Options storeOptions;
+    storeOptions.segmentBytes = uint64_t(getIntOption(env, options, "segmentBytes", int64_t(storeOptions.segmentBytes)));
+    storeOptions.compactBytes = uint64_t(getIntOption(env, options, "compactBytes", int64_t(storeOptions.compactBytes)));
+    storeOptions.maxAgeMs = getIntOption(env, options, "maxAgeMs", storeOptions.maxAgeMs);
+    storeOptions.maxBytes = uint64_t(getIntOption(env, options, "maxBytes", int64_t(storeOptions.maxBytes)));
+    const bool readOnly = getBoolOption(env, options, "readOnly", false);
+
+    ThreadStore *store = new ThreadStore(storeOptions);
+    if (!store->open(std::filesystem::u8path(directory), readOnly)) {
+        napi_throw_error(env, nullptr, store->lastError().c_str());
+        delete store;
+        return nullptr;
+    }
+
+    if (napi_wrap(env, self, store, [](napi_env, void *data, void *) {
+            delete static_cast<ThreadStore*>(data);
+        }, nullptr, nullptr) != napi_ok) {
+        delete store;
+        napi_throw_error(env, nullptr, "could not wrap ThreadStore");
+        return nullptr;
+    }
+    return self;
+}
+
+napi_value append(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, &argc, args);
+    if (!store) return nullptr;
+
+    std::string topic;
+    int64_t timestamp = 0;
+    if (argc < 4 || !getString(env, args[0], key) || !getString(env, args[1], topic)
+        || !getInt64(env, args[2], timestamp) || !getString(env, args[3], payload))
+        return nullptr;
+
+    return makeBool(env, store->append(key, topic, timestamp, payload));
+}
+
+// finalize(key, ts) and remove(key, ts)
+template <bool (ThreadStore::*Method)(const std::string &, int64_t)>
+napi_value keyed(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, &argc, args);
+    if (!store) return nullptr;
+
+    int64_t timestamp = 0;
+    if (argc < 2 || !getString(env, args[0], key) || !getInt64(env, args[1], timestamp)) return nullptr;
+    return makeBool(env, (store->*Method)(key, timestamp));
+}
+
+// clear(ts) and compact(now)
+template <bool (ThreadStore::*Method)(int64_t)>
+napi_value timed(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, &argc, args);
+    if (!store) return nullptr;
+
+    int64_t timestamp = 0;
+    if (argc < 1 || !getInt64(env, args[0], timestamp)) return nullptr;
+    return makeBool(env, (store->*Method)(timestamp));
+}
+
+napi_value refresh(napi_env env, napi_callback_info info) {
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, nullptr, nullptr);
+    if (!store) return nullptr;
+    return makeBool(env, store->refresh());
+}
+
+napi_value threads(napi_env env, napi_callback_info info) {
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, nullptr, nullptr);
+    if (!store) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_array_with_length(env, store->threads().size(), &result));
+
+    uint32_t index = 0;
+    for (const auto &entry : store->threads()) {
+        const StoredThread &thread = entry.second;
+        napi_value object, value, events;
+        NAPI_CALL(env, napi_create_object(env, &object));
+
+        NAPI_CALL(env, napi_create_string_utf8(env, thread.key.data(), thread.key.size(), &value));
+        NAPI_CALL(env, napi_set_named_property(env, object, "key", value));
+        NAPI_CALL(env, napi_create_string_utf8(env, thread.topic.data(), thread.topic.size(), &value));
+        NAPI_CALL(env, napi_set_named_property(env, object, "topic", value));
+        NAPI_CALL(env, napi_create_double(env, double(thread.created), &value));
+        NAPI_CALL(env, napi_set_named_property(env, object, "created", value));
+        NAPI_CALL(env, napi_create_double(env, double(thread.lastUpdated), &value));
+        NAPI_CALL(env, napi_set_named_property(env, object, "lastUpdated", value));
+        NAPI_CALL(env, napi_get_boolean(env, thread.finalized, &value));
+        NAPI_CALL(env, napi_set_named_property(env, object, "finalized", value));
+
+        NAPI_CALL(env, napi_create_array_with_length(env, thread.events.size(), &events));
+        for (uint32_t i = 0; i < thread.events.size(); ++i) {
+            const std::string &event = thread.events[i];
+            NAPI_CALL(env, napi_create_string_utf8(env, event.data(), event.size(), &value));
+            NAPI_CALL(env, napi_set_element(env, events, i, value));
+        }
+        NAPI_CALL(env, napi_set_named_property(env, object, "events", events));
+
+        NAPI_CALL(env, napi_set_element(env, result, index++, object));
+    }
+    return result;
+}
+
+napi_value stats(napi_env env, napi_callback_info info) {
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, nullptr, nullptr);
+    if (!store) return nullptr;
+
+    const struct { const char *name; double value; } fields[] = {
+        {"sequence", double(store->sequence())},
+        {"segments", double(store->log().segmentCount())},
+        {"logBytes", double(store->log().totalBytes())},
+        {"threads", double(store->threads().size())},
+        {"discardedBytes", double(store->log().discardedBytes())},
+    };
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_object(env, &result));
+    for (const auto &field : fields) {
+        napi_value value;
+        NAPI_CALL(env, napi_create_double(env, field.value, &value));
+        NAPI_CALL(env, napi_set_named_property(env, result, field.name, value));
+    }
+    return result;
+}
+
+napi_value lastError(napi_env env, napi_callback_info info) {
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, nullptr, nullptr);
+    if (!store) return nullptr;
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_string_utf8(env, store->lastError().data(), store->lastError().size(), &result));
+    return result;
+}
+
+napi_value closeStore(napi_env env, napi_callback_info info) {
+    ThreadStore *store = unwrapThis<ThreadStore>(env, info, nullptr, nullptr);
+    if (store) store->close();
+    return nullptr;
+}
+
+} // namespace
+
+napi_value InitThreadStore(napi_env env, napi_value exports) {
+    const napi_property_descriptor methods[] = {
+        {"append", nullptr, append, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"finalize", nullptr, keyed<&ThreadStore::finalize>, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"remove", nullptr, keyed<&ThreadStore::remove>, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"clear", nullptr, timed<&ThreadStore::clear>, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"compact", nullptr, timed<&ThreadStore::compact>, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"refresh", nullptr, refresh, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"threads", nullptr, threads, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"stats", nullptr, stats, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"lastError", nullptr, lastError, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"close", nullptr, closeStore, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+
+    napi_value constructor;
+    NAPI_CALL(env, napi_define_class(env, "ThreadStore", NAPI_AUTO_LENGTH, construct, nullptr,
+                                     sizeof(methods) / sizeof(methods[0]), methods, &constructor));
+    NAPI_CALL(env, napi_set_named_property(env, exports, "ThreadStore", constructor));
+    return exports;
+}
@@ -1,47 +1,133 @@
-import { createClient } from "redis";
 import crypto from "crypto";
 import { cleanOCR } from "./clean-ocr.js";
+import { createFrameDeltas } from "./frame-delta.js";
 import { parseLLMJson } from "../utility/llm-json-parser.js";
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
+import { native } from "../utility/native.js";
+import { redis, isRedisAvailable } from "../utility/cache-client.js";
 
-const redis = createClient();
+const logToFile = createLogger("ocr-cache");
 
-try {
-  await redis.connect();
-} catch (err) {
-  logToFile("❌ Redis failed to connect. Using LLM-only mode.");
-}
+// Near-duplicate reuse: frames whose SimHash is within this many bits of a
+// recent frame from the same app/window reuse its cleaned result
+const NEAR_DUP_DISTANCE = parseInt(process.env.OCR_NEAR_DUP_DISTANCE || "6");
+const NEAR_DUP_CAPACITY = parseInt(process.env.OCR_NEAR_DUP_CAPACITY || "4096");
+const NEAR_DUP_MIN_LENGTH = 40; // shorter texts give unstable fingerprints
+const STATS_EVERY = 50;
+
+const nearDuplicates = native && NEAR_DUP_DISTANCE >= 0
+  ? new native.NearDuplicateIndex({ maxDistance: NEAR_DUP_DISTANCE, capacity: NEAR_DUP_CAPACITY })
+  : null;
+if (!nearDuplicates) logToFile("⚠️ Near-duplicate OCR index disabled — exact cache only");
+
+// Frame deltas: when less than this share of a frame changed since the last
+// one from the same app/window, only the changed lines are cleaned
+const DELTA_MAX_CHANGE = parseFloat(process.env.OCR_DELTA_MAX_CHANGE || "0.6");
+// Letters and digits a change needs before it is worth a call of its own;
+// smaller ones add up until they are (npm run bench:delta)
+const DELTA_MIN_CHARS = parseInt(process.env.OCR_DELTA_MIN_CHARS || "120");
+const SCOPE_TOPICS_CAPACITY = 256;
+
+const deltas = createFrameDeltas({ maxChange: DELTA_MAX_CHANGE, minLength: DELTA_MIN_CHARS, capacity: SCOPE_TOPICS_CAPACITY });
+if (!deltas) logToFile("⚠️ OCR frame deltas disabled — cleaning whole frames");
+
+// Topic of each scope's last cleaned frame, which its deltas are filed under
+const scopeTopics = new Map();
+
+let lookups = 0;
+
+// Frames cleaned and, of those, how many needed the LLM: gem-ingest slows
+// its sweeps while the caches absorb most frames
+const cleaning = { frames: 0, llmCalls: 0 };
 
 function generateCacheKey(text) {
   const hash = crypto.createHash("sha256").update(text).digest("hex");
   return `ocr:${hash}`;
 }
 
-export async function getCleanedTextWithCache(rawText, app_name, window_name, browser_url) {
-  const key = generateCacheKey(rawText);
+function nearDuplicateScope(app_name, window_name) {
+  return `${app_name || ""}\u001f${window_name || ""}`;
+}
+
+function rememberTopic(scope, topic) {
+  if (!topic || topic === "unrecognised") return;
+  scopeTopics.delete(scope);
+  scopeTopics.set(scope, topic);
+  if (scopeTopics.size > SCOPE_TOPICS_CAPACITY) scopeTopics.delete(scopeTopics.keys().next().value);
+}
+
+export function getNearDuplicateStats() {
+  return nearDuplicates ? nearDuplicates.stats() : null;
+}
+
+export function getCleaningStats() {
+  return { ...cleaning };
+}
+
+// Parsed cleaned result under key, or null; a corrupt entry is dropped
+async function readCache(key) {
+  if (!isRedisAvailable()) {
+    logToFile("⚠️ Redis not available — skipping cache.");
+    return null;
+  }
+
   let cached = null;
-  if (isRedisAvailable()) {
-    try {
-      cached = await redis.get(key);
-    } catch (err) {
-      logToFile("❌ Redis GET failed — fallback to LLM", err);
+  try {
+    cached = await redis.get(key);
+  } catch (err) {
+    logToFile("❌ Redis GET failed — fallback to LLM", err);
+  }
+  if (!cached) return null;
+
+  try {
+    const json = JSON.parse(cached);
+    logToFile("🧠 Cached OCR", json);
+    return json;
+  } catch (e) {
+    logToFile("❌ Failed to parse cached OCR JSON", cached);
+    if (isRedisAvailable()) {
+      await redis.del(key);
     }
-  } else {
-    logToFile("⚠️ Redis not available — skipping cache.");
+    return null;
   }
-  if (cached) {
-    try {
-      const json = JSON.parse(cached);
-      logToFile("🧠 Cached OCR", json);
+}
+
+async function writeCache(key, cleanedJSON) {
+  if (isRedisAvailable()) {
+    await redis.set(key, JSON.stringify(cleanedJSON), { EX: 600 });
+    logToFile("✅ OCR Cache Updated", cleanedJSON);
+  }
+}
+
+function fingerprintOf(rawText) {
+  return nearDuplicates && String(rawText || "").length >= NEAR_DUP_MIN_LENGTH
+    ? nearDuplicates.fingerprint(rawText)
+    : null;
+}
+
+// A screen much like one already cleaned: the near-duplicate index, then the
+// exact cache. Results marked delta were cleaned as a delta and hold only
+// what changed then.
+async function findCleaned(scope, rawText, fingerprint) {
+  if (fingerprint !== null) {
+    const match = nearDuplicates.lookup(scope, fingerprint);
+    if (++lookups % STATS_EVERY === 0) logToFile("📊 Near-duplicate index", nearDuplicates.stats(), "debug");
+    if (match) {
+      const json = JSON.parse(match.payload);
+      logToFile("♻️ Near-duplicate OCR — reusing cleaned result", { distance: match.distance, topic: json.topic });
       return json;
-    } catch (e) {
-      logToFile("❌ Failed to parse cached OCR JSON", cached);
-      if (isRedisAvailable()) {
-        await redis.del(key);
-      }
     }
   }
 
+  const cached = await readCache(generateCacheKey(rawText));
+  if (cached && fingerprint !== null) nearDuplicates.insert(scope, fingerprint, JSON.stringify(cached));
+  return cached;
+}
+
+// A whole frame nothing had cleaned yet, through the LLM
+async function cleanFrame(scope, rawText, fingerprint, app_name, window_name, browser_url) {
+  const key = generateCacheKey(rawText);
+  cleaning.llmCalls++;
   const cleaned = await cleanOCR(rawText, app_name, window_name, browser_url);
   logToFile("🧼 LLM Cleaned OCR", cleaned);
 
@@ -50,19 +136,110 @@ export async function getCleanedTextWithCache(rawText, app_name, window_name, br
     return { cleaned_text: rawText, topic: "unrecognised" };
   }
 
-  if (isRedisAvailable()) {
-    await redis.set(key, JSON.stringify(cleanedJSON), { EX: 600 });
-    logToFile("✅ OCR Cache Updated", cleanedJSON);
-  }
+  if (fingerprint !== null) nearDuplicates.insert(scope, fingerprint, JSON.stringify(cleanedJSON));
+  await writeCache(key, cleanedJSON);
   return cleanedJSON;
 }
 
-export async function flushOcrCache() {
-  const keys = await redis.keys("ocr:*");
-  for (const key of keys) await redis.del(key);
-  logToFile(`🗑️ Flushed ${keys.length} OCR cache entries`);
+// Only the changed lines, cleaned with the screen's topic for context and
+// cached on both, since the same lines can turn up on different screens.
+// The result is filed under the screen's topic unless the LLM saw a new
+// one; an empty cleaned_text means the change was noise (a clock, a cursor).
+// The frame goes into the near-duplicate index, marked delta, so the
+// frames after it that barely differ cost nothing.
+async function cleanDelta(scope, fingerprint, step, previousTopic, app_name, window_name, browser_url) {
+  const { delta } = step;
+  const key = generateCacheKey(`${previousTopic}\u001f${step.text}`);
+
+  let cleanedJSON = await readCache(key);
+  if (!cleanedJSON) {
+    cleaning.llmCalls++;
+    const cleaned = await cleanOCR(step.text, app_name, window_name, browser_url, { previousTopic });
+    logToFile("🧼 LLM Cleaned OCR delta", cleaned);
+    cleanedJSON = parseLLMJson(cleaned);
+    if (!cleanedJSON) return { cleaned_text: step.text, topic: previousTopic, delta: true };
+    await writeCache(key, cleanedJSON);
+  }
+
+  logToFile("✂️ OCR delta cleaned", {
+    lines: `${delta.changedLines}/${delta.totalLines}`,
+    bytes: `${delta.changedBytes}/${delta.totalBytes}`,
+    topic: cleanedJSON.topic
+  });
+  const topic = cleanedJSON.topic && cleanedJSON.topic !== "unrecognised" ? cleanedJSON.topic : previousTopic;
+  const result = { cleaned_text: cleanedJSON.cleaned_text || "", topic, delta: true };
+  if (fingerprint !== null) nearDuplicates.insert(scope, fingerprint, JSON.stringify(result));
+  return result;
 }
 
-function isRedisAvailable() {
-  return redis?.isReady || redis?.status === "ready";
+// { cleaned_text, topic } for a frame; with frame deltas, also `delta` when
+// cleaned_text holds only what changed since the scope's last frame, or
+// `unchanged` (and no text) when nothing new needs filing.
+//
+// Every call pays for the same long instructions, so a delta is only
+// cleaned when the frame would cost a call anyway: one the near-duplicate
+// index or the exact cache already knows adds nothing to its thread, and is
+// left out of the baseline so that small changes add up to one delta.
+export async function getCleanedTextWithCache(rawText, app_name, window_name, browser_url) {
+  const scope = nearDuplicateScope(app_name, window_name);
+  const step = deltas ? deltas.next(scope, rawText) : null;
+  const previousTopic = scopeTopics.get(scope);
+  cleaning.frames++;
+  if (step && deltas.stats().frames % STATS_EVERY === 0) {
+    logToFile("📊 OCR frame deltas", deltas.stats(), "debug");
+  }
+
+  try {
+    if (step?.kind === "unchanged" && previousTopic) {
+      logToFile("⏸️ OCR frame unchanged — nothing to clean", { topic: previousTopic }, "debug");
+      return { cleaned_text: "", topic: previousTopic, unchanged: true };
+    }
+
+    const fingerprint = fingerprintOf(rawText);
+    const known = await findCleaned(scope, rawText, fingerprint);
+    if (known && (known.delta || (step?.kind === "delta" && previousTopic))) {
+      const topic = known.topic && known.topic !== "unrecognised" ? known.topic : previousTopic;
+      if (topic) return { cleaned_text: "", topic, unchanged: true };
+    }
+
+    let result = known && !known.delta ? known : null;
+    if (!result) {
+      result = step?.kind === "delta" && previousTopic
+        ? await cleanDelta(scope, fingerprint, step, previousTopic, app_name, window_name, browser_url)
+        : await cleanFrame(scope, rawText, fingerprint, app_name, window_name, browser_url);
+    }
+    deltas?.keep(scope); // cleaned, whole or as a delta: the next frame is diffed against this one
+    rememberTopic(scope, result.topic);
+    return result;
+  } catch (err) {
+    deltas?.forget(scope); // this frame never reached a thread
+    throw err;
+  }
+}
+
+const FLUSH_BATCH = 500;
+
+// One DELPREFIX on gem-cache; against a real Redis, which lacks it, SCAN in
+// batches and delete each batch with a single DEL
+export async function flushOcrCache() {
+  let flushed = 0;
+  if (isRedisAvailable()) {
+    try {
+      flushed = await redis.sendCommand(["DELPREFIX", "ocr:"]);
+    } catch {
+      let batch = [];
+      for await (const key of redis.scanIterator({ MATCH: "ocr:*", COUNT: FLUSH_BATCH })) {
+        batch.push(key);
+        if (batch.length >= FLUSH_BATCH) {
+          flushed += await redis.del(batch);
+          batch = [];
+        }
+      }
+      if (batch.length > 0) flushed += await redis.del(batch);
+    }
+  }
+  nearDuplicates?.clear();
+  deltas?.clear();
+  scopeTopics.clear();
+  logToFile(`🗑️ Flushed ${flushed} OCR cache entries`);
 }
\ No newline at end of file
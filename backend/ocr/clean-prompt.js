@@ -0,0 +1,50 @@
+// cleanOCR's prompt, apart from the client so the benches can count what a
+// call really sends, instructions and all. context.previousTopic: text is
+// only what changed on a screen already cleaned under that topic (see
+// frame-delta.js)
+export function cleanPrompt(text, app_name, window_name, browser_url, context = {}) {
+  const partial = context.previousTopic ? `
+The OCR input is only the part of the screen that changed since the previous capture. The rest of the screen was already cleaned under the topic "${context.previousTopic}". Keep that topic unless the new text clearly shows a different activity, and clean only the text given.
+` : "";
+
+  return `
+You are an intelligent screen text cleaner. You receive noisy OCR data from user screens and must extract only the relevant content.
+
+Instructions:
+- Remove noise such as browser tabs, bookmarks, IDE folders, or sidebar menus.
+- Identify the primary activity from the screen text.
+- Label this as a topic.
+- The topic should be of form: [activity] on [app name]/[window name]/[browser url] (Ex: Reading email regarding [topic] on [app name]/[window name]/[browser url], Shopping for [topic] on [app name]/[window name]/[browser url], etc.)
+- Use no adjectives or adverbs in the topic. (like "technical", "important", "urgent", etc.)
+- Return a **valid JSON** object in this format:
+{
+  "cleaned_text": "...",
+  "topic": "..."
+}
+
+For example, if the raw text is:
+  event '25: Invitation t X + C mail.google.com/mail/u/O/#inbox/FMfcgzQZVJwfJsnC in LinkedIn GitHub Google dev Google Colab cu outlook Google Careers Ims Devfolio Calendar ibm cuims Duolingo Coercive control : th... Adobe Acrobat C: Compiler Explorer SMS reqLkst format Gmail Compose Inbox 
+    Starred C) Snoozed Sent Drafts More Labels Q Search mail Google VO 2025 lof90 
+    < Invitation to attend Opening Ceremony of EVENT '25- Largest and most epic event IT'S TIME TO GET STARTED' We are beyond 
+    thrilled to announce the OPENING CEREMONY event '25; largest and most epic event' Join the Opening Ceremony LIVE! 
+    https://wwwyoutube/live/ 17 Date: April 11th A Time: 9 PM of During the ceremony we'll take you through the entire event 
+    process, addressing major areas of common doubts Mark your clocks and get ready to EMBARK ON THIS ADVENTURE' Stay tuned for 
+    more updates and get ready to YOUR WAY TO SUCCESS! e', Best regards, event '25 Organizing Team
+then the output should be:
+{
+  "cleaned_text": "Invitation to attend Opening Ceremony of EVENT '25- Largest and most epic event IT'S TIME TO GET STARTED' We are beyond 
+    thrilled to announce the OPENING CEREMONY event '25; largest and most epic event' Join the Opening Ceremony LIVE! 
+    https://wwwyoutube/live/ 17 Date: April 11th A Time: 9 PM of During the ceremony we'll take you through the entire event 
+    process, addressing major areas of common doubts Mark your clocks and get ready to EMBARK ON THIS ADVENTURE' Stay tuned for 
+    more updates and get ready to YOUR WAY TO SUCCESS! e', Best regards, event '25 Organizing Team",
+  "topic": "reading email regarding event invitation on gmail"
+}
+AND NO EXTRA TEXT OR EXPLANATIONS. ONLY RETURN A PARSABLE NO MARKDOWN JSON OBJECT.
+If nothing useful is found, return the original text as "cleaned_text" and "unrecognised" as the topic.
+
+The app name is "${app_name}", the window name is "${window_name}", and the browser url is "${browser_url}".
+Return the { "cleaned_text": str , "topic" : str} JSON ONLY
+${partial}OCR input:
+${text}
+`;
+}
@@ -0,0 +1,48 @@
+import { native } from "../utility/native.js";
+
+const WORDLESS = /[\s\p{P}\p{S}]+/gu;
+
+// Successive OCR frames of one app/window mostly repeat each other. The
+// native TextDeltaTracker diffs each frame against the scope's last one, so
+// only the lines with new content need cleaning — unless so much changed
+// (more than maxChange of the frame's bytes) that the frame is better
+// cleaned whole, as a new screen. Changes with fewer than minLength letters
+// and digits (a clock ticking, a counter, a line or so) count as nothing new
+// yet.
+//
+// next(scope, text) gives one of
+//   { kind: "full", delta }            clean text as it is
+//   { kind: "delta", text, delta }     clean only text: the changed lines
+//   { kind: "unchanged", delta }       nothing new on screen
+//
+// Unchanged and delta frames are not kept: the next one is diffed against
+// the last frame that was cleaned, so a change made a few letters (or
+// lines) at a time still adds up to one delta. keep(scope) makes the last
+// frame the baseline, once its delta is cleaned or when it is cleaned
+// whole after all.
+//
+// Null without the addon; callers then clean every frame whole.
+export function createFrameDeltas({ maxChange = 0.6, minLength = 12, capacity = 256, maxEdits = 1000 } = {}) {
+  if (!native?.TextDeltaTracker || !(maxChange > 0)) return null;
+  const tracker = new native.TextDeltaTracker({ capacity, maxEdits });
+
+  return {
+    next(scope, text) {
+      const delta = tracker.peek(scope, String(text || ""));
+      if (delta.baseline || delta.changedBytes > delta.totalBytes * maxChange) {
+        tracker.commit(scope);
+        return { kind: "full", delta };
+      }
+      const changed = delta.spans.map(span => span.text).join("\n");
+      if (changed.replace(WORDLESS, "").length < minLength) return { kind: "unchanged", delta };
+      return { kind: "delta", text: changed, delta };
+    },
+    // The last frame next() gave for scope becomes its baseline
+    keep: (scope) => tracker.commit(scope),
+    // After a frame that never made it into a thread: diff the next one
+    // against nothing
+    forget: (scope) => tracker.forget(scope),
+    stats: () => tracker.stats(),
+    clear: () => tracker.clear()
+  };
+}
@@ -0,0 +1,92 @@
+import { spawn } from "child_process";
+import { existsSync } from "fs";
+import path from "path";
+import readline from "readline";
+import { fileURLToPath } from "url";
+
+import { createLogger } from "../utility/logger.js";
+
+const logToFile = createLogger("ingest");
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+// Built by Gem/ingest next to the Gem executable
+const INGEST_BINARY = path.resolve(__dirname, "../../gem-ingest" + (process.platform === "win32" ? ".exe" : ""));
+
+const CREDIT_WINDOW = 4; // frames in flight between gem-ingest and the poller
+const RESTART_MIN_MS = 1000;
+const RESTART_MAX_MS = 30000;
+
+export function isNativeIngestAvailable() {
+  return existsSync(INGEST_BINARY);
+}
+
+// Runs gem-ingest and hands each frame to onFrame, one at a time. Credit is
+// returned only after onFrame settles, so the native queue absorbs bursts
+// and Screenpipe is not queried faster than we can clean frames.
+//
+// With cadence.adaptive, gem-ingest picks its own interval between
+// cadence.min and cadence.max seconds (pollFreq is where it starts) from
+// how fast the screen changes; cleaningStats() should return the running
+// { frames, llmCalls } counts, which are sent back after every sweep so it
+// can also slow down while the caches absorb most frames.
+export function startNativeIngest({ onFrame, onStatus, port, pollFreq, cadence, cleaningStats }) {
+  let cursor = 0;
+  let restartDelay = RESTART_MIN_MS;
+  let chain = Promise.resolve();
+
+  function launch() {
+    const args = ["--url", `http://localhost:${port}`, "--interval", String(pollFreq)];
+    if (cursor > 0) args.push("--cursor", String(cursor));
+    if (cadence?.adaptive) {
+      args.push("--adaptive", "--min-interval", String(cadence.min), "--max-interval", String(cadence.max));
+    }
+
+    const child = spawn(INGEST_BINARY, args, { stdio: ["pipe", "pipe", "inherit"] });
+    const lines = readline.createInterface({ input: child.stdout });
+
+    const grant = (n) => {
+      if (!child.stdin.destroyed) child.stdin.write(`credit ${n}\n`);
+    };
+
+    lines.on("line", (line) => {
+      let message;
+      try {
+        message = JSON.parse(line);
+      } catch {
+        return;
+      }
+
+      if (message.type === "ready") {
+        restartDelay = RESTART_MIN_MS;
+        grant(CREDIT_WINDOW);
+      } else if (message.type === "frame") {
+        const frame = message.frame;
+        chain = chain
+          .then(() => onFrame(frame))
+          .catch((err) => logToFile("❌ Frame handler failed", err))
+          .finally(() => {
+            cursor = Math.max(cursor, Date.parse(frame.timestamp) || 0);
+            grant(1);
+          });
+      } else if (message.type === "status") {
+        onStatus?.(message);
+        const stats = cadence?.adaptive ? cleaningStats?.() : null;
+        if (stats && !child.stdin.destroyed) child.stdin.write(`cleaned ${stats.frames} ${stats.llmCalls}\n`);
+      } else if (message.type === "error") {
+        logToFile("⚠️ gem-ingest sweep failed", message.message);
+      }
+    });
+
+    child.on("error", (err) => logToFile("❌ gem-ingest failed to start", err));
+    child.on("exit", (code, signal) => {
+      logToFile("⚠️ gem-ingest exited — restarting", { code, signal, restartDelay, cursor });
+      setTimeout(launch, restartDelay);
+      restartDelay = Math.min(restartDelay * 2, RESTART_MAX_MS);
+    });
+
+    logToFile("📥 gem-ingest started", { binary: INGEST_BINARY, args });
+  }
+
+  launch();
+}
@@ -1,35 +1,112 @@
 import { pipe } from "@screenpipe/js";
 
-import { addToThread, finalizeOldThreads, getActiveThreads } from "../threads/thread-manager.js";
-import { getCleanedTextWithCache } from "./cache-ocr.js";
+import { addToThread, touchThread, finalizeOldThreads, getActiveThreads } from "../threads/thread-manager.js";
+import { getCleanedTextWithCache, getCleaningStats } from "./cache-ocr.js";
+import { isNativeIngestAvailable, startNativeIngest } from "./native-ingest.js";
 import { startSuggestionPoller } from "../agent/agent-poller.js";
-import { logToFile } from "../utility/logger.js";
-import { getBlacklist } from "../utility/get-blacklist.js";
+import { createLogger } from "../utility/logger.js";
+import { getBlacklistMatcher } from "../utility/get-blacklist.js";
+import { onMessage, sendMessage } from "../utility/ipc-client.js";
+import { markThreaded, newTraceId, recordSpan, traceNow, traced } from "../utility/tracing.js";
 
 import { configDotenv } from "dotenv";
 import { fileURLToPath } from "url";
 import path from "path";
 
+const logToFile = createLogger("screenpipe-poller");
+
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 
 configDotenv({ path: path.resolve(__dirname, "../../.env") });
 
 const pollFreq = parseInt(process.env.POLL_FREQ || "10");
+// gem-ingest only, and opt-in until a gem-replay run shows it beats the
+// fixed intervals: adapt the interval between POLL_MIN and POLL_MAX
+// seconds to how fast the screen changes, starting from POLL_FREQ
+const pollAdaptive = process.env.POLL_ADAPTIVE === "1";
+const pollMin = parseInt(process.env.POLL_MIN || "2");
+const pollMax = parseInt(process.env.POLL_MAX || "30");
 const screenpipePort = process.env.SCREENPIPE_PORT || "3030";
 
-const IGNORED_APPS = getBlacklist().apps || [];
-const IGNORED_WINDOWS = getBlacklist().windows || [];
-
 if (typeof globalThis.self === "undefined") {
   globalThis.self = globalThis;
 }
 
 await pipe.settings.update({ server: `http://localhost:${screenpipePort}` });
 
+// Clean one OCR frame and file it into a thread. Frames use the SDK's field
+// names (appName, windowName, browserUrl, text, timestamp); trace is the
+// frame's latency trace id.
+async function processFrame(content, trace) {
+  // ignore if the app or window is blacklisted
+  const appName = content.appName || "";
+  const windowName = content.windowName || "";
+
+  if (getBlacklistMatcher().isIgnored(appName, windowName)) {
+    logToFile("🚫 Ignored App/Window", { appName, windowName });
+    return;
+  }
+
+  // clean raw text using LLM
+  const rawText = content.text;
+  const { cleaned_text, topic, delta, unchanged } = await traced(trace, "clean_ocr", () => getCleanedTextWithCache(
+    rawText, content.appName, content.windowName, content.browserUrl ?? content.browser_url
+  ));
+  logToFile("🧼 Cleaned OCR", { rawText, cleaned_text, topic, delta: Boolean(delta) });
+
+  // Same screen, nothing new worth keeping: the thread is still being
+  // worked on, so keep it from going stale, but add no event
+  if (!cleaned_text && topic && (unchanged || delta)) {
+    if (!touchThread(topic)) addToThread(topic, null);
+    markThreaded(trace);
+    return;
+  }
+  if (!cleaned_text) {
+    logToFile("⚠️ Skipped OCR input — no cleaned text produced.");
+    return;
+  }
+  if (!topic) {
+    logToFile("⚠️ Warning: No topic extracted from OCR.", { rawText });
+  }
+
+  // add to thread; a delta event carries only what this frame added to the
+  // screen, so the thread's events read on from the previous one
+  const threadStart = traceNow();
+  addToThread(topic, {
+    timestamp: content.timestamp,
+    app_name: content.appName,
+    window_name: content.windowName,
+    browser_url: content.browserUrl ?? content.browser_url,
+    text: cleaned_text,
+    ...(delta ? { delta: true } : {})
+  });
+  recordSpan(trace, "add_to_thread", threadStart);
+  markThreaded(trace);
+
+  // log active threads
+  const activeThreads = getActiveThreads();
+  for (const thread of activeThreads) {
+    logToFile("🧵 Active Thread", thread.topic);
+  }
+
+  // finalise threads and log them
+  const finalized = finalizeOldThreads();
+  if (finalized && finalized.length > 0) {
+    logToFile("🧵 Finalized Threads", finalized);
+    for (const thread of finalized) {
+      logToFile("\nThread:", thread.topic);
+      logToFile("App:", thread.app_name);
+      logToFile("Events:", thread.events.join("\n"));
+    }
+  }
+}
+
+// Fallback when gem-ingest is not built: one SDK query per interval
 async function extractAndCleanScreenData() {
   try {
     const now = new Date();
+    const queryStart = traceNow();
     const results = await pipe.queryScreenpipe({
       contentType: "ocr",
       limit: 1,
@@ -40,57 +117,12 @@ async function extractAndCleanScreenData() {
 
     logToFile("📷 Screenpipe Raw Response", results);
 
-    for (const item of results.data) {
-      // ignore if the app name is in the ignored list
-      const appName = (item.content.appName || "").toLowerCase();
-      const windowName = (item.content.windowName || "").toLowerCase();
-
-      const fromIgnoredApp = IGNORED_APPS.some(app => appName.includes(app));
-      const fromIgnoredWindow = IGNORED_WINDOWS.some(win => windowName.includes(win));
+    const queryEnd = traceNow();
 
-      if (fromIgnoredApp || fromIgnoredWindow) {
-        logToFile("🚫 Ignored App/Window", { appName, windowName });
-        continue;
-      }
-
-      // clean raw text using LLM
-      const rawText = item.content.text;
-      const { cleaned_text, topic } = await getCleanedTextWithCache(rawText);
-      logToFile("🧼 Cleaned OCR", { rawText, cleaned_text, topic });
-
-      if (!cleaned_text) {
-        logToFile("⚠️ Skipped OCR input — no cleaned text produced.");
-        continue;
-      }
-      if (!topic) {
-        logToFile("⚠️ Warning: No topic extracted from OCR.", { rawText });
-      }
-
-      // add to thread
-      addToThread(topic, {
-        timestamp: item.content.timestamp,
-        app_name: item.content.appName,
-        window_name: item.content.windowName,
-        browser_url: item.content.browser_url,
-        text: cleaned_text
-      });
-
-      // log active threads
-      const activeThreads = getActiveThreads();
-      for (const thread of activeThreads) {
-        logToFile("🧵 Active Thread", thread.topic);
-      }
-
-      // finalise threads and log them
-      const finalized = finalizeOldThreads();
-      if (finalized && finalized.length > 0) {
-        logToFile("🧵 Finalized Threads", finalized);
-        for (const thread of finalized) {
-          logToFile("\nThread:", thread.topic);
-          logToFile("App:", thread.app_name);
-          logToFile("Events:", thread.events.join("\n"));
-        }
-      }
+    for (const item of results.data) {
+      const trace = newTraceId();
+      recordSpan(trace, "screenpipe_query", queryStart, queryEnd);
+      await processFrame(item.content, trace);
     }
   } catch (err) {
     logToFile("❌ Poller Error", err.message);
@@ -98,5 +130,43 @@ async function extractAndCleanScreenData() {
   }
 }
 
+onMessage("connect", () => sendMessage("status", { text: "Running!" }));
+
 startSuggestionPoller();
-setInterval(extractAndCleanScreenData, pollFreq * 1000);
\ No newline at end of file
+
+if (isNativeIngestAvailable()) {
+  startNativeIngest({
+    port: screenpipePort,
+    pollFreq,
+    cadence: { adaptive: pollAdaptive, min: pollMin, max: pollMax },
+    cleaningStats: getCleaningStats,
+    onFrame: async (frame) => {
+      const trace = newTraceId();
+      if (frame.query) recordSpan(trace, "screenpipe_query", frame.query.start, frame.query.end);
+      try {
+        await processFrame(frame, trace);
+      } catch (err) {
+        logToFile("❌ Poller Error", err.message);
+      }
+    },
+    onStatus: (status) => {
+      if (status.new > 0 || status.duplicates > 0) logToFile("📷 Ingest sweep", status);
+      const { cadence } = status;
+      if (!cadence) return;
+      if (cadence.intervalMs !== cadence.previousMs) logToFile("⏱️ Capture cadence changed", cadence);
+      sendMessage("cadence", cadence);
+    }
+  });
+} else {
+  logToFile("⚠️ gem-ingest not found — using SDK polling");
+  setInterval(extractAndCleanScreenData, pollFreq * 1000);
+}
+
+// Under the Qt supervisor: announce readiness on stdout, and exit as soon as
+// the supervisor's end of the pipe closes so we never outlive the app.
+if (process.env.GEM_SUPERVISED) {
+  process.stdin.on("end", () => process.exit(0));
+  process.stdin.on("error", () => process.exit(0));
+  process.stdin.resume();
+  process.stdout.write("GEM_READY\n");
+}
\ No newline at end of file
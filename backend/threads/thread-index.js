@@ -0,0 +1,291 @@
+import { normalizeText } from "../utility/text-search.js";
+
+// Inverted index over the topic and events of the threads still active:
+// term -> thread keys, and per thread term -> ordinals of the events holding
+// it (-1 for the topic), ascending because events are only ever appended.
+// Kept up to date as events arrive and dropped thread by thread when they
+// are finalised, so a query costs what its postings cost, however long the
+// session has run.
+//
+// Keywords are normalised like everything else (utility/text-search.js) and
+// split into terms. A keyword of several terms is a phrase: all of them in
+// one event, in order and adjacent. A trailing "*" makes the last term a
+// prefix ("mail*" matches "mailbox"). Queries combine keywords:
+//
+//   "gmail"                               one keyword
+//   ["gmail", "inbox"]                    any of them
+//   { all: [...], any: [...], none: [...] }  every one of all, at least one
+//                                         of any, none of none; entries may
+//                                         nest further queries
+const TOPIC = -1;
+const BUCKET_LENGTH = 2; // terms are bucketed by their first characters for prefix lookups
+
+function parseKeyword(raw) {
+  const text = String(raw ?? "");
+  const terms = normalizeText(text).split(" ").filter(Boolean);
+  if (terms.length === 0) return null;
+  return { terms, prefix: /\*\s*$/.test(text) };
+}
+
+// Repeats are fine: a term already posted for this ordinal is skipped
+function termsOf(text) {
+  const normalized = normalizeText(text);
+  return normalized ? normalized.split(" ") : [];
+}
+
+// Merge of ascending ordinal lists, without duplicates
+function union(lists) {
+  if (lists.length === 1) return lists[0];
+  return [...new Set(lists.flat())].sort((a, b) => a - b);
+}
+
+function intersect(a, b) {
+  const out = [];
+  for (let i = 0, j = 0; i < a.length && j < b.length;) {
+    if (a[i] < b[j]) i++;
+    else if (a[i] > b[j]) j++;
+    else {
+      out.push(a[i]);
+      i++;
+      j++;
+    }
+  }
+  return out;
+}
+
+// Ordinals of a term in one thread: a number while there is one, since
+// most terms turn up in a single event of a thread
+function ordinalsOf(entry) {
+  return typeof entry === "number" ? [entry] : entry;
+}
+
+export class ThreadIndex {
+  // textOf(key, ordinal) returns the raw text of an event (or the topic for
+  // -1); only used to check phrase order on events that hold every term
+  constructor({ textOf } = {}) {
+    this.textOf = textOf;
+    this.threadTerms = new Map(); // key -> Map(term id -> ordinal or ordinals)
+    this.postings = [];           // term id -> Set(key)
+    this.termIds = new Map();     // term -> id; ids of dropped terms are reused
+    this.termNames = [];          // id -> term
+    this.freeIds = [];
+    this.buckets = new Map();     // term prefix -> Set(term)
+    this.postingCount = 0;
+  }
+
+  has(key) {
+    return this.threadTerms.has(key);
+  }
+
+  keys() {
+    return this.threadTerms.keys();
+  }
+
+  stats() {
+    return { threads: this.threadTerms.size, terms: this.termIds.size, postings: this.postingCount };
+  }
+
+  clear() {
+    this.threadTerms.clear();
+    this.postings = [];
+    this.termIds.clear();
+    this.termNames = [];
+    this.freeIds = [];
+    this.buckets.clear();
+    this.postingCount = 0;
+  }
+
+  // Index a whole thread: on creation, on load and when a finalised thread
+  // comes back to life
+  addThread(key, topic, events = []) {
+    this.removeThread(key);
+    this.addEvent(key, TOPIC, topic);
+    events.forEach((text, ordinal) => this.addEvent(key, ordinal, text));
+  }
+
+  // Small integer keys keep the per-thread maps cheap to build and to
+  // collect; there are millions of entries in a long session
+  addEvent(key, ordinal, text) {
+    let terms = this.threadTerms.get(key);
+    if (!terms) {
+      terms = new Map();
+      this.threadTerms.set(key, terms);
+    }
+
+    for (const term of termsOf(text)) {
+      const id = this.termIds.get(term) ?? this.addTerm(term);
+      const entry = terms.get(id);
+      if (entry === undefined) {
+        terms.set(id, ordinal);
+        this.postings[id].add(key);
+      } else if (typeof entry === "number") {
+        if (entry === ordinal) continue;
+        terms.set(id, [entry, ordinal]);
+      } else {
+        if (entry[entry.length - 1] === ordinal) continue;
+        entry.push(ordinal);
+      }
+      this.postingCount++;
+    }
+  }
+
+  addTerm(term) {
+    const id = this.freeIds.length > 0 ? this.freeIds.pop() : this.termNames.length;
+    this.termIds.set(term, id);
+    this.termNames[id] = term;
+    this.postings[id] = new Set();
+
+    const bucketKey = term.slice(0, BUCKET_LENGTH);
+    if (!this.buckets.has(bucketKey)) this.buckets.set(bucketKey, new Set());
+    this.buckets.get(bucketKey).add(term);
+    return id;
+  }
+
+  removeTerm(id) {
+    const term = this.termNames[id];
+    this.termIds.delete(term);
+    this.termNames[id] = undefined;
+    this.postings[id] = undefined;
+    this.freeIds.push(id);
+
+    const bucketKey = term.slice(0, BUCKET_LENGTH);
+    const bucket = this.buckets.get(bucketKey);
+    bucket.delete(term);
+    if (bucket.size === 0) this.buckets.delete(bucketKey);
+  }
+
+  // Drop every posting of a thread; costs what the thread holds
+  removeThread(key) {
+    const terms = this.threadTerms.get(key);
+    if (!terms) return;
+
+    for (const [id, entry] of terms) {
+      this.postingCount -= typeof entry === "number" ? 1 : entry.length;
+      const threads = this.postings[id];
+      threads.delete(key);
+      if (threads.size === 0) this.removeTerm(id);
+    }
+    this.threadTerms.delete(key);
+  }
+
+  // Indexed terms starting with prefix
+  expand(prefix) {
+    if (prefix.length >= BUCKET_LENGTH) {
+      const bucket = this.buckets.get(prefix.slice(0, BUCKET_LENGTH));
+      return bucket ? [...bucket].filter(term => term.startsWith(prefix)) : [];
+    }
+    const terms = [];
+    for (const [bucketKey, bucket] of this.buckets) {
+      if (bucketKey.startsWith(prefix)) terms.push(...bucket);
+    }
+    return terms;
+  }
+
+  // Ids of the terms a keyword term stands for, and the threads holding any
+  lookup(term, prefix) {
+    const ids = (prefix ? this.expand(term) : [term]).map(t => this.termIds.get(t)).filter(id => id !== undefined);
+    if (ids.length === 0) return { ids, threads: new Set() };
+    if (ids.length === 1) return { ids, threads: this.postings[ids[0]] };
+
+    const threads = new Set();
+    for (const id of ids) {
+      for (const key of this.postings[id]) threads.add(key);
+    }
+    return { ids, threads };
+  }
+
+  // Ordinals in one thread holding any of the terms
+  ordinals(key, ids) {
+    const entries = this.threadTerms.get(key);
+    const lists = [];
+    for (const id of ids) {
+      const entry = entries.get(id);
+      if (entry !== undefined) lists.push(ordinalsOf(entry));
+    }
+    return union(lists);
+  }
+
+  // Thread keys holding one keyword that accept(key) allows; only the first
+  // with first set. The returned set may be the index's own: don't modify.
+  matchKeyword(keyword, accept = null, first = false) {
+    const last = keyword.terms.length - 1;
+    const lookups = keyword.terms.map((term, i) => this.lookup(term, keyword.prefix && i === last));
+    const rarest = lookups.reduce((a, b) => (b.threads.size < a.threads.size ? b : a));
+    if (lookups.length === 1 && !accept && !first) return rarest.threads;
+
+    // Phrase: walk the threads of the rarest term, keep events holding every
+    // term, then check those few for the terms in order
+    const needle = " " + keyword.terms.join(" ") + (keyword.prefix ? "" : " ");
+    const matched = new Set();
+    for (const key of rarest.threads) {
+      if (accept && !accept(key)) continue;
+      if (lookups.length > 1 && !this.hasPhrase(key, lookups, rarest, needle)) continue;
+      matched.add(key);
+      if (first) break;
+    }
+    return matched;
+  }
+
+  hasPhrase(key, lookups, rarest, needle) {
+    let ordinals = this.ordinals(key, rarest.ids);
+    for (const lookup of lookups) {
+      if (lookup === rarest) continue;
+      if (!lookup.threads.has(key)) return false;
+      ordinals = intersect(ordinals, this.ordinals(key, lookup.ids));
+      if (ordinals.length === 0) return false;
+    }
+    return ordinals.some(ordinal =>
+      !this.textOf || (" " + normalizeText(this.textOf(key, ordinal)) + " ").includes(needle));
+  }
+
+  // Thread keys matching a query (see above); don't modify the result
+  query(query) {
+    if (query == null) return new Set();
+    if (typeof query === "string") {
+      const keyword = parseKeyword(query);
+      return keyword ? this.matchKeyword(keyword) : new Set();
+    }
+    if (Array.isArray(query)) return this.any(query);
+
+    const { all = [], any, none = [] } = query;
+    let result = null;
+    for (const part of all) {
+      const matched = this.query(part);
+      result = result ? new Set([...result].filter(key => matched.has(key))) : matched;
+      if (result.size === 0) return result;
+    }
+    if (any) {
+      const matched = this.any(any);
+      result = result ? new Set([...result].filter(key => matched.has(key))) : matched;
+    }
+    if (none.length > 0) {
+      const excluded = this.any(none);
+      // only exclusions: start from every thread
+      result = [...(result || this.keys())].filter(key => !excluded.has(key));
+      return new Set(result);
+    }
+    return result || new Set(this.keys());
+  }
+
+  any(queries) {
+    if (queries.length === 1) return this.query(queries[0]);
+    const result = new Set();
+    for (const part of queries) {
+      for (const key of this.query(part)) result.add(key);
+    }
+    return result;
+  }
+
+  // Does any thread accept(key) allows match the query; stops at the first
+  some(query, accept = () => true) {
+    if (typeof query === "string") {
+      const keyword = parseKeyword(query);
+      return keyword ? this.matchKeyword(keyword, accept, true).size > 0 : false;
+    }
+    if (Array.isArray(query)) return query.some(part => this.some(part, accept));
+    for (const key of this.query(query)) {
+      if (accept(key)) return true;
+    }
+    return false;
+  }
+}
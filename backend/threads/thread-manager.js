@@ -1,53 +1,144 @@
 import fs from "fs";
 import path from "path";
-import { fileURLToPath } from "url";
 
-import { logToFile } from "../utility/logger.js";
-import { getBlacklist } from "../utility/get-blacklist.js";
+import { createLogger } from "../utility/logger.js";
+import { getBlacklistMatcher } from "../utility/get-blacklist.js";
+import { native } from "../utility/native.js";
+import { configPath } from "../utility/config-path.js";
+import { sendMessage } from "../utility/ipc-client.js";
+import { ThreadIndex } from "./thread-index.js";
 
-let threads = new Map(); // store threads in memory
+const logToFile = createLogger("threads");
 
-const __dirname = path.dirname(fileURLToPath(import.meta.url));
+let threads = new Map(); // store threads in memory
 
 const THREAD_TTL_MS = 60 * 10 * 1000; // 10 minutes
-const THREADS_FILE = path.resolve(__dirname, "../../config/threads.json");
+const THREADS_FILE = configPath("threads.json");
+const THREADS_DIR = configPath("threads");
+const THREAD_RETENTION_MS = parseFloat(process.env.THREAD_RETENTION_DAYS || "7") * 24 * 60 * 60 * 1000;
+const JSON_SAVE_DELAY_MS = 1000; // threads.json fallback only
+const CHANGE_NOTIFY_MS = 250;
+
+// Append-only native store (one record per event) when the addon is built;
+// otherwise threads.json, rewritten at most once per JSON_SAVE_DELAY_MS.
+const store = openStore();
+let saveTimer = null;
+
+function openStore() {
+  if (!native) return null;
+  try {
+    const opened = new native.ThreadStore(THREADS_DIR, { maxAgeMs: THREAD_RETENTION_MS });
+    const warning = opened.lastError();
+    if (warning) logToFile("⚠️ Thread store recovered", warning);
+    return opened;
+  } catch (err) {
+    logToFile("❌ Failed to open thread store — falling back to threads.json", err);
+    return null;
+  }
+}
+
+// Lets the app's Threads tab read what changed instead of polling; once per
+// CHANGE_NOTIFY_MS at most, after the change is on disk
+let changeTimer = null;
+
+function announceChange() {
+  if (changeTimer) return;
+  changeTimer = setTimeout(() => {
+    changeTimer = null;
+    sendMessage("threads_changed", { threads: threads.size });
+  }, CHANGE_NOTIFY_MS);
+  changeTimer.unref?.();
+}
 
-const IGNORED_APPS = getBlacklist().apps || [];
-const IGNORED_WINDOWS = getBlacklist().windows || [];
+function parseStored(json) {
+  try {
+    return JSON.parse(json);
+  } catch {
+    return json;
+  }
+}
 
-// normalise text for processing
-function normalizeText(text) {
+// Thread keys; kept as they were so stored threads line up with new events
+function topicKeyOf(text) {
   return String(text || "").toLowerCase().replace(/[^a-z0-9]/gi, " ").trim();
 }
 
-// get all currently non-finalized threads
-function getActiveThreads() {
-  finalizeOldThreads();
+function topicOf(thread) {
+  return typeof thread.topic === "string" ? thread.topic : thread.topic?.topic || "";
+}
 
-  return Array.from(threads.values()).filter(t => {
-    if (t.finalized) return false;
+// What of an event a keyword can match (events are objects, not text)
+function eventText(event) {
+  if (!event || typeof event !== "object") return String(event ?? "");
+  return [event.app_name, event.window_name, event.browser_url, event.text].filter(Boolean).join(" ");
+}
 
-    const latestEvent = t.events?.slice(-1)[0] || {};
-    const appName = (latestEvent.app_name || "").toLowerCase();
-    const windowName = (latestEvent.window_name || "").toLowerCase();
+// Keyword index over the non-finalised threads, kept up to date as events
+// arrive; finalised threads leave it
+const index = new ThreadIndex({
+  textOf(key, ordinal) {
+    const thread = threads.get(key);
+    return ordinal < 0 ? topicOf(thread) : eventText(thread.events[ordinal]);
+  }
+});
+
+// Keys of the non-finalised threads, so neither the finalise sweep nor the
+// active list walks finished history
+const activeKeys = new Set();
+let nextSweepAt = 0;      // no thread can go stale before this
+let activeCache = null;   // { blacklist, entries: [[key, thread]], keys }
+
+function activate(key, thread) {
+  activeKeys.add(key);
+  index.addThread(key, topicOf(thread), (thread.events || []).map(eventText));
+  nextSweepAt = Math.min(nextSweepAt, thread.last_updated + THREAD_TTL_MS);
+}
+
+function rebuildActive() {
+  activeKeys.clear();
+  index.clear();
+  nextSweepAt = 0;
+  activeCache = null;
+  for (const [key, thread] of threads) {
+    if (!thread.finalized) activate(key, thread);
+  }
+}
 
-    const fromIgnoredApp = IGNORED_APPS.some(app => appName.includes(app));
-    const fromIgnoredWindow = IGNORED_WINDOWS.some(win => windowName.includes(win));
+// Active threads whose latest event is not blacklisted; rebuilt only when a
+// thread changes or the blacklist does
+function activeEntries() {
+  finalizeOldThreads();
+  const blacklist = getBlacklistMatcher();
+  if (activeCache && activeCache.blacklist === blacklist) return activeCache;
 
-    return !fromIgnoredApp && !fromIgnoredWindow;
-  });
+  const entries = [];
+  for (const key of activeKeys) {
+    const thread = threads.get(key);
+    const latestEvent = thread.events?.slice(-1)[0] || {};
+    if (!blacklist.isIgnored(latestEvent.app_name, latestEvent.window_name)) entries.push([key, thread]);
+  }
+  activeCache = { blacklist, entries, keys: new Set(entries.map(([key]) => key)) };
+  return activeCache;
+}
+
+// get all currently non-finalized threads
+function getActiveThreads() {
+  return activeEntries().entries.map(([, thread]) => thread);
 }
 
 // get the most recent thread
 function getMostRecentThread() {
-  const activeThreads = getActiveThreads();
-  return activeThreads.sort((a, b) => b.last_updated - a.last_updated)[0] || null;
+  let latest = null;
+  for (const [, thread] of activeEntries().entries) {
+    if (!latest || thread.last_updated > latest.last_updated) latest = thread;
+  }
+  return latest;
 }
 
 // add a new event to a thread or create a new thread if it doesn't exist
 function addToThread(topic, event) {
   const now = Date.now();
-  const topicKey = normalizeText(
+  const topicKey = topicKeyOf(
     typeof topic === "string" ? topic : topic.topic || JSON.stringify(topic)
   );
 
@@ -55,126 +146,212 @@ function addToThread(topic, event) {
     const thread = threads.get(topicKey);
     if (event) thread.events.push(event);
     thread.last_updated = now;
-    thread.finalized = false; // thread is not stale
+    if (thread.finalized) {
+      thread.finalized = false; // thread is not stale
+      activate(topicKey, thread);
+    } else if (event) {
+      index.addEvent(topicKey, thread.events.length - 1, eventText(event));
+    }
   } else {
-    threads.set(topicKey, {
+    const thread = {
       topic,
       events: event ? [event] : [],
       created: now,
       last_updated: now,
       finalized: false,
-    });
+    };
+    threads.set(topicKey, thread);
+    activate(topicKey, thread);
+  }
+  activeCache = null;
+
+  if (store) {
+    if (!store.append(topicKey, JSON.stringify(topic), now, event ? JSON.stringify(event) : "")) {
+      logToFile("❌ Thread store append failed", store.lastError());
+    }
+    announceChange();
+  } else {
+    scheduleJsonSave();
   }
+}
 
-  saveThreadsToDisk();
+// The screen behind an active thread is still up but shows nothing new:
+// keep the thread from going stale, in memory only — no store record and no
+// threads_changed for what would be a frame-rate stream of empty events.
+// False when the thread is not active; addToThread revives it.
+function touchThread(topic) {
+  const topicKey = topicKeyOf(
+    typeof topic === "string" ? topic : topic.topic || JSON.stringify(topic)
+  );
+  const thread = threads.get(topicKey);
+  if (!thread || thread.finalized) return false;
+  thread.last_updated = Date.now();
+  return true;
 }
 
 // if a thread has not been updated for a while, mark it as finalized
+// (only walks the active threads, and only once one may have gone stale)
 function finalizeOldThreads() {
   const now = Date.now();
-  for (const thread of threads.values()) {
-    if (!thread.finalized && now - thread.last_updated > THREAD_TTL_MS) {
+  if (now <= nextSweepAt) return;
+
+  let oldest = Infinity;
+  for (const key of activeKeys) {
+    const thread = threads.get(key);
+    if (now - thread.last_updated > THREAD_TTL_MS) {
       thread.finalized = true;
+      activeKeys.delete(key);
+      index.removeThread(key);
+      activeCache = null;
+      if (store) {
+        store.finalize(key, now);
+        announceChange();
+      } else {
+        scheduleJsonSave();
+      }
+    } else {
+      oldest = Math.min(oldest, thread.last_updated);
     }
   }
+  nextSweepAt = oldest + THREAD_TTL_MS;
 }
 
-function isContextActive(keywords = []) {
-  const activeThreads = getActiveThreads();
+// Active threads matching a keyword query: a keyword, an array of them (any)
+// or { all, any, none } — see thread-index.js
+function queryThreads(query) {
+  const matched = index.query(query);
+  if (matched.size === 0) return [];
 
-  return activeThreads.some(thread => {
-    const rawTopic = typeof thread.topic === "string" ? thread.topic : thread.topic?.topic || "";
-    const topic = normalizeText(rawTopic);
-    const eventStrings = (thread.events || []).map(e => normalizeText(e));
+  // activeEntries has already dropped blacklisted apps and windows
+  const { entries, keys } = activeEntries();
+  if (matched.size < entries.length) {
+    return [...matched].filter(key => keys.has(key)).map(key => threads.get(key));
+  }
+  return entries.filter(([key]) => matched.has(key)).map(([, thread]) => thread);
+}
 
-    return keywords.some(keyword => {
-      const normKeyword = normalizeText(keyword);
-      return topic.includes(normKeyword) || eventStrings.some(e => e.includes(normKeyword));
-    });
-  });
+// Does any active thread's topic or an event mention one of the keywords
+function isContextActive(keywords = []) {
+  const { keys } = activeEntries();
+  return index.some(keywords, key => keys.has(key));
 }
 
 function getRelevantThreadsByKeywords(keywords = []) {
-  const activeThreads = getActiveThreads();
+  return queryThreads(keywords);
+}
 
-  return activeThreads.filter(thread => {
-    const latestEvent = thread.events?.slice(-1)[0] || {};
-    const appName = (latestEvent.app_name || "").toLowerCase();
-    const windowName = (latestEvent.window_name || "").toLowerCase();
-
-    // Skip if it's from our own app
-    if (
-      IGNORED_APPS.some(a => appName.includes(a)) ||
-      IGNORED_WINDOWS.some(w => windowName.includes(w))
-    ) {
-      return false;
-    }
+function scheduleJsonSave() {
+  if (saveTimer) return;
+  saveTimer = setTimeout(() => {
+    saveTimer = null;
+    saveThreadsToDisk();
+  }, JSON_SAVE_DELAY_MS);
+  saveTimer.unref?.();
+}
 
-    // Keyword match
-    const topicText = normalizeText(
-      typeof thread.topic === "string" ? thread.topic : thread.topic?.topic || ""
-    );
+// Checkpoint: compacts the store into a snapshot, or writes threads.json
+function saveThreadsToDisk() {
+  if (store) {
+    if (!store.compact(Date.now())) logToFile("❌ Thread store compaction failed", store.lastError());
+    return;
+  }
 
-    return keywords.some(keyword =>
-      topicText.includes(normalizeText(keyword)) ||
-      thread.events.some(e => normalizeText(e).includes(normalizeText(keyword)))
-    );
-  });
+  if (saveTimer) {
+    clearTimeout(saveTimer);
+    saveTimer = null;
+  }
+  try {
+    fs.mkdirSync(path.dirname(THREADS_FILE), { recursive: true });
+    fs.writeFileSync(THREADS_FILE, JSON.stringify(Object.fromEntries(threads)));
+    announceChange();
+  } catch (err) {
+    logToFile("❌ Failed to save threads.json", err);
+  }
 }
 
-function saveThreadsToDisk() {
-  const obj = Object.fromEntries(threads);
-  const resolvedPath = path.resolve(THREADS_FILE);
-  const workingDir = process.cwd();
+function readThreadsFile() {
+  if (!fs.existsSync(THREADS_FILE)) {
+    logToFile("📁 threads.json not found — starting fresh.");
+    return new Map();
+  }
 
-  logToFile("💾 Saving threads to", {
-    path: resolvedPath,
-    cwd: workingDir,
-    __dirname
-  });
+  const raw = fs.readFileSync(THREADS_FILE, "utf8").trim();
+  if (!raw) {
+    logToFile("📁 threads.json is empty — starting fresh.");
+    return new Map();
+  }
 
-  fs.mkdirSync(path.dirname(THREADS_FILE), { recursive: true });
-  fs.writeFileSync(THREADS_FILE, JSON.stringify(obj, null, 2));
+  return new Map(Object.entries(JSON.parse(raw)));
 }
 
+// One-off import of a threads.json written before the store existed
+function migrateThreadsFile() {
+  const legacy = readThreadsFile();
+  for (const [key, thread] of legacy) {
+    const topic = JSON.stringify(thread.topic);
+    const created = thread.created || Date.now();
+    store.append(key, topic, created, "");
+    for (const event of thread.events || []) store.append(key, topic, created, JSON.stringify(event));
+    store.append(key, topic, thread.last_updated || created, "");
+    if (thread.finalized) store.finalize(key, thread.last_updated || created);
+  }
+  fs.renameSync(THREADS_FILE, THREADS_FILE + ".migrated");
+  logToFile("📦 Migrated threads.json into the thread store", { threads: legacy.size });
+}
 
 function loadThreadsFromDisk() {
   try {
-    if (!fs.existsSync(THREADS_FILE)) {
-      threads = new Map();
-      logToFile("📁 threads.json not found — starting fresh.");
-      return;
-    }
+    if (store) {
+      if (store.stats().threads === 0 && fs.existsSync(THREADS_FILE)) migrateThreadsFile();
+
+      // Folds the replayed tail into a fresh snapshot and applies retention
+      store.compact(Date.now());
 
-    const raw = fs.readFileSync(THREADS_FILE, "utf8").trim();
-    if (!raw) {
       threads = new Map();
-      logToFile("📁 threads.json is empty — starting fresh.");
+      for (const stored of store.threads()) {
+        threads.set(stored.key, {
+          topic: parseStored(stored.topic),
+          events: stored.events.map(parseStored),
+          created: stored.created,
+          last_updated: stored.lastUpdated,
+          finalized: stored.finalized,
+        });
+      }
+      rebuildActive();
+      logToFile("✅ Threads loaded from the thread store.", store.stats());
       return;
     }
 
-    const parsed = JSON.parse(raw);
-    threads = new Map(Object.entries(parsed));
+    threads = readThreadsFile();
+    rebuildActive();
     logToFile("✅ threads.json loaded from disk.");
   } catch (err) {
     threads = new Map(); // still fallback
-    logToFile("❌ Failed to load threads from disk", err, "loadThreadsFromDisk");
+    rebuildActive();
+    logToFile("❌ Failed to load threads from disk", err);
   }
 }
 
 function clearThreadsFile() {
+  if (store) {
+    store.clear(Date.now());
+    announceChange();
+  }
   if (fs.existsSync(THREADS_FILE)) fs.unlinkSync(THREADS_FILE);
   threads.clear();
+  rebuildActive();
 }
 
 loadThreadsFromDisk();
 
 export {
   addToThread,
+  touchThread,
   getActiveThreads,
   getMostRecentThread,
   isContextActive,
   getRelevantThreadsByKeywords,
+  queryThreads,
   finalizeOldThreads,
   saveThreadsToDisk,
   loadThreadsFromDisk,
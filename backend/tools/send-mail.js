@@ -1,24 +1,17 @@
-import { logToFile } from "../utility/logger.js";
+import { createLogger } from "../utility/logger.js";
+import { getSetting } from "../utility/settings.js";
 import { isContextActive, getRelevantThreadsByKeywords } from "../threads/thread-manager.js";
 
 import { exec } from "child_process";
 
-import { readFileSync } from "fs";
-import path from "path";
-import { fileURLToPath } from "url";
-
-const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const logToFile = createLogger("send-mail");
 
 export async function sendMail({ to, subject, body }) {
   const subjectEncoded = encodeURIComponent(subject);
   const bodyEncoded = encodeURIComponent(body);
   const toEncoded = encodeURIComponent(to);
 
-  const settingsPath = path.resolve(__dirname, "../../config/settings.json");
-  let preferredMethod = null;
-  try {
-    preferredMethod = JSON.parse(readFileSync(settingsPath, "utf8")).preferredMailMethod;
-  } catch {}
+  const preferredMethod = getSetting("preferredMailMethod", null);
 
   const gmailURL = `https://mail.google.com/mail/?view=cm&fs=1&to=${toEncoded}&su=${subjectEncoded}&body=${bodyEncoded}`;
   const outlookWebURL = `https://outlook.office.com/mail/deeplink/compose?to=${toEncoded}&subject=${subjectEncoded}&body=${bodyEncoded}`;
@@ -27,12 +20,14 @@ export async function sendMail({ to, subject, body }) {
     gmail: {
       name: "Gmail",
       url: gmailURL,
-      keywords: ["gmail", "mail.google.com", "inbox", "compose", "mail", "email"],
+      // Matched as whole terms by the thread index; "*" keeps plurals and
+      // compounds ("emails", "mailbox", "inbox-zero")
+      keywords: ["gmail*", "mail.google.com", "inbox*", "compose*", "mail*", "email*"],
     },
     outlook: {
       name: "Outlook Web",
       url: outlookWebURL,
-      keywords: ["outlook", "office365", "compose email"],
+      keywords: ["outlook*", "office365*", "compose email*"],
     }
   };
 
@@ -1,41 +1,226 @@
-import Groq from "groq-sdk";
-import { logToFile } from "../utility/logger.js";
+import crypto from "crypto";
 
-import { configDotenv } from "dotenv";
-import { fileURLToPath } from "url";
-import path from "path";
+import { groq } from "../utility/llm.js";
+import { createLogger } from "../utility/logger.js";
+import { onMessage, sendMessage } from "../utility/ipc-client.js";
+import { createTextChunker } from "../utility/text-chunker.js";
+import { redis, isRedisAvailable } from "../utility/cache-client.js";
 
 import clipboard from 'clipboardy';
 
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
+const logToFile = createLogger("summarise");
 
-configDotenv({ path: path.resolve(__dirname, "../../.env") });
+const MODEL = "gemma2-9b-it"; // "llama-3.3-70b-versatile"
 
-const groq = new Groq({ apiKey: process.env.GROQ_API_KEY });
+// Deltas are batched so the app repaints a few times per frame at most
+const CHUNK_FLUSH_MS = 40;
 
-export async function summarisePdf({ content }) {
-  try {
-    if (!content || content.trim().length === 0) {
-      return { success: false, message: "No content provided." };
-    }
+// Documents over one chunk are map-reduced: each chunk is summarised on its
+// own (a few at a time), then the partial summaries are combined. Partials
+// are cached by chunk hash, so after an edit only the changed chunks go
+// back to the model. Bump PROMPT_VERSION when the prompts change.
+const CHUNK_TOKENS = parseInt(process.env.SUMMARY_CHUNK_TOKENS || "3000");
+const CHUNK_OVERLAP = parseInt(process.env.SUMMARY_CHUNK_OVERLAP || "150");
+const MAP_CONCURRENCY = parseInt(process.env.SUMMARY_CONCURRENCY || "4");
+const PARTIAL_TTL_SECONDS = parseInt(process.env.SUMMARY_CACHE_TTL || "604800");
+const PROMPT_VERSION = 1;
+const MAX_REDUCE_LEVELS = 4;
+
+const chunker = createTextChunker({ maxTokens: CHUNK_TOKENS, overlapTokens: CHUNK_OVERLAP });
 
-    const prompt = `
+const summaryPrompt = (text) => `
     You are a concise summarization assistant. Summarise the following text clearly and precisely in a few paragraphs. Focus on the main ideas, remove any redundant details.
     AND ONLY RETURN THE SUMMARY. NO ADDITIONAL TEXT OR EXPLANATIONS.
 
     Text:
-    ${content}
+    ${text}
+    `;
+
+// No part numbers: the prompt must depend on the chunk alone to be cacheable
+const partPrompt = (text) => `
+    You are a concise summarization assistant. The text below is one part of a longer document; it may start or end mid-thought. Summarise the main ideas, facts and figures of this part in one short paragraph. Do not introduce or conclude the document.
+    AND ONLY RETURN THE SUMMARY. NO ADDITIONAL TEXT OR EXPLANATIONS.
+
+    Text:
+    ${text}
     `;
 
-    const response = await groq.chat.completions.create({
-        model: "gemma2-9b-it", // "llama-3.3-70b-versatile"
-        messages: [{ role: "user", content: prompt }]
-    });
+const combinePrompt = (summaries) => `
+    You are a concise summarization assistant. Below are summaries of consecutive parts of one document, in order. Combine them into a single clear summary of the whole document in a few paragraphs. Merge repeated points and keep the overall flow.
+    AND ONLY RETURN THE SUMMARY. NO ADDITIONAL TEXT OR EXPLANATIONS.
+
+    Part summaries:
+    ${summaries.map((summary, i) => `[${i + 1}] ${summary}`).join("\n\n")}
+    `;
+
+// Runs fn over items with at most limit in flight, keeping order
+async function mapLimit(items, limit, signal, fn) {
+  const results = new Array(items.length);
+  let next = 0;
+  const worker = async () => {
+    while (next < items.length && !signal.aborted) {
+      const i = next++;
+      results[i] = await fn(items[i], i);
+    }
+  };
+  await Promise.all(Array.from({ length: Math.min(Math.max(limit, 1), items.length) }, worker));
+  signal.throwIfAborted();
+  return results;
+}
+
+// One non-streamed completion, answered from the cache when this exact
+// prompt was summarised before
+async function cachedSummary(prompt, signal, counters) {
+  const key = "summary:" + crypto.createHash("sha256")
+    .update(`${PROMPT_VERSION}\u001f${MODEL}\u001f${prompt}`)
+    .digest("hex");
+
+  if (isRedisAvailable()) {
+    try {
+      const cached = await redis.get(key);
+      if (cached) {
+        counters.cached++;
+        return cached;
+      }
+    } catch (err) {
+      logToFile("❌ Redis GET failed — summarising part again", err);
+    }
+  }
+
+  const response = await groq.chat.completions.create({
+      model: MODEL,
+      messages: [{ role: "user", content: prompt }]
+  }, { signal });
+  const summary = (response.choices[0]?.message?.content || "").trim();
+
+  if (summary && isRedisAvailable()) {
+    try {
+      await redis.set(key, summary, { EX: PARTIAL_TTL_SECONDS });
+    } catch (err) {
+      logToFile("❌ Redis SET failed for partial summary", err);
+    }
+  }
+  return summary;
+}
 
-    const summary = response.choices[0].message.content;
+// Map, then combine partials level by level until they fit in one prompt.
+// Returns the prompt for the final, streamed, reduce.
+async function reducePrompt(chunks, signal, onProgress, counters) {
+  let done = 0;
+  onProgress(done, chunks.length);
+  let partials = await mapLimit(chunks, MAP_CONCURRENCY, signal, async (chunk) => {
+    const summary = await cachedSummary(partPrompt(chunk.text), signal, counters);
+    onProgress(++done, chunks.length);
+    return summary;
+  });
+  partials = partials.filter(Boolean);
+
+  for (let level = 0; level < MAX_REDUCE_LEVELS; level++) {
+    if (chunker.countTokens(combinePrompt(partials)) <= CHUNK_TOKENS) break;
+
+    // Group consecutive partials into prompts that fit, and combine each
+    const groups = [];
+    let group = [];
+    for (const partial of partials) {
+      if (group.length > 1 && chunker.countTokens(combinePrompt([...group, partial])) > CHUNK_TOKENS) {
+        groups.push(group);
+        group = [];
+      }
+      group.push(partial);
+    }
+    if (group.length > 0) groups.push(group);
+    if (groups.length === partials.length) break; // each partial alone is too big; stop shrinking
+
+    logToFile(`🧩 Combining ${partials.length} partial summaries in ${groups.length} groups`);
+    partials = (await mapLimit(groups, MAP_CONCURRENCY, signal,
+      (members) => cachedSummary(combinePrompt(members), signal, { cached: 0 }))).filter(Boolean);
+  }
+  return combinePrompt(partials);
+}
+
+// Streams the summary to the app as summary_chunk messages when streamId is
+// given; a summary_cancel with the same id stops generation mid-stream.
+// Long documents report their map progress as summary_progress.
+export async function summarisePdf({ content, streamId = null }) {
+  const controller = new AbortController();
+  const offCancel = streamId
+    ? onMessage("summary_cancel", (message) => {
+        if (message.id === streamId) controller.abort();
+      })
+    : () => {};
+
+  const started = performance.now();
+  let firstTokenAt = null;
+  let deltas = 0;
+  let usage = null;
+  let summary = "";
+  let pending = "";
+  let lastFlush = started;
+  const counters = { chunks: 1, cached: 0 };
+
+  const flush = () => {
+    if (pending && streamId) sendMessage("summary_chunk", { id: streamId, text: pending });
+    pending = "";
+    lastFlush = performance.now();
+  };
+
+  // Time to first token, and generation rate from the first token on
+  const finish = (outcome) => {
+    const ended = performance.now();
+    const tokens = usage?.completion_tokens ?? deltas;
+    const genSeconds = firstTokenAt ? (ended - firstTokenAt) / 1000 : 0;
+    const stats = {
+      ttftMs: firstTokenAt ? Math.round(firstTokenAt - started) : null,
+      tokens,
+      tokensPerSec: genSeconds > 0 ? Math.round((tokens / genSeconds) * 10) / 10 : null,
+      totalMs: Math.round(ended - started),
+      chunks: counters.chunks,
+      cachedChunks: counters.cached
+    };
+    if (streamId) sendMessage("summary_done", { id: streamId, ...outcome, ...stats });
+    logToFile("⏱️ Summary stream", { ...outcome, ...stats });
+    return stats;
+  };
+
+  try {
+    if (!content || content.trim().length === 0) {
+      finish({ ok: false, error: "No content provided." });
+      return { success: false, message: "No content provided." };
+    }
+
+    const parts = chunker.split(content);
+    counters.chunks = parts.length;
+    let prompt = summaryPrompt(content);
+    if (parts.length > 1) {
+      logToFile(`🧩 Map-reducing ${parts.length} chunks`, { tokens: chunker.countTokens(content) });
+      const onProgress = (done, total) => {
+        if (streamId) sendMessage("summary_progress", { id: streamId, done, total });
+      };
+      prompt = await reducePrompt(parts, controller.signal, onProgress, counters);
+    }
+
+    const stream = await groq.chat.completions.create({
+        model: MODEL,
+        messages: [{ role: "user", content: prompt }],
+        stream: true
+    }, { signal: controller.signal });
+
+    for await (const chunk of stream) {
+      const delta = chunk.choices?.[0]?.delta?.content || "";
+      if (delta) {
+        firstTokenAt ??= performance.now();
+        ++deltas;
+        summary += delta;
+        pending += delta;
+        if (performance.now() - lastFlush >= CHUNK_FLUSH_MS) flush();
+      }
+      // Groq reports usage on the last chunk
+      usage = chunk.x_groq?.usage ?? chunk.usage ?? usage;
+    }
+    flush();
 
     if (!summary || summary.trim().length === 0) {
+      finish({ ok: false, error: "Summary was empty." });
       return { success: false, message: "Summary was empty." };
     }
 
@@ -43,16 +228,28 @@ export async function summarisePdf({ content }) {
     await clipboard.writeSync(summary); // copy summary to clipboard
     logToFile("📋 Summary copied to clipboard", summary);
 
+    const stats = finish({ ok: true });
     return {
       success: true,
-      summary
+      summary,
+      stats
     };
   } catch (err) {
+    if (controller.signal.aborted) {
+      flush();
+      const stats = finish({ ok: false, cancelled: true });
+      logToFile("🛑 Summary cancelled by user");
+      return { success: false, message: "Cancelled", summary, stats };
+    }
+
+    finish({ ok: false, error: err.message });
     logToFile("❌ Failed to summarise PDF", err);
     return {
       success: false,
       message: "Error during summarisation",
       error: err.message
     };
+  } finally {
+    offCancel();
   }
-}
\ No newline at end of file
+}
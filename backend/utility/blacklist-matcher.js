@@ -0,0 +1,44 @@
+import { native } from "./native.js";
+
+// ASCII case folding, as BlacklistMatcher's fold(): "É" and "é" stay distinct
+const foldAscii = (text) => text.replace(/[A-Z]+/g, run => run.toLowerCase());
+
+// Plain JS equivalent of Gem/core's BlacklistMatcher, used when the addon is
+// not built. Same semantics: ASCII case-insensitive, empty and duplicate
+// patterns dropped, findFirst returns an index into the distinct patterns.
+class JsBlacklistMatcher {
+  constructor(patterns = []) {
+    this.patterns = [...new Set(patterns.map(p => foldAscii(String(p))).filter(Boolean))];
+  }
+
+  get size() {
+    return this.patterns.length;
+  }
+
+  findFirst(text) {
+    if (typeof text !== "string" || this.patterns.length === 0) return -1;
+    // The match ending earliest wins, then the lowest index
+    const haystack = foldAscii(text);
+    let first = -1, firstEnd = Infinity;
+    this.patterns.forEach((p, i) => {
+      const at = haystack.indexOf(p);
+      if (at >= 0 && at + p.length < firstEnd) {
+        first = i;
+        firstEnd = at + p.length;
+      }
+    });
+    return first;
+  }
+
+  matches(text) {
+    return this.findFirst(text) >= 0;
+  }
+}
+
+// Compile a list of substrings into a matcher. With the addon this is an
+// Aho-Corasick automaton, so a check costs O(text) however long the list is.
+export function compileMatcher(patterns) {
+  return native ? new native.BlacklistMatcher(patterns) : new JsBlacklistMatcher(patterns);
+}
+
+export { JsBlacklistMatcher };
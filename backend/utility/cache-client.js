@@ -0,0 +1,26 @@
+import { createClient } from "redis";
+
+import { createLogger } from "./logger.js";
+
+const logToFile = createLogger("cache");
+
+// One connection to gem-cache (or any Redis) shared by every stage that
+// caches LLM results. REDIS_URL points it at another server; "none" turns
+// it off (gem-replay does, so replays don't depend on what a previous run
+// cached).
+const redisUrl = process.env.REDIS_URL;
+export const redis = createClient(redisUrl && redisUrl !== "none" ? { url: redisUrl } : undefined);
+
+if (redisUrl === "none") {
+  logToFile("⚠️ Redis disabled by REDIS_URL. Using LLM-only mode.");
+} else {
+  try {
+    await redis.connect();
+  } catch (err) {
+    logToFile("❌ Redis failed to connect. Using LLM-only mode.");
+  }
+}
+
+export function isRedisAvailable() {
+  return redis?.isReady || redis?.status === "ready";
+}
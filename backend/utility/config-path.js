@@ -0,0 +1,15 @@
+import path from "path";
+import { fileURLToPath } from "url";
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+// config/ at the project root, unless GEM_CONFIG_DIR points elsewhere
+// (gem-replay uses a scratch directory so a replay never touches the real
+// log, threads or settings)
+export const CONFIG_DIR = process.env.GEM_CONFIG_DIR
+  ? path.resolve(process.env.GEM_CONFIG_DIR)
+  : path.resolve(__dirname, "../../config");
+
+export function configPath(name) {
+  return path.join(CONFIG_DIR, name);
+}
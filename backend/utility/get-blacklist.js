@@ -1,7 +1,9 @@
 import { configDotenv } from "dotenv";
 import path from "path";
 import { fileURLToPath } from "url";
-import { readFileSync } from "fs";
+
+import { compileMatcher } from "./blacklist-matcher.js";
+import { getSettings } from "./settings.js";
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -9,20 +11,43 @@ const __dirname = path.dirname(__filename);
 configDotenv({ path: path.resolve(__dirname, "../../.env") });
 console.log("ENV path: ", path.resolve(__dirname, "../../.env"));
 
-const settingsPath = path.resolve(__dirname, "../../config/settings.json");
+function splitList(value) {
+  // Case is folded by the matcher, ASCII only, like the app's preview
+  return (value || "").split(",").map(s => s.trim()).filter(Boolean);
+}
 
-export function getBlacklist() {
-  let PUBLIC_IGNORED_WINDOWS, PUBLIC_IGNORED_APPS;;
-  try {
-    PUBLIC_IGNORED_APPS = JSON.parse(readFileSync(settingsPath, "utf8")).blacklistedApps || [];
-    PUBLIC_IGNORED_WINDOWS = JSON.parse(readFileSync(settingsPath, "utf8")).blacklistedWindows || [];
-  } catch {}
+export function getBlacklist(settings = getSettings()) {
+  const PUBLIC_IGNORED_APPS = Array.isArray(settings.blacklistedApps) ? settings.blacklistedApps : [];
+  const PUBLIC_IGNORED_WINDOWS = Array.isArray(settings.blacklistedWindows) ? settings.blacklistedWindows : [];
 
-  const PRIVATE_IGNORED_APPS = (process.env.PRIVATE_BLACKLISTED_APPS || "").split(",").map(s => s.trim().toLowerCase());
-  const PRIVATE_IGNORED_WINDOWS = (process.env.PRIVATE_BLACKLISTED_WINDOWS || "").split(",").map(s => s.trim().toLowerCase());
+  const PRIVATE_IGNORED_APPS = splitList(process.env.PRIVATE_BLACKLISTED_APPS);
+  const PRIVATE_IGNORED_WINDOWS = splitList(process.env.PRIVATE_BLACKLISTED_WINDOWS);
 
   // combine public and private ignored apps and windows
   const IGNORED_APPS = [...new Set([...PUBLIC_IGNORED_APPS, ...PRIVATE_IGNORED_APPS])];
   const IGNORED_WINDOWS = [...new Set([...PUBLIC_IGNORED_WINDOWS, ...PRIVATE_IGNORED_WINDOWS])];
   return { apps : IGNORED_APPS, windows : IGNORED_WINDOWS };
-}
\ No newline at end of file
+}
+
+let compiled = null;
+let compiledFrom = null;
+
+// Compiled app/window matchers, rebuilt only when the settings object changes
+export function getBlacklistMatcher() {
+  const settings = getSettings();
+  if (compiled && compiledFrom === settings) return compiled;
+
+  const { apps, windows } = getBlacklist(settings);
+  const appMatcher = compileMatcher(apps);
+  const windowMatcher = compileMatcher(windows);
+
+  compiledFrom = settings;
+  compiled = {
+    apps,
+    windows,
+    isIgnored(appName, windowName) {
+      return appMatcher.matches(appName || "") || windowMatcher.matches(windowName || "");
+    }
+  };
+  return compiled;
+}
@@ -0,0 +1,142 @@
+import net from "net";
+import os from "os";
+import path from "path";
+
+import { createLogger } from "./logger.js";
+
+const logToFile = createLogger("ipc");
+
+// Local-socket channel to the Qt app (see Gem/ipcserver.h).
+// Each frame is a 4-byte big-endian length followed by a UTF-8 JSON object
+// carrying "v" (protocol version) and "type".
+export const PROTOCOL_VERSION = 1;
+
+const MAX_FRAME_BYTES = 16 * 1024 * 1024;
+const RECONNECT_MIN_MS = 250;
+const RECONNECT_MAX_MS = 5000;
+
+const IPC_PATH = process.env.GEM_IPC_PATH ||
+  (process.platform === "win32" ? "\\\\.\\pipe\\gem-ipc" : path.join(os.tmpdir(), "gem-ipc"));
+
+let socket = null;
+let connected = false;
+let buffer = Buffer.alloc(0);
+let reconnectDelay = RECONNECT_MIN_MS;
+
+const handlers = new Map(); // type -> Set of callbacks
+
+function connect() {
+  socket = net.createConnection(IPC_PATH);
+  socket.unref();
+
+  socket.on("connect", () => {
+    connected = true;
+    reconnectDelay = RECONNECT_MIN_MS;
+    buffer = Buffer.alloc(0);
+    logToFile("🔌 IPC connected", IPC_PATH);
+    sendMessage("hello", { pid: process.pid, role: path.basename(process.argv[1] || "node") });
+    dispatch("connect", {});
+  });
+
+  socket.on("data", onData);
+  socket.on("error", () => {}); // "close" follows and schedules the reconnect
+
+  socket.on("close", () => {
+    if (connected) {
+      logToFile("🔌 IPC disconnected — falling back to file hand-off", IPC_PATH);
+      dispatch("disconnect", {});
+    }
+    connected = false;
+    socket = null;
+
+    const retry = setTimeout(connect, reconnectDelay);
+    retry.unref();
+    reconnectDelay = Math.min(reconnectDelay * 2, RECONNECT_MAX_MS);
+  });
+}
+
+function onData(chunk) {
+  buffer = buffer.length ? Buffer.concat([buffer, chunk]) : chunk;
+
+  while (buffer.length >= 4) {
+    const length = buffer.readUInt32BE(0);
+    if (length > MAX_FRAME_BYTES) {
+      logToFile("❌ IPC frame too large — resetting connection", { length });
+      socket?.destroy();
+      return;
+    }
+    if (buffer.length < 4 + length) break;
+
+    const body = buffer.subarray(4, 4 + length);
+    buffer = buffer.subarray(4 + length);
+
+    let message;
+    try {
+      message = JSON.parse(body.toString("utf8"));
+    } catch (err) {
+      logToFile("❌ IPC frame is not valid JSON", err.message);
+      continue;
+    }
+
+    if (!message || typeof message.v !== "number" || message.v < 1 || message.v > PROTOCOL_VERSION) {
+      logToFile("⚠️ IPC frame has unsupported version", message?.v);
+      continue;
+    }
+
+    dispatch(message.type, message);
+  }
+}
+
+function dispatch(type, message) {
+  const set = handlers.get(type);
+  if (!set) return;
+  for (const handler of [...set]) {
+    try {
+      handler(message);
+    } catch (err) {
+      logToFile("❌ IPC handler error", err.message);
+    }
+  }
+}
+
+export function isIpcConnected() {
+  return connected;
+}
+
+// Returns false when the Qt app is not connected so callers can use the file fallback.
+export function sendMessage(type, payload = {}) {
+  if (!connected || !socket) return false;
+
+  const body = Buffer.from(JSON.stringify({ ...payload, v: PROTOCOL_VERSION, type }), "utf8");
+  const header = Buffer.alloc(4);
+  header.writeUInt32BE(body.length, 0);
+
+  socket.write(Buffer.concat([header, body]));
+  return true;
+}
+
+export function onMessage(type, handler) {
+  if (!handlers.has(type)) handlers.set(type, new Set());
+  handlers.get(type).add(handler);
+  return () => handlers.get(type)?.delete(handler);
+}
+
+// Resolves with the first matching message, or null on timeout or disconnect.
+export function waitForMessage(type, { timeoutMs = 15000, filter = () => true } = {}) {
+  return new Promise((resolve) => {
+    const finish = (value) => {
+      clearTimeout(timer);
+      offMessage();
+      offDisconnect();
+      resolve(value);
+    };
+
+    const offMessage = onMessage(type, (message) => {
+      if (filter(message)) finish(message);
+    });
+    const offDisconnect = onMessage("disconnect", () => finish(null));
+    const timer = setTimeout(() => finish(null), timeoutMs);
+  });
+}
+
+connect();
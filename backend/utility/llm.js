@@ -0,0 +1,17 @@
+import path from "path";
+import { fileURLToPath } from "url";
+import { configDotenv } from "dotenv";
+import Groq from "groq-sdk";
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+
+configDotenv({ path: path.resolve(__dirname, "../../.env") });
+
+// One Groq client for every stage. Under the app, GEM_GATEWAY_URL routes
+// calls through gem-gateway, which coalesces identical in-flight prompts,
+// caches answers and reuses upstream connections; otherwise the SDK talks
+// to the provider (or GROQ_BASE_URL) directly.
+export const groq = new Groq({
+  apiKey: process.env.GROQ_API_KEY,
+  ...(process.env.GEM_GATEWAY_URL ? { baseURL: process.env.GEM_GATEWAY_URL } : {})
+});
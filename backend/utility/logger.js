@@ -1,22 +1,48 @@
 import fs from "fs";
-import path from "path";
-import { fileURLToPath } from "url";
+import { configPath } from "./config-path.js";
 
-// Resolve this file's directory
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
-
-// Final log path — rooted at project root (2 levels up from /backend/utility/logger.js)
-const LOG_PATH = path.resolve(__dirname, "../../config/debug.log");
+// Final log path — config/debug.log at the project root (see config-path.js)
+const LOG_PATH = configPath("debug.log");
 console.log("Log path:", LOG_PATH);
 
-export function logToFile(label, data) {
-  const timestamp = new Date().toISOString();
-  const entry = `[${timestamp}] ${label}\n${typeof data === "string" ? data : JSON.stringify(data, null, 2)}\n\n`;
+const LEVELS = new Set(["debug", "info", "warn", "error"]);
+
+// Labels already carry an emoji marker; use it when no level is given
+function inferLevel(label) {
+  const text = String(label);
+  if (text.startsWith("❌")) return "error";
+  if (text.startsWith("⚠️") || text.startsWith("🚫")) return "warn";
+  return "info";
+}
+
+function serialise(data) {
+  if (data instanceof Error) return { message: data.message, stack: data.stack };
+  return data;
+}
+
+// One JSON record per line, fields in fixed order (ts, level, stage, msg, data)
+// so the Qt log index can read the prefix without a full JSON parse.
+function writeRecord(stage, label, data, level) {
+  const record = {
+    ts: new Date().toISOString(),
+    level: LEVELS.has(level) ? level : inferLevel(label),
+    stage,
+    msg: String(label)
+  };
+  if (data !== undefined) record.data = serialise(data);
 
   try {
-    fs.appendFileSync(LOG_PATH, entry, "utf8");
+    fs.appendFileSync(LOG_PATH, JSON.stringify(record) + "\n", "utf8");
   } catch (err) {
     console.error("❌ Failed to write log:", err);
   }
-}
\ No newline at end of file
+}
+
+// Returns a logToFile-compatible function bound to a pipeline stage
+export function createLogger(stage) {
+  return (label, data, level) => writeRecord(stage, label, data, level);
+}
+
+export function logToFile(label, data, level) {
+  writeRecord("general", label, data, level);
+}
@@ -0,0 +1,34 @@
+import { createRequire } from "module";
+import path from "path";
+import { fileURLToPath } from "url";
+
+import { createLogger } from "./logger.js";
+
+const logToFile = createLogger("native");
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+
+// Built by `npm run build:native` (node-gyp over backend/native)
+const ADDON_PATHS = [
+  path.resolve(__dirname, "../native/build/Release/gem_native.node"),
+  path.resolve(__dirname, "../native/build/Debug/gem_native.node")
+];
+
+function loadAddon() {
+  if (process.env.GEM_DISABLE_NATIVE === "1") return null;
+
+  for (const addonPath of ADDON_PATHS) {
+    try {
+      const addon = require(addonPath);
+      logToFile("🧩 Native addon loaded", addonPath, "debug");
+      return addon;
+    } catch (err) {
+      if (err.code !== "MODULE_NOT_FOUND") logToFile("⚠️ Native addon failed to load", err);
+    }
+  }
+  return null;
+}
+
+// The addon, or null when it isn't built; every caller has a JS fallback
+export const native = loadAddon();
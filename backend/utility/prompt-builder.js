@@ -0,0 +1,282 @@
+import { performance } from "perf_hooks";
+
+import { createLogger } from "./logger.js";
+import { native } from "./native.js";
+import { estimateTokens } from "./text-chunker.js";
+import { jsNormalizeText } from "./text-search.js";
+
+const logToFile = createLogger("prompt");
+
+// Tokens of thread context a prompt may carry, by model; the rest of the
+// window is left to the instructions and the reply. PROMPT_CONTEXT_TOKENS
+// overrides the table.
+const MODEL_CONTEXT_TOKENS = {
+  "llama-3.3-70b-versatile": 4000,
+  "gemma2-9b-it": 2000
+};
+const DEFAULT_CONTEXT_TOKENS = 2000;
+const CONTEXT_TOKENS = parseInt(process.env.PROMPT_CONTEXT_TOKENS || "0");
+const MAX_EVENT_TOKENS = parseInt(process.env.PROMPT_EVENT_TOKENS || "400");
+const HALF_LIFE_MS = parseFloat(process.env.PROMPT_HALF_LIFE_S || "120") * 1000;
+
+// The model's BPE ranks in tiktoken's format (for Llama 3, its
+// tokenizer.model); without them token counts are estimates that err high
+export const TOKENIZER_PATH = process.env.LLM_TOKENIZER_PATH || "";
+
+// Plain JS equivalent of Gem/core's PromptBuilder, used when the addon is
+// not built: the same ranking and budget, with estimated token counts and
+// only exact (normalised) repeats dropped.
+const ELLIPSIS = "…";
+const FULL_RELEVANCE_MATCHES = 3;
+
+function renderEvent(event, text) {
+  const out = {};
+  if (event.timestamp) out.timestamp = event.timestamp;
+  if (event.app_name) out.app_name = event.app_name;
+  if (event.window_name) out.window_name = event.window_name;
+  if (event.browser_url) out.browser_url = event.browser_url;
+  if (text) out.text = text;
+  if (event.delta === true) out.delta = true;
+  return JSON.stringify(out);
+}
+
+const threadStart = (topic) => `{"topic":${JSON.stringify(topic)},"events":[`;
+
+class JsPromptBuilder {
+  constructor() {
+    // Per event object: its compact source tokens, its overhead (rendered
+    // with the text cut to nothing) and its normalised text and window,
+    // which every later request would otherwise work out again
+    this.seen = new WeakMap();
+  }
+
+  factsOf(event) {
+    let facts = this.seen.get(event);
+    if (!facts) {
+      facts = {
+        sourceTokens: estimateTokens(renderEvent(event, event.text)),
+        overheadTokens: estimateTokens(renderEvent(event, ELLIPSIS)),
+        normalized: jsNormalizeText(event.text),
+        window: jsNormalizeText(event.window_name)
+      };
+      this.seen.set(event, facts);
+    }
+    return facts;
+  }
+
+  exact() {
+    return false;
+  }
+
+  countTokens(text) {
+    return estimateTokens(text);
+  }
+
+  truncate(text, maxTokens) {
+    text = String(text ?? "");
+    if (estimateTokens(text) <= maxTokens) return text;
+    const limit = Math.max(0, maxTokens - estimateTokens(ELLIPSIS));
+
+    let fits = 0;
+    let over = text.length;
+    while (fits + 1 < over) {
+      const mid = (fits + over) >> 1;
+      if (estimateTokens(text.slice(0, mid)) <= limit) fits = mid;
+      else over = mid;
+    }
+    let cut = fits;
+    const code = text.charCodeAt(cut);
+    if (cut > 0 && code >= 0xdc00 && code <= 0xdfff) cut--; // not between a surrogate pair
+
+    const space = Math.max(text.lastIndexOf(" ", cut - 1), text.lastIndexOf("\n", cut - 1), text.lastIndexOf("\t", cut - 1));
+    if (space >= 0 && space >= cut - Math.floor(cut / 5)) cut = space;
+    return text.slice(0, cut).trimEnd() + ELLIPSIS;
+  }
+
+  build(threads, { maxTokens = 3000, maxEventTokens = 400, minEventTokens = 48, halfLifeMs = 120000, keywords = [] } = {}) {
+    const needles = keywords.map(jsNormalizeText).filter(Boolean);
+
+    let sourceTokens = estimateTokens("[]");
+    let newest = 0;
+    const order = [];
+    threads.forEach((thread, t) => {
+      sourceTokens += estimateTokens(threadStart(thread.topic) + "]}") + 1;
+      thread.events.forEach((event, e) => {
+        if (!event.text) return;
+        order.push({ t, e, time: event.time || 0 });
+        newest = Math.max(newest, event.time || 0);
+        sourceTokens += this.factsOf(event).sourceTokens + 1;
+      });
+    });
+    order.reverse(); // later in a thread is newer on a tie
+    order.sort((a, b) => b.time - a.time);
+
+    const topics = threads.map(thread => jsNormalizeText(thread.topic));
+    const seen = new Set();
+    const candidates = [];
+    let duplicates = 0;
+    for (const { t, e, time } of order) {
+      const event = threads[t].events[e];
+      const { normalized, window } = this.factsOf(event);
+      if (!normalized || seen.has(normalized)) {
+        duplicates++;
+        continue;
+      }
+      seen.add(normalized);
+
+      const haystack = `${topics[t]}\u0001${window}\u0001${normalized}`;
+      const matches = needles.filter(needle => haystack.includes(needle)).length;
+      const relevance = Math.min(1, matches / FULL_RELEVANCE_MATCHES);
+      const recency = time > 0 ? Math.pow(2, -(newest - time) / Math.max(halfLifeMs, 1)) : 0;
+      candidates.push({ t, e, time, score: recency * (1 + 2 * relevance), text: "", truncated: false });
+    }
+    candidates.sort((a, b) => b.score - a.score);
+
+    const opened = new Set();
+    const chosen = [];
+    let used = estimateTokens("[]");
+    for (const candidate of candidates) {
+      if (used + minEventTokens >= maxTokens) break;
+      const event = threads[candidate.t].events[candidate.e];
+      const opening = opened.has(candidate.t) ? 0 : estimateTokens(threadStart(threads[candidate.t].topic) + "]}") + 1;
+      // Once the budget is nearly spent most events can't be cut to fit
+      const { sourceTokens: whole, overheadTokens } = this.factsOf(event);
+      if (used + opening + whole + 1 > maxTokens && used + opening + overheadTokens + 1 + minEventTokens > maxTokens) continue;
+      candidate.text = this.truncate(event.text, maxEventTokens);
+      candidate.truncated = candidate.text !== event.text;
+
+      let tokens = estimateTokens(renderEvent(event, candidate.text)) + 1;
+      if (used + opening + tokens > maxTokens) {
+        const overhead = overheadTokens + 1;
+        const left = Math.max(0, maxTokens - used - opening);
+        if (left < overhead + minEventTokens) continue;
+        candidate.text = this.truncate(candidate.text, left - overhead);
+        candidate.truncated = true;
+        tokens = estimateTokens(renderEvent(event, candidate.text)) + 1;
+        if (used + opening + tokens > maxTokens) continue;
+      }
+      used += opening + tokens;
+      opened.add(candidate.t);
+      chosen.push(candidate);
+    }
+
+    const render = () => {
+      const groups = new Map();
+      for (const candidate of [...chosen].sort((a, b) => a.time - b.time || a.e - b.e)) {
+        const group = groups.get(candidate.t) || { latest: 0, events: [] };
+        group.latest = Math.max(group.latest, candidate.time);
+        group.events.push(renderEvent(threads[candidate.t].events[candidate.e], candidate.text));
+        groups.set(candidate.t, group);
+      }
+      const ordered = [...groups.entries()].sort((a, b) => b[1].latest - a[1].latest);
+      return `[${ordered.map(([t, group]) => threadStart(threads[t].topic) + group.events.join(",") + "]}").join(",")}]`;
+    };
+
+    let text = render();
+    let tokens = estimateTokens(text);
+    while (tokens > maxTokens && chosen.length > 0) {
+      chosen.pop();
+      text = render();
+      tokens = estimateTokens(text);
+    }
+
+    return {
+      text,
+      tokens,
+      sourceTokens,
+      events: order.length,
+      kept: chosen.length,
+      duplicates,
+      truncated: chosen.filter(candidate => candidate.truncated).length
+    };
+  }
+}
+
+function createBuilder() {
+  if (!native?.PromptBuilder) return new JsPromptBuilder();
+  try {
+    return new native.PromptBuilder({ vocab: TOKENIZER_PATH });
+  } catch (err) {
+    logToFile("⚠️ Tokenizer vocabulary failed to load — estimating tokens", err.message);
+    return new native.PromptBuilder({});
+  }
+}
+
+const builder = createBuilder();
+const totals = { requests: 0, sourceTokens: 0, tokens: 0 };
+
+export function contextBudget(model) {
+  return CONTEXT_TOKENS > 0 ? CONTEXT_TOKENS : MODEL_CONTEXT_TOKENS[model] ?? DEFAULT_CONTEXT_TOKENS;
+}
+
+export function countTokens(text) {
+  return builder.countTokens(String(text ?? ""));
+}
+
+export function getPromptStats() {
+  return { ...totals, saved: totals.sourceTokens - totals.tokens, exact: builder.exact() };
+}
+
+// Prompt form of each thread event, by identity: the manager only ever
+// appends events, so a request converts just the ones new since the last
+const promptEvents = new WeakMap();
+
+function promptEvent(event) {
+  let converted = promptEvents.get(event);
+  if (!converted) {
+    converted = {
+      timestamp: event.timestamp,
+      time: Date.parse(event.timestamp) || 0,
+      app_name: event.app_name,
+      window_name: event.window_name,
+      browser_url: event.browser_url,
+      text: typeof event.text === "string" ? event.text : "",
+      delta: event.delta === true
+    };
+    promptEvents.set(event, converted);
+  }
+  return converted;
+}
+
+// Threads as prompts show them: topic and events, nothing of the manager's
+// bookkeeping; time lets events be ranked by recency
+function promptThreads(threads) {
+  return threads.filter(Boolean).map(thread => ({
+    topic: typeof thread.topic === "string" ? thread.topic : thread.topic?.topic || "",
+    events: (thread.events || []).filter(event => event && typeof event === "object").map(promptEvent)
+  }));
+}
+
+// Thread context for a prompt to model, as compact JSON within the model's
+// budget: repeats dropped, events ranked by recency and by how many of the
+// keywords they mention, long ones cut. Returns { text, tokens,
+// sourceTokens, saved, events, kept, duplicates, truncated }.
+export function buildThreadContext(threads, { model, keywords = [], maxTokens = contextBudget(model), label = "" } = {}) {
+  const start = performance.now();
+  const context = builder.build(promptThreads(threads), {
+    maxTokens,
+    maxEventTokens: MAX_EVENT_TOKENS,
+    halfLifeMs: HALF_LIFE_MS,
+    keywords
+  });
+  const saved = Math.max(0, context.sourceTokens - context.tokens);
+
+  totals.requests++;
+  totals.sourceTokens += context.sourceTokens;
+  totals.tokens += context.tokens;
+  logToFile("✂️ Prompt context built", {
+    label,
+    model,
+    tokens: context.tokens,
+    sourceTokens: context.sourceTokens,
+    saved,
+    events: `${context.kept}/${context.events}`,
+    duplicates: context.duplicates,
+    truncated: context.truncated,
+    exact: builder.exact(),
+    ms: Number((performance.now() - start).toFixed(2))
+  }, "debug");
+  return { ...context, saved };
+}
+
+export { JsPromptBuilder };
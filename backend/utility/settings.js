@@ -0,0 +1,106 @@
+import { readFileSync, statSync } from "fs";
+
+import { createLogger } from "./logger.js";
+import { onMessage } from "./ipc-client.js";
+import { configPath } from "./config-path.js";
+
+const logToFile = createLogger("settings");
+
+const SETTINGS_PATH = configPath("settings.json");
+
+// Only used while the Qt app is not pushing (backend run on its own)
+const DISK_RECHECK_MS = 1000;
+
+// The Qt app owns settings.json (Gem/settingsstore.h) and pushes a versioned
+// "settings" message on connect and after every change. Consumers read the
+// in-memory copy; the object is replaced, never mutated, so callers can
+// cache anything derived from it by identity.
+let current = Object.freeze({});
+let version = -1;
+let pushed = false;
+let diskMtime = -1;
+let lastDiskCheck = 0;
+
+const listeners = new Set();
+
+function changedKeys(previous, next) {
+  const keys = new Set([...Object.keys(previous), ...Object.keys(next)]);
+  return [...keys].filter(key => JSON.stringify(previous[key]) !== JSON.stringify(next[key]));
+}
+
+function apply(settings, newVersion, changed) {
+  const previous = current;
+  const { version: _, ...values } = settings || {};
+  current = Object.freeze(values);
+  version = newVersion;
+
+  const keys = changed ?? changedKeys(previous, current);
+  for (const listener of listeners) {
+    try {
+      listener(current, { version, changed: keys, previous });
+    } catch (err) {
+      logToFile("❌ Settings listener failed", err);
+    }
+  }
+}
+
+function loadFromDisk() {
+  let mtime = 0;
+  try {
+    mtime = statSync(SETTINGS_PATH).mtimeMs;
+  } catch {}
+  if (mtime === diskMtime) return;
+  diskMtime = mtime;
+
+  let settings = {};
+  try {
+    settings = JSON.parse(readFileSync(SETTINGS_PATH, "utf8"));
+  } catch {}
+  apply(settings, typeof settings.version === "number" ? settings.version : 0);
+}
+
+function checkDisk() {
+  if (pushed) return;
+  const now = Date.now();
+  if (now - lastDiskCheck < DISK_RECHECK_MS) return;
+  lastDiskCheck = now;
+  loadFromDisk();
+}
+
+onMessage("settings", (message) => {
+  if (typeof message.version !== "number") return;
+  pushed = true;
+  if (message.version === version) return;
+
+  apply(message.settings, message.version, Array.isArray(message.changed) && message.changed.length
+    ? message.changed
+    : undefined);
+  logToFile("⚙️ Settings updated", { version, changed: message.changed });
+});
+
+onMessage("disconnect", () => {
+  pushed = false;
+  diskMtime = -1; // pick up whatever the app flushed last
+});
+
+loadFromDisk();
+
+export function getSettings() {
+  checkDisk();
+  return current;
+}
+
+export function getSetting(key, fallback = undefined) {
+  const value = getSettings()[key];
+  return value === undefined ? fallback : value;
+}
+
+export function getSettingsVersion() {
+  return version;
+}
+
+// listener(settings, { version, changed, previous }); returns an unsubscribe
+export function onSettingsChanged(listener) {
+  listeners.add(listener);
+  return () => listeners.delete(listener);
+}
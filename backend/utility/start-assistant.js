@@ -1,16 +1,19 @@
 import { exec, spawn } from "child_process";
-import { logToFile } from "./logger.js";
+import { createLogger } from "./logger.js";
 import fetch from "node-fetch";
 import { setTimeout as sleep } from "timers/promises";
 import fs from "fs";
 import path from "path";
 import { fileURLToPath } from "url";
 import { configDotenv } from "dotenv";
+import { configPath } from "./config-path.js";
+
+const logToFile = createLogger("start");
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 
-const stateFile = path.resolve(__dirname, "../../config/assistant-state.json");
+const stateFile = configPath("assistant-state.json");
 
 // Load .env from project root
 configDotenv({ path: path.resolve(__dirname, "../../.env") });
@@ -38,48 +41,23 @@ function checkScreenpipeExists() {
   });
 }
 
-// --- Check if WSL is Installed ---
-function checkWSLExists() {
-  return new Promise((resolve) => {
-    exec("where wsl", (error, stdout) => {
-      resolve(!error && stdout.trim());
-    });
-  });
-}
-
-// --- Check if Redis is Installed in WSL ---
-function checkRedisExistsInWSL() {
-  return new Promise((resolve) => {
-    exec("wsl which redis-server", (error, stdout) => {
-      resolve(!error && stdout.trim());
-    });
-  });
-}
-
-// --- Launch Redis via WSL ---
-async function launchRedisViaWSL() {
-  const wslExists = await checkWSLExists();
-  if (!wslExists) {
-    console.warn("⚠️ WSL not found, skipping Redis launch");
-    logToFile("⚠️ WSL CHECK", "WSL not found, skipping Redis launch");
-    return;
-  }
-
-  const redisExists = await checkRedisExistsInWSL();
-  if (!redisExists) {
-    console.warn("⚠️ redis-server not found inside WSL, skipping Redis launch");
-    logToFile("⚠️ REDIS CHECK", "redis-server not found inside WSL, skipping Redis launch");
+// --- Launch gem-cache (the OCR cache, built next to the Gem executable) ---
+function launchCache() {
+  const cachePath = path.resolve(__dirname, "../../gem-cache" + (process.platform === "win32" ? ".exe" : ""));
+  if (!fs.existsSync(cachePath)) {
+    console.warn("⚠️ gem-cache not found, skipping cache launch");
+    logToFile("⚠️ CACHE CHECK", "gem-cache not found, skipping cache launch");
     return;
   }
 
-  const redisProc = spawn("wsl", ["redis-server"], {
+  const cacheProc = spawn(cachePath, [], {
     detached: true,
     stdio: "ignore",
   });
-  redisProc.unref();
-  updateState({ redisPID: redisProc.pid });
-  logToFile("🟥 REDIS", `Launched via WSL (PID: ${redisProc.pid})`);
-  console.log("✅ Redis launched via WSL");
+  cacheProc.unref();
+  updateState({ cachePID: cacheProc.pid });
+  logToFile("🟥 CACHE", `Launched gem-cache (PID: ${cacheProc.pid})`);
+  console.log("✅ gem-cache launched");
 }
 
 // --- Launch Screenpipe ---
@@ -136,11 +114,11 @@ async function startAssistantFlow() {
   }
 
   try {
-    launchRedisViaWSL();
+    launchCache();
     launchScreenpipe();
   } catch (err) {
-    logToFile("❌ LAUNCH ERROR", "Failed to launch Redis or Screenpipe");
-    console.error("Failed to launch Redis or Screenpipe:", err.message);
+    logToFile("❌ LAUNCH ERROR", "Failed to launch the cache or Screenpipe");
+    console.error("Failed to launch the cache or Screenpipe:", err.message);
     process.exit(1);
   }
 
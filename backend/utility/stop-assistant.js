@@ -1,13 +1,11 @@
 import fs from "fs";
 import { execSync } from "child_process";
-import path from "path";
-import { logToFile } from "./logger.js";
-import { fileURLToPath } from "url";
+import { createLogger } from "./logger.js";
+import { configPath } from "./config-path.js";
 
-const __filename = fileURLToPath(import.meta.url);
-const __dirname = path.dirname(__filename);
+const logToFile = createLogger("stop");
 
-const stateFile = path.resolve(__dirname, "../../config/assistant-state.json");
+const stateFile = configPath("assistant-state.json");
 
 // --- Kill Process by PID (with fallback by name) ---
 function kill(pid, label, fallbackProcessName = null) {
@@ -41,20 +39,6 @@ function kill(pid, label, fallbackProcessName = null) {
   return false;
 }
 
-// --- WSL-safe Redis Kill ---// --- WSL-safe Redis Kill ---
-function killRedisWSL() {
-  try {
-    execSync(`wsl pkill -f redis-server`);
-    console.log("🛑 Redis (inside WSL) stopped");
-    logToFile("🛑 STOPPED Redis", "Killed via wsl:pkill");
-    return true;
-  } catch (err) {
-    console.warn("⚠️ Could not kill Redis with normal pkill. Skipping Redis kill.");
-    logToFile("⚠️ REDIS KILL FAILED", err.message);
-    return false;
-  }
-}
-
 // --- Main Stop Routine ---
 async function stopAssistantFlow() {
   if (!fs.existsSync(stateFile)) {
@@ -67,9 +51,9 @@ async function stopAssistantFlow() {
 
     const pollerKilled = kill(state.pollerPID, "Poller", "node.exe");
     const screenpipeKilled = kill(state.screenpipePID, "Screenpipe", "screenpipe.exe");
-    const redisKilled = killRedisWSL();
+    const cacheKilled = kill(state.cachePID, "Cache", "gem-cache.exe");
 
-    if (!pollerKilled && !screenpipeKilled && !redisKilled) {
+    if (!pollerKilled && !screenpipeKilled && !cacheKilled) {
       console.warn("⚠️ Nothing was running.");
     }
   } 
@@ -0,0 +1,138 @@
+import { native } from "./native.js";
+
+// Plain JS equivalent of Gem/core's TextChunker, used when the addon is not
+// built. Same rules: sentence/line units, content-defined cuts past half
+// the budget, overlap from the previous chunk. Boundaries may differ from
+// the native ones (different unit hash), which only costs cache hits.
+
+const TOKEN_PIECES = /[A-Za-z]+|[0-9]+|\s+|[^\x00-\x7F]|[\x00-\x7F]/gu;
+
+export function estimateTokens(text) {
+  let tokens = 0;
+  for (const [piece] of String(text).matchAll(TOKEN_PIECES)) {
+    const c = piece.charCodeAt(0);
+    if ((c >= 65 && c <= 90) || (c >= 97 && c <= 122)) tokens += 1 + Math.floor((piece.length - 1) / 6);
+    else if (c >= 48 && c <= 57) tokens += Math.floor((piece.length + 2) / 3);
+    else if (/\s/.test(piece)) tokens += piece.length > 1 || piece.includes("\n") ? 1 : 0;
+    else tokens += 1;
+  }
+  return tokens;
+}
+
+function unitHash(text) {
+  let h = 0x811c9dc5; // FNV-1a, 32-bit
+  for (let i = 0; i < text.length; i++) {
+    h ^= text.charCodeAt(i);
+    h = Math.imul(h, 0x01000193);
+  }
+  h ^= h >>> 16;
+  h = Math.imul(h, 0x85ebca6b);
+  h ^= h >>> 13;
+  return h >>> 0;
+}
+
+const UNIT_END = /[.!?](?=\s|$)\s*|\n\s*/g;
+
+class JsTextChunker {
+  constructor({ maxTokens = 2048, overlapTokens = 128 } = {}) {
+    this.maxTokens = Math.max(1, maxTokens);
+    this.overlapTokens = overlapTokens >= this.maxTokens ? Math.floor(this.maxTokens / 4) : Math.max(0, overlapTokens);
+  }
+
+  countTokens(text) {
+    return estimateTokens(text);
+  }
+
+  units(text, bodyBudget) {
+    const cutRate = 2 / Math.max(bodyBudget - Math.floor(bodyBudget / 2), 1);
+    const out = [];
+    const emit = (piece) => {
+      const tokens = estimateTokens(piece);
+      if (tokens > bodyBudget) {
+        // Between words, and between characters for a word that won't fit
+        let current = "";
+        let currentTokens = 0;
+        for (const [word] of piece.matchAll(/\S*\s*/g)) {
+          if (!word) continue;
+          let rest = word;
+          let restTokens = estimateTokens(rest);
+          if (currentTokens > 0 && currentTokens + restTokens > bodyBudget) {
+            out.push({ text: current, tokens: currentTokens, cut: false });
+            current = "";
+            currentTokens = 0;
+          }
+          while (restTokens > bodyBudget) {
+            const chars = Array.from(rest);
+            const take = Math.max(1, Math.floor(chars.length * bodyBudget / restTokens));
+            const head = chars.slice(0, take).join("");
+            out.push({ text: head, tokens: estimateTokens(head), cut: false });
+            rest = chars.slice(take).join("");
+            restTokens = estimateTokens(rest);
+          }
+          current += rest;
+          currentTokens += restTokens;
+        }
+        if (current) out.push({ text: current, tokens: currentTokens, cut: false });
+        return;
+      }
+      const threshold = Math.min(1, tokens * cutRate) * 4294967296;
+      out.push({ text: piece, tokens, cut: unitHash(piece) < threshold });
+    };
+
+    let start = 0;
+    for (const match of text.matchAll(UNIT_END)) {
+      const end = match.index + match[0].length;
+      if (end > start) emit(text.slice(start, end));
+      start = end;
+    }
+    if (start < text.length) emit(text.slice(start));
+    return out;
+  }
+
+  split(text) {
+    text = String(text ?? "");
+    if (!text) return [];
+
+    const bodyBudget = this.maxTokens - this.overlapTokens;
+    const minBody = Math.floor(bodyBudget / 2);
+    const all = this.units(text, bodyBudget);
+
+    const total = all.reduce((sum, unit) => sum + unit.tokens, 0);
+    if (total <= this.maxTokens) return [{ text, tokens: total }];
+
+    const chunks = [];
+    let i = 0;
+    let previousBody = 0;
+    while (i < all.length) {
+      const bodyStart = i;
+      let body = 0;
+      while (i < all.length) {
+        if (body > 0 && body + all[i].tokens > bodyBudget) break;
+        body += all[i].tokens;
+        i++;
+        if (body >= minBody && all[i - 1].cut) break;
+      }
+
+      let first = bodyStart;
+      let overlap = 0;
+      while (first > previousBody && overlap + all[first - 1].tokens <= this.overlapTokens) {
+        first--;
+        overlap += all[first].tokens;
+      }
+
+      chunks.push({
+        text: all.slice(first, i).map(unit => unit.text).join(""),
+        tokens: body + overlap
+      });
+      previousBody = bodyStart;
+    }
+    return chunks;
+  }
+}
+
+// Token-budgeted chunker for long documents; the addon's when it is built
+export function createTextChunker(options) {
+  return native?.TextChunker ? new native.TextChunker(options) : new JsTextChunker(options);
+}
+
+export { JsTextChunker };
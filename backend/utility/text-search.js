@@ -0,0 +1,18 @@
+import { native } from "./native.js";
+
+// Plain JS equivalent of Gem/core's text kernels, used when the addon is not
+// built. Same rules: lower case, each run of separators (ASCII punctuation
+// and whitespace, Latin-1 symbols, general and CJK punctuation) becomes one
+// space, other characters are kept. Native case folding covers fewer
+// scripts than toLowerCase; both sides of a comparison always go through
+// the same implementation, so that never splits a match.
+const SEPARATORS = /[\x00-\x2f\x3a-\x40\x5b-\x60\x7b-\xbf\xd7\xf7\u2000-\u206f\u3000-\u303f\ufeff]+/g;
+
+export function jsNormalizeText(text) {
+  return String(text ?? "").toLowerCase().replace(SEPARATORS, " ").trim();
+}
+
+const useNative = Boolean(native?.normalizeText);
+
+// Normalised form used for every keyword and context query
+export const normalizeText = useNative ? (text) => native.normalizeText(String(text ?? "")) : jsNormalizeText;
@@ -0,0 +1,106 @@
+import { randomBytes } from "crypto";
+import { performance } from "perf_hooks";
+
+import { onMessage, sendMessage } from "./ipc-client.js";
+
+// Pipeline latency tracing. Every OCR frame gets a trace id that follows it
+// through cleaning, threading, the suggestion debounce, the agent, the app
+// and the action; each stage records a span (start/end, epoch ms). Spans go
+// into a preallocated ring and are shipped to the app's Latency tab in one
+// "spans" IPC message per second at most. Without the app connected the
+// ring just keeps the newest spans.
+
+// Pipeline order; names match TraceCollector::Stage in Gem/tracecollector.h
+export const STAGES = [
+  "screenpipe_query",
+  "clean_ocr",
+  "add_to_thread",
+  "debounce",
+  "suggest",
+  "handoff",
+  "user",
+  "perform_action"
+];
+
+const CAPACITY = 4096;
+const FLUSH_DELAY_MS = 1000;
+
+// Columns instead of span objects: recording allocates nothing
+const traces = new Array(CAPACITY).fill("");
+const stages = new Uint8Array(CAPACITY);
+const starts = new Float64Array(CAPACITY);
+const ends = new Float64Array(CAPACITY);
+let head = 0;  // next slot to write
+let count = 0; // spans waiting to be shipped
+let dropped = 0;
+let flushTimer = null;
+
+const stageIndex = new Map(STAGES.map((name, index) => [name, index]));
+
+let latest = null; // newest trace to reach a thread, for the suggestion debounce
+
+// Sub-millisecond wall clock, comparable with the app's
+export function traceNow() {
+  return performance.timeOrigin + performance.now();
+}
+
+export function newTraceId() {
+  return randomBytes(8).toString("hex");
+}
+
+export function recordSpan(trace, stage, start, end = traceNow()) {
+  const index = stageIndex.get(stage);
+  if (!trace || index === undefined) return;
+
+  traces[head] = trace;
+  stages[head] = index;
+  starts[head] = start;
+  ends[head] = Math.max(start, end);
+  head = (head + 1) % CAPACITY;
+  if (count < CAPACITY) count++;
+  else dropped++;
+
+  if (!flushTimer) {
+    flushTimer = setTimeout(flushSpans, FLUSH_DELAY_MS);
+    flushTimer.unref?.();
+  }
+}
+
+// Times an async stage; the span is recorded even if fn throws
+export async function traced(trace, stage, fn) {
+  const start = traceNow();
+  try {
+    return await fn();
+  } finally {
+    recordSpan(trace, stage, start);
+  }
+}
+
+export function markThreaded(trace, at = traceNow()) {
+  if (trace) latest = { trace, at };
+}
+
+export function latestThreadedTrace() {
+  return latest;
+}
+
+export function getTraceStats() {
+  return { pending: count, dropped, capacity: CAPACITY };
+}
+
+function flushSpans() {
+  flushTimer = null;
+  if (count === 0) return;
+
+  const spans = new Array(count);
+  let index = (head - count + CAPACITY) % CAPACITY;
+  for (let i = 0; i < count; i++) {
+    spans[i] = [traces[index], STAGES[stages[index]], starts[index], ends[index]];
+    index = (index + 1) % CAPACITY;
+  }
+
+  // Kept for the next connection if the app isn't there
+  if (sendMessage("spans", { spans, dropped })) count = 0;
+}
+
+onMessage("connect", flushSpans);